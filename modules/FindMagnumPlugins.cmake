@@ -500,7 +500,12 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
             set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
                 INTERFACE_LINK_LIBRARIES ${IL_LIBRARIES} ${ILU_LIBRARIES})
 
-        # DrFlacAudioImporter has no dependencies
+        # DrFlacAudioImporter plugin dependencies
+        elseif(_component STREQUAL DrFlacAudioImporter)
+            find_package(Threads REQUIRED)
+            set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                INTERFACE_LINK_LIBRARIES Threads::Threads)
+
         # DrMp3AudioImporter has no dependencies
         # DrWavAudioImporter has no dependencies
         # EtcDecImageConverter has no dependencies
@@ -513,6 +518,9 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
 
         # FreeTypeFont plugin dependencies
         elseif(_component STREQUAL FreeTypeFont)
+            find_package(Threads REQUIRED)
+            set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                INTERFACE_LINK_LIBRARIES Threads::Threads)
             find_package(Freetype)
             # Need to handle special cases where both debug and release
             # libraries are available (in form of debug;A;optimized;B in
@@ -528,8 +536,9 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
         # GlslangShaderConverter plugin dependencies
         elseif(_component STREQUAL GlslangShaderConverter)
             find_package(Glslang REQUIRED)
+            find_package(Threads REQUIRED)
             set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
-                INTERFACE_LINK_LIBRARIES Glslang::Glslang)
+                INTERFACE_LINK_LIBRARIES Glslang::Glslang Threads::Threads)
 
         # GltfImporter has no dependencies
         # GltfSceneConverter has no dependencies
@@ -567,7 +576,26 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
                     INTERFACE_LINK_LIBRARIES ${JPEG_LIBRARIES})
             endif()
 
-        # KtxImageConverter has no dependencies
+        # KtxImageConverter plugin dependencies. The supercompression
+        # libraries are optional, the configure file says which of them the
+        # plugin was built with, and only those are then required.
+        elseif(_component STREQUAL KtxImageConverter)
+            find_package(Threads REQUIRED)
+            set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                INTERFACE_LINK_LIBRARIES Threads::Threads)
+            list(FIND _magnumPluginsConfigure "#define MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD" _magnumPluginsKtxImageConverterWithZstd)
+            if(NOT _magnumPluginsKtxImageConverterWithZstd EQUAL -1)
+                find_package(Zstd REQUIRED)
+                set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                    INTERFACE_LINK_LIBRARIES Zstd::Zstd)
+            endif()
+            list(FIND _magnumPluginsConfigure "#define MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB" _magnumPluginsKtxImageConverterWithZlib)
+            if(NOT _magnumPluginsKtxImageConverterWithZlib EQUAL -1)
+                find_package(ZLIB REQUIRED)
+                set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                    INTERFACE_LINK_LIBRARIES ZLIB::ZLIB)
+            endif()
+
         # KtxImporter has no dependencies
 
         # MeshOptimizerSceneConverter plugin dependencies
@@ -601,7 +629,12 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
                     INTERFACE_LINK_OPTIONS "SHELL:-s DISABLE_EXCEPTION_CATCHING=0")
             endif()
 
-        # No special setup for the OpenDdl library
+        # OpenDdl library dependencies
+        elseif(_component STREQUAL OpenDdl)
+            find_package(Threads REQUIRED)
+            set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                INTERFACE_LINK_LIBRARIES Threads::Threads)
+
         # OpenGexImporter has no dependencies
 
         # PngImageConverter / PngImporter plugin dependencies
@@ -621,14 +654,21 @@ foreach(_component ${MagnumPlugins_FIND_COMPONENTS})
                 set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
                     INTERFACE_LINK_LIBRARIES ${PNG_LIBRARIES})
             endif()
+            # PngImageConverter additionally compresses in parallel
+            if(_component STREQUAL PngImageConverter)
+                find_package(Threads REQUIRED)
+                set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
+                    INTERFACE_LINK_LIBRARIES Threads::Threads)
+            endif()
 
         # PrimitiveImporter has no dependencies
 
         # SpirvToolsShaderConverter plugin dependencies
         elseif(_component STREQUAL SpirvToolsShaderConverter)
             find_package(SpirvTools REQUIRED)
+            find_package(Threads REQUIRED)
             set_property(TARGET MagnumPlugins::${_component} APPEND PROPERTY
-                INTERFACE_LINK_LIBRARIES SpirvTools::SpirvTools SpirvTools::Opt)
+                INTERFACE_LINK_LIBRARIES SpirvTools::SpirvTools SpirvTools::Opt SpirvTools::Link Threads::Threads)
 
         # SpngImporter plugin dependencies
         elseif(_component STREQUAL SpngImporter)
@@ -8,11 +8,14 @@
 #  SpirvTools::SpirvTools    - SpirvTools imported target
 #  SpirvTools::Opt           - SpirvTools optimizer imported target. Depends on
 #   SpirvTools::SpirvTools.
+#  SpirvTools::Link          - SpirvTools linker imported target. Depends on
+#   SpirvTools::Opt.
 #
 # Additionally these variables are defined for internal usage:
 #
 #  SpirvTools_LIBRARY        - SpirvTools library
 #  SpirvTools_Opt_LIBRARY    - SpirvTools library
+#  SpirvTools_Link_LIBRARY   - SpirvTools linker library
 #  SpirvTools_INCLUDE_DIR    - Include dir
 #
 
@@ -98,6 +101,10 @@ if(TARGET SPIRV-Tools)
     if(NOT TARGET SPIRV-Tools-opt)
         find_package(SPIRV-Tools-opt CONFIG REQUIRED)
     endif()
+    # And the linker as well, same story
+    if(NOT TARGET SPIRV-Tools-link)
+        find_package(SPIRV-Tools-link CONFIG REQUIRED)
+    endif()
 
     get_target_property(_SPIRVTOOLS_INTERFACE_INCLUDE_DIRECTORIES SPIRV-Tools INTERFACE_INCLUDE_DIRECTORIES)
     # In case of a CMake subproject, the SPIRV-Tools target doesn't define any
@@ -133,6 +140,11 @@ if(TARGET SPIRV-Tools)
         add_library(SpirvTools::Opt INTERFACE IMPORTED)
         set_target_properties(SpirvTools::Opt PROPERTIES INTERFACE_LINK_LIBRARIES SPIRV-Tools-opt)
     endif()
+    if(NOT TARGET SpirvTools::Link)
+        # Aliases of (global) targets [..] CMake 3.11 [...], as above
+        add_library(SpirvTools::Link INTERFACE IMPORTED)
+        set_target_properties(SpirvTools::Link PROPERTIES INTERFACE_LINK_LIBRARIES SPIRV-Tools-link)
+    endif()
 
     # Just to make FPHSA print some meaningful location, nothing else. Luckily
     # we can just reuse what we had to find above.
@@ -146,6 +158,7 @@ endif()
 # Libraries. See above why this completely ignores SPIRV-Tools-shared.
 find_library(SpirvTools_LIBRARY NAMES SPIRV-Tools)
 find_library(SpirvTools_Opt_LIBRARY NAMES SPIRV-Tools-opt)
+find_library(SpirvTools_Link_LIBRARY NAMES SPIRV-Tools-link)
 
 # Include dir
 find_path(SpirvTools_INCLUDE_DIR
@@ -173,3 +186,10 @@ if(NOT TARGET SpirvTools::Opt)
         IMPORTED_LOCATION ${SpirvTools_Opt_LIBRARY}
         INTERFACE_LINK_LIBRARIES SpirvTools::SpirvTools)
 endif()
+
+if(NOT TARGET SpirvTools::Link)
+    add_library(SpirvTools::Link UNKNOWN IMPORTED)
+    set_target_properties(SpirvTools::Link PROPERTIES
+        IMPORTED_LOCATION ${SpirvTools_Link_LIBRARY}
+        INTERFACE_LINK_LIBRARIES SpirvTools::Opt)
+endif()
@@ -0,0 +1,68 @@
+#ifndef Magnum_Implementation_audioFileStream_h
+#define Magnum_Implementation_audioFileStream_h
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstdio>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+
+#ifdef CORRADE_TARGET_WINDOWS
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Unicode.h>
+#endif
+
+/* Common code used by the audio importer plugins to decode directly from a
+   file in the streaming mode, instead of reading the whole file to memory
+   first. The read and seek functions have the same shape as the callbacks
+   in dr_flac, dr_wav and dr_mp3, with the user data being the file handle.
+   Only the seek origin enum differs between the libraries, so that's
+   translated by the caller. */
+namespace Magnum { namespace Implementation { namespace {
+
+/* Returns nullptr if the file can't be opened. UTF-8 paths are widened on
+   Windows as the narrow stdio APIs use the current codepage there. */
+inline std::FILE* openAudioFile(const Containers::StringView filename) {
+    #ifdef CORRADE_TARGET_WINDOWS
+    return _wfopen(Utility::Unicode::widen(filename).data(), L"rb");
+    #else
+    return std::fopen(Containers::String::nullTerminatedView(filename).data(), "rb");
+    #endif
+}
+
+inline std::size_t readAudioFile(void* const userData, void* const out, const std::size_t size) {
+    return std::fread(out, 1, size, static_cast<std::FILE*>(userData));
+}
+
+/* The libraries split offsets larger than 2 GB into multiple calls, so an int
+   is enough even for large files */
+inline bool seekAudioFile(void* const userData, const int offset, const bool fromCurrent) {
+    return std::fseek(static_cast<std::FILE*>(userData), offset, fromCurrent ? SEEK_CUR : SEEK_SET) == 0;
+}
+
+}}}
+
+#endif
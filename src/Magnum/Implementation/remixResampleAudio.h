@@ -0,0 +1,345 @@
+#ifndef Magnum_Implementation_remixResampleAudio_h
+#define Magnum_Implementation_remixResampleAudio_h
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/Magnum.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Functions.h>
+
+/* Common code used by the audio importer plugins to remix and resample the
+   decoded data to a channel count and a sample rate given in the plugin
+   configuration. Everything is done on floats, the output is always
+   interleaved 32-bit float samples. To not depend on the Audio library, the
+   input sample type and the channel layout are described by the caller
+   instead of a BufferFormat.
+
+   Remixing supports downmixing any of the OpenAL channel layouts to stereo or
+   mono and upmixing mono to stereo. The resampler is a polyphase
+   Kaiser-windowed sinc filter, with the filter bank calculated upfront for
+   each combination of sample rates and with linear interpolation between
+   phases if the rate ratio has too large numerator. Each channel is processed
+   as a contiguous zero-padded array, so the inner loop is a plain dot product
+   that the compiler can vectorize. */
+namespace Magnum { namespace Implementation { namespace {
+
+enum class AudioSampleType: UnsignedByte {
+    /* 8-bit samples are unsigned */
+    UnsignedByte,
+    Short,
+    Float,
+    Double
+};
+
+std::size_t audioSampleTypeSize(const AudioSampleType type) {
+    switch(type) {
+        case AudioSampleType::UnsignedByte: return 1;
+        case AudioSampleType::Short: return 2;
+        case AudioSampleType::Float: return 4;
+        case AudioSampleType::Double: return 8;
+    }
+
+    CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+}
+
+/* Remixing matrices for downmixing to stereo, in the channel order used by
+   the OpenAL BufferFormat enums, with the LFE channel dropped. Center and
+   surround channels are attenuated by 3 dB, rear center by 6 dB to each side.
+   Each row is then normalized so the coefficients sum to 1 to avoid
+   clipping. */
+constexpr Float Db3 = 0.70710678f;
+constexpr Float Db6 = 0.5f;
+/* Front left, front right, rear left, rear right */
+constexpr Float QuadToStereo[2][4]{
+    {1.0f, 0.0f, Db3, 0.0f},
+    {0.0f, 1.0f, 0.0f, Db3}
+};
+/* Front left, front right, front center, LFE, rear left, rear right */
+constexpr Float Surround51ToStereo[2][6]{
+    {1.0f, 0.0f, Db3, 0.0f, Db3, 0.0f},
+    {0.0f, 1.0f, Db3, 0.0f, 0.0f, Db3}
+};
+/* Front left, front right, front center, LFE, rear center, side left, side
+   right */
+constexpr Float Surround61ToStereo[2][7]{
+    {1.0f, 0.0f, Db3, 0.0f, Db6, Db3, 0.0f},
+    {0.0f, 1.0f, Db3, 0.0f, Db6, 0.0f, Db3}
+};
+/* Front left, front right, front center, LFE, rear left, rear right, side
+   left, side right */
+constexpr Float Surround71ToStereo[2][8]{
+    {1.0f, 0.0f, Db3, 0.0f, Db3, 0.0f, Db3, 0.0f},
+    {0.0f, 1.0f, Db3, 0.0f, 0.0f, Db3, 0.0f, Db3}
+};
+
+/* Whether remixing from given channel count to another is supported. Same
+   channel count is always supported. */
+bool canRemixAudio(const UnsignedInt channelCount, const UnsignedInt outputChannelCount) {
+    if(channelCount == outputChannelCount)
+        return true;
+    if(outputChannelCount == 2)
+        return channelCount == 1 || channelCount == 4 || channelCount == 6 || channelCount == 7 || channelCount == 8;
+    if(outputChannelCount == 1)
+        return channelCount == 2 || channelCount == 4 || channelCount == 6 || channelCount == 7 || channelCount == 8;
+    return false;
+}
+
+/* Fills a outputChannelCount x channelCount remixing matrix */
+void audioRemixMatrix(const UnsignedInt channelCount, const UnsignedInt outputChannelCount, Float* const matrix) {
+    CORRADE_INTERNAL_ASSERT(canRemixAudio(channelCount, outputChannelCount));
+
+    /* Identity */
+    if(channelCount == outputChannelCount) {
+        for(UnsignedInt o = 0; o != outputChannelCount; ++o)
+            for(UnsignedInt i = 0; i != channelCount; ++i)
+                matrix[o*channelCount + i] = o == i ? 1.0f : 0.0f;
+        return;
+    }
+
+    /* Mono to stereo, duplicate */
+    if(channelCount == 1) {
+        matrix[0] = matrix[1] = 1.0f;
+        return;
+    }
+
+    /* Downmix to stereo first. For stereo it's an identity. */
+    Float stereo[2][8]{};
+    const Float* source = nullptr;
+    switch(channelCount) {
+        case 2: stereo[0][0] = stereo[1][1] = 1.0f; break;
+        case 4: source = &QuadToStereo[0][0]; break;
+        case 6: source = &Surround51ToStereo[0][0]; break;
+        case 7: source = &Surround61ToStereo[0][0]; break;
+        case 8: source = &Surround71ToStereo[0][0]; break;
+        default: CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+    }
+    if(source) for(UnsignedInt o = 0; o != 2; ++o) {
+        Float sum = 0.0f;
+        for(UnsignedInt i = 0; i != channelCount; ++i)
+            sum += source[o*channelCount + i];
+        for(UnsignedInt i = 0; i != channelCount; ++i)
+            stereo[o][i] = source[o*channelCount + i]/sum;
+    }
+
+    /* And then, if mono is desired, average the two */
+    for(UnsignedInt o = 0; o != outputChannelCount; ++o)
+        for(UnsignedInt i = 0; i != channelCount; ++i)
+            matrix[o*channelCount + i] = outputChannelCount == 2 ? stereo[o][i] :
+                0.5f*(stereo[0][i] + stereo[1][i]);
+}
+
+UnsignedInt greatestCommonDivisor(UnsignedInt a, UnsignedInt b) {
+    while(b) {
+        const UnsignedInt t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Zeroth-order modified Bessel function of the first kind, for the Kaiser
+   window. The series converges fast for the argument range used. */
+Double besselI0(const Double x) {
+    Double sum = 1.0, term = 1.0;
+    for(Int k = 1; k != 64; ++k) {
+        const Double t = x/(2.0*k);
+        term *= t*t;
+        sum += term;
+        if(term < sum*1.0e-12) break;
+    }
+    return sum;
+}
+
+/* Half-length of the lowpass filter in zero crossings at the cutoff
+   frequency and the Kaiser window shape, giving roughly 80 dB of stopband
+   attenuation. The cutoff is slightly below the Nyquist frequency of the
+   lower of the two rates to leave room for the transition band. */
+constexpr Int ResampleZeroCrossings = 16;
+constexpr Double ResampleKaiserBeta = 8.0;
+constexpr Double ResampleRolloff = 0.95;
+/* If the reduced output rate has a larger numerator than this, phases
+   in between are linearly interpolated */
+constexpr UnsignedInt ResampleMaxPhaseCount = 1024;
+
+/* Dot product split into four independent accumulators, which allows the
+   compiler to vectorize it even without reassociating float additions */
+Float audioDotProduct(const Float* const a, const Float* const b, const std::size_t size) {
+    Float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    std::size_t i = 0;
+    for(; i + 4 <= size; i += 4) {
+        sum0 += a[i + 0]*b[i + 0];
+        sum1 += a[i + 1]*b[i + 1];
+        sum2 += a[i + 2]*b[i + 2];
+        sum3 += a[i + 3]*b[i + 3];
+    }
+    for(; i != size; ++i)
+        sum0 += a[i]*b[i];
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/* Count of output frames for given input frame count and sample rates */
+std::size_t resampledAudioFrameCount(const std::size_t frameCount, const UnsignedInt frequency, const UnsignedInt outputFrequency) {
+    const UnsignedInt divisor = greatestCommonDivisor(frequency, outputFrequency);
+    const UnsignedLong up = outputFrequency/divisor;
+    const UnsignedLong down = frequency/divisor;
+    return (frameCount*up + down - 1)/down;
+}
+
+/* Converts the input to floats, remixes it to outputChannelCount channels and
+   resamples from frequency to outputFrequency. Expects that
+   canRemixAudio() returns true for given channel counts, the returned
+   array contains interleaved floats. */
+Containers::Array<char> remixResampleAudio(const Containers::ArrayView<const char> data, const AudioSampleType type, const UnsignedInt channelCount, const UnsignedInt frequency, const UnsignedInt outputChannelCount, const UnsignedInt outputFrequency) {
+    CORRADE_INTERNAL_ASSERT(channelCount && outputChannelCount && channelCount <= 8 && frequency && outputFrequency);
+    const std::size_t sampleSize = audioSampleTypeSize(type);
+    const std::size_t frameCount = data.size()/(sampleSize*channelCount);
+
+    /* Filter parameters. For upsampling the cutoff is at the input Nyquist
+       frequency, for downsampling at the output one, in which case the
+       filter gets proportionally longer. */
+    const UnsignedInt divisor = greatestCommonDivisor(frequency, outputFrequency);
+    const UnsignedInt up = outputFrequency/divisor;
+    const UnsignedInt down = frequency/divisor;
+    const bool resample = up != down;
+    const Double cutoff = (up < down ? Double(up)/down : 1.0)*ResampleRolloff;
+    const std::size_t halfLength = resample ? std::size_t(std::ceil(ResampleZeroCrossings/cutoff)) : 0;
+    const std::size_t tapCount = 2*halfLength;
+
+    /* Remix directly while deinterleaving and converting to floats. Each
+       output channel is stored contiguously, with halfLength zeros on both
+       sides so the resampling doesn't need to special-case the edges. */
+    Float remixMatrix[8*8];
+    audioRemixMatrix(channelCount, outputChannelCount, remixMatrix);
+
+    const std::size_t paddedFrameCount = frameCount + tapCount;
+    Containers::Array<Float> channels{ValueInit, paddedFrameCount*outputChannelCount};
+    Float frame[8];
+    for(std::size_t i = 0; i != frameCount; ++i) {
+        const char* const in = data.data() + i*channelCount*sampleSize;
+        for(UnsignedInt c = 0; c != channelCount; ++c) {
+            switch(type) {
+                case AudioSampleType::UnsignedByte:
+                    frame[c] = (Int(UnsignedByte(in[c])) - 128)/128.0f;
+                    break;
+                case AudioSampleType::Short: {
+                    Short value;
+                    std::memcpy(&value, in + c*2, 2);
+                    frame[c] = value/32768.0f;
+                } break;
+                case AudioSampleType::Float:
+                    std::memcpy(frame + c, in + c*4, 4);
+                    break;
+                case AudioSampleType::Double: {
+                    Double value;
+                    std::memcpy(&value, in + c*8, 8);
+                    frame[c] = Float(value);
+                } break;
+            }
+        }
+
+        for(UnsignedInt o = 0; o != outputChannelCount; ++o) {
+            Float sum = 0.0f;
+            for(UnsignedInt c = 0; c != channelCount; ++c)
+                sum += remixMatrix[o*channelCount + c]*frame[c];
+            channels[o*paddedFrameCount + halfLength + i] = sum;
+        }
+    }
+
+    /* No resampling needed, just interleave */
+    if(!resample) {
+        Containers::Array<char> out{NoInit, frameCount*outputChannelCount*sizeof(Float)};
+        Float* const outFloats = reinterpret_cast<Float*>(out.data());
+        for(std::size_t i = 0; i != frameCount; ++i)
+            for(UnsignedInt o = 0; o != outputChannelCount; ++o)
+                outFloats[i*outputChannelCount + o] = channels[o*paddedFrameCount + i];
+        return out;
+    }
+
+    /* Filter bank. Phase p is for output samples that lie at p/phaseCount
+       between two input samples, tap k then corresponds to the input sample
+       at offset k - halfLength + 1 from the first one. There's one more
+       phase than needed to interpolate in the last interval. Each phase is
+       normalized to have unit gain for a constant signal. */
+    const UnsignedInt phaseCount = Math::min(up, ResampleMaxPhaseCount);
+    Containers::Array<Float> filters{NoInit, (phaseCount + 1)*tapCount};
+    const Double windowScale = 1.0/besselI0(ResampleKaiserBeta);
+    for(UnsignedInt p = 0; p <= phaseCount; ++p) {
+        Float* const filter = filters.data() + p*tapCount;
+        const Double offset = Double(p)/phaseCount;
+        Double sum = 0.0;
+        for(std::size_t k = 0; k != tapCount; ++k) {
+            const Double t = Double(k) - Double(halfLength - 1) - offset;
+            const Double x = cutoff*t;
+            const Double sinc = x == 0.0 ? 1.0 :
+                std::sin(Constants<Double>::pi()*x)/(Constants<Double>::pi()*x);
+            const Double w = t/halfLength;
+            const Double window = w <= -1.0 || w >= 1.0 ? 0.0 :
+                besselI0(ResampleKaiserBeta*std::sqrt(1.0 - w*w))*windowScale;
+            const Double value = sinc*window;
+            filter[k] = Float(value);
+            sum += value;
+        }
+        for(std::size_t k = 0; k != tapCount; ++k)
+            filter[k] = Float(filter[k]/sum);
+    }
+
+    /* Output sample n lies at n*down/up in the input. With the padding, the
+       first tap for input sample i is at i in the padded array. */
+    const std::size_t outputFrameCount = resampledAudioFrameCount(frameCount, frequency, outputFrequency);
+    Containers::Array<char> out{NoInit, outputFrameCount*outputChannelCount*sizeof(Float)};
+    Float* const outFloats = reinterpret_cast<Float*>(out.data());
+    for(std::size_t n = 0; n != outputFrameCount; ++n) {
+        const UnsignedLong position = UnsignedLong(n)*down;
+        const std::size_t input = position/up;
+        const UnsignedInt remainder = position % up;
+
+        /* Exact phase if there's at most ResampleMaxPhaseCount phases,
+           otherwise interpolate between two neighboring ones */
+        const Double phase = Double(remainder)*phaseCount/up;
+        const UnsignedInt phase0 = UnsignedInt(phase);
+        const Float factor = Float(phase - phase0);
+        const Float* const filter0 = filters.data() + phase0*tapCount;
+        const Float* const filter1 = filter0 + tapCount;
+
+        for(UnsignedInt o = 0; o != outputChannelCount; ++o) {
+            const Float* const in = channels.data() + o*paddedFrameCount + input + 1;
+            Float value = audioDotProduct(in, filter0, tapCount);
+            if(factor != 0.0f)
+                value += factor*(audioDotProduct(in, filter1, tapCount) - value);
+            outFloats[n*outputChannelCount + o] = value;
+        }
+    }
+
+    return out;
+}
+
+}}}
+
+#endif
@@ -0,0 +1,387 @@
+#ifndef Magnum_Implementation_yFlipCompressedBlocks_h
+#define Magnum_Implementation_yFlipCompressedBlocks_h
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstring>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/Endianness.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Math/ColorBatch.h>
+#include <Magnum/Math/Functions.h>
+
+/* Common code used by KtxImporter and DdsImporter to Y-flip block-compressed
+   data in place. BC1 to BC5 is delegated to the batch helpers in
+   Magnum/Math/ColorBatch.h, ETC2 and EAC is handled here. The per-block
+   helpers operate on a native-endian 64-bit word, the big-endian byte order of
+   ETC2 and EAC blocks is taken care of by the caller.
+
+   BC6H, BC7 and ASTC aren't supported, as with the multi-partition modes a
+   Y-flipped partition shape isn't generally present in the (fixed or
+   procedurally generated) partition set, so these can't be flipped without
+   decoding and encoding the block again. Importers fail for BC6H and BC7
+   instead of importing them with a wrong orientation, see isBc6hOrBc7(). */
+namespace Magnum { namespace Implementation { namespace {
+
+/* EAC R11, RG11 and the ETC2 RGBA8 alpha block. The upper 16 bits contain the
+   base codeword, multiplier and table index, the lower 48 bits are 3-bit
+   pixel indices with the first pixel in the most significant bits and pixels
+   ordered column by column, i.e. each 12 bits is one column of four pixels.
+   A Y flip is then just reversing the order of the four triplets in each
+   column, which can be done for all four columns at once. */
+UnsignedLong yFlipEacBlock(const UnsignedLong block) {
+    return (block & 0xffff000000000000ull)|
+        ((block & 0x0000e00e00e00e00ull) >> 9)|
+        ((block & 0x00001c01c01c01c0ull) >> 3)|
+        ((block & 0x0000038038038038ull) << 3)|
+        ((block & 0x0000007007007007ull) << 9);
+}
+
+/* Quantized ETC2 planar mode channel with given bit count. The value at a
+   pixel is extrapolated from the origin O, the horizontal H and the vertical
+   V values, with V being the value at y = 4, and the result is clamped to the
+   8-bit range. For a Y flip the new origin is the original value at y = 3 and
+   the new vertical value is the original extrapolated to y = -1, which isn't
+   generally representable in the quantized values. Instead, the neighborhood
+   of the ideal values is searched for the ones giving the smallest maximal
+   error against the original pixel values flipped.
+
+   If the ideal values fit into the 8-bit range, the maximal error is 3 for
+   the 6-bit channels and 2 for the 7-bit channel. Otherwise the original
+   gradient got clamped and the flipped gradient can't be clamped at the other
+   end in the same way, so the error can get arbitrarily close to the whole
+   range for steep gradients. */
+void yFlipEtc2PlanarChannel(UnsignedInt& o, UnsignedInt& h, UnsignedInt& v, const Int bits) {
+    const Int max = (1 << bits) - 1;
+    const auto expand = [bits](const Int value) {
+        return (value << (8 - bits))|(value >> (2*bits - 8));
+    };
+    const auto decode = [](const Int o, const Int h, const Int v, const Int x, const Int y) {
+        return Math::clamp((x*(h - o) + y*(v - o) + 4*o + 2) >> 2, 0, 255);
+    };
+    const auto quantize = [max](const Int value) {
+        return (Math::clamp(value, 0, 255)*max + 127)/255;
+    };
+
+    const Int oe = expand(o), he = expand(h), ve = expand(v);
+    Int target[4][4];
+    for(Int y = 0; y != 4; ++y)
+        for(Int x = 0; x != 4; ++x)
+            target[y][x] = decode(oe, he, ve, x, 3 - y);
+
+    /* The candidates are tried starting with the ideal values, so if those
+       are exact, the result is the same as with just rounding them */
+    const Int idealO = (oe + 3*ve + 2)/4;
+    const Int idealQuantized[3]{
+        quantize(idealO),
+        quantize(idealO + he - oe),
+        quantize(idealO + oe - ve)
+    };
+    constexpr Int offsets[]{0, -1, 1};
+    Int bestError = 256;
+    for(const Int offsetO: offsets) {
+        const Int newO = idealQuantized[0] + offsetO;
+        if(newO < 0 || newO > max) continue;
+        for(const Int offsetH: offsets) {
+            const Int newH = idealQuantized[1] + offsetH;
+            if(newH < 0 || newH > max) continue;
+            for(const Int offsetV: offsets) {
+                const Int newV = idealQuantized[2] + offsetV;
+                if(newV < 0 || newV > max) continue;
+
+                const Int newOe = expand(newO), newHe = expand(newH), newVe = expand(newV);
+                Int error = 0;
+                for(Int y = 0; y != 4 && error < bestError; ++y)
+                    for(Int x = 0; x != 4; ++x)
+                        error = Math::max(error, Math::abs(decode(newOe, newHe, newVe, x, y) - target[y][x]));
+                if(error < bestError) {
+                    bestError = error;
+                    o = newO;
+                    h = newH;
+                    v = newV;
+                }
+            }
+        }
+    }
+}
+
+/* ETC2 RGB8 (and thus ETC1 as well) and the color part of ETC2 RGBA8 and
+   RGB8A1. The upper 32 bits contain colors, table codewords, a differential
+   (or, for punchthrough alpha, opaque) bit and a flip bit, the lower 32 bits
+   are 2-bit pixel indices split into LSBs in the lower 16 bits and MSBs in the
+   upper 16 bits, ordered column by column with the first pixel in the least
+   significant bit. I.e., each nibble is one column and a Y flip is reversing
+   bit order in each nibble.
+
+   The individual and differential modes additionally have two sub-blocks and
+   if the flip bit is set, the sub-blocks are on top of each other, so they
+   have to be swapped. For the individual mode it's just swapping the colors
+   and table codewords, in the differential mode the second color is a signed
+   3-bit delta from the first and negating the delta of -4 isn't representable
+   so the top sub-block gets off by one in the 5-bit channel value in that
+   case, which is an error of at most 9 after expanding to 8 bits. The T and H
+   modes don't have sub-blocks so only the indices are flipped. The planar
+   mode doesn't have any indices, instead the gradient is recalculated, see
+   above. All other cases are lossless. */
+UnsignedLong yFlipEtc2Block(const UnsignedLong block, const bool punchthroughAlpha) {
+    UnsignedInt colors = block >> 32;
+    UnsignedInt indices = block & 0xffffffffu;
+
+    /* Without punchthrough alpha the bit toggles between the individual and
+       differential mode, with punchthrough alpha the differential mode is
+       implicit and the bit marks opaque blocks instead */
+    if(!punchthroughAlpha && !(colors & 0x2)) {
+        /* Individual mode with sub-blocks on top of each other, swap
+           4-bit colors and 3-bit table codewords */
+        if(colors & 0x1) colors =
+            ((colors & 0xf0f0f000u) >> 4)|
+            ((colors & 0x0f0f0f00u) << 4)|
+            ((colors & 0x000000e0u) >> 3)|
+            ((colors & 0x0000001cu) << 3)|
+            (colors & 0x00000003u);
+
+    } else {
+        /* 5-bit base colors and 3-bit signed deltas. If a base color plus
+           delta is out of range, it's a T, H or planar mode for R, G and B,
+           respectively. */
+        Int base[3];
+        Int delta[3];
+        for(std::size_t i = 0; i != 3; ++i) {
+            base[i] = (colors >> (27 - i*8)) & 0x1f;
+            delta[i] = Int((colors >> (24 - i*8)) & 0x07);
+            if(delta[i] & 0x04) delta[i] -= 8;
+        }
+
+        /* T and H mode, keep the colors, flip just the indices */
+        if(base[0] + delta[0] < 0 || base[0] + delta[0] > 31 ||
+           base[1] + delta[1] < 0 || base[1] + delta[1] > 31) {}
+
+        /* Planar mode. The 6-7-6 bit colors are scattered across the whole 64
+           bits, with gaps in between that make the block decode as the
+           planar mode. */
+        else if(base[2] + delta[2] < 0 || base[2] + delta[2] > 31) {
+            UnsignedInt ro = (block >> 57) & 0x3f;
+            UnsignedInt go = ((block >> 50) & 0x40)|((block >> 49) & 0x3f);
+            UnsignedInt bo = ((block >> 43) & 0x20)|((block >> 40) & 0x18)|((block >> 39) & 0x07);
+            UnsignedInt rh = ((block >> 33) & 0x3e)|((block >> 32) & 0x01);
+            UnsignedInt gh = (block >> 25) & 0x7f;
+            UnsignedInt bh = (block >> 19) & 0x3f;
+            UnsignedInt rv = (block >> 13) & 0x3f;
+            UnsignedInt gv = (block >> 6) & 0x7f;
+            UnsignedInt bv = block & 0x3f;
+            yFlipEtc2PlanarChannel(ro, rh, rv, 6);
+            yFlipEtc2PlanarChannel(go, gh, gv, 7);
+            yFlipEtc2PlanarChannel(bo, bh, bv, 6);
+
+            UnsignedLong out =
+                (UnsignedLong(ro) << 57)|
+                (UnsignedLong(go & 0x40) << 50)|
+                (UnsignedLong(go & 0x3f) << 49)|
+                (UnsignedLong(bo & 0x20) << 43)|
+                (UnsignedLong(bo & 0x18) << 40)|
+                (UnsignedLong(bo & 0x07) << 39)|
+                (UnsignedLong(rh & 0x3e) << 33)|
+                (block & 0x0000000200000000ull)|
+                (UnsignedLong(rh & 0x01) << 32)|
+                (UnsignedLong(gh) << 25)|
+                (UnsignedLong(bh) << 19)|
+                (UnsignedLong(rv) << 13)|
+                (UnsignedLong(gv) << 6)|
+                UnsignedLong(bv);
+
+            /* Fill the gaps so R and G don't overflow, which would make it
+               a T or H mode, and B overflows. Picking the highest bit of R
+               and G to be 1 only if the value would underflow otherwise,
+               and the highest three bits of B together with the highest
+               delta bit either to be 111 and 0 or 000 and 1, whichever
+               makes the sum overflow. */
+            const Int rLow = (ro >> 2) & 0x0f;
+            const Int gLow = (go >> 2) & 0x0f;
+            Int rDelta = ((ro & 0x03) << 1)|(go >> 6);
+            Int gDelta = ((go & 0x03) << 1)|(bo >> 5);
+            if(rDelta & 0x04) rDelta -= 8;
+            if(gDelta & 0x04) gDelta -= 8;
+            if(rLow + rDelta < 0)
+                out |= 0x8000000000000000ull;
+            if(gLow + gDelta < 0)
+                out |= 0x0080000000000000ull;
+            if(((bo >> 3) & 0x03) + ((bo >> 1) & 0x03) >= 4)
+                out |= 0x0000e00000000000ull;
+            else
+                out |= 0x0000040000000000ull;
+
+            return out;
+
+        /* Differential mode with sub-blocks on top of each other. Swap the
+           base color with the base color plus delta, negate the delta and
+           swap the 3-bit table codewords. */
+        } else if(colors & 0x1) {
+            UnsignedInt out = colors & 0x00000003u;
+            for(std::size_t i = 0; i != 3; ++i) {
+                Int newBase = base[i] + delta[i];
+                Int newDelta = -delta[i];
+                if(newDelta == 4) {
+                    ++newBase;
+                    newDelta = 3;
+                }
+                out |= UnsignedInt(newBase) << (27 - i*8);
+                out |= UnsignedInt(newDelta & 0x07) << (24 - i*8);
+            }
+            colors = out|
+                ((colors & 0x000000e0u) >> 3)|
+                ((colors & 0x0000001cu) << 3);
+        }
+    }
+
+    indices =
+        ((indices & 0x11111111u) << 3)|
+        ((indices & 0x22222222u) << 1)|
+        ((indices & 0x44444444u) >> 1)|
+        ((indices & 0x88888888u) >> 3);
+
+    return (UnsignedLong(colors) << 32)|indices;
+}
+
+bool isYFlipCompressedSupported(const CompressedPixelFormat format) {
+    switch(format) {
+        case CompressedPixelFormat::Bc1RGBUnorm:
+        case CompressedPixelFormat::Bc1RGBSrgb:
+        case CompressedPixelFormat::Bc1RGBAUnorm:
+        case CompressedPixelFormat::Bc1RGBASrgb:
+        case CompressedPixelFormat::Bc2RGBAUnorm:
+        case CompressedPixelFormat::Bc2RGBASrgb:
+        case CompressedPixelFormat::Bc3RGBAUnorm:
+        case CompressedPixelFormat::Bc3RGBASrgb:
+        case CompressedPixelFormat::Bc4RUnorm:
+        case CompressedPixelFormat::Bc4RSnorm:
+        case CompressedPixelFormat::Bc5RGUnorm:
+        case CompressedPixelFormat::Bc5RGSnorm:
+        case CompressedPixelFormat::EacR11Unorm:
+        case CompressedPixelFormat::EacR11Snorm:
+        case CompressedPixelFormat::EacRG11Unorm:
+        case CompressedPixelFormat::EacRG11Snorm:
+        case CompressedPixelFormat::Etc2RGB8Unorm:
+        case CompressedPixelFormat::Etc2RGB8Srgb:
+        case CompressedPixelFormat::Etc2RGB8A1Unorm:
+        case CompressedPixelFormat::Etc2RGB8A1Srgb:
+        case CompressedPixelFormat::Etc2RGBA8Unorm:
+        case CompressedPixelFormat::Etc2RGBA8Srgb:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Unlike ASTC, these are in the same family as the other BCn formats, all of
+   which are flipped, so the importers treat a Y flip of these as an error
+   instead of warning and importing the data with a wrong orientation */
+bool isBc6hOrBc7(const CompressedPixelFormat format) {
+    return
+        format == CompressedPixelFormat::Bc6hRGBUfloat ||
+        format == CompressedPixelFormat::Bc6hRGBSfloat ||
+        format == CompressedPixelFormat::Bc7RGBAUnorm ||
+        format == CompressedPixelFormat::Bc7RGBASrgb;
+}
+
+/* Expects a {z, y, x, blockDataSize} view on whole blocks of a format for
+   which isYFlipCompressedSupported() returns true */
+void yFlipCompressedInPlace(const CompressedPixelFormat format, const Containers::StridedArrayView4D<char>& blocks) {
+    switch(format) {
+        /* BC1 blocks are the same regardless of the alpha */
+        case CompressedPixelFormat::Bc1RGBUnorm:
+        case CompressedPixelFormat::Bc1RGBSrgb:
+        case CompressedPixelFormat::Bc1RGBAUnorm:
+        case CompressedPixelFormat::Bc1RGBASrgb:
+            Math::yFlipBc1InPlace(blocks);
+            return;
+        case CompressedPixelFormat::Bc2RGBAUnorm:
+        case CompressedPixelFormat::Bc2RGBASrgb:
+            Math::yFlipBc2InPlace(blocks);
+            return;
+        case CompressedPixelFormat::Bc3RGBAUnorm:
+        case CompressedPixelFormat::Bc3RGBASrgb:
+            Math::yFlipBc3InPlace(blocks);
+            return;
+        case CompressedPixelFormat::Bc4RUnorm:
+        case CompressedPixelFormat::Bc4RSnorm:
+            Math::yFlipBc4InPlace(blocks);
+            return;
+        case CompressedPixelFormat::Bc5RGUnorm:
+        case CompressedPixelFormat::Bc5RGSnorm:
+            Math::yFlipBc5InPlace(blocks);
+            return;
+        default:
+            break;
+    }
+
+    /* What remains are ETC2 and EAC formats, which are either a single 64-bit
+       word or two of them. First flip the block order, then the contents of
+       each block. */
+    const bool eacFirst =
+        format == CompressedPixelFormat::EacR11Unorm ||
+        format == CompressedPixelFormat::EacR11Snorm ||
+        format == CompressedPixelFormat::EacRG11Unorm ||
+        format == CompressedPixelFormat::EacRG11Snorm ||
+        format == CompressedPixelFormat::Etc2RGBA8Unorm ||
+        format == CompressedPixelFormat::Etc2RGBA8Srgb;
+    const bool eacSecond =
+        format == CompressedPixelFormat::EacRG11Unorm ||
+        format == CompressedPixelFormat::EacRG11Snorm;
+    const bool punchthroughAlpha =
+        format == CompressedPixelFormat::Etc2RGB8A1Unorm ||
+        format == CompressedPixelFormat::Etc2RGB8A1Srgb;
+    const std::size_t blockDataSize = eacFirst &&
+        format != CompressedPixelFormat::EacR11Unorm &&
+        format != CompressedPixelFormat::EacR11Snorm ? 16 : 8;
+    CORRADE_INTERNAL_ASSERT(blocks.size()[3] == blockDataSize && blocks.isContiguous<3>());
+
+    Utility::flipInPlace<1>(blocks);
+
+    for(std::size_t z = 0; z != blocks.size()[0]; ++z) {
+        for(std::size_t y = 0; y != blocks.size()[1]; ++y) {
+            for(std::size_t x = 0; x != blocks.size()[2]; ++x) {
+                char* const data = static_cast<char*>(blocks[z][y][x].data());
+                for(std::size_t i = 0; i != blockDataSize/8; ++i) {
+                    UnsignedLong block;
+                    std::memcpy(&block, data + i*8, 8);
+                    Utility::Endianness::bigEndianInPlace(block);
+                    if(i == 0 ? eacFirst : eacSecond)
+                        block = yFlipEacBlock(block);
+                    else
+                        block = yFlipEtc2Block(block, punchthroughAlpha);
+                    Utility::Endianness::bigEndianInPlace(block);
+                    std::memcpy(data + i*8, &block, 8);
+                }
+            }
+        }
+    }
+}
+
+}}}
+
+#endif
@@ -32,8 +32,9 @@
 
 #include <string>
 #include <vector>
-#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Assert.h>
 
 #include "Magnum/OpenDdl/visibility.h"
 #include "Magnum/OpenDdl/OpenDdl.h"
@@ -59,8 +60,71 @@ namespace Implementation {
     template<class> struct ExtractFloatingPointDataListItem;
     enum class ParseErrorType: UnsignedInt;
     struct ParseError;
+    struct UnresolvedReference;
     class StructureList;
     template<std::size_t size> class StructureOfList;
+
+    /* Chunked storage for parsed data. Each allocation is contiguous and the
+       chunks are never reallocated, so already parsed data don't need to be
+       copied when more data get parsed and pointers to them stay valid for
+       the whole document lifetime. */
+    template<class T> class DocumentArena {
+        public:
+            /* Large enough to make the per-chunk overhead negligible */
+            enum: std::size_t { ChunkSize = 16384/sizeof(T) };
+
+            /* Allocates a contiguous range of value-initialized items. If
+               it doesn't fit into the remaining space in the last chunk, a
+               new chunk is created, with a dedicated one for allocations
+               larger than the default chunk size. */
+            T* allocate(std::size_t count) {
+                if(!count) return nullptr;
+                reserve(count);
+
+                T* const out = _chunks.back() + _used;
+                _used += count;
+                return out;
+            }
+
+            /* Makes subsequent allocations of up to given count of items
+               in total contiguous with each other, creating a new chunk if
+               they wouldn't fit into the remaining space in the last one */
+            void reserve(std::size_t count) {
+                if(!count || (!_chunks.empty() && _used + count <= _chunks.back().size()))
+                    return;
+                _chunks.emplace_back(ValueInit, count > ChunkSize ? count : ChunkSize);
+                _used = 0;
+            }
+
+            /* Gives back unused items at the end of the last allocation, if
+               the allocation was larger than needed */
+            void trim(std::size_t count) {
+                CORRADE_INTERNAL_ASSERT(count <= _used);
+                _used -= count;
+            }
+
+            /* Takes over all chunks of another arena, pointers to its data
+               stay valid. Remaining space in the current last chunk isn't
+               used for subsequent allocations anymore. */
+            void adopt(DocumentArena<T>&& other) {
+                if(other._chunks.empty()) return;
+                for(Containers::Array<T>& chunk: other._chunks)
+                    _chunks.push_back(std::move(chunk));
+                _used = other._used;
+                other._chunks.clear();
+                other._used = 0;
+            }
+
+            /* Fallback value for graceful assertions */
+            static const T& defaultValue() {
+                static const T value{};
+                return value;
+            }
+
+        private:
+            std::vector<Containers::Array<T>> _chunks;
+            std::size_t _used{};
+    };
 }
 
 namespace Validation {
@@ -74,7 +138,10 @@ namespace Validation {
 Parser for the [OpenDDL](https://www.openddl.org) file format.
 
 The parser loads the file into an in-memory structure, which is just a set of
-flat arrays. When traversing the parsed document, all @ref Structure and
+flat arrays. Primitive data of each structure are stored contiguously in
+chunks that are sized based on a quick scan of each data list, so even large
+files don't need any reallocation and copying during the parse. When
+traversing the parsed document, all @ref Structure and
 @ref Property objects are just tiny wrappers around references to the internal
 data of the originating document, thus you must ensure that the document is
 available for whole lifetime of these instances. On the other hand this allows
@@ -304,6 +371,61 @@ class MAGNUM_OPENDDL_EXPORT Document {
         /** @brief Moving is disabled */
         Document& operator=(Document&&) = delete;
 
+        /**
+         * @brief Parse thread count
+         *
+         * @see @ref setParseThreadCount()
+         */
+        UnsignedInt parseThreadCount() const { return _parseThreadCount; }
+
+        /**
+         * @brief Set parse thread count
+         * @return Reference to self (for method chaining)
+         *
+         * If set to a value other than @cpp 1 @ce, @ref parse() first finds
+         * boundaries of top-level structures, splits them into ranges of
+         * roughly equal size and parses each on a separate thread. The
+         * results are then merged together in the original order before
+         * resolving references, so the parsed document is the same as when
+         * parsing serially. This is beneficial mainly for large documents
+         * consisting of several large top-level structures, such as OpenGEX
+         * files with many geometry objects. Setting the value to @cpp 0 @ce
+         * uses all available hardware threads. Default is @cpp 1 @ce, i.e.
+         * parsing everything on the calling thread. If Corrade isn't built
+         * with @ref CORRADE_BUILD_MULTITHREADED, the document is always parsed
+         * serially.
+         */
+        Document& setParseThreadCount(UnsignedInt count) {
+            _parseThreadCount = count;
+            return *this;
+        }
+
+        /**
+         * @brief Whether data of top-level structures are stored contiguously
+         *
+         * @see @ref setTopLevelDataContiguous()
+         */
+        bool isTopLevelDataContiguous() const { return _topLevelDataContiguous; }
+
+        /**
+         * @brief Store data of top-level structures contiguously
+         * @return Reference to self (for method chaining)
+         *
+         * If enabled, @ref parse() stores primitive data of the same type
+         * coming from one top-level structure and all its substructures in a
+         * single contiguous block of memory, in the order in which they
+         * appear in the file. That allows for example an OpenGEX importer to
+         * reference all vertex arrays of a mesh with a single view instead of
+         * copying them. The space is reserved upfront based on a quick scan of
+         * the whole structure, which means slightly higher memory use and
+         * parsing time. Default is @cpp false @ce, i.e. only data of a single
+         * structure are guaranteed to be contiguous.
+         */
+        Document& setTopLevelDataContiguous(bool enabled) {
+            _topLevelDataContiguous = enabled;
+            return *this;
+        }
+
         /**
          * @brief Parse data
          * @param data                      Document data
@@ -318,6 +440,7 @@ class MAGNUM_OPENDDL_EXPORT Document {
          *
          * After parsing, all references to structure data are valid until next
          * parse call.
+         * @see @ref setParseThreadCount(), @ref setTopLevelDataContiguous()
          */
         /** @todo some sane way to ensure that the initializer lists are valid for whole Document lifetime */
         bool parse(Containers::ArrayView<const char> data, std::initializer_list<CharacterLiteral> structureIdentifiers, std::initializer_list<CharacterLiteral> propertyIdentifiers);
@@ -434,9 +557,10 @@ class MAGNUM_OPENDDL_EXPORT Document {
         struct PropertyData;
         struct StructureData;
 
-        MAGNUM_OPENDDL_LOCAL const char* parseProperty(Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Int position, Implementation::ParseError& error);
-        MAGNUM_OPENDDL_LOCAL std::pair<const char*, std::size_t> parseStructure(std::size_t parent, Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Implementation::ParseError& error);
-        MAGNUM_OPENDDL_LOCAL const char* parseStructureList(std::size_t parent, Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Implementation::ParseError& error);
+        MAGNUM_OPENDDL_LOCAL const char* parseProperty(Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, Int position, Implementation::ParseError& error);
+        MAGNUM_OPENDDL_LOCAL std::pair<const char*, std::size_t> parseStructure(std::size_t parent, Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error);
+        MAGNUM_OPENDDL_LOCAL const char* parseStructureList(std::size_t parent, Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error);
+        MAGNUM_OPENDDL_LOCAL const char* parseStructureListParallel(Containers::ArrayView<const char> data, UnsignedInt threadCount, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error);
 
         MAGNUM_OPENDDL_LOCAL std::size_t dereference(std::size_t originatingStructure, Containers::ArrayView<const char> reference) const;
 
@@ -446,87 +570,43 @@ class MAGNUM_OPENDDL_EXPORT Document {
         MAGNUM_OPENDDL_LOCAL const char* structureName(Int identifier) const;
         MAGNUM_OPENDDL_LOCAL const char* propertyName(Int identifier) const;
 
-        template<class T> std::vector<T>& data();
-        template<class T> const std::vector<T>& data() const;
-        template<Type> std::size_t dataPosition() const;
-
-        std::vector<bool> _bools;
-        std::vector<Byte> _bytes;
-        std::vector<UnsignedByte> _unsignedBytes;
-        std::vector<Short> _shorts;
-        std::vector<UnsignedShort> _unsignedShorts;
-        std::vector<Int> _ints;
-        std::vector<UnsignedInt> _unsignedInts;
+        Implementation::DocumentArena<bool> _bools;
+        Implementation::DocumentArena<Byte> _bytes;
+        Implementation::DocumentArena<UnsignedByte> _unsignedBytes;
+        Implementation::DocumentArena<Short> _shorts;
+        Implementation::DocumentArena<UnsignedShort> _unsignedShorts;
+        Implementation::DocumentArena<Int> _ints;
+        Implementation::DocumentArena<UnsignedInt> _unsignedInts;
         #ifndef CORRADE_TARGET_EMSCRIPTEN
-        std::vector<Long> _longs;
-        std::vector<UnsignedLong> _unsignedLongs;
+        Implementation::DocumentArena<Long> _longs;
+        Implementation::DocumentArena<UnsignedLong> _unsignedLongs;
         #endif
         /** @todo Half */
-        std::vector<Float> _floats;
-        std::vector<Double> _doubles;
-        std::vector<std::string> _strings;
-        std::vector<std::size_t> _references;
-        std::vector<Type> _types;
+        Implementation::DocumentArena<Float> _floats;
+        Implementation::DocumentArena<Double> _doubles;
+        Implementation::DocumentArena<std::string> _strings;
+        Implementation::DocumentArena<std::size_t> _references;
+        Implementation::DocumentArena<Type> _types;
+        std::vector<std::string> _names;
 
         std::vector<PropertyData> _properties;
         std::vector<StructureData> _structures;
 
         Containers::ArrayView<const CharacterLiteral> _structureIdentifiers;
         Containers::ArrayView<const CharacterLiteral> _propertyIdentifiers;
-};
 
-#ifndef DOXYGEN_GENERATING_OUTPUT
-#define _c(T, member) \
-    template<> inline std::vector<T>& Document::data() { return member; } \
-    template<> inline const std::vector<T>& Document::data() const { return member; }
-_c(bool, _bools)
-_c(UnsignedByte, _unsignedBytes)
-_c(Byte, _bytes)
-_c(UnsignedShort, _unsignedShorts)
-_c(Short, _shorts)
-_c(UnsignedInt, _unsignedInts)
-_c(Int, _ints)
-#ifndef CORRADE_TARGET_EMSCRIPTEN
-_c(UnsignedLong, _unsignedLongs)
-_c(Long, _longs)
-#endif
-/** @todo Half */
-_c(Float, _floats)
-_c(Double, _doubles)
-_c(std::string, _strings)
-_c(Type, _types)
-#undef _c
-
-#define _c(type, T) \
-    template<> inline std::size_t Document::dataPosition<Type::type>() const { \
-        return data<T>().size(); \
-    }
-_c(Bool, bool)
-_c(UnsignedByte, UnsignedByte)
-_c(Byte, Byte)
-_c(UnsignedShort, UnsignedShort)
-_c(Short, Short)
-_c(UnsignedInt, UnsignedInt)
-_c(Int, Int)
-#ifndef CORRADE_TARGET_EMSCRIPTEN
-_c(UnsignedLong, UnsignedLong)
-_c(Long, Long)
-#endif
-/** @todo Half */
-_c(Float, Float)
-_c(Double, Double)
-_c(String, std::string)
-_c(Type, Type)
-#undef _c
-#endif
+        UnsignedInt _parseThreadCount{1};
+        bool _topLevelDataContiguous{};
+};
 
 #ifndef DOXYGEN_GENERATING_OUTPUT
 struct MAGNUM_OPENDDL_LOCAL Document::PropertyData {
-    constexpr explicit PropertyData(Int identifier, Implementation::InternalPropertyType type, std::size_t position) noexcept: identifier{identifier}, type{type}, position{position} {}
+    constexpr explicit PropertyData(Int identifier, Implementation::InternalPropertyType type, const void* data) noexcept: identifier{identifier}, type{type}, data{data} {}
 
     Int identifier;
     Implementation::InternalPropertyType type;
-    std::size_t position;
+    /* Points to the data arena corresponding to the type */
+    const void* data;
 };
 
 struct MAGNUM_OPENDDL_LOCAL Document::StructureData {
@@ -534,19 +614,20 @@ struct MAGNUM_OPENDDL_LOCAL Document::StructureData {
        replaced with real one */
     explicit StructureData() noexcept: name{}, custom{UnknownIdentifier, 0, 0, 0}, parent{0}, next{0} {}
 
-    explicit StructureData(Type type, std::size_t name, std::size_t subArraySize, std::size_t dataBegin, std::size_t dataSize, std::size_t parent, std::size_t next) noexcept;
+    explicit StructureData(Type type, std::size_t name, std::size_t subArraySize, const void* data, std::size_t dataSize, std::size_t parent, std::size_t next) noexcept;
 
     explicit StructureData(Int type, std::size_t name, std::size_t propertyBegin, std::size_t propertySize, std::size_t firstChild, std::size_t parent, std::size_t next) noexcept;
 
     std::size_t name;
 
     struct Primitive {
-        constexpr explicit Primitive(Type type, std::size_t subArraySize, std::size_t begin, std::size_t size) noexcept: type{type}, subArraySize{subArraySize}, begin{begin}, size{size} {}
+        constexpr explicit Primitive(Type type, std::size_t subArraySize, const void* data, std::size_t size) noexcept: type{type}, subArraySize{subArraySize}, data{data}, size{size} {}
 
         Type type;
         std::size_t subArraySize;
 
-        std::size_t begin;
+        /* Points to the data arena corresponding to the type */
+        const void* data;
         std::size_t size;
     };
 
@@ -26,6 +26,7 @@
 
 #include "Parsers.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <limits>
 #include <tuple>
@@ -83,6 +84,9 @@ template<> constexpr bool isBaseN<10>(char c) {
 template<> constexpr bool isBaseN<16>(char c) {
     return isBaseN<10>(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
 }
+constexpr UnsignedInt digitValue(char c) {
+    return c <= '9' ? c - '0' : (c >= 'a' ? c - 'a' + 0xa : c - 'A' + 0xA);
+}
 constexpr bool isBinaryPrefix(char c) {
     return c == 'b' || c == 'o' || c == 'x' ||
            c == 'B' || c == 'O' || c == 'X';
@@ -118,11 +122,6 @@ template<std::size_t n> inline const char* prefix(const Containers::ArrayView<co
     return equalsPrefix(data.prefix(end), compare) ? end : nullptr;
 }
 
-void extractWithoutUnderscore(const Containers::ArrayView<const char> data, std::string& buffer) {
-    buffer.clear();
-    for(char c: data) if(c != '_') buffer += c;
-}
-
 }
 
 bool equals(const Containers::ArrayView<const char> a, const Containers::ArrayView<const char> b) {
@@ -299,9 +298,6 @@ template<class> struct ExtractToType;
 #ifndef CORRADE_TARGET_EMSCRIPTEN
 template<> struct ExtractToType<UnsignedLong> {
     typedef UnsignedLong Type;
-    static UnsignedLong extract(const std::string& buffer, Int base) {
-        return std::stoul(buffer, nullptr, base);
-    }
 };
 template<> struct ExtractToType<UnsignedByte>: ExtractToType<UnsignedLong> {};
 template<> struct ExtractToType<Byte>: ExtractToType<UnsignedLong> {};
@@ -317,9 +313,6 @@ template<> struct ExtractToType<long>: ExtractToType<UnsignedLong> {};
 #else
 template<> struct ExtractToType<UnsignedInt> {
     typedef UnsignedInt Type;
-    static UnsignedInt extract(const std::string& buffer, Int base) {
-        return std::stoi(buffer, nullptr, base);
-    }
 };
 template<> struct ExtractToType<UnsignedByte>: ExtractToType<UnsignedInt> {};
 template<> struct ExtractToType<Byte>: ExtractToType<UnsignedInt> {};
@@ -334,14 +327,35 @@ template<> struct ExtractToType<unsigned long>: ExtractToType<UnsignedInt> {};
 #endif
 template<class T> using ExtractedType = typename ExtractToType<T>::Type;
 
-template<> struct ExtractToType<Float> {
-    static Float extract(const std::string& buffer) {
-        return std::stof(buffer);
+/* Mantissas and powers of ten that are both exactly representable in given
+   type, in which case a single multiplication or division gives a correctly
+   rounded result */
+template<class> struct FloatingPointTraits;
+template<> struct FloatingPointTraits<Float> {
+    static constexpr UnsignedLong MaxExactMantissa = 1ull << 24;
+    static constexpr Int MaxExactExponent = 10;
+    static Float power10(Int exponent) {
+        static const Float powers[]{
+            1.0e0f, 1.0e1f, 1.0e2f, 1.0e3f, 1.0e4f, 1.0e5f, 1.0e6f, 1.0e7f,
+            1.0e8f, 1.0e9f, 1.0e10f};
+        return powers[exponent];
+    }
+    static Float parse(const char* data) {
+        return std::strtof(data, nullptr);
     }
 };
-template<> struct ExtractToType<Double> {
-    static Double extract(const std::string& buffer) {
-        return std::stod(buffer);
+template<> struct FloatingPointTraits<Double> {
+    static constexpr UnsignedLong MaxExactMantissa = 1ull << 53;
+    static constexpr Int MaxExactExponent = 22;
+    static Double power10(Int exponent) {
+        static const Double powers[]{
+            1.0e0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8,
+            1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15, 1.0e16,
+            1.0e17, 1.0e18, 1.0e19, 1.0e20, 1.0e21, 1.0e22};
+        return powers[exponent];
+    }
+    static Double parse(const char* data) {
+        return std::strtod(data, nullptr);
     }
 };
 
@@ -405,7 +419,7 @@ template<Int base, class T> const char* numericCharacters(const Containers::Arra
     return i;
 }
 
-template<Int base, class T> std::pair<const char*, T> baseNLiteral(const Containers::ArrayView<const char> data, std::string& buffer, ParseError& error) {
+template<Int base, class T> std::pair<const char*, T> baseNLiteral(const Containers::ArrayView<const char> data, ParseError& error) {
     /* Propagate errors */
     if(!data) return {};
 
@@ -414,19 +428,130 @@ template<Int base, class T> std::pair<const char*, T> baseNLiteral(const Contain
     /* Propagate errors */
     if(!i) return {};
 
-    extractWithoutUnderscore(data.prefix(i), buffer);
-    const ExtractedType<T> out = ExtractToType<T>::extract(buffer, base);
-    if(out > ExtractedType<T>(std::numeric_limits<T>::max())) {
-        error = {ParseErrorType::LiteralOutOfRange, typeFor<T>(), data};
-        return {};
+    /* Accumulate the value directly from the input, skipping underscores and
+       checking for overflow on every digit */
+    constexpr ExtractedType<T> max = ExtractedType<T>(std::numeric_limits<T>::max());
+    ExtractedType<T> out = 0;
+    for(const char* c = data; c != i; ++c) {
+        if(*c == '_') continue;
+
+        const ExtractedType<T> digit = digitValue(*c);
+        if(out > (max - digit)/base) {
+            error = {ParseErrorType::LiteralOutOfRange, typeFor<T>(), data};
+            return {};
+        }
+
+        out = out*base + digit;
     }
 
     return {i, T(out)};
 }
 
+/* Expects an already validated decimal literal without a sign. Returns false
+   if the value is too large for given type. */
+template<class T> bool decimalFloatingPointValue(const Containers::ArrayView<const char> data, T& out) {
+    /* Significant digits are collected into a buffer, which is then, if the
+       fast path can't be taken, passed to strtof() / strtod() in a form
+       without a decimal point, making it independent of current locale. The
+       digit count is limited, which is way more than both types can
+       represent -- the rest only affects rounding of values extremely close
+       to a halfway point and so is represented by a single nonzero digit
+       if it isn't all zeros. Then there's space for the exponent and a null
+       terminator. */
+    constexpr Int MaxDigits = 64;
+    char digits[MaxDigits + 1 + 1 + 11 + 1];
+    Int digitCount = 0;
+    Int exponent = 0;
+    bool afterDot = false;
+    bool truncated = false;
+    UnsignedLong mantissa = 0;
+
+    const char* i = data.begin();
+    for(; i != data.end() && *i != 'e' && *i != 'E'; ++i) {
+        const char c = *i;
+        if(c == '_') continue;
+        if(c == '.') {
+            afterDot = true;
+            continue;
+        }
+
+        /* Leading zeros aren't significant, they only shift the exponent if
+           after the dot */
+        if(c == '0' && !digitCount) {
+            if(afterDot) --exponent;
+            continue;
+        }
+
+        if(digitCount < MaxDigits) {
+            digits[digitCount++] = c;
+            if(digitCount <= 19) mantissa = mantissa*10 + (c - '0');
+            if(afterDot) --exponent;
+        } else {
+            if(c != '0') truncated = true;
+            if(!afterDot) ++exponent;
+        }
+    }
+
+    /* Exponent. Clamping it to a value that overflows or underflows any
+       type anyway to avoid integer overflow. */
+    if(i != data.end()) {
+        ++i;
+        bool negative = false;
+        if(*i == '+') ++i;
+        else if(*i == '-') {
+            negative = true;
+            ++i;
+        }
+
+        Int explicitExponent = 0;
+        for(; i != data.end(); ++i) {
+            if(*i == '_') continue;
+            if(explicitExponent < 100000)
+                explicitExponent = explicitExponent*10 + (*i - '0');
+        }
+
+        exponent += negative ? -explicitExponent : explicitExponent;
+    }
+
+    /* All zeros */
+    if(!digitCount) {
+        out = T(0);
+        return true;
+    }
+
+    /* Both the mantissa and the power of ten are exactly representable, a
+       single operation gives a correctly rounded result. This is the case for
+       vast majority of real-world data. */
+    typedef FloatingPointTraits<T> Traits;
+    if(digitCount <= 19 && mantissa <= Traits::MaxExactMantissa && exponent >= -Traits::MaxExactExponent && exponent <= Traits::MaxExactExponent) {
+        out = exponent < 0 ?
+            T(mantissa)/Traits::power10(-exponent) :
+            T(mantissa)*Traits::power10(exponent);
+        return true;
+    }
+
+    /* Otherwise let the libc do the hard work */
+    if(truncated) {
+        digits[digitCount++] = '1';
+        --exponent;
+    }
+    char* end = digits + digitCount;
+    *end++ = 'e';
+    if(exponent < 0) *end++ = '-';
+    char exponentDigits[10];
+    Int exponentDigitCount = 0;
+    for(UnsignedInt e = exponent < 0 ? -exponent : exponent; e || !exponentDigitCount; e /= 10)
+        exponentDigits[exponentDigitCount++] = '0' + e%10;
+    while(exponentDigitCount) *end++ = exponentDigits[--exponentDigitCount];
+    *end = '\0';
+
+    out = Traits::parse(digits);
+    return out != std::numeric_limits<T>::infinity();
+}
+
 }
 
-template<class T> std::tuple<const char*, T, Int> integralLiteral(const Containers::ArrayView<const char> data, std::string& buffer, ParseError& error) {
+template<class T> std::tuple<const char*, T, Int> integralLiteral(const Containers::ArrayView<const char> data, ParseError& error) {
     /* Propagate errors */
     if(!data) return {};
 
@@ -463,19 +588,19 @@ template<class T> std::tuple<const char*, T, Int> integralLiteral(const Containe
         case 'x':
         case 'X': {
             base = 16;
-            std::tie(i, value) = baseNLiteral<16, T>(data.suffix(i + 2), buffer, error);
+            std::tie(i, value) = baseNLiteral<16, T>(data.suffix(i + 2), error);
             break;
         }
         case 'o':
         case 'O': {
             base = 8;
-            std::tie(i, value) = baseNLiteral<8, T>(data.suffix(i + 2), buffer, error);
+            std::tie(i, value) = baseNLiteral<8, T>(data.suffix(i + 2), error);
             break;
         }
         case 'b':
         case 'B': {
             base = 2;
-            std::tie(i, value) = baseNLiteral<2, T>(data.suffix(i + 2), buffer, error);
+            std::tie(i, value) = baseNLiteral<2, T>(data.suffix(i + 2), error);
             break;
         }
 
@@ -484,35 +609,35 @@ template<class T> std::tuple<const char*, T, Int> integralLiteral(const Containe
     /* Decimal literal  */
     } else {
         base = 10;
-        std::tie(i, value) = baseNLiteral<10, T>(data.suffix(i), buffer, error);
+        std::tie(i, value) = baseNLiteral<10, T>(data.suffix(i), error);
     }
 
     /** @todo C++14: use {} */
     return std::make_tuple(i, sign*value, base);
 }
 
-template std::tuple<const char*, UnsignedByte, Int> integralLiteral<UnsignedByte>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, Byte, Int> integralLiteral<Byte>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, UnsignedShort, Int> integralLiteral<UnsignedShort>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, Short, Int> integralLiteral<Short>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, UnsignedInt, Int> integralLiteral<UnsignedInt>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, Int, Int> integralLiteral<Int>(Containers::ArrayView<const char>, std::string&, ParseError&);
+template std::tuple<const char*, UnsignedByte, Int> integralLiteral<UnsignedByte>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, Byte, Int> integralLiteral<Byte>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, UnsignedShort, Int> integralLiteral<UnsignedShort>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, Short, Int> integralLiteral<Short>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, UnsignedInt, Int> integralLiteral<UnsignedInt>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, Int, Int> integralLiteral<Int>(Containers::ArrayView<const char>, ParseError&);
 #ifdef CORRADE_TARGET_APPLE
-template std::tuple<const char*, unsigned long, Int> integralLiteral<unsigned long>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, long, Int> integralLiteral<long>(Containers::ArrayView<const char>, std::string&, ParseError&);
+template std::tuple<const char*, unsigned long, Int> integralLiteral<unsigned long>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, long, Int> integralLiteral<long>(Containers::ArrayView<const char>, ParseError&);
 #endif
 #ifndef CORRADE_TARGET_EMSCRIPTEN
-template std::tuple<const char*, UnsignedLong, Int> integralLiteral<UnsignedLong>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::tuple<const char*, Long, Int> integralLiteral<Long>(Containers::ArrayView<const char>, std::string&, ParseError&);
+template std::tuple<const char*, UnsignedLong, Int> integralLiteral<UnsignedLong>(Containers::ArrayView<const char>, ParseError&);
+template std::tuple<const char*, Long, Int> integralLiteral<Long>(Containers::ArrayView<const char>, ParseError&);
 #else
 /* Emscripten 1.38.10 and newer has std::size_t defined as unsigned long, while
    it was unsigned int before. We should support both cases,
    integralLiteral<std::size_t>() is used in some places in the parsers. */
 static_assert(sizeof(unsigned long) == 4, "unsigned long is not four bytes on Emscripten");
-template std::tuple<const char*, unsigned long, Int> integralLiteral<unsigned long>(Containers::ArrayView<const char>, std::string&, ParseError&);
+template std::tuple<const char*, unsigned long, Int> integralLiteral<unsigned long>(Containers::ArrayView<const char>, ParseError&);
 #endif
 
-template<class T> std::pair<const char*, T> floatingPointLiteral(const Containers::ArrayView<const char> data, std::string& buffer, ParseError& error) {
+template<class T> std::pair<const char*, T> floatingPointLiteral(const Containers::ArrayView<const char> data, ParseError& error) {
     /* Propagate errors */
     if(!data) return {};
 
@@ -537,17 +662,17 @@ template<class T> std::pair<const char*, T> floatingPointLiteral(const Container
         switch(i[1]) {
             case 'x':
             case 'X': {
-                std::tie(i, integralValue) = baseNLiteral<16, IntegralTypeFor<T>>(data.suffix(i + 2), buffer, error);
+                std::tie(i, integralValue) = baseNLiteral<16, IntegralTypeFor<T>>(data.suffix(i + 2), error);
                 break;
             }
             case 'o':
             case 'O': {
-                std::tie(i, integralValue) = baseNLiteral<8, IntegralTypeFor<T>>(data.suffix(i + 2), buffer, error);
+                std::tie(i, integralValue) = baseNLiteral<8, IntegralTypeFor<T>>(data.suffix(i + 2), error);
                 break;
             }
             case 'b':
             case 'B': {
-                std::tie(i, integralValue) = baseNLiteral<2, IntegralTypeFor<T>>(data.suffix(i + 2), buffer, error);
+                std::tie(i, integralValue) = baseNLiteral<2, IntegralTypeFor<T>>(data.suffix(i + 2), error);
                 break;
             }
 
@@ -591,14 +716,17 @@ template<class T> std::pair<const char*, T> floatingPointLiteral(const Container
     /* Propagate errors */
     if(!i) return {};
 
-    /** @todo verifying out-of-range */
+    T value;
+    if(!decimalFloatingPointValue(data.slice(before, i), value)) {
+        error = {ParseErrorType::LiteralOutOfRange, typeFor<T>(), data};
+        return {};
+    }
 
-    extractWithoutUnderscore(data.prefix(i), buffer);
-    return {i, ExtractToType<T>::extract(buffer)};
+    return {i, sign*value};
 }
 
-template std::pair<const char*, Float> floatingPointLiteral<Float>(Containers::ArrayView<const char>, std::string&, ParseError&);
-template std::pair<const char*, Double> floatingPointLiteral<Double>(Containers::ArrayView<const char>, std::string&, ParseError&);
+template std::pair<const char*, Float> floatingPointLiteral<Float>(Containers::ArrayView<const char>, ParseError&);
+template std::pair<const char*, Double> floatingPointLiteral<Double>(Containers::ArrayView<const char>, ParseError&);
 
 std::pair<const char*, std::string> stringLiteral(const Containers::ArrayView<const char> data, ParseError& error) {
     /* Propagate errors */
@@ -629,14 +757,18 @@ std::pair<const char*, std::string> stringLiteral(const Containers::ArrayView<co
 
             /* Continuation not found, done */
             if(j + 1 >= data.end() || *j != '"')
-                return {j, out};
+                return {j, std::move(out)};
 
             i = j + 1;
 
-        /* Any other character, append it to result */
+        /* Any other character, append the whole run of them to the result
+           at once. If there are no escapes or continuations, this results in
+           just a single allocation. */
         } else {
-            out += c;
-            ++i;
+            const char* j = i + 1;
+            while(j != data.end() && UnsignedByte(*j) >= 0x20 && *j != '\\' && *j != '"') ++j;
+            out.append(i, j);
+            i = j;
         }
     }
 
@@ -734,7 +866,7 @@ std::pair<const char*, Type> typeLiteral(const Containers::ArrayView<const char>
     return {};
 }
 
-std::pair<const char*, InternalPropertyType> propertyValue(const Containers::ArrayView<const char> data, bool& boolValue, Int& integerValue, Float& floatingPointValue, std::string& stringValue, Containers::ArrayView<const char>& referenceValue, Type& typeValue, std::string& buffer, ParseError& error) {
+std::pair<const char*, InternalPropertyType> propertyValue(const Containers::ArrayView<const char> data, bool& boolValue, Int& integerValue, Float& floatingPointValue, std::string& stringValue, Containers::ArrayView<const char>& referenceValue, Type& typeValue, ParseError& error) {
     /* Propagate errors */
     if(!data) return {};
 
@@ -762,7 +894,7 @@ std::pair<const char*, InternalPropertyType> propertyValue(const Containers::Arr
         /* Float literal if there is dot */
         for(const char* j = i; j != data.end(); ++j) {
             if(*j == '.') {
-                std::tie(i, floatingPointValue) = floatingPointLiteral<Float>(data, buffer, error);
+                std::tie(i, floatingPointValue) = floatingPointLiteral<Float>(data, error);
                 return {i, InternalPropertyType::Float};
             }
 
@@ -771,7 +903,7 @@ std::pair<const char*, InternalPropertyType> propertyValue(const Containers::Arr
 
         /* Integer literal otherwise */
         Int base;
-        std::tie(i, integerValue, base) = integralLiteral<Int>(data, buffer, error);
+        std::tie(i, integerValue, base) = integralLiteral<Int>(data, error);
         switch(base) {
             case 2:
             case 8:
@@ -90,15 +90,15 @@ const char* identifier(Containers::ArrayView<const char> data, ParseError& error
 
 std::pair<const char*, bool> boolLiteral(Containers::ArrayView<const char> data, ParseError& error);
 std::pair<const char*, char> characterLiteral(Containers::ArrayView<const char> data, ParseError& error);
-template<class T> std::tuple<const char*, T, Int> integralLiteral(Containers::ArrayView<const char> data, std::string& buffer, ParseError& error);
-template<class T> std::pair<const char*, T> floatingPointLiteral(Containers::ArrayView<const char> data, std::string& buffer, ParseError& error);
+template<class T> std::tuple<const char*, T, Int> integralLiteral(Containers::ArrayView<const char> data, ParseError& error);
+template<class T> std::pair<const char*, T> floatingPointLiteral(Containers::ArrayView<const char> data, ParseError& error);
 std::pair<const char*, std::string> stringLiteral(Containers::ArrayView<const char> data, ParseError& error);
 std::pair<const char*, std::string> nameLiteral(Containers::ArrayView<const char> data, ParseError& error);
 std::pair<const char*, Containers::ArrayView<const char>> referenceLiteral(Containers::ArrayView<const char> data, ParseError& error);
 std::pair<const char*, Type> possiblyTypeLiteral(Containers::ArrayView<const char> data);
 std::pair<const char*, Type> typeLiteral(Containers::ArrayView<const char> data, ParseError& error);
 
-std::pair<const char*, InternalPropertyType> propertyValue(Containers::ArrayView<const char> data, bool& boolValue, Int& integerValue, Float& floatingPointValue, std::string& stringValue, Containers::ArrayView<const char>& referenceValue, Type& typeValue, std::string& buffer, ParseError& error);
+std::pair<const char*, InternalPropertyType> propertyValue(Containers::ArrayView<const char> data, bool& boolValue, Int& integerValue, Float& floatingPointValue, std::string& stringValue, Containers::ArrayView<const char>& referenceValue, Type& typeValue, ParseError& error);
 
 }}}
 
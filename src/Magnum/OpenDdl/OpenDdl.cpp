@@ -25,7 +25,10 @@
 */
 
 #include <algorithm> /* std::find(), std::find_if() */
+#include <atomic>
+#include <thread>
 #include <tuple>
+#include <Corrade/Containers/Pointer.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/DebugStl.h>
 
@@ -116,9 +119,23 @@ namespace Implementation {
     }
 }
 
+namespace Implementation {
+
+struct UnresolvedReference {
+    /*implicit*/ UnresolvedReference(std::size_t structure, Containers::ArrayView<const char> reference, std::size_t& out) noexcept: structure{structure}, reference{reference}, out(&out) {}
+
+    /* Structure containing the reference, needed for resolving local names */
+    std::size_t structure;
+    Containers::ArrayView<const char> reference;
+    /* Where to put the resolved structure index */
+    std::size_t* out;
+};
+
+}
+
 Document::Document() {
-    /* First string is reserved for empty names */
-    _strings.emplace_back();
+    /* First name is reserved for unnamed structures */
+    _names.emplace_back();
 }
 
 Document::~Document() = default;
@@ -191,11 +208,21 @@ bool Document::parse(Containers::ArrayView<const char> data, const std::initiali
     _propertyIdentifiers = {propertyIdentifiers.begin(), propertyIdentifiers.size()};
 
     Implementation::ParseError error;
-    std::string buffer;
+
+    #ifdef CORRADE_BUILD_MULTITHREADED
+    UnsignedInt threadCount = _parseThreadCount;
+    if(!threadCount)
+        threadCount = std::thread::hardware_concurrency();
+    #else
+    const UnsignedInt threadCount = 1;
+    #endif
 
     const char* i = Implementation::whitespace(data);
-    std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>> references;
-    i = parseStructureList(NoParent, data.suffix(i), references, buffer, error);
+    std::vector<Implementation::UnresolvedReference> references;
+    if(threadCount > 1)
+        i = parseStructureListParallel(data.suffix(i), threadCount, references, error);
+    else
+        i = parseStructureList(NoParent, data.suffix(i), references, error);
 
     if(!i) {
         /* Calculate line number */
@@ -299,26 +326,26 @@ bool Document::parse(Containers::ArrayView<const char> data, const std::initiali
     }
 
     /* Everything parsed, dereference references */
-    for(const std::pair<std::size_t, Containers::ArrayView<const char>>& reference: references) {
+    for(const Implementation::UnresolvedReference& reference: references) {
         /* Null reference */
-        if(reference.second.isEmpty())
-            _references.push_back(NullReference);
+        if(reference.reference.isEmpty())
+            *reference.out = NullReference;
 
         /* Non-null, try to dereference */
         else {
-            std::size_t r = dereference(reference.first, reference.second);
+            std::size_t r = dereference(reference.structure, reference.reference);
             if(r == NullReference) {
-                Error() << "OpenDdl::Document::parse(): reference" << std::string{reference.second, reference.second.size()} << "was not found";
+                Error() << "OpenDdl::Document::parse(): reference" << std::string{reference.reference, reference.reference.size()} << "was not found";
                 return false;
             }
-            _references.push_back(r);
+            *reference.out = r;
         }
     }
 
     return true;
 }
 
-const char* Document::parseProperty(const Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, const Int identifier, Implementation::ParseError& error) {
+const char* Document::parseProperty(const Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, const Int identifier, Implementation::ParseError& error) {
     bool boolValue;
     Int integerValue;
     Float floatValue;
@@ -328,64 +355,60 @@ const char* Document::parseProperty(const Containers::ArrayView<const char> data
 
     const char* i;
     Implementation::InternalPropertyType type;
-    std::tie(i, type) = Implementation::propertyValue(data, boolValue, integerValue, floatValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(i, type) = Implementation::propertyValue(data, boolValue, integerValue, floatValue, stringValue, referenceValue, typeValue, error);
 
     if(!i) return nullptr;
 
-    std::size_t position = 0;
+    const void* value = nullptr;
     switch(type) {
         case Implementation::InternalPropertyType::Bool:
-            position = _bools.size();
-            _bools.push_back(boolValue);
+            value = &(*_bools.allocate(1) = boolValue);
             break;
         case Implementation::InternalPropertyType::Binary:
         case Implementation::InternalPropertyType::Character:
         case Implementation::InternalPropertyType::Integral:
-            position = _ints.size();
-            _ints.push_back(integerValue);
+            value = &(*_ints.allocate(1) = integerValue);
             break;
         case Implementation::InternalPropertyType::Float:
-            position = _floats.size();
-            _floats.push_back(floatValue);
+            value = &(*_floats.allocate(1) = floatValue);
             break;
         case Implementation::InternalPropertyType::String:
-            position = _strings.size();
-            _strings.push_back(stringValue);
+            value = &(*_strings.allocate(1) = std::move(stringValue));
             break;
-        case Implementation::InternalPropertyType::Reference:
-            position = references.size();
+        case Implementation::InternalPropertyType::Reference: {
+            std::size_t* const out = _references.allocate(1);
             /* Containing structure will be put into the vector after the
                properties are parsed */
-            references.emplace_back(_structures.size(), referenceValue);
-            break;
+            references.emplace_back(_structures.size(), referenceValue, *out);
+            value = out;
+        } break;
         case Implementation::InternalPropertyType::Type:
-            position = _types.size();
-            _types.push_back(typeValue);
+            value = &(*_types.allocate(1) = typeValue);
             break;
     }
 
-    _properties.emplace_back(identifier, type, position);
+    _properties.emplace_back(identifier, type, value);
     return i;
 }
 
 namespace Implementation {
 
 template<> struct ExtractDataListItem<Type::Bool> {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>&, std::string&, Implementation::ParseError& error) {
+    typedef bool ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document&, std::vector<Implementation::UnresolvedReference>&, bool& out, Implementation::ParseError& error) {
         const char* i;
-        bool value;
-        std::tie(i, value) = Implementation::boolLiteral(data, error);
-        document.data<bool>().push_back(value);
+        std::tie(i, out) = Implementation::boolLiteral(data, error);
         return i;
     }
 };
 
 template<class T> struct ExtractIntegralDataListItem {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>&, std::string& buffer, Implementation::ParseError& error) {
+    typedef T ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document&, std::vector<Implementation::UnresolvedReference>&, T& out, Implementation::ParseError& error) {
         const char* i;
-        T value;
-        std::tie(i, value, std::ignore) = Implementation::integralLiteral<T>(data, buffer, error);
-        document.data<T>().push_back(value);
+        std::tie(i, out, std::ignore) = Implementation::integralLiteral<T>(data, error);
         return i;
     }
 };
@@ -404,11 +427,11 @@ _c(Long)
 #undef _c
 
 template<class T> struct ExtractFloatingPointDataListItem {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>&, std::string& buffer, Implementation::ParseError& error) {
+    typedef T ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document&, std::vector<Implementation::UnresolvedReference>&, T& out, Implementation::ParseError& error) {
         const char* i;
-        T value;
-        std::tie(i, value) = Implementation::floatingPointLiteral<T>(data, buffer, error);
-        document.data<T>().push_back(value);
+        std::tie(i, out) = Implementation::floatingPointLiteral<T>(data, error);
         return i;
     }
 };
@@ -420,33 +443,36 @@ _c(Double)
 #undef _c
 
 template<> struct ExtractDataListItem<Type::String> {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>&, std::string&, Implementation::ParseError& error) {
+    typedef std::string ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document&, std::vector<Implementation::UnresolvedReference>&, std::string& out, Implementation::ParseError& error) {
         const char* i;
-        std::string value;
-        std::tie(i, value) = Implementation::stringLiteral(data, error);
-        document.data<std::string>().push_back(std::move(value));
+        std::tie(i, out) = Implementation::stringLiteral(data, error);
         return i;
     }
 };
 
 template<> struct ExtractDataListItem<Type::Reference> {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string&, Implementation::ParseError& error) {
+    typedef std::size_t ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<Implementation::UnresolvedReference>& references, std::size_t& out, Implementation::ParseError& error) {
         const char* i;
         Containers::ArrayView<const char> value;
         std::tie(i, value) = Implementation::referenceLiteral(data, error);
         /* Containing structure will be put into the vector after its data are
-           parsed */
-        references.emplace_back(document._structures.size(), value);
+           parsed, the reference itself is resolved after the whole document
+           is parsed */
+        references.emplace_back(document._structures.size(), value, out);
         return i;
     }
 };
 
 template<> struct ExtractDataListItem<Type::Type> {
-    static const char* extract(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>&, std::string&, Implementation::ParseError& error) {
+    typedef OpenDdl::Type ValueType;
+
+    static const char* extract(const Containers::ArrayView<const char> data, Document&, std::vector<Implementation::UnresolvedReference>&, OpenDdl::Type& out, Implementation::ParseError& error) {
         const char* i;
-        Type value;
-        std::tie(i, value) = Implementation::typeLiteral(data, error);
-        document.data<Type>().push_back(value);
+        std::tie(i, out) = Implementation::typeLiteral(data, error);
         return i;
     }
 };
@@ -455,7 +481,142 @@ template<> struct ExtractDataListItem<Type::Type> {
 
 namespace {
 
-template<Type type> std::pair<const char*, std::size_t> dataList(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Implementation::ParseError& error) {
+/* If there's a string or character literal or a comment at the beginning of
+   the view, returns a pointer to its last character, otherwise returns the
+   beginning of the view. Returns the end of the view if the literal or comment
+   isn't terminated. */
+const char* skipLiteralOrComment(const Containers::ArrayView<const char> data) {
+    const char* i = data;
+    const char c = *i;
+
+    /* String or character literal, skip until the matching unescaped quote */
+    if(c == '"' || c == '\'') {
+        for(++i; i != data.end() && *i != c; ++i)
+            if(*i == '\\' && i + 1 != data.end()) ++i;
+
+    /* Single-line comment, skip until the end of the line */
+    } else if(c == '/' && i + 1 != data.end() && i[1] == '/') {
+        for(i += 2; i != data.end() && *i != '\n'; ++i);
+
+    /* Multi-line comment, skip until the terminating sequence */
+    } else if(c == '/' && i + 1 != data.end() && i[1] == '*') {
+        for(i += 2; i != data.end() && !(*i == '*' && i + 1 != data.end() && i[1] == '/'); ++i);
+        if(i != data.end()) ++i;
+    }
+
+    return i;
+}
+
+/* Upper bound on the literal count in a data list that starts at the
+   beginning of the view, used to allocate the storage for it upfront. Each
+   literal except the first is preceded by a comma, which is true for
+   subarrays as well, so it's enough to count commas outside of string and
+   character literals and comments until the end of the list. Returns also
+   a pointer to the closing brace of the list or the end of the view. Doesn't
+   do any validation, that's done in the actual parsing. */
+std::pair<std::size_t, const char*> dataListSizeBound(const Containers::ArrayView<const char> data) {
+    if(data.isEmpty() || *data == '}') return {0, data.begin()};
+
+    std::size_t commas = 0;
+    std::size_t depth = 0;
+    const char* i = data;
+    for(; i != data.end(); ++i) {
+        const char c = *i;
+        if(c == ',') ++commas;
+        else if(c == '{') ++depth;
+        else if(c == '}') {
+            if(!depth) break;
+            --depth;
+        } else if((i = skipLiteralOrComment(data.suffix(i))) == data.end())
+            break;
+    }
+
+    return {commas + 1, i};
+}
+
+/* Upper bounds on the literal count of each primitive type in a structure
+   that starts at the beginning of the view, including all its substructures,
+   used to reserve contiguous storage for all of them upfront. Data lists are
+   bounded with dataListSizeBound() so the bounds are consistent with the
+   actual allocations, a property value is counted for each type it can be
+   stored as. Doesn't do any validation, that's done in the actual parsing. */
+void structureDataSizeBounds(const Containers::ArrayView<const char> data, std::size_t(&bounds)[std::size_t(Type::Custom)]) {
+    std::size_t depth = 0;
+    /* Type of the last identifier, Type::Custom if it wasn't a primitive
+       type */
+    Type type = Type::Custom;
+    for(const char* i = data; i != data.end(); ++i) {
+        const char c = *i;
+
+        /* Identifier or a name. Only identifiers can be primitive types. */
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' || c == '%') {
+            const char* end = i + 1;
+            for(; end != data.end() && ((*end >= 'a' && *end <= 'z') || (*end >= 'A' && *end <= 'Z') || (*end >= '0' && *end <= '9') || *end == '_'); ++end);
+            if(c != '$' && c != '%') {
+                const char* typeEnd;
+                Type identifierType;
+                std::tie(typeEnd, identifierType) = Implementation::possiblyTypeLiteral(data.slice(i, end));
+                type = typeEnd == end ? identifierType : Type::Custom;
+            }
+            i = end - 1;
+
+        /* Property list, each value is preceded by an assignment */
+        } else if(c == '(') {
+            for(++i; i != data.end() && *i != ')'; ++i) {
+                if(*i == '=') for(Type t: {Type::Bool, Type::Int, Type::Float, Type::String, Type::Reference, Type::Type})
+                    ++bounds[std::size_t(t)];
+                else if((i = skipLiteralOrComment(data.suffix(i))) == data.end())
+                    return;
+            }
+            if(i == data.end()) return;
+
+        /* Data list of a primitive structure, its closing brace ends the
+           structure. Leading whitespace is skipped to not overestimate empty
+           lists. */
+        } else if(c == '{' && type != Type::Custom) {
+            for(++i; i != data.end() && *i <= 32; ++i);
+            std::size_t bound;
+            std::tie(bound, i) = dataListSizeBound(data.suffix(i));
+            bounds[std::size_t(type)] += bound;
+            if(i == data.end() || !depth) return;
+            type = Type::Custom;
+
+        /* Substructure list of a custom structure */
+        } else if(c == '{') {
+            ++depth;
+        } else if(c == '}') {
+            if(!depth || !--depth) return;
+        } else if((i = skipLiteralOrComment(data.suffix(i))) == data.end())
+            return;
+    }
+}
+
+/* Splits a list of structures into at most given count of ranges of roughly
+   equal size, with each split right after the closing brace of a structure.
+   Splitting stops at a closing brace without a matching opening brace, where
+   the parser stops as well. Doesn't do any validation, that's done in the
+   actual parsing. Returns the range boundaries, the first being the beginning
+   and the last the end of the view. */
+std::vector<const char*> splitStructureList(const Containers::ArrayView<const char> data, const std::size_t count) {
+    std::vector<const char*> out{data.begin()};
+    const std::size_t rangeSize = data.size()/count;
+    std::size_t depth = 0;
+    for(const char* i = data; i != data.end() && out.size() != count; ++i) {
+        const char c = *i;
+        if(c == '{') ++depth;
+        else if(c == '}') {
+            if(!depth) break;
+            if(!--depth && std::size_t(i + 1 - out.back()) >= rangeSize)
+                out.push_back(i + 1);
+        } else if((i = skipLiteralOrComment(data.suffix(i))) == data.end())
+            break;
+    }
+
+    if(out.back() != data.end()) out.push_back(data.end());
+    return out;
+}
+
+template<Type type> std::pair<const char*, std::size_t> dataList(const Containers::ArrayView<const char> data, Document& document, std::vector<Implementation::UnresolvedReference>& references, typename Implementation::ExtractDataListItem<type>::ValueType* const out, const std::size_t capacity, Implementation::ParseError& error) {
     const char* i = data;
     std::size_t j = 0;
     for(; i && i != data.end() && *i != '}'; ) {
@@ -468,7 +629,14 @@ template<Type type> std::pair<const char*, std::size_t> dataList(const Container
             i = Implementation::whitespace(data.suffix(i + 1));
         }
 
-        i = Implementation::ExtractDataListItem<type>::extract(data.suffix(i), document, references, buffer, error);
+        /* The capacity is an upper bound, so this can happen only with
+           malformed input */
+        if(j == capacity) {
+            error = {Implementation::ParseErrorType::ExpectedListEnd, i};
+            return {};
+        }
+
+        i = Implementation::ExtractDataListItem<type>::extract(data.suffix(i), document, references, out[j], error);
 
         i = Implementation::whitespace(data.suffix(i));
 
@@ -478,8 +646,8 @@ template<Type type> std::pair<const char*, std::size_t> dataList(const Container
     return {i, j};
 }
 
-template<Type type> std::pair<const char*, std::size_t> dataArrayList(const Containers::ArrayView<const char> data, Document& document, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, const std::size_t subArraySize, Implementation::ParseError& error) {
-    if(!subArraySize) return dataList<type>(data, document, references, buffer, error);
+template<Type type> std::pair<const char*, std::size_t> dataArrayList(const Containers::ArrayView<const char> data, Document& document, std::vector<Implementation::UnresolvedReference>& references, const std::size_t subArraySize, typename Implementation::ExtractDataListItem<type>::ValueType* const out, const std::size_t capacity, Implementation::ParseError& error) {
+    if(!subArraySize) return dataList<type>(data, document, references, out, capacity, error);
 
     const char* i = data;
     std::size_t j = 0;
@@ -510,7 +678,14 @@ template<Type type> std::pair<const char*, std::size_t> dataArrayList(const Cont
                 i = Implementation::whitespace(data.suffix(i + 1));
             }
 
-            i = Implementation::ExtractDataListItem<type>::extract(data.suffix(i), document, references, buffer, error);
+            /* The capacity is an upper bound, so this can happen only with
+               malformed input */
+            if(j*subArraySize + k == capacity) {
+                error = {Implementation::ParseErrorType::ExpectedListEnd, i};
+                return {};
+            }
+
+            i = Implementation::ExtractDataListItem<type>::extract(data.suffix(i), document, references, out[j*subArraySize + k], error);
 
             i = Implementation::whitespace(data.suffix(i));
         }
@@ -542,7 +717,7 @@ Int identifierId(const Containers::ArrayView<const char> data, Containers::Array
 
 }
 
-std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t parent, const Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Implementation::ParseError& error) {
+std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t parent, const Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error) {
     /* Identifier */
     const char* const structureIdentifier = Implementation::identifier(data, error);
     if(!structureIdentifier) return {};
@@ -561,7 +736,7 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
         if(i != data.end() && *i == '[') {
             i = Implementation::whitespace(data.suffix(i + 1));
 
-            std::tie(i, subArraySize, std::ignore) = Implementation::integralLiteral<std::size_t>(data.suffix(i), buffer, error);
+            std::tie(i, subArraySize, std::ignore) = Implementation::integralLiteral<std::size_t>(data.suffix(i), error);
 
             if(subArraySize == 0) {
                 error = {Implementation::ParseErrorType::InvalidSubArraySize, i};
@@ -585,8 +760,8 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
         if(i && i != data.end() && (*i == '%' || *i == '$')) {
             std::string s;
             std::tie(i, s) = Implementation::nameLiteral(data.suffix(i), error);
-            name = _strings.size();
-            _strings.push_back(std::move(s));
+            name = _names.size();
+            _names.push_back(std::move(s));
 
             i = Implementation::whitespace(data.suffix(i));
         }
@@ -602,33 +777,37 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
 
         i = Implementation::whitespace(data.suffix(i + 1));
 
-        std::size_t dataBegin = 0, dataSize = 0;
+        /* Allocate storage for the data upfront. As the size is just an upper
+           bound, the unused part is given back after. */
+        const std::size_t capacity = dataListSizeBound(data.suffix(i)).first;
+        const void* dataBegin = nullptr;
+        std::size_t dataSize = 0;
         switch(type) {
-            #define _c(type) \
-            case Type::type: \
-                dataBegin = dataPosition<Type::type>(); \
-                std::tie(i, dataSize) = dataArrayList<Type::type>(data.suffix(i), *this, references, buffer, subArraySize, error); break;
-            _c(Bool)
-            _c(UnsignedByte)
-            _c(Byte)
-            _c(UnsignedShort)
-            _c(Short)
-            _c(UnsignedInt)
-            _c(Int)
+            #define _c(type, storage) \
+            case Type::type: { \
+                auto* const out = storage.allocate(capacity); \
+                std::tie(i, dataSize) = dataArrayList<Type::type>(data.suffix(i), *this, references, subArraySize, out, capacity, error); \
+                if(i) storage.trim(capacity - dataSize); \
+                dataBegin = out; \
+            } break;
+            _c(Bool, _bools)
+            _c(UnsignedByte, _unsignedBytes)
+            _c(Byte, _bytes)
+            _c(UnsignedShort, _unsignedShorts)
+            _c(Short, _shorts)
+            _c(UnsignedInt, _unsignedInts)
+            _c(Int, _ints)
             #ifndef CORRADE_TARGET_EMSCRIPTEN
-            _c(UnsignedLong)
-            _c(Long)
+            _c(UnsignedLong, _unsignedLongs)
+            _c(Long, _longs)
             #endif
             /** @todo Half */
-            _c(Float)
-            _c(Double)
-            _c(String)
-            _c(Type)
+            _c(Float, _floats)
+            _c(Double, _doubles)
+            _c(String, _strings)
+            _c(Reference, _references)
+            _c(Type, _types)
             #undef _c
-            case Type::Reference:
-                dataBegin = references.size();
-                std::tie(i, dataSize) = dataArrayList<Type::Reference>(data.suffix(i), *this, references, buffer, subArraySize, error);
-                break;
             case Type::Custom:
                 CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
         }
@@ -657,8 +836,8 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
         if(i && i != data.end() && (*i == '%' || *i == '$')) {
             std::string s;
             std::tie(i, s) = Implementation::nameLiteral(data.suffix(i), error);
-            name = _strings.size();
-            _strings.push_back(std::move(s));
+            name = _names.size();
+            _names.push_back(std::move(s));
 
             i = Implementation::whitespace(data.suffix(i));
         }
@@ -697,7 +876,7 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
 
                 i = Implementation::whitespace(data.suffix(i + 1));
 
-                i = parseProperty(data.suffix(i), references, buffer, propertyIdentifierId, error);
+                i = parseProperty(data.suffix(i), references, propertyIdentifierId, error);
 
                 i = Implementation::whitespace(data.suffix(i));
 
@@ -727,7 +906,7 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
         _structures.emplace_back();
 
         /* Substructure */
-        i = parseStructureList(position, data.suffix(i), references, buffer, error);
+        i = parseStructureList(position, data.suffix(i), references, error);
 
         /* Propagate errors */
         if(!i) return {};
@@ -753,7 +932,7 @@ std::pair<const char*, std::size_t> Document::parseStructure(const std::size_t p
     }
 }
 
-const char* Document::parseStructureList(const std::size_t parent, const Containers::ArrayView<const char> data, std::vector<std::pair<std::size_t, Containers::ArrayView<const char>>>& references, std::string& buffer, Implementation::ParseError& error) {
+const char* Document::parseStructureList(const std::size_t parent, const Containers::ArrayView<const char> data, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error) {
     const std::size_t listStart = _structures.size();
 
     /* Parse all structures in the list */
@@ -775,7 +954,34 @@ const char* Document::parseStructureList(const std::size_t parent, const Contain
     std::size_t last;
     #endif
     while(i && i != data.end() && *i != '}') {
-        std::tie(i, last) = parseStructure(parent, data.suffix(i), references, buffer, error);
+        /* Reserve contiguous storage for all data of a top-level structure,
+           if requested */
+        if(parent == NoParent && _topLevelDataContiguous) {
+            std::size_t bounds[std::size_t(Type::Custom)]{};
+            structureDataSizeBounds(data.suffix(i), bounds);
+            #define _c(type, storage) \
+                storage.reserve(bounds[std::size_t(Type::type)]);
+            _c(Bool, _bools)
+            _c(UnsignedByte, _unsignedBytes)
+            _c(Byte, _bytes)
+            _c(UnsignedShort, _unsignedShorts)
+            _c(Short, _shorts)
+            _c(UnsignedInt, _unsignedInts)
+            _c(Int, _ints)
+            #ifndef CORRADE_TARGET_EMSCRIPTEN
+            _c(UnsignedLong, _unsignedLongs)
+            _c(Long, _longs)
+            #endif
+            /** @todo Half */
+            _c(Float, _floats)
+            _c(Double, _doubles)
+            _c(String, _strings)
+            _c(Reference, _references)
+            _c(Type, _types)
+            #undef _c
+        }
+
+        std::tie(i, last) = parseStructure(parent, data.suffix(i), references, error);
         i = Implementation::whitespace(data.suffix(i));
     }
 
@@ -785,6 +991,126 @@ const char* Document::parseStructureList(const std::size_t parent, const Contain
     return i;
 }
 
+const char* Document::parseStructureListParallel(const Containers::ArrayView<const char> data, const UnsignedInt threadCount, std::vector<Implementation::UnresolvedReference>& references, Implementation::ParseError& error) {
+    /* If the list can't be split into more than one range, parse it
+       serially */
+    const std::vector<const char*> split = splitStructureList(data, threadCount);
+    if(split.size() <= 2)
+        return parseStructureList(NoParent, data, references, error);
+
+    /* The first range is parsed directly into this document, the others into
+       temporary documents that are merged into this one after */
+    struct Range {
+        Containers::Pointer<Document> document;
+        std::vector<Implementation::UnresolvedReference> references;
+        Implementation::ParseError error;
+        const char* end;
+    };
+    const std::size_t rangeCount = split.size() - 1;
+    Containers::Array<Range> ranges{rangeCount};
+    for(std::size_t r = 1; r != rangeCount; ++r) {
+        ranges[r].document.emplace();
+        ranges[r].document->_structureIdentifiers = _structureIdentifiers;
+        ranges[r].document->_propertyIdentifiers = _propertyIdentifiers;
+        ranges[r].document->_topLevelDataContiguous = _topLevelDataContiguous;
+    }
+
+    const std::size_t listStart = _structures.size();
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for(std::size_t r; (r = next++) < rangeCount; ) {
+            const Containers::ArrayView<const char> range = data.slice(split[r], split[r + 1]);
+            Range& out = ranges[r];
+            out.end = (r ? *out.document : *this).parseStructureList(NoParent, range.suffix(Implementation::whitespace(range)), r ? out.references : references, out.error);
+        }
+    };
+
+    Containers::Array<std::thread> threads{rangeCount - 1};
+    for(std::thread& thread: threads)
+        thread = std::thread{worker};
+    worker();
+    for(std::thread& thread: threads)
+        thread.join();
+
+    /* Find the last top-level structure parsed into this document, if any */
+    std::size_t last = NoParent;
+    if(listStart != _structures.size())
+        for(last = listStart; _structures[last].next; last = _structures[last].next);
+
+    /* Merge the ranges in order, stopping at the first that failed or that
+       ended prematurely, consistently with what the serial parse would do */
+    for(std::size_t r = 0; r != rangeCount; ++r) {
+        Range& range = ranges[r];
+        if(!range.end) {
+            error = range.error;
+            return nullptr;
+        }
+
+        if(r && !range.document->_structures.empty()) {
+            Document& document = *range.document;
+            const std::size_t structureOffset = _structures.size();
+            const std::size_t propertyOffset = _properties.size();
+            /* The first name is the empty one, not copied */
+            const std::size_t nameOffset = _names.size() - 1;
+
+            /* Link the top-level structures to the previous ones */
+            if(last != NoParent) _structures[last].next = structureOffset;
+            for(last = 0; document._structures[last].next; last = document._structures[last].next);
+            last += structureOffset;
+
+            /* Copy the structures, offsetting all indices. Index 0 has a
+               special meaning for the first child and next sibling, but it
+               can't be a valid value for them in a non-empty document
+               either. */
+            _structures.reserve(_structures.size() + document._structures.size());
+            for(StructureData structure: document._structures) {
+                if(structure.name) structure.name += nameOffset;
+                if(structure.parent != NoParent) structure.parent += structureOffset;
+                if(structure.next) structure.next += structureOffset;
+                if(Utility::min(Type::Custom, structure.primitive.type) == Type::Custom) {
+                    structure.custom.propertiesBegin += propertyOffset;
+                    if(structure.custom.firstChild)
+                        structure.custom.firstChild += structureOffset;
+                }
+                _structures.push_back(structure);
+            }
+
+            /* Properties and data don't contain any indices, take over the
+               data arenas so the pointers stay valid */
+            _properties.insert(_properties.end(), document._properties.begin(), document._properties.end());
+            for(std::size_t i = 1; i != document._names.size(); ++i)
+                _names.push_back(std::move(document._names[i]));
+            _bools.adopt(std::move(document._bools));
+            _bytes.adopt(std::move(document._bytes));
+            _unsignedBytes.adopt(std::move(document._unsignedBytes));
+            _shorts.adopt(std::move(document._shorts));
+            _unsignedShorts.adopt(std::move(document._unsignedShorts));
+            _ints.adopt(std::move(document._ints));
+            _unsignedInts.adopt(std::move(document._unsignedInts));
+            #ifndef CORRADE_TARGET_EMSCRIPTEN
+            _longs.adopt(std::move(document._longs));
+            _unsignedLongs.adopt(std::move(document._unsignedLongs));
+            #endif
+            _floats.adopt(std::move(document._floats));
+            _doubles.adopt(std::move(document._doubles));
+            _strings.adopt(std::move(document._strings));
+            _references.adopt(std::move(document._references));
+            _types.adopt(std::move(document._types));
+
+            /* The reference slots are in the arenas taken over above, only
+               the originating structure index needs to be offset */
+            for(Implementation::UnresolvedReference& reference: range.references) {
+                reference.structure += structureOffset;
+                references.push_back(reference);
+            }
+        }
+
+        if(range.end != split[r + 1]) return range.end;
+    }
+
+    return data.end();
+}
+
 bool Document::validate(const Validation::Structures allowedRootStructures, const std::initializer_list<Validation::Structure> structures) const {
     std::vector<Int> countsBuffer;
     countsBuffer.reserve(structures.size());
@@ -933,7 +1259,7 @@ const char* Document::propertyName(const Int identifier) const {
     return *(_propertyIdentifiers.begin() + identifier);
 }
 
-Document::StructureData::StructureData(const Type type, const std::size_t name, const std::size_t subArraySize, const std::size_t dataBegin, const std::size_t dataSize, const std::size_t parent, const std::size_t next) noexcept: name{name}, primitive{type, subArraySize, dataBegin, dataSize}, parent{parent}, next{next} {
+Document::StructureData::StructureData(const Type type, const std::size_t name, const std::size_t subArraySize, const void* const data, const std::size_t dataSize, const std::size_t parent, const std::size_t next) noexcept: name{name}, primitive{type, subArraySize, data, dataSize}, parent{parent}, next{next} {
     CORRADE_INTERNAL_ASSERT(type < Type::Custom);
 }
 
@@ -1010,7 +1336,7 @@ std::size_t Structure::subArraySize() const {
 Containers::Optional<Structure> Structure::asReference() const {
     CORRADE_ASSERT(arraySize() == 1, "OpenDdl::Structure::asReference(): not a single value", {});
     CORRADE_ASSERT(type() == Type::Reference, "OpenDdl::Structure::asReference(): not of reference type", {});
-    const std::size_t reference = _document.get()._references[_data.get().primitive.begin];
+    const std::size_t reference = *static_cast<const std::size_t*>(_data.get().primitive.data);
     return reference == NullReference ? Containers::NullOpt :
         Containers::optional(Structure{_document, _document.get()._structures[reference]});
 }
@@ -1019,9 +1345,10 @@ Containers::Array<Containers::Optional<Structure>> Structure::asReferenceArray()
     CORRADE_ASSERT(type() == Type::Reference, "OpenDdl::Structure::asReferenceArray(): not of reference type", nullptr);
 
     Containers::Array<Containers::Optional<Structure>> out(_data.get().primitive.size);
+    const std::size_t* const references = static_cast<const std::size_t*>(_data.get().primitive.data);
     for(std::size_t i = 0; i != _data.get().primitive.size; ++i)
-        if(const std::size_t reference = _document.get()._references[_data.get().primitive.begin + i])
-            out[i] = Structure{_document, _document.get()._structures[reference]};
+        if(references[i] != NullReference)
+            out[i] = Structure{_document, _document.get()._structures[references[i]]};
 
     return out;
 }
@@ -1172,7 +1499,7 @@ bool Property::isTypeCompatibleWith(PropertyType type) const {
 
 Containers::Optional<Structure> Property::asReference() const {
     CORRADE_ASSERT(isTypeCompatibleWith(PropertyType::Reference), "OpenDdl::Property::asReference(): not of reference type", {});
-    const std::size_t reference = _document.get()._references[_data.get().position];
+    const std::size_t reference = *static_cast<const std::size_t*>(_data.get().data);
     return reference == NullReference ? Containers::NullOpt :
         Containers::optional(Structure{_document, _document.get()._structures[reference]});
 }
@@ -114,7 +114,7 @@ namespace Implementation {
         return type == InternalPropertyType::Float;
     }
     template<> constexpr bool isPropertyType<std::string>(InternalPropertyType type) {
-        return type == InternalPropertyType::String || type == InternalPropertyType::Reference;
+        return type == InternalPropertyType::String;
     }
 }
 
@@ -126,8 +126,8 @@ const T&
 #endif
 Property::as() const {
     CORRADE_ASSERT(Implementation::isPropertyType<T>(_data.get().type),
-        "OpenDdl::Property::as(): not compatible with given type", _document.get().data<T>().front());
-    return _document.get().data<T>()[_data.get().position];
+        "OpenDdl::Property::as(): not compatible with given type", Implementation::DocumentArena<T>::defaultValue());
+    return *static_cast<const T*>(_data.get().data);
 }
 
 namespace Implementation {
@@ -100,7 +100,7 @@ class MAGNUM_OPENDDL_EXPORT Structure {
          *
          * @see @ref hasName()
          */
-        const std::string& name() const { return _document.get()._strings[_data.get().name]; }
+        const std::string& name() const { return _document.get()._names[_data.get().name]; }
 
         /**
          * @brief Array size
@@ -409,16 +409,16 @@ const T&
 #endif
 Structure::as() const {
     CORRADE_ASSERT(arraySize() == 1,
-        "OpenDdl::Structure::as(): not a single value", _document.get().data<T>().front());
+        "OpenDdl::Structure::as(): not a single value", Implementation::DocumentArena<T>::defaultValue());
     CORRADE_ASSERT(Implementation::isStructureType<T>(type()),
-        "OpenDdl::Structure::as(): not of given type", _document.get().data<T>().front());
-    return _document.get().data<T>()[_data.get().primitive.begin];
+        "OpenDdl::Structure::as(): not of given type", Implementation::DocumentArena<T>::defaultValue());
+    return *static_cast<const T*>(_data.get().primitive.data);
 }
 
 template<class T> Containers::ArrayView<const T> Structure::asArray() const {
     CORRADE_ASSERT(Implementation::isStructureType<T>(type()),
         "OpenDdl::Structure::asArray(): not of given type", nullptr);
-    return {_document.get().data<T>().data() + _data.get().primitive.begin, _data.get().primitive.size};
+    return {static_cast<const T*>(_data.get().primitive.data), _data.get().primitive.size};
 }
 
 namespace Implementation {
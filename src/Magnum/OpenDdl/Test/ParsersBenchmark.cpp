@@ -0,0 +1,143 @@
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <tuple>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/FormatStl.h>
+
+#include "Magnum/OpenDdl/Type.h"
+#include "Magnum/OpenDdl/Implementation/Parsers.h"
+
+namespace Magnum { namespace OpenDdl { namespace Test { namespace {
+
+struct ParsersBenchmark: TestSuite::Tester {
+    explicit ParsersBenchmark();
+
+    void floatLiteral();
+    void floatLiteralStl();
+    void integerLiteral();
+    void integerLiteralStl();
+
+    private:
+        std::string _floats, _integers;
+};
+
+/* Roughly what a typical OpenGEX vertex array looks like */
+constexpr std::size_t LiteralCount = 100000;
+
+ParsersBenchmark::ParsersBenchmark() {
+    addBenchmarks({&ParsersBenchmark::floatLiteral,
+                   &ParsersBenchmark::floatLiteralStl,
+                   &ParsersBenchmark::integerLiteral,
+                   &ParsersBenchmark::integerLiteralStl}, 10);
+
+    for(std::size_t i = 0; i != LiteralCount; ++i) {
+        _floats += Utility::formatString("{}{}.{}, ", i % 3 ? "" : "-", i % 100, (i*7919) % 1000000);
+        _integers += Utility::formatString("{}, ", (i*7919) % 100000);
+    }
+}
+
+/* The Stl variants are doing what the parsers did before, copying the
+   literal without underscores into a std::string and passing that to the
+   libc, to have a baseline to compare to */
+
+void ParsersBenchmark::floatLiteral() {
+    Containers::ArrayView<const char> data{_floats.data(), _floats.size()};
+
+    Float sum{};
+    CORRADE_BENCHMARK(1) {
+        Implementation::ParseError error;
+        const char* i = data.begin();
+        for(std::size_t j = 0; j != LiteralCount; ++j) {
+            Float value;
+            std::tie(i, value) = Implementation::floatingPointLiteral<Float>(data.suffix(i), error);
+            sum += value;
+            i += 2;
+        }
+    }
+
+    CORRADE_VERIFY(sum != 0.0f);
+}
+
+void ParsersBenchmark::floatLiteralStl() {
+    Containers::ArrayView<const char> data{_floats.data(), _floats.size()};
+
+    Float sum{};
+    CORRADE_BENCHMARK(1) {
+        std::string buffer;
+        const char* i = data.begin();
+        for(std::size_t j = 0; j != LiteralCount; ++j) {
+            buffer.clear();
+            for(; *i != ','; ++i) if(*i != '_') buffer += *i;
+            sum += std::stof(buffer);
+            i += 2;
+        }
+    }
+
+    CORRADE_VERIFY(sum != 0.0f);
+}
+
+void ParsersBenchmark::integerLiteral() {
+    Containers::ArrayView<const char> data{_integers.data(), _integers.size()};
+
+    UnsignedInt sum{};
+    CORRADE_BENCHMARK(1) {
+        Implementation::ParseError error;
+        const char* i = data.begin();
+        for(std::size_t j = 0; j != LiteralCount; ++j) {
+            UnsignedInt value;
+            std::tie(i, value, std::ignore) = Implementation::integralLiteral<UnsignedInt>(data.suffix(i), error);
+            sum += value;
+            i += 2;
+        }
+    }
+
+    CORRADE_VERIFY(sum != 0);
+}
+
+void ParsersBenchmark::integerLiteralStl() {
+    Containers::ArrayView<const char> data{_integers.data(), _integers.size()};
+
+    UnsignedInt sum{};
+    CORRADE_BENCHMARK(1) {
+        std::string buffer;
+        const char* i = data.begin();
+        for(std::size_t j = 0; j != LiteralCount; ++j) {
+            buffer.clear();
+            for(; *i != ','; ++i) if(*i != '_') buffer += *i;
+            sum += std::stoul(buffer, nullptr, 10);
+            i += 2;
+        }
+    }
+
+    CORRADE_VERIFY(sum != 0);
+}
+
+}}}}
+
+CORRADE_TEST_MAIN(Magnum::OpenDdl::Test::ParsersBenchmark)
@@ -68,6 +68,7 @@ struct ParsersTest: TestSuite::Tester {
 
     void floatLiteralInvalid();
     void floatLiteral();
+    void floatLiteralPrecision();
     void floatLiteralBinary();
 
     void stringLiteralInvalid();
@@ -130,6 +131,7 @@ ParsersTest::ParsersTest() {
 
               &ParsersTest::floatLiteralInvalid,
               &ParsersTest::floatLiteral,
+              &ParsersTest::floatLiteralPrecision,
               &ParsersTest::floatLiteralBinary,
 
               &ParsersTest::stringLiteralInvalid,
@@ -373,27 +375,36 @@ void ParsersTest::characterLiteralEscaped() {
 
 void ParsersTest::integerLiteralInvalid() {
     Implementation::ParseError error;
-    std::string buffer;
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{""}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{""}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::ExpectedLiteral);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"+"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"+"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"A"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"A"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"_1"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"_1"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"0b_1"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"0b_1"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"32768"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<Short>(CharacterLiteral{"32768"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
 
-    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<UnsignedShort>(CharacterLiteral{"-1"}, buffer, error)));
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<UnsignedShort>(CharacterLiteral{"-1"}, error)));
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
+
+    /* Overflowing even the type used for the intermediate value */
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<UnsignedInt>(CharacterLiteral{"4_294_967_296"}, error)));
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
+
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<UnsignedInt>(CharacterLiteral{"0x1_0000_0000"}, error)));
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
+
+    CORRADE_VERIFY(!std::get<0>(Implementation::integralLiteral<UnsignedInt>(CharacterLiteral{"99999999999999999999999999"}, error)));
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
 }
 
@@ -401,11 +412,10 @@ void ParsersTest::integerLiteral() {
     CharacterLiteral a{"-3_7X"};
 
     Implementation::ParseError error;
-    std::string buffer;
     const char* ai;
     Short value;
     Int base;
-    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, buffer, error);
+    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, error);
     VERIFY_PARSED(error, a, ai, "-3_7");
     CORRADE_COMPARE(value, -37);
     CORRADE_COMPARE(base, 10);
@@ -415,11 +425,10 @@ void ParsersTest::integerLiteralChar() {
     CharacterLiteral a{"+'a'X"};
 
     Implementation::ParseError error;
-    std::string buffer;
     const char* ai;
     Short value;
     Int base;
-    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, buffer, error);
+    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, error);
     VERIFY_PARSED(error, a, ai, "+'a'");
     CORRADE_COMPARE(value, 'a');
     CORRADE_COMPARE(base, 256);
@@ -429,11 +438,10 @@ void ParsersTest::integerLiteralBinary() {
     CharacterLiteral a{"-0o7_5"};
 
     Implementation::ParseError error;
-    std::string buffer;
     const char* ai;
     Short value;
     Int base;
-    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, buffer, error);
+    std::tie(ai, value, base) = Implementation::integralLiteral<Short>(a, error);
     VERIFY_PARSED(error, a, ai, "-0o7_5");
     CORRADE_COMPARE(value, -075);
     CORRADE_COMPARE(base, 8);
@@ -441,47 +449,74 @@ void ParsersTest::integerLiteralBinary() {
 
 void ParsersTest::floatLiteralInvalid() {
     Implementation::ParseError error;
-    std::string buffer;
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{""}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{""}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::ExpectedLiteral);
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"+"}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"+"}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"A"}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"A"}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"_1"}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"_1"}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"."}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"."}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
 
-    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"0.e-"}, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"0.e-"}, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidLiteral);
+
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Float>(CharacterLiteral{"3.5e38"}, error).first);
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
+
+    CORRADE_VERIFY(!Implementation::floatingPointLiteral<Double>(CharacterLiteral{"-1.0e309"}, error).first);
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::LiteralOutOfRange);
 }
 
 void ParsersTest::floatLiteral() {
     CharacterLiteral a{"-1_.0_0e+5X"};
 
     Implementation::ParseError error;
-    std::string buffer;
     const char* ai;
     Float value;
-    std::tie(ai, value) = Implementation::floatingPointLiteral<Float>(a, buffer, error);
+    std::tie(ai, value) = Implementation::floatingPointLiteral<Float>(a, error);
     VERIFY_PARSED(error, a, ai, "-1_.0_0e+5");
     CORRADE_COMPARE(value, -1.0e+5);
 }
 
+void ParsersTest::floatLiteralPrecision() {
+    Implementation::ParseError error;
+
+    /* Values that aren't exactly representable, should be rounded the same
+       way as the compiler does it */
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Float>(CharacterLiteral{"0.1"}, error).second, 0.1f);
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Float>(CharacterLiteral{"-0.000_123_4"}, error).second, -0.0001234f);
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Double>(CharacterLiteral{"0.1"}, error).second, 0.1);
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Double>(CharacterLiteral{"3.14159265358979323846"}, error).second, 3.14159265358979323846);
+
+    /* Exponents and mantissas outside of the exactly representable range */
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Float>(CharacterLiteral{"1.17549435e-38"}, error).second, 1.17549435e-38f);
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Double>(CharacterLiteral{"1.7976931348623157e308"}, error).second, 1.7976931348623157e308);
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Double>(CharacterLiteral{"9007199254740993.0"}, error).second, 9007199254740993.0);
+
+    /* More significant digits than what's kept, the rest should still affect
+       rounding */
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Double>(CharacterLiteral{"1.000000000000000111022302462515654042363166809082031250000000000000000000001"}, error).second, 1.0000000000000002);
+
+    /* Zeros */
+    CORRADE_COMPARE(Implementation::floatingPointLiteral<Float>(CharacterLiteral{"000.000e55"}, error).second, 0.0f);
+    CORRADE_COMPARE(error.error, Implementation::ParseErrorType::NoError);
+}
+
 void ParsersTest::floatLiteralBinary() {
     CharacterLiteral a{"-0xbad_cafe_X"};
 
     Implementation::ParseError error;
-    std::string buffer;
     const char* ai;
     Float value;
-    std::tie(ai, value) = Implementation::floatingPointLiteral<Float>(a, buffer, error);
+    std::tie(ai, value) = Implementation::floatingPointLiteral<Float>(a, error);
     VERIFY_PARSED(error, a, ai, "-0xbad_cafe_");
     UnsignedInt v = 0xbadcafe;
     CORRADE_COMPARE(value, -reinterpret_cast<Float&>(v));
@@ -629,7 +664,6 @@ void ParsersTest::typeLiteral() {
 
 void ParsersTest::propertyValueInvalid() {
     Implementation::ParseError error;
-    std::string buffer;
 
     bool boolValue = {};
     Int integerValue = {};
@@ -638,10 +672,10 @@ void ParsersTest::propertyValueInvalid() {
     Containers::ArrayView<const char> referenceValue;
     Type typeValue = {};
 
-    CORRADE_VERIFY(!Implementation::propertyValue(CharacterLiteral{""}, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::propertyValue(CharacterLiteral{""}, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::ExpectedPropertyValue);
 
-    CORRADE_VERIFY(!Implementation::propertyValue(CharacterLiteral{"bleh"}, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error).first);
+    CORRADE_VERIFY(!Implementation::propertyValue(CharacterLiteral{"bleh"}, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error).first);
     CORRADE_COMPARE(error.error, Implementation::ParseErrorType::InvalidPropertyValue);
 }
 
@@ -649,7 +683,6 @@ void ParsersTest::propertyValueBool() {
     CharacterLiteral a{"true,"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -658,7 +691,7 @@ void ParsersTest::propertyValueBool() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "true");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Bool);
     CORRADE_COMPARE(boolValue, true);
@@ -668,7 +701,6 @@ void ParsersTest::propertyValueIntegral() {
     CharacterLiteral a{"17, 0.0"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -677,7 +709,7 @@ void ParsersTest::propertyValueIntegral() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "17");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Integral);
     CORRADE_COMPARE(integerValue, 17);
@@ -687,7 +719,6 @@ void ParsersTest::propertyValueCharacter() {
     CharacterLiteral a{"'a', 0.0"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -696,7 +727,7 @@ void ParsersTest::propertyValueCharacter() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "'a'");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Character);
     CORRADE_COMPARE(integerValue, 'a');
@@ -706,7 +737,6 @@ void ParsersTest::propertyValueBinary() {
     CharacterLiteral a{"0xff, 0.0"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -715,7 +745,7 @@ void ParsersTest::propertyValueBinary() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "0xff");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Binary);
     CORRADE_COMPARE(integerValue, 0xff);
@@ -725,7 +755,6 @@ void ParsersTest::propertyValueFloatingPoint() {
     CharacterLiteral a{"15.0_0,"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -734,7 +763,7 @@ void ParsersTest::propertyValueFloatingPoint() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "15.0_0");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Float);
     CORRADE_COMPARE(floatingPointValue, 15.0f);
@@ -744,7 +773,6 @@ void ParsersTest::propertyValueString() {
     CharacterLiteral a{"\"hello\","};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -753,7 +781,7 @@ void ParsersTest::propertyValueString() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "\"hello\"");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::String);
     CORRADE_COMPARE(stringValue, "hello");
@@ -763,7 +791,6 @@ void ParsersTest::propertyValueReference() {
     CharacterLiteral a{"%my_array2,"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -772,7 +799,7 @@ void ParsersTest::propertyValueReference() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "%my_array2");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Reference);
     CORRADE_COMPARE((std::string{referenceValue, referenceValue.size()}), "%my_array2");
@@ -782,7 +809,6 @@ void ParsersTest::propertyValueReferenceNull() {
     CharacterLiteral a{"null,"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -791,7 +817,7 @@ void ParsersTest::propertyValueReferenceNull() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "null");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Reference);
     CORRADE_VERIFY(referenceValue.isEmpty());
@@ -801,7 +827,6 @@ void ParsersTest::propertyValueType() {
     CharacterLiteral a{"float,"};
 
     Implementation::ParseError error;
-    std::string buffer;
     bool boolValue = {};
     Int integerValue = {};
     Float floatingPointValue = {};
@@ -810,7 +835,7 @@ void ParsersTest::propertyValueType() {
     Type typeValue = {};
     const char* ai;
     Implementation::InternalPropertyType type;
-    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, buffer, error);
+    std::tie(ai, type) = Implementation::propertyValue(a, boolValue, integerValue, floatingPointValue, stringValue, referenceValue, typeValue, error);
     VERIFY_PARSED(error, a, ai, "float");
     CORRADE_COMPARE(type, Implementation::InternalPropertyType::Type);
     CORRADE_COMPARE(typeValue, Type::Float);
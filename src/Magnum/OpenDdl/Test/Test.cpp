@@ -28,6 +28,7 @@
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/Utility/DebugStl.h> /* for std::string */
+#include <Corrade/Utility/FormatStl.h>
 
 #include "Magnum/OpenDdl/Document.h"
 #include "Magnum/OpenDdl/Property.h"
@@ -42,6 +43,8 @@ struct Test: TestSuite::Tester {
     void primitive();
     void primitiveEmpty();
     void primitiveName();
+    void primitiveLarge();
+    void primitiveSeparatorsInLiteralsAndComments();
     void primitiveExpectedListStart();
     void primitiveExpectedListEnd();
     void primitiveExpectedSeparator();
@@ -104,14 +107,21 @@ struct Test: TestSuite::Tester {
     void reference();
     void referenceInProperty();
     void referenceNull();
+    void referenceArrayNull();
     void referenceChain();
     void referenceInvalid();
+
+    void parseParallel();
+    void parseParallelError();
+    void parseTopLevelDataContiguous();
 };
 
 Test::Test() {
     addTests({&Test::primitive,
               &Test::primitiveEmpty,
               &Test::primitiveName,
+              &Test::primitiveLarge,
+              &Test::primitiveSeparatorsInLiteralsAndComments,
               &Test::primitiveExpectedListStart,
               &Test::primitiveExpectedListEnd,
               &Test::primitiveExpectedSeparator,
@@ -174,8 +184,13 @@ Test::Test() {
               &Test::reference,
               &Test::referenceInProperty,
               &Test::referenceNull,
+              &Test::referenceArrayNull,
               &Test::referenceChain,
-              &Test::referenceInvalid});
+              &Test::referenceInvalid,
+
+              &Test::parseParallel,
+              &Test::parseParallelError,
+              &Test::parseTopLevelDataContiguous});
 }
 
 void Test::primitive() {
@@ -214,6 +229,53 @@ void Test::primitiveName() {
     CORRADE_COMPARE(d.firstChild().name(), "%name");
 }
 
+void Test::primitiveLarge() {
+    /* Larger than the default arena chunk size, to verify that the data are
+       still stored contiguously and that data parsed before and after are
+       unaffected */
+    std::string data = "int32 { 1, 2 } unsigned_int32 {";
+    Containers::Array<UnsignedInt> expected{NoInit, 20000};
+    for(std::size_t i = 0; i != expected.size(); ++i) {
+        expected[i] = i*3;
+        data += Utility::formatString("{}{}", i ? ", " : " ", expected[i]);
+    }
+    data += " } int32 { 3 }";
+
+    Document d;
+    CORRADE_VERIFY(d.parse(Containers::arrayView(data.data(), data.size()), {}, {}));
+
+    Structure first = d.firstChild();
+    CORRADE_COMPARE_AS(first.asArray<Int>(),
+        (Containers::Array<Int>{InPlaceInit, {1, 2}}),
+        TestSuite::Compare::Container);
+
+    Containers::Optional<Structure> large = first.findNext();
+    CORRADE_VERIFY(large);
+    CORRADE_COMPARE(large->type(), Type::UnsignedInt);
+    CORRADE_COMPARE_AS(large->asArray<UnsignedInt>(),
+        expected,
+        TestSuite::Compare::Container);
+
+    Containers::Optional<Structure> last = large->findNext();
+    CORRADE_VERIFY(last);
+    CORRADE_COMPARE(last->as<Int>(), 3);
+}
+
+void Test::primitiveSeparatorsInLiteralsAndComments() {
+    /* The storage size is estimated upfront from the separator count, which
+       shouldn't get confused by separators and braces in literals and
+       comments */
+    Document d;
+    CORRADE_VERIFY(d.parse(CharacterLiteral{
+        "string { \"}\", /* }, */ \"\\\"}\" // }\n"
+        ", \"a\" }"}, {}, {}));
+
+    Structure s = d.firstChild();
+    CORRADE_COMPARE_AS(s.asArray<std::string>(),
+        (Containers::Array<std::string>{InPlaceInit, {"}", "\"}", "a"}}),
+        TestSuite::Compare::Container);
+}
+
 void Test::primitiveExpectedListStart() {
     Containers::String out;
     Error redirectError{&out};
@@ -1160,6 +1222,25 @@ Hierarchic { ref { null } }
     CORRADE_VERIFY(!d.firstChildOf(HierarchicStructure).firstChild().asReference());
 }
 
+void Test::referenceArrayNull() {
+    Document d;
+    /* GCC < 4.9 cannot handle multiline raw string literals inside macros */
+    auto s = CharacterLiteral{
+R"oddl(
+Root $root {}
+ref { null, $root }
+    )oddl"};
+    CORRADE_VERIFY(d.parse(s, structureIdentifiers, propertyIdentifiers));
+
+    /* Null and non-null references mixed in an array, the non-null one
+       pointing to the very first structure */
+    Containers::Array<Containers::Optional<Structure>> references = d.firstChildOf(Type::Reference).asReferenceArray();
+    CORRADE_COMPARE(references.size(), 2);
+    CORRADE_VERIFY(!references[0]);
+    CORRADE_VERIFY(references[1]);
+    CORRADE_COMPARE(references[1]->name(), "$root");
+}
+
 void Test::referenceChain() {
     Document d;
     /* GCC < 4.9 cannot handle multiline raw string literals inside macros */
@@ -1272,6 +1353,138 @@ Root %root {
         "OpenDdl::Document::parse(): reference %local1%local2 was not found\n");
 }
 
+void Test::parseParallel() {
+    Document d;
+    CORRADE_COMPARE(d.parseThreadCount(), 1);
+    d.setParseThreadCount(4);
+    CORRADE_COMPARE(d.parseThreadCount(), 4);
+
+    /* Each top-level structure is likely parsed on a different thread, with
+       references, names and properties across them and braces in literals and
+       comments that shouldn't confuse the splitting */
+    /* GCC < 4.9 cannot handle multiline raw string literals inside macros */
+    auto s = CharacterLiteral{
+R"oddl(
+Root $first (some = "}{") {
+    int32 %local { 1, 2, 3 } /* { */
+}
+Hierarchic $second (reference = $third) {
+    ref { %child, $first%local }
+    Root %child { string { "{", "}" } }
+}
+Root $third (reference = $second) { // }
+    float { 1.5 }
+}
+Some { ref { $first, null, $third } }
+    )oddl"};
+    CORRADE_VERIFY(d.parse(s, structureIdentifiers, propertyIdentifiers));
+
+    Containers::Optional<Structure> first = d.findFirstChild();
+    CORRADE_VERIFY(first);
+    CORRADE_COMPARE(first->name(), "$first");
+    CORRADE_COMPARE(first->propertyOf(SomeProperty).as<std::string>(), "}{");
+    CORRADE_COMPARE_AS(first->firstChild().asArray<Int>(),
+        (Containers::Array<Int>{InPlaceInit, {1, 2, 3}}),
+        TestSuite::Compare::Container);
+
+    Containers::Optional<Structure> second = first->findNext();
+    CORRADE_VERIFY(second);
+    CORRADE_COMPARE(second->name(), "$second");
+    Containers::Array<Containers::Optional<Structure>> secondReferences = second->firstChild().asReferenceArray();
+    CORRADE_COMPARE(secondReferences.size(), 2);
+    CORRADE_VERIFY(secondReferences[0]);
+    CORRADE_COMPARE(secondReferences[0]->name(), "%child");
+    CORRADE_VERIFY(secondReferences[0]->parent() == second);
+    CORRADE_COMPARE_AS(secondReferences[0]->firstChild().asArray<std::string>(),
+        (Containers::Array<std::string>{InPlaceInit, {"{", "}"}}),
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(secondReferences[1]);
+    CORRADE_COMPARE(secondReferences[1]->name(), "%local");
+    CORRADE_VERIFY(secondReferences[1]->parent() == first);
+
+    Containers::Optional<Structure> third = second->findNext();
+    CORRADE_VERIFY(third);
+    CORRADE_COMPARE(third->name(), "$third");
+    CORRADE_COMPARE(third->firstChild().as<Float>(), 1.5f);
+    CORRADE_VERIFY(second->propertyOf(ReferenceProperty).asReference() == third);
+    CORRADE_VERIFY(third->propertyOf(ReferenceProperty).asReference() == second);
+
+    Containers::Optional<Structure> last = third->findNext();
+    CORRADE_VERIFY(last);
+    CORRADE_COMPARE(last->identifier(), SomeStructure);
+    CORRADE_VERIFY(!last->findNext());
+    Containers::Array<Containers::Optional<Structure>> lastReferences = last->firstChild().asReferenceArray();
+    CORRADE_COMPARE(lastReferences.size(), 3);
+    CORRADE_VERIFY(lastReferences[0] == first);
+    CORRADE_VERIFY(!lastReferences[1]);
+    CORRADE_VERIFY(lastReferences[2] == third);
+}
+
+void Test::parseParallelError() {
+    Document d;
+    d.setParseThreadCount(4);
+
+    Containers::String out;
+    Error redirectError{&out};
+
+    /* The first error in the document should be reported, even if the
+       structures after are parsed on other threads */
+    /* GCC < 4.9 cannot handle multiline raw string literals inside macros */
+    auto s = CharacterLiteral{
+R"oddl(
+int32 { 1, 2 }
+int32 { 3 4 }
+int32 { 5, 6 }
+float { x }
+    )oddl"};
+    CORRADE_VERIFY(!d.parse(s, {}, {}));
+    CORRADE_COMPARE(out, "OpenDdl::Document::parse(): expected , character on line 3\n");
+}
+
+void Test::parseTopLevelDataContiguous() {
+    Document d;
+    CORRADE_VERIFY(!d.isTopLevelDataContiguous());
+    d.setTopLevelDataContiguous(true);
+    CORRADE_VERIFY(d.isTopLevelDataContiguous());
+
+    /* The data lists are too large to fit into a single chunk together, and
+       they're interleaved with property values and data of other types,
+       names that look like type identifiers and commas and braces in literals
+       and comments that shouldn't confuse the size estimation */
+    std::string data = "Some (some = 1.5) { float { 0.5 } }\n";
+    for(std::size_t i = 0; i != 3; ++i) {
+        std::string subArrays, floats;
+        for(std::size_t j = 0; j != 1000*(i + 1); ++j) {
+            subArrays += j ? ", {1.0, 2.0}" : "{1.0, 2.0}";
+            floats += j ? ", 3.0" : "3.0";
+        }
+        data += Utility::formatString("Root $float{} (some = 2.5) {{\n", i) +
+            "    Hierarchic (some = \"{,\") { float[2] %int32 { " + subArrays + " } }\n"
+            "    int32 { 1, 2, 3 }\n"
+            "    Hierarchic { float { " + floats + " } // , {\n"
+            "    }\n"
+            "    float { }\n"
+            "}\n";
+    }
+    CORRADE_VERIFY(d.parse(Containers::arrayView(data.data(), data.size()), structureIdentifiers, propertyIdentifiers));
+
+    std::size_t count = 0;
+    for(Structure root: d.childrenOf(RootStructure)) {
+        CORRADE_ITERATION(count);
+        Containers::Optional<Structure> a = root.findFirstChildOf(HierarchicStructure);
+        CORRADE_VERIFY(a);
+        Containers::Optional<Structure> b = a->findNextOf(HierarchicStructure);
+        CORRADE_VERIFY(b);
+        Containers::ArrayView<const Float> aData = a->firstChild().asArray<Float>();
+        Containers::ArrayView<const Float> bData = b->firstChild().asArray<Float>();
+        CORRADE_COMPARE(aData.size(), 2000*(count + 1));
+        CORRADE_COMPARE(bData.size(), 1000*(count + 1));
+        CORRADE_VERIFY(bData.data() == aData.end());
+        ++count;
+    }
+    CORRADE_COMPARE(count, 3);
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::OpenDdl::Test::Test)
@@ -0,0 +1,215 @@
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+#include <cmath>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
+
+#include "Magnum/Magnum.h"
+#include "Magnum/Math/Constants.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
+
+namespace Magnum { namespace Test { namespace {
+
+struct RemixResampleAudioTest: TestSuite::Tester {
+    explicit RemixResampleAudioTest();
+
+    void canRemix();
+    void remixMatrixMonoToStereo();
+    void remixMatrixStereoToMono();
+    void remixMatrixSurround51ToStereo();
+
+    void convertUnsignedByte();
+    void convertShort();
+    void remixOnly();
+
+    void frameCount();
+    void resampleConstant();
+    void resampleSine();
+};
+
+const struct {
+    const char* name;
+    UnsignedInt frequency, outputFrequency;
+} ResampleData[]{
+    {"48 kHz to 44.1 kHz", 48000, 44100},
+    {"44.1 kHz to 48 kHz", 44100, 48000},
+    {"22.05 kHz to 96 kHz", 22050, 96000},
+    {"96 kHz to 8 kHz", 96000, 8000},
+    /* Goes over ResampleMaxPhaseCount, so the phases get interpolated */
+    {"44.1 kHz to 44.101 kHz", 44100, 44101},
+};
+
+RemixResampleAudioTest::RemixResampleAudioTest() {
+    addTests({&RemixResampleAudioTest::canRemix,
+              &RemixResampleAudioTest::remixMatrixMonoToStereo,
+              &RemixResampleAudioTest::remixMatrixStereoToMono,
+              &RemixResampleAudioTest::remixMatrixSurround51ToStereo,
+
+              &RemixResampleAudioTest::convertUnsignedByte,
+              &RemixResampleAudioTest::convertShort,
+              &RemixResampleAudioTest::remixOnly,
+
+              &RemixResampleAudioTest::frameCount});
+
+    addInstancedTests({&RemixResampleAudioTest::resampleConstant,
+                       &RemixResampleAudioTest::resampleSine},
+        Containers::arraySize(ResampleData));
+}
+
+void RemixResampleAudioTest::canRemix() {
+    CORRADE_VERIFY(Implementation::canRemixAudio(3, 3));
+    CORRADE_VERIFY(Implementation::canRemixAudio(1, 2));
+    CORRADE_VERIFY(Implementation::canRemixAudio(2, 1));
+    CORRADE_VERIFY(Implementation::canRemixAudio(8, 2));
+    CORRADE_VERIFY(Implementation::canRemixAudio(6, 1));
+    CORRADE_VERIFY(!Implementation::canRemixAudio(3, 2));
+    CORRADE_VERIFY(!Implementation::canRemixAudio(2, 6));
+}
+
+void RemixResampleAudioTest::remixMatrixMonoToStereo() {
+    Float matrix[2];
+    Implementation::audioRemixMatrix(1, 2, matrix);
+    CORRADE_COMPARE_AS(Containers::arrayView(matrix),
+        Containers::arrayView({1.0f, 1.0f}),
+        TestSuite::Compare::Container);
+}
+
+void RemixResampleAudioTest::remixMatrixStereoToMono() {
+    Float matrix[2];
+    Implementation::audioRemixMatrix(2, 1, matrix);
+    CORRADE_COMPARE_AS(Containers::arrayView(matrix),
+        Containers::arrayView({0.5f, 0.5f}),
+        TestSuite::Compare::Container);
+}
+
+void RemixResampleAudioTest::remixMatrixSurround51ToStereo() {
+    Float matrix[2*6];
+    Implementation::audioRemixMatrix(6, 2, matrix);
+
+    /* LFE is dropped, the left channel doesn't get anything from the right
+       side and vice versa */
+    CORRADE_COMPARE(matrix[0*6 + 3], 0.0f);
+    CORRADE_COMPARE(matrix[1*6 + 3], 0.0f);
+    CORRADE_COMPARE(matrix[0*6 + 1], 0.0f);
+    CORRADE_COMPARE(matrix[0*6 + 5], 0.0f);
+    CORRADE_COMPARE(matrix[1*6 + 0], 0.0f);
+    CORRADE_COMPARE(matrix[1*6 + 4], 0.0f);
+
+    /* Each row is normalized to not clip, center is shared equally */
+    for(UnsignedInt o = 0; o != 2; ++o) {
+        CORRADE_ITERATION(o);
+        Float sum = 0.0f;
+        for(UnsignedInt i = 0; i != 6; ++i) sum += matrix[o*6 + i];
+        CORRADE_COMPARE(sum, 1.0f);
+    }
+    CORRADE_COMPARE(matrix[0*6 + 2], matrix[1*6 + 2]);
+}
+
+void RemixResampleAudioTest::convertUnsignedByte() {
+    const UnsignedByte data[]{0, 128, 255};
+    Containers::Array<char> out = Implementation::remixResampleAudio(Containers::arrayCast<const char>(Containers::arrayView(data)), Implementation::AudioSampleType::UnsignedByte, 1, 22050, 1, 22050);
+    CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out),
+        Containers::arrayView({-1.0f, 0.0f, 0.9921875f}),
+        TestSuite::Compare::Container);
+}
+
+void RemixResampleAudioTest::convertShort() {
+    const Short data[]{-32768, 0, 16384};
+    Containers::Array<char> out = Implementation::remixResampleAudio(Containers::arrayCast<const char>(Containers::arrayView(data)), Implementation::AudioSampleType::Short, 1, 22050, 1, 22050);
+    CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out),
+        Containers::arrayView({-1.0f, 0.0f, 0.5f}),
+        TestSuite::Compare::Container);
+}
+
+void RemixResampleAudioTest::remixOnly() {
+    /* Two stereo frames to mono and back to stereo */
+    const Float data[]{
+        0.5f, -0.25f,
+        1.0f, 0.0f
+    };
+    Containers::Array<char> mono = Implementation::remixResampleAudio(Containers::arrayCast<const char>(Containers::arrayView(data)), Implementation::AudioSampleType::Float, 2, 44100, 1, 44100);
+    CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(mono),
+        Containers::arrayView({0.125f, 0.5f}),
+        TestSuite::Compare::Container);
+
+    Containers::Array<char> stereo = Implementation::remixResampleAudio(mono, Implementation::AudioSampleType::Float, 1, 44100, 2, 44100);
+    CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(stereo),
+        Containers::arrayView({0.125f, 0.125f, 0.5f, 0.5f}),
+        TestSuite::Compare::Container);
+}
+
+void RemixResampleAudioTest::frameCount() {
+    CORRADE_COMPARE(Implementation::resampledAudioFrameCount(48000, 48000, 44100), 44100);
+    CORRADE_COMPARE(Implementation::resampledAudioFrameCount(44100, 44100, 48000), 48000);
+    /* Partial frames at the end are rounded up */
+    CORRADE_COMPARE(Implementation::resampledAudioFrameCount(3, 48000, 44100), 3);
+    CORRADE_COMPARE(Implementation::resampledAudioFrameCount(13, 96000, 8000), 2);
+    CORRADE_COMPARE(Implementation::resampledAudioFrameCount(0, 96000, 8000), 0);
+}
+
+void RemixResampleAudioTest::resampleConstant() {
+    auto&& data = ResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* A constant signal should stay constant, apart from the edges where the
+       filter reaches into the zero padding */
+    Containers::Array<Float> in{NoInit, data.frequency/10};
+    for(Float& i: in) i = 0.75f;
+
+    Containers::Array<char> out = Implementation::remixResampleAudio(Containers::arrayCast<const char>(in), Implementation::AudioSampleType::Float, 1, data.frequency, 1, data.outputFrequency);
+    Containers::ArrayView<const Float> outFloats = Containers::arrayCast<const Float>(out);
+    CORRADE_COMPARE(outFloats.size(), Implementation::resampledAudioFrameCount(in.size(), data.frequency, data.outputFrequency));
+
+    Float maxError = 0.0f;
+    for(std::size_t i = outFloats.size()/10; i != outFloats.size()*9/10; ++i)
+        maxError = Math::max(maxError, Math::abs(outFloats[i] - 0.75f));
+    CORRADE_COMPARE_AS(maxError, 1.0e-3f, TestSuite::Compare::Less);
+}
+
+void RemixResampleAudioTest::resampleSine() {
+    auto&& data = ResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* A 1 kHz sine is well below the Nyquist frequency of all rates, so it
+       should pass through with only a small error */
+    Containers::Array<Float> in{NoInit, data.frequency/10};
+    for(std::size_t i = 0; i != in.size(); ++i)
+        in[i] = 0.5f*std::sin(2.0*Constants<Double>::pi()*1000.0*i/data.frequency);
+
+    Containers::Array<char> out = Implementation::remixResampleAudio(Containers::arrayCast<const char>(in), Implementation::AudioSampleType::Float, 1, data.frequency, 1, data.outputFrequency);
+    Containers::ArrayView<const Float> outFloats = Containers::arrayCast<const Float>(out);
+
+    Float maxError = 0.0f;
+    for(std::size_t i = outFloats.size()/10; i != outFloats.size()*9/10; ++i)
+        maxError = Math::max(maxError, Math::abs(outFloats[i] - Float(0.5*std::sin(2.0*Constants<Double>::pi()*1000.0*i/data.outputFrequency))));
+    CORRADE_COMPARE_AS(maxError, 1.0e-3f, TestSuite::Compare::Less);
+}
+
+}}}
+
+CORRADE_TEST_MAIN(Magnum::Test::RemixResampleAudioTest)
@@ -0,0 +1,258 @@
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Container.h>
+
+#include "Magnum/Magnum.h"
+#include "Magnum/Implementation/yFlipCompressedBlocks.h"
+
+namespace Magnum { namespace Test { namespace {
+
+const struct {
+    const char* name;
+    Int bits;
+    Int horizontalStep;
+    Int maxErrorInRange, maxError;
+} Etc2PlanarErrorBoundsData[]{
+    {"6-bit channel", 6, 1, 3, 112},
+    /* Going through all horizontal values of the 7-bit channel would take too
+       long, every ninth still hits the maximal errors */
+    {"7-bit channel", 7, 9, 2, 114},
+};
+
+struct YFlipCompressedBlocksTest: TestSuite::Tester {
+    explicit YFlipCompressedBlocksTest();
+
+    void eac();
+    void etc2Individual();
+    void etc2Differential();
+    void etc2DifferentialPunchthroughAlpha();
+    void etc2Planar();
+    void etc2DifferentialErrorBounds();
+    void etc2PlanarErrorBounds();
+
+    void supported();
+    void blocks();
+};
+
+YFlipCompressedBlocksTest::YFlipCompressedBlocksTest() {
+    addTests({&YFlipCompressedBlocksTest::eac,
+              &YFlipCompressedBlocksTest::etc2Individual,
+              &YFlipCompressedBlocksTest::etc2Differential,
+              &YFlipCompressedBlocksTest::etc2DifferentialPunchthroughAlpha,
+              &YFlipCompressedBlocksTest::etc2Planar,
+              &YFlipCompressedBlocksTest::etc2DifferentialErrorBounds});
+
+    addInstancedTests({&YFlipCompressedBlocksTest::etc2PlanarErrorBounds},
+        Containers::arraySize(Etc2PlanarErrorBoundsData));
+
+    addTests({&YFlipCompressedBlocksTest::supported,
+              &YFlipCompressedBlocksTest::blocks});
+}
+
+void YFlipCompressedBlocksTest::eac() {
+    /* First column has indices 0, 1, 2, 3 from the top, second 7, 6, 0, 0,
+       the rest is zero. The base codeword, multiplier and table index stay. */
+    CORRADE_COMPARE(Implementation::yFlipEacBlock(0x805a053f80000000ull),
+                                                  0x805a688037000000ull);
+}
+
+void YFlipCompressedBlocksTest::etc2Individual() {
+    /* With sub-blocks on top of each other the colors and table codewords get
+       swapped, in addition to the indices */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x123456390001000eull, false),
+                                                   0x214365c500080007ull);
+
+    /* With sub-blocks side by side only the indices get flipped */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x123456380001000eull, false),
+                                                   0x1234563800080007ull);
+}
+
+void YFlipCompressedBlocksTest::etc2Differential() {
+    /* R is 10 with a delta of -4, G 20 with a delta of 3, B 0 with a delta of
+       1. The negated delta of -4 isn't representable, so the R base gets off
+       by one instead. */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x54a3015700010001ull, false),
+                                                   0x3bbd0fab00080008ull);
+}
+
+void YFlipCompressedBlocksTest::etc2DifferentialPunchthroughAlpha() {
+    /* Same as above, but with the opaque bit not set, which would be the
+       individual mode without punchthrough alpha */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x54a3015500010001ull, true),
+                                                   0x3bbd0fa900080008ull);
+}
+
+void YFlipCompressedBlocksTest::etc2Planar() {
+    /* Red origin 16, horizontal 20 and vertical 24, everything else zero. The
+       vertical delta is divisible by four, so the flip is reversible. */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x2000042a00030000ull, false),
+                                                   0x2c0004360001c000ull);
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x2c0004360001c000ull, false),
+                                                   0x2000042a00030000ull);
+
+    /* A block produced by an actual encoder. Without any vertical gradient it
+       should stay the same, including the bits that select the planar
+       mode. */
+    CORRADE_COMPARE(Implementation::yFlipEtc2Block(0x7e00047f0007e000ull, false),
+                                                   0x7e00047f0007e000ull);
+}
+
+void YFlipCompressedBlocksTest::etc2DifferentialErrorBounds() {
+    /* Sub-blocks on top of each other, red going through all base and delta
+       combinations that don't make it a T mode, green and blue being 16 with
+       a zero delta, table codewords 1 and 6 and some indices */
+    const auto expand = [](const UnsignedInt value) {
+        return Int((value << 3)|(value >> 2));
+    };
+    Int maxError = 0;
+    Int maxErrorDeltaMinus4 = 0;
+    for(UnsignedInt base = 0; base != 32; ++base) {
+        for(Int delta = -4; delta != 4; ++delta) {
+            if(Int(base) + delta < 0 || Int(base) + delta > 31)
+                continue;
+
+            CORRADE_ITERATION(base << Debug::nospace << "," << delta);
+            const UnsignedLong block =
+                (UnsignedLong(base) << 59)|
+                (UnsignedLong(delta & 0x07) << 56)|
+                (16ull << 51)|
+                (16ull << 43)|
+                (1ull << 37)|
+                (6ull << 34)|
+                (3ull << 32)|
+                0x0123fedcull;
+            const UnsignedLong flipped = Implementation::yFlipEtc2Block(block, false);
+
+            /* Green and blue stay the same, table codewords get swapped */
+            CORRADE_COMPARE(flipped & 0x00ffff0000000000ull, block & 0x00ffff0000000000ull);
+            CORRADE_COMPARE((flipped >> 37) & 0x07, 6ull);
+            CORRADE_COMPARE((flipped >> 34) & 0x07, 1ull);
+
+            /* The top sub-block of the flipped block should be the bottom one
+               of the original and vice versa */
+            const UnsignedInt flippedBase = (flipped >> 59) & 0x1f;
+            Int flippedDelta = (flipped >> 56) & 0x07;
+            if(flippedDelta & 0x04) flippedDelta -= 8;
+            const Int error = Math::max(
+                Math::abs(expand(flippedBase) - expand(base + delta)),
+                Math::abs(expand(flippedBase + flippedDelta) - expand(base)));
+
+            /* Everything except a delta of -4 is lossless and thus
+               reversible */
+            if(delta == -4)
+                maxErrorDeltaMinus4 = Math::max(maxErrorDeltaMinus4, error);
+            else {
+                maxError = Math::max(maxError, error);
+                CORRADE_COMPARE(Implementation::yFlipEtc2Block(flipped, false), block);
+            }
+        }
+    }
+
+    CORRADE_COMPARE(maxError, 0);
+    CORRADE_COMPARE(maxErrorDeltaMinus4, 9);
+}
+
+void YFlipCompressedBlocksTest::etc2PlanarErrorBounds() {
+    auto&& data = Etc2PlanarErrorBoundsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const auto expand = [&data](const Int value) {
+        return (value << (8 - data.bits))|(value >> (2*data.bits - 8));
+    };
+    const auto decode = [](const Int o, const Int h, const Int v, const Int x, const Int y) {
+        return Math::clamp((x*(h - o) + y*(v - o) + 4*o + 2) >> 2, 0, 255);
+    };
+
+    /* Compare the decoded flipped channel with the original decoded channel
+       flipped, separately for the cases where the ideal flipped values are
+       in range and where they aren't */
+    const Int max = (1 << data.bits) - 1;
+    Int maxErrorInRange = 0;
+    Int maxError = 0;
+    for(Int o = 0; o <= max; ++o) {
+        for(Int h = 0; h <= max; h += data.horizontalStep) {
+            for(Int v = 0; v <= max; ++v) {
+                UnsignedInt flippedO = o, flippedH = h, flippedV = v;
+                Implementation::yFlipEtc2PlanarChannel(flippedO, flippedH, flippedV, data.bits);
+
+                const Int oe = expand(o), he = expand(h), ve = expand(v);
+                const Int flippedOe = expand(flippedO), flippedHe = expand(flippedH), flippedVe = expand(flippedV);
+                Int error = 0;
+                for(Int y = 0; y != 4; ++y)
+                    for(Int x = 0; x != 4; ++x)
+                        error = Math::max(error, Math::abs(decode(flippedOe, flippedHe, flippedVe, x, y) - decode(oe, he, ve, x, 3 - y)));
+
+                const Int idealO = (oe + 3*ve + 2)/4;
+                if(idealO + he - oe >= 0 && idealO + he - oe <= 255 &&
+                   idealO + oe - ve >= 0 && idealO + oe - ve <= 255)
+                    maxErrorInRange = Math::max(maxErrorInRange, error);
+                maxError = Math::max(maxError, error);
+            }
+        }
+    }
+
+    CORRADE_COMPARE(maxErrorInRange, data.maxErrorInRange);
+    CORRADE_COMPARE(maxError, data.maxError);
+}
+
+void YFlipCompressedBlocksTest::supported() {
+    CORRADE_VERIFY(Implementation::isYFlipCompressedSupported(CompressedPixelFormat::Bc1RGBUnorm));
+    CORRADE_VERIFY(Implementation::isYFlipCompressedSupported(CompressedPixelFormat::Etc2RGB8A1Srgb));
+    CORRADE_VERIFY(Implementation::isYFlipCompressedSupported(CompressedPixelFormat::EacRG11Snorm));
+    CORRADE_VERIFY(!Implementation::isYFlipCompressedSupported(CompressedPixelFormat::Bc6hRGBUfloat));
+    CORRADE_VERIFY(!Implementation::isYFlipCompressedSupported(CompressedPixelFormat::Bc7RGBAUnorm));
+    CORRADE_VERIFY(!Implementation::isYFlipCompressedSupported(CompressedPixelFormat::Astc4x4RGBAUnorm));
+
+    CORRADE_VERIFY(Implementation::isBc6hOrBc7(CompressedPixelFormat::Bc6hRGBSfloat));
+    CORRADE_VERIFY(Implementation::isBc6hOrBc7(CompressedPixelFormat::Bc7RGBASrgb));
+    CORRADE_VERIFY(!Implementation::isBc6hOrBc7(CompressedPixelFormat::Bc5RGUnorm));
+    CORRADE_VERIFY(!Implementation::isBc6hOrBc7(CompressedPixelFormat::Astc4x4RGBAUnorm));
+}
+
+void YFlipCompressedBlocksTest::blocks() {
+    /* Two rows of EAC RG11 blocks, each being two 64-bit big-endian words. The
+       rows should get swapped and each word flipped separately. */
+    char data[]{
+        '\x80', '\x5a', '\x05', '\x3f', '\x80', '\x00', '\x00', '\x00',
+        '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+        '\x01', '\x02', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+        '\x80', '\x5a', '\x05', '\x3f', '\x80', '\x00', '\x00', '\x00',
+    };
+    Implementation::yFlipCompressedInPlace(CompressedPixelFormat::EacRG11Unorm, Containers::StridedArrayView4D<char>{data, {1, 2, 1, 16}});
+    CORRADE_COMPARE_AS(Containers::arrayView(data), Containers::arrayView<char>({
+        '\x01', '\x02', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+        '\x80', '\x5a', '\x68', '\x80', '\x37', '\x00', '\x00', '\x00',
+        '\x80', '\x5a', '\x68', '\x80', '\x37', '\x00', '\x00', '\x00',
+        '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+    }), TestSuite::Compare::Container);
+}
+
+}}}
+
+CORRADE_TEST_MAIN(Magnum::Test::YFlipCompressedBlocksTest)
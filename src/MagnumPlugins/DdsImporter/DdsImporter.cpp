@@ -36,13 +36,14 @@
 #include <Corrade/Utility/Endianness.h>
 #include <Corrade/Utility/Debug.h>
 #include <Magnum/PixelFormat.h>
-#include <Magnum/Math/ColorBatch.h>
 #include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Vector3.h>
 #include <Magnum/Math/Vector4.h>
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/Trade/ImageData.h>
 
+#include "Magnum/Implementation/yFlipCompressedBlocks.h"
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 #include <Magnum/Trade/TextureData.h>
 #endif
@@ -233,6 +234,10 @@ constexpr struct {
 
 struct DdsImporter::File {
     Containers::Array<char> in;
+    /* DataFlag::ExternallyOwned if the memory passed to openData() was
+       taken over without a copy and outlives the importer, empty otherwise.
+       Used for zero-copy image views. */
+    DataFlags inDataFlags;
 
     /* Size of one top-level slice. As it's used as an input for level size
        calculation, it doesn't take sliceCount into account. */
@@ -312,6 +317,7 @@ void DdsImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
     /* Take over the existing array or copy the data if we can't */
     if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned)) {
         f->in = Utility::move(data);
+        f->inDataFlags = dataFlags & DataFlag::ExternallyOwned;
     } else {
         f->in = Containers::Array<char>{NoInit, data.size()};
         Utility::copy(data, f->in);
@@ -676,20 +682,16 @@ void DdsImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dat
         if(f->dimensions == 3 || (f->dimensions == 2 && !(f->imageFlags & ImageFlag3D::Array)))
             f->yzFlip.set(0);
 
+        /* BC6H and BC7 can't be Y-flipped without re-encoding, fail instead
+           of importing the data with a wrong orientation */
+        if(f->yzFlip[0] && f->compressed && Implementation::isBc6hOrBc7(f->properties.compressed.format)) {
+            Error{} << "Trade::DdsImporter::openData(): Y flip is not possible for" << f->properties.compressed.format << Debug::nospace << ", enable assumeYUpZBackward to import the data with the original orientation";
+            return;
+        }
+
         /* Only some compressed formats can be Y-flipped right now. Print a
            warning for the others and reset the flip bit. */
-        if(f->yzFlip[0] && f->compressed &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc1RGBAUnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc1RGBASrgb &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc2RGBAUnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc2RGBASrgb &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc3RGBAUnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc3RGBASrgb &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc4RUnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc4RSnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc5RGUnorm &&
-            f->properties.compressed.format != CompressedPixelFormat::Bc5RGSnorm
-        ) {
+        if(f->yzFlip[0] && f->compressed && !Implementation::isYFlipCompressedSupported(f->properties.compressed.format)) {
             if(!(flags() & ImporterFlag::Quiet))
                 Warning{} << "Trade::DdsImporter::openData(): Y flip is not yet implemented for" << f->properties.compressed.format << Debug::nospace << ", imported data will have wrong orientation. Enable assumeYUpZBackward to suppress this warning.";
             f->yzFlip.reset(0);
@@ -756,24 +758,9 @@ void flipBlocks(const Vector3i& size, const ImporterFlags flags, const char* mes
         if(!(flags & ImporterFlag::Quiet) && size.y() % blockSize.y() != 0)
             Warning{} << messagePrefix << "Y-flipping a compressed image that's not whole blocks, the result will be shifted by" << (blockSize.y() - (size.y() % blockSize.y())) << "pixels";
 
-        if(format == CompressedPixelFormat::Bc1RGBAUnorm ||
-           format == CompressedPixelFormat::Bc1RGBASrgb)
-            Math::yFlipBc1InPlace(view);
-        else if(format == CompressedPixelFormat::Bc2RGBAUnorm ||
-                format == CompressedPixelFormat::Bc2RGBASrgb)
-            Math::yFlipBc2InPlace(view);
-        else if(format == CompressedPixelFormat::Bc3RGBAUnorm ||
-                format == CompressedPixelFormat::Bc3RGBASrgb)
-            Math::yFlipBc3InPlace(view);
-        else if(format == CompressedPixelFormat::Bc4RUnorm ||
-                format == CompressedPixelFormat::Bc4RSnorm)
-            Math::yFlipBc4InPlace(view);
-        else if(format == CompressedPixelFormat::Bc5RGUnorm ||
-                format == CompressedPixelFormat::Bc5RGSnorm)
-            Math::yFlipBc5InPlace(view);
-        /* For all other -- not yet supported -- formats the yzFlip[0] bit was
-           reset so it shouldn't get here */
-        else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+        /* For formats that can't be flipped the yzFlip[0] bit was reset in
+           openData() so it shouldn't get here */
+        Implementation::yFlipCompressedInPlace(format, view);
     }
     if(yzFlip[1])
         Utility::flipInPlace<0>(view);
@@ -781,7 +768,25 @@ void flipBlocks(const Vector3i& size, const ImporterFlags flags, const char* mes
 
 }
 
-template<UnsignedInt dimensions> ImageData<dimensions> DdsImporter::doImage(const char* const messagePrefix, UnsignedInt, const UnsignedInt level) {
+template<UnsignedInt dimensions> Containers::Optional<ImageData<dimensions>> DdsImporter::doImage(const char* const messagePrefix, UnsignedInt, const UnsignedInt level) {
+    /* Import either all slices or just the one selected in the
+       configuration. A single cube map face isn't a cube map anymore. */
+    std::size_t sliceOffset = 0;
+    std::size_t sliceCount = _f->sliceCount;
+    ImageFlags3D imageFlags = _f->imageFlags;
+    const Int layer = configuration().value<Int>("layer");
+    if(layer >= 0) {
+        if(UnsignedInt(layer) >= _f->sliceCount) {
+            Error{} << messagePrefix << "layer" << layer << "out of range for" << _f->sliceCount << "layers";
+            return {};
+        }
+
+        sliceOffset = layer;
+        sliceCount = 1;
+        if(imageFlags & ImageFlag3D::CubeMap)
+            imageFlags = (imageFlags & ~ImageFlag3D::CubeMap)|ImageFlag3D::Array;
+    }
+
     /* Calculate input offset, data size and image slice size */
     const Containers::Triple<std::size_t, std::size_t, Vector3i> offsetSize = _f->compressed ?
         levelOffsetSize(_f->topLevelSliceSize, _f->properties.compressed.blockSize, _f->properties.compressed.blockDataSize, level) :
@@ -789,17 +794,42 @@ template<UnsignedInt dimensions> ImageData<dimensions> DdsImporter::doImage(cons
 
     /* Image size is slice size combined with slice count */
     Vector3i imageSize = offsetSize.third();
-    if(_f->sliceCount != 1) {
+    if(sliceCount != 1) {
         CORRADE_INTERNAL_ASSERT(imageSize[dimensions - 1] == 1);
-        imageSize[dimensions - 1] = _f->sliceCount;
+        imageSize[dimensions - 1] = sliceCount;
+    }
+
+    /* Adjust pixel storage if row size is not four byte aligned */
+    PixelStorage storage;
+    if(!_f->compressed && (imageSize.x()*_f->properties.uncompressed.pixelSize % 4 != 0))
+        storage.setAlignment(1);
+
+    /* If no swizzling or flipping is needed and all imported slices of the
+       level are next to each other in the file, which is the case if there's
+       just one slice or just one level, or if just one layer is imported,
+       return a non-owning view on the data the importer holds if requested.
+       That's either the original memory passed to openData() with
+       DataFlag::Owned or DataFlag::ExternallyOwned, or the importer's own
+       copy. */
+    if(configuration().value<bool>("zeroCopy") &&
+       _f->yzFlip.none() &&
+       (_f->compressed || !_f->properties.uncompressed.needsSwizzle) &&
+       (sliceCount == 1 || _f->levelCount == 1))
+    {
+        const std::size_t inputOffset = _f->dataOffset + sliceOffset*_f->sliceSize + offsetSize.first();
+        const Containers::ArrayView<const char> levelData = _f->in.slice(inputOffset, inputOffset + offsetSize.second()*sliceCount);
+        if(_f->compressed)
+            return ImageData<dimensions>{_f->properties.compressed.format, Math::Vector<dimensions, Int>::pad(imageSize), _f->inDataFlags, levelData, ImageFlag<dimensions>(UnsignedShort(imageFlags))};
+        else
+            return ImageData<dimensions>{storage, _f->properties.uncompressed.format, Math::Vector<dimensions, Int>::pad(imageSize), _f->inDataFlags, levelData, ImageFlag<dimensions>(UnsignedShort(imageFlags))};
     }
 
     /* Allocate image data */
-    Containers::Array<char> data{NoInit, offsetSize.second()*_f->sliceCount};
+    Containers::Array<char> data{NoInit, offsetSize.second()*sliceCount};
 
     /* Copy all slices */
-    for(std::size_t i = 0; i != _f->sliceCount; ++i) {
-        const std::size_t inputOffset = _f->dataOffset + i*_f->sliceSize + offsetSize.first();
+    for(std::size_t i = 0; i != sliceCount; ++i) {
+        const std::size_t inputOffset = _f->dataOffset + (sliceOffset + i)*_f->sliceSize + offsetSize.first();
         const std::size_t outputOffset = i*offsetSize.second();
         Utility::copy(_f->in.slice(inputOffset, inputOffset + offsetSize.second()),
             data.slice(outputOffset, outputOffset + offsetSize.second()));
@@ -809,7 +839,7 @@ template<UnsignedInt dimensions> ImageData<dimensions> DdsImporter::doImage(cons
     if(_f->compressed) {
         flipBlocks(imageSize, flags(), messagePrefix, _f->yzFlip, _f->properties.compressed.format, _f->properties.compressed.blockSize, _f->properties.compressed.blockDataSize, data);
 
-        return ImageData<dimensions>{_f->properties.compressed.format, Math::Vector<dimensions, Int>::pad(imageSize), Utility::move(data), ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+        return ImageData<dimensions>{_f->properties.compressed.format, Math::Vector<dimensions, Int>::pad(imageSize), Utility::move(data), ImageFlag<dimensions>(UnsignedShort(imageFlags))};
     }
 
     /* Uncompressed. Swizzle and flip if needed. */
@@ -817,14 +847,9 @@ template<UnsignedInt dimensions> ImageData<dimensions> DdsImporter::doImage(cons
         swizzlePixels(_f->properties.uncompressed.format, data);
     flipPixels(_f->yzFlip, _f->properties.uncompressed.pixelSize, imageSize, data);
 
-    /* Adjust pixel storage if row size is not four byte aligned */
-    PixelStorage storage;
-    if((imageSize.x()*_f->properties.uncompressed.pixelSize % 4 != 0))
-        storage.setAlignment(1);
-
     /** @todo expose DdsAlphaMode::Premultiplied through ImageFlags once it has
         such flag */
-    return ImageData<dimensions>{storage, _f->properties.uncompressed.format, Math::Vector<dimensions, Int>::pad(imageSize), Utility::move(data), ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+    return ImageData<dimensions>{storage, _f->properties.uncompressed.format, Math::Vector<dimensions, Int>::pad(imageSize), Utility::move(data), ImageFlag<dimensions>(UnsignedShort(imageFlags))};
 }
 
 UnsignedInt DdsImporter::doImage1DCount() const {
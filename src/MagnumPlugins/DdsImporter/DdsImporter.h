@@ -112,10 +112,12 @@ See @ref building-plugins, @ref cmake-plugins, @ref plugins and
 @par
     Y-flipping block-compressed data is nontrivial and so far is implemented
     only for BC1, BC2, BC3, BC4 and BC5 formats with APIs from
-    @ref Magnum/Math/ColorBatch.h. Other compressed formats will print a
-    message to @relativeref{Magnum,Warning} and the data will not be flipped. A
-    warning also gets printed in case the flip is performed on an image whose
-    height isn't whole blocks, as that causes the data to be shifted.
+    @ref Magnum/Math/ColorBatch.h. BC6H and BC7, whose multi-partition blocks
+    can't be flipped without re-encoding, cause the import to fail with a
+    message printed to @relativeref{Magnum,Error} unless the
+    @cb{.ini} assumeYUpZBackward @ce option is set. A warning gets printed in
+    case the flip is performed on an image whose height isn't whole blocks, as
+    that causes the data to be shifted.
 @par
     Set the @cb{.ini} assumeYUpZBackward @ce
     @ref Trade-DdsImporter-configuration "configuration option" to assume the
@@ -141,6 +143,13 @@ dimension. 1D array textures import @ref ImageData2D with n y-slices, 2D array
 textures import @ref ImageData3D with n z-slices and (layered) cube maps import
 @ref ImageData3D with 6*n z-slices.
 
+Setting the @cb{.ini} layer @ce
+@ref Trade-DdsImporter-configuration "configuration option" to a non-negative
+value imports just given array layer or cube map face, with the last dimension
+being @cpp 1 @ce. In that case only data of given layer are accessed, and a
+single cube map face is imported with @ref ImageFlag3D::Array instead of
+@ref ImageFlag3D::CubeMap.
+
 @subsection Trade-DdsImporter-behavior-multilevel Multilevel images
 
 Files with multiple mip levels are imported with the largest level first, with
@@ -240,6 +249,25 @@ Packed formats, (planar) YUV / YCbCr video formats,
 and @m_class{m-doc-external} [R10G10B10_XR_BIAS_A2_UNORM](https://docs.microsoft.com/en-us/windows/win32/api/dxgiformat/ne-dxgiformat-dxgi_format)
 are not supported.
 
+@subsection Trade-DdsImporter-behavior-zero-copy Zero-copy import
+
+By default, image data are copied out of the file on every @ref image1D(),
+@ref image2D() or @ref image3D() call. If the @cb{.ini} zeroCopy @ce
+@ref Trade-DdsImporter-configuration "configuration option" is enabled and the
+data don't need to be flipped or swizzled, the returned image is instead a
+non-owning view pointing directly into the file data. As DDS stores the whole
+mip chain of a slice before the next slice, this is possible only if the file
+has either a single slice or a single mip level, otherwise the slices of a
+particular level aren't next to each other and are copied. For mipmapped
+arrays and cube maps, importing a single layer through the @cb{.ini} layer @ce
+option described above results in a view as well. In combination with
+@ref openMemory() on a memory-mapped file no copy of the data is then made at
+all, only the parts that are actually accessed get paged in and
+@ref ImageData::dataFlags() contain @ref DataFlag::ExternallyOwned. If the file
+was opened with @ref openData() or @ref openFile(), the view points into the
+importer's own copy of the data and the data flags are empty. In both cases
+the view is valid only as long as the file stays opened.
+
 @section Trade-DdsImporter-configuration Plugin-specific configuration
 
 It's possible to tune various import options through @ref configuration(). See
@@ -263,7 +291,7 @@ class MAGNUM_DDSIMPORTER_EXPORT DdsImporter: public AbstractImporter {
         MAGNUM_DDSIMPORTER_LOCAL void doClose() override;
         MAGNUM_DDSIMPORTER_LOCAL void doOpenData(Containers::Array<char>&& data, DataFlags dataFlags) override;
 
-        template<UnsignedInt dimensions> MAGNUM_DDSIMPORTER_LOCAL ImageData<dimensions> doImage(const char* messagePrefix, UnsignedInt id, UnsignedInt level);
+        template<UnsignedInt dimensions> MAGNUM_DDSIMPORTER_LOCAL Containers::Optional<ImageData<dimensions>> doImage(const char* messagePrefix, UnsignedInt id, UnsignedInt level);
 
         MAGNUM_DDSIMPORTER_LOCAL UnsignedInt doImage1DCount() const override;
         MAGNUM_DDSIMPORTER_LOCAL UnsignedInt doImage1DLevelCount(UnsignedInt id) override;
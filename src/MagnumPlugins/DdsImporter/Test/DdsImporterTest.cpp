@@ -96,8 +96,12 @@ struct DdsImporterTest: TestSuite::Tester {
        and rgba3D() */
     void compressedFormatFlip();
     void compressedFormatFlip3D();
+    void compressedFormatFlipNotPossible();
 
     void openMemory();
+    void layer();
+    void layerOutOfRange();
+    void zeroCopy();
     void openTwice();
     void importTwice();
 
@@ -485,13 +489,9 @@ const struct {
     {"BC5 signed, incomplete blocks",
         "bc5snorm.dds", {}, {}, true,
         "Trade::DdsImporter::image2D(): Y-flipping a compressed image that's not whole blocks, the result will be shifted by 2 pixels\n"},
-    /* These are all not implemented yet */
-    {"BC7, flip not implemented",
-        "dxt10-bc7.dds", {}, {}, false,
-        "Trade::DdsImporter::openData(): Y flip is not yet implemented for CompressedPixelFormat::Bc7RGBAUnorm, imported data will have wrong orientation. Enable assumeYUpZBackward to suppress this warning.\n"},
-    {"BC7, flip not implemented, quiet",
-        "dxt10-bc7.dds", ImporterFlag::Quiet, {}, false, nullptr},
-    {"BC7, flip not implemented, assume Y up, verbose",
+    /* BC7 can't be flipped, so it's imported only if no flip is needed. The
+       failure is tested in compressedFormatFlipNotPossible(). */
+    {"BC7, assume Y up, verbose",
         "dxt10-bc7.dds", ImporterFlag::Verbose, true, false, nullptr},
     /** @todo include ASTC (flip not implemented) once a decoder exists */
 };
@@ -513,14 +513,21 @@ const struct {
         "Trade::DdsImporter::image3D(): Y-flipping a compressed image that's not whole blocks, the result will be shifted by 3 pixels\n"},
     {"BC1, incomplete blocks, assume Y up Z backward, verbose",
         "dxt1-3d.dds", ImporterFlag::Verbose, true, false, false, nullptr},
-    {"BC7, flip not implemented, verbose",
-        "dxt10-bc7-3d.dds", ImporterFlag::Verbose, {}, false, true,
-        "Trade::DdsImporter::openData(): Y flip is not yet implemented for CompressedPixelFormat::Bc7RGBAUnorm, imported data will have wrong orientation. Enable assumeYUpZBackward to suppress this warning.\n"
-        "Trade::DdsImporter::openData(): image will be flipped along Z\n"},
-    {"BC7, flip not implemented, assume Y up Z backward, verbose",
+    {"BC7, assume Y up Z backward, verbose",
         "dxt10-bc7-3d.dds", ImporterFlag::Verbose, true, false, false, nullptr},
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    ImporterFlags flags;
+} CompressedFormatFlipNotPossibleData[]{
+    {"BC7", "dxt10-bc7.dds", {}},
+    /* The quiet flag silences only warnings, not errors */
+    {"BC7, quiet", "dxt10-bc7.dds", ImporterFlag::Quiet},
+    {"BC7, 3D", "dxt10-bc7-3d.dds", {}},
+};
+
 /* Shared among all plugins that implement data copying optimizations */
 const struct {
     const char* name;
@@ -537,6 +544,39 @@ const struct {
     }},
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    bool assumeYUpZBackward;
+    UnsignedInt level;
+    Int layer;
+    bool expectZeroCopy;
+} ZeroCopyData[]{
+    {"", "rgba8unorm-3d.dds", true, 0, -1, true},
+    {"compressed", "dxt1-3d.dds", true, 0, -1, true},
+    {"array", "dxt10-rgba8unorm-array.dds", true, 0, -1, true},
+    {"array, single layer", "dxt10-rgba8unorm-array.dds", true, 0, 2, true},
+    {"cube map with mips", "dxt1-cube-mips.dds", true, 1, -1, false},
+    {"cube map with mips, single face", "dxt1-cube-mips.dds", true, 1, 3, true},
+    {"cube map array, single layer", "dxt10-r8snorm-cube-array.dds", true, 0, 7, true},
+    {"flip needed", "rgba8unorm-3d.dds", false, 0, -1, false},
+    {"swizzle needed", "bgra8unorm-3d.dds", true, 0, -1, false},
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt level;
+    Int layer;
+    ImageFlags3D flags;
+} LayerData[]{
+    {"array", "dxt10-rgba8unorm-array.dds", 0, 2, ImageFlag3D::Array},
+    {"cube map", "rgba8unorm-cube.dds", 0, 4, ImageFlag3D::Array},
+    {"cube map with mips", "dxt1-cube-mips.dds", 1, 3, ImageFlag3D::Array},
+    {"cube map array", "dxt10-r8snorm-cube-array.dds", 0, 7, ImageFlag3D::Array},
+    {"3D image", "rgba8unorm-3d.dds", 0, 0, {}},
+};
+
 DdsImporterTest::DdsImporterTest() {
     addRepeatedTests({&DdsImporterTest::enumValueMatching},
         Containers::arraySize(DxgiFormatData));
@@ -590,9 +630,20 @@ DdsImporterTest::DdsImporterTest() {
     addInstancedTests({&DdsImporterTest::compressedFormatFlip3D},
         Containers::arraySize(CompressedFormatFlip3DData));
 
+    addInstancedTests({&DdsImporterTest::compressedFormatFlipNotPossible},
+        Containers::arraySize(CompressedFormatFlipNotPossibleData));
+
     addInstancedTests({&DdsImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
+    addInstancedTests({&DdsImporterTest::layer},
+        Containers::arraySize(LayerData));
+
+    addTests({&DdsImporterTest::layerOutOfRange});
+
+    addInstancedTests({&DdsImporterTest::zeroCopy},
+        Containers::arraySize(ZeroCopyData));
+
     addTests({&DdsImporterTest::openTwice,
               &DdsImporterTest::importTwice});
 
@@ -1682,6 +1733,19 @@ void DdsImporterTest::compressedFormatFlip3D() {
     }
 }
 
+void DdsImporterTest::compressedFormatFlipNotPossible() {
+    auto&& data = CompressedFormatFlipNotPossibleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    importer->addFlags(data.flags);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(DDSIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(out, "Trade::DdsImporter::openData(): Y flip is not possible for CompressedPixelFormat::Bc7RGBAUnorm, enable assumeYUpZBackward to import the data with the original orientation\n");
+}
+
 void DdsImporterTest::openMemory() {
     /* compared to dxt3() uses openData() & openMemory() instead of openFile()
        to test data copying on import, and a deliberately small file */
@@ -1708,6 +1772,92 @@ void DdsImporterTest::openMemory() {
     }), TestSuite::Compare::Container);
 }
 
+void DdsImporterTest::layer() {
+    auto&& data = LayerData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    /* Assume Y up orientation to get the data exactly as in the file without
+       any warnings */
+    importer->configuration().setValue("assumeYUpZBackward", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DDSIMPORTER_TEST_DIR, data.filename)));
+
+    /* Import all layers first to have something to compare to */
+    Containers::Optional<ImageData3D> all = importer->image3D(0, data.level);
+    CORRADE_VERIFY(all);
+
+    importer->configuration().setValue("layer", data.layer);
+    Containers::Optional<ImageData3D> image = importer->image3D(0, data.level);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->isCompressed(), all->isCompressed());
+    CORRADE_COMPARE(image->flags(), data.flags);
+
+    /* The layer is a slice of the full image. A 3D image has just a single
+       layer, which is the whole image. */
+    const std::size_t layerCount = data.flags & ImageFlag3D::Array ? all->size().z() : 1;
+    CORRADE_COMPARE(image->size(), (Vector3i{all->size().xy(), all->size().z()/Int(layerCount)}));
+    const std::size_t layerSize = all->data().size()/layerCount;
+    CORRADE_COMPARE_AS(image->data(),
+        all->data().sliceSize(data.layer*layerSize, layerSize),
+        TestSuite::Compare::Container);
+}
+
+void DdsImporterTest::layerOutOfRange() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    importer->configuration().setValue("assumeYUpZBackward", true);
+    importer->configuration().setValue("layer", 6);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DDSIMPORTER_TEST_DIR, "rgba8unorm-cube.dds")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image3D(0));
+    CORRADE_COMPARE(out, "Trade::DdsImporter::image3D(): layer 6 out of range for 6 layers\n");
+}
+
+void DdsImporterTest::zeroCopy() {
+    auto&& data = ZeroCopyData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Optional<Containers::Array<char>> memory = Utility::Path::read(Utility::Path::join(DDSIMPORTER_TEST_DIR, data.filename));
+    CORRADE_VERIFY(memory);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
+    importer->configuration().setValue("assumeYUpZBackward", data.assumeYUpZBackward);
+    importer->configuration().setValue("layer", data.layer);
+
+    /* Import a copy first to have something to compare to */
+    CORRADE_VERIFY(importer->openMemory(*memory));
+    Containers::Optional<ImageData3D> expected = importer->image3D(0, data.level);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(expected->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+
+    importer->configuration().setValue("zeroCopy", true);
+    Containers::Optional<ImageData3D> image = importer->image3D(0, data.level);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->isCompressed(), expected->isCompressed());
+    CORRADE_COMPARE(image->size(), expected->size());
+    CORRADE_COMPARE(image->flags(), expected->flags());
+    CORRADE_COMPARE_AS(image->data(), expected->data(), TestSuite::Compare::Container);
+
+    if(data.expectZeroCopy) {
+        /* The data should point directly into the memory passed to
+           openMemory(), which is guaranteed to outlive the importer */
+        CORRADE_COMPARE(image->dataFlags(), DataFlag::ExternallyOwned);
+        CORRADE_VERIFY(image->data().begin() >= memory->begin());
+        CORRADE_VERIFY(image->data().end() <= memory->end());
+
+        /* With openData() it points into the importer's own copy, which has
+           no such guarantee */
+        CORRADE_VERIFY(importer->openData(*memory));
+        Containers::Optional<ImageData3D> imageFromData = importer->image3D(0, data.level);
+        CORRADE_VERIFY(imageFromData);
+        CORRADE_COMPARE(imageFromData->dataFlags(), DataFlags{});
+        CORRADE_COMPARE_AS(imageFromData->data(), expected->data(), TestSuite::Compare::Container);
+    } else {
+        CORRADE_COMPARE(image->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+    }
+}
+
 void DdsImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DdsImporter");
     /* Assume Y up orientation to get the data exactly as in the file without
@@ -27,14 +27,22 @@
 
 #include "DrFlacImporter.h"
 
+#include <cstring>
+#include <thread>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/ScopeGuard.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Assert.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Endianness.h>
 
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Packing.h>
 
+#include "Magnum/Implementation/audioFileStream.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
+
 #define DR_FLAC_IMPLEMENTATION
 #define DR_FLAC_NO_STDIO /* Otherwise it includes windows.h, ugh */
 #include "dr_flac.h"
@@ -57,43 +65,127 @@ const BufferFormat flacFormatTable[8][3] = {
 };
 #undef _v
 
-/* Converts 32-bit PCM into lower bit levels by skipping bytes */
-Containers::Array<char> convert32PCM(const Containers::Array<char>& container, const UnsignedInt samples, const UnsignedInt size) {
-    Containers::Array<char> convertData{NoInit, samples*size};
+/* Narrows 32-bit samples decoded by dr_flac into the output format. The
+   loops are kept trivial and branch-free so the compiler can vectorize
+   them. */
+void convertSamples(const Containers::ArrayView<const Int> samples, const UnsignedInt bytesPerSample, char* const out) {
+    /* 8-bit needs to become unsigned */
+    if(bytesPerSample == 1) {
+        for(std::size_t i = 0; i != samples.size(); ++i)
+            out[i] = char((samples[i] >> 24) + 128);
+
+    } else if(bytesPerSample == 2) {
+        for(std::size_t i = 0; i != samples.size(); ++i) {
+            const Short value = Short(samples[i] >> 16);
+            std::memcpy(out + i*sizeof(Short), &value, sizeof(Short));
+        }
 
-    /* Incrementing `skip` for the first time makes it 0 */
-    UnsignedInt skip = ~UnsignedInt{}, index = 0;
-    for(char item: container) {
-        ++skip;
+    /* 24-bit needs to become float */
+    } else if(bytesPerSample == 3) {
+        for(std::size_t i = 0; i != samples.size(); ++i) {
+            const Float value = Math::unpack<Float>(Int(samples[i] & 0xffffff00));
+            std::memcpy(out + i*sizeof(Float), &value, sizeof(Float));
+        }
 
-        if(skip > 3)
-            skip = 0;
-        if(skip < 4 - size)
-            continue;
+    } else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+}
+
+/* 24-bit samples are imported as floats */
+inline UnsignedInt outputSampleSize(const UnsignedInt bytesPerSample) {
+    return bytesPerSample == 3 ? 4 : bytesPerSample;
+}
 
-        convertData[index] = item;
-        ++index;
+/* Decodes up to sampleCount samples from the current position in chunks on
+   stack, narrowing each directly into the output instead of decoding
+   everything to 32-bit first. The chunk has to contain whole frames,
+   otherwise dr_flac produces garbage for channel counts that don't divide the
+   chunk size. If decoding fails midway, the rest of the output is left
+   untouched. */
+void decodeSamples(drflac* const handle, const std::size_t sampleCount, const UnsignedInt bytesPerSample, char* const out) {
+    const UnsignedInt sampleSize = outputSampleSize(bytesPerSample);
+    Int chunk[4096];
+    const std::size_t maxChunkSampleCount = Containers::arraySize(chunk) - Containers::arraySize(chunk) % handle->channels;
+    for(std::size_t offset = 0; offset != sampleCount; ) {
+        const std::size_t read = drflac_read_s32(handle, Math::min(sampleCount - offset, maxChunkSampleCount), chunk);
+        if(!read) break;
+        convertSamples(Containers::arrayView(chunk).prefix(read), bytesPerSample, out + offset*sampleSize);
+        offset += read;
     }
+}
 
-    return convertData;
+bool seekFile(void* const userData, const int offset, const drflac_seek_origin origin) {
+    return Implementation::seekAudioFile(userData, offset, origin == drflac_seek_origin_current);
 }
 
 }
 
+struct DrFlacImporter::Stream {
+    /* Decoding from a copy of the data passed to openData() */
+    explicit Stream(const Containers::ArrayView<const char> input): data{NoInit, input.size()} {
+        Utility::copy(input, data);
+    }
+
+    /* Decoding from a file passed to openFile(), takes ownership of it */
+    explicit Stream(std::FILE* const file): file{file} {}
+
+    ~Stream() {
+        if(handle) drflac_close(handle);
+        if(file) std::fclose(file);
+    }
+
+    Containers::Array<char> data;
+    std::FILE* file{};
+    drflac* handle{};
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 DrFlacImporter::DrFlacImporter() = default; /* LCOV_EXCL_LINE */
 #endif
 
 DrFlacImporter::DrFlacImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
+DrFlacImporter::~DrFlacImporter() = default;
+
 ImporterFeatures DrFlacImporter::doFeatures() const { return ImporterFeature::OpenData; }
 
-bool DrFlacImporter::doIsOpened() const { return !!_data; }
+bool DrFlacImporter::doIsOpened() const { return _data || _stream; }
 
 void DrFlacImporter::doOpenData(Containers::ArrayView<const char> data) {
-    drflac* const handle = drflac_open_memory(data.data(), data.size());
+    /* In the streaming mode the decoder stays open after this function exits,
+       so it has to operate on a copy of the data */
+    Containers::Pointer<Stream> stream;
+    if(configuration().value<bool>("streaming")) {
+        stream.emplace(data);
+        data = stream->data;
+    }
+
+    openInternal(Utility::move(stream), data, "Audio::DrFlacImporter::openData():");
+}
+
+void DrFlacImporter::doOpenFile(const Containers::StringView filename) {
+    /* Without streaming everything is decoded upfront, so read the whole file
+       to memory, which also makes multi-threaded decoding possible */
+    if(!configuration().value<bool>("streaming"))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* Otherwise keep the file open and let the decoder read from it only
+       what it needs, instead of having a copy of the whole compressed file in
+       memory */
+    std::FILE* const file = Implementation::openAudioFile(filename);
+    if(!file) {
+        Error{} << "Audio::DrFlacImporter::openFile(): cannot open file" << filename;
+        return;
+    }
+
+    openInternal(Containers::Pointer<Stream>{InPlaceInit, file}, nullptr, "Audio::DrFlacImporter::openFile():");
+}
+
+void DrFlacImporter::openInternal(Containers::Pointer<Stream>&& stream, const Containers::ArrayView<const char> data, const char* const prefix) {
+    drflac* const handle = stream && stream->file ?
+        drflac_open(Implementation::readAudioFile, seekFile, stream->file) :
+        drflac_open_memory(data.data(), data.size());
     if(!handle) {
-        Error() << "Audio::DrFlacImporter::openData(): failed to open and decode FLAC data";
+        Error() << prefix << "failed to open and decode FLAC data";
         return;
     }
     Containers::ScopeGuard drflacClose{handle, drflac_close};
@@ -117,55 +209,248 @@ void DrFlacImporter::doOpenData(Containers::ArrayView<const char> data) {
     */
     if(numChannels == 0 || numChannels == 3 || numChannels == 5 || numChannels > 8 ||
        normalizedBytesPerSample == 0 || normalizedBytesPerSample > 3) {
-        Error{} << "Audio::DrFlacImporter::openData(): unsupported channel count"
+        Error{} << prefix << "unsupported channel count"
                 << numChannels << "with" << bitsPerSample
                 << "bits per sample";
         return;
     }
 
+    /* Remixing and resampling is done on the whole decoded data, so it's
+       ignored in the streaming mode */
+    UnsignedInt outputFrequency = configuration().value<UnsignedInt>("outputFrequency");
+    UnsignedInt outputChannelCount = configuration().value<UnsignedInt>("outputChannelCount");
+    if(stream && (outputFrequency || outputChannelCount)) {
+        Warning{} << prefix << "outputFrequency and outputChannelCount options are ignored in the streaming mode";
+        outputFrequency = outputChannelCount = 0;
+    }
+    if(!outputFrequency) outputFrequency = handle->sampleRate;
+    if(!outputChannelCount) outputChannelCount = numChannels;
+    if(!Implementation::canRemixAudio(numChannels, outputChannelCount)) {
+        Error{} << prefix << "can't remix" << numChannels << "channels to" << outputChannelCount;
+        return;
+    }
+
     _frequency = handle->sampleRate;
     _format = flacFormatTable[numChannels-1][normalizedBytesPerSample-1];
     CORRADE_INTERNAL_ASSERT(_format != BufferFormat{});
+    _channelCount = numChannels;
+    _bytesPerSample = normalizedBytesPerSample;
+    _sampleSize = outputSampleSize(normalizedBytesPerSample);
+    _frameCount = samples/numChannels;
+    _frameOffset = 0;
+
+    /* In the streaming mode just keep the decoder open, frames get decoded
+       in readFrames() */
+    if(stream) {
+        drflacClose.release();
+        stream->handle = handle;
+        _stream = Utility::move(stream);
+        return;
+    }
 
-    Containers::Array<char> tempData{NoInit, std::size_t(samples*sizeof(Int))};
-    drflac_read_s32(handle, samples, reinterpret_cast<Int*>(tempData.begin()));
-
-    _data = convert32PCM(tempData, samples, normalizedBytesPerSample);
-
-    /* 8-bit needs to become unsigned */
-    if(normalizedBytesPerSample == 1) {
-        for(char& item: *_data) item = item - 128;
-
-    /* 24-bit needs to become float */
-    } else if(normalizedBytesPerSample == 3) {
-        Containers::Array<char> floatData{NoInit, std::size_t(samples*sizeof(Float))};
-
-        const Containers::ArrayView<Float> floats = Containers::arrayCast<Float>(floatData);
-        for(std::size_t i = 0; i != samples; ++i) {
-            const UnsignedInt s0 = (*_data)[i*3 + 0];
-            const UnsignedInt s1 = (*_data)[i*3 + 1];
-            const UnsignedInt s2 = (*_data)[i*3 + 2];
-
-            const Int intData = Int((s0 << 8) | (s1 << 16) | (s2 << 24));
-            floats[i] = Math::unpack<Float>(intData);
+    /* If decoding fails midway, the rest stays zero-filled */
+    const UnsignedInt sampleSize = _sampleSize;
+    Containers::Array<char> out{ValueInit, std::size_t(samples*sampleSize)};
+
+    /* FLAC frames can be decoded independently, so with more than one thread
+       the stream is split into contiguous ranges, each decoded with its own
+       decoder into a disjoint part of the output. Without a seek table
+       dr_flac seeks by scanning all frame headers from the start, which would
+       make each thread redo most of the work of the threads before it, so the
+       range boundaries are taken from the SEEKTABLE and files without one are
+       decoded on a single thread. A seek point is always at a frame boundary,
+       so no frame gets decoded twice. */
+    UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+    if(!threadCount)
+        threadCount = std::thread::hardware_concurrency();
+
+    /* Range boundaries in frames, the last one is the total count. Each seek
+       point is 18 bytes, a big-endian 64-bit index of the first frame,
+       64-bit byte offset and 16-bit frame sample count. For each thread pick
+       the first seek point at or after its ideal boundary, placeholder
+       points (with the first frame being all ones) are skipped by the range
+       check. */
+    Containers::Array<UnsignedLong> rangeOffsets;
+    arrayAppend(rangeOffsets, 0);
+    if(threadCount > 1 && handle->seektablePos && handle->seektablePos + handle->seektableSize <= data.size()) {
+        const Containers::ArrayView<const char> seekPoints = data.sliceSize(std::size_t(handle->seektablePos), handle->seektableSize/18*18);
+        for(std::size_t i = 0; i != seekPoints.size() && rangeOffsets.size() != threadCount; i += 18) {
+            UnsignedLong firstFrame;
+            std::memcpy(&firstFrame, seekPoints.data() + i, sizeof(UnsignedLong));
+            Utility::Endianness::bigEndianInPlace(firstFrame);
+            if(firstFrame >= _frameCount*rangeOffsets.size()/threadCount &&
+               firstFrame > rangeOffsets.back() && firstFrame < _frameCount)
+                arrayAppend(rangeOffsets, firstFrame);
         }
+    }
+    arrayAppend(rangeOffsets, _frameCount);
+    threadCount = UnsignedInt(rangeOffsets.size() - 1);
+
+    /* A drflac can't be used from multiple threads at once, so each
+       additional thread gets its own handle on the same memory. The first
+       thread continues with the already opened one. Opening can fail only if
+       an allocation fails, in which case it falls back to decoding on a
+       single thread. */
+    Containers::Array<drflac*> handles{ValueInit, threadCount};
+    handles[0] = handle;
+    for(UnsignedInt i = 1; i != threadCount; ++i) {
+        if(!(handles[i] = drflac_open_memory(data.data(), data.size()))) {
+            for(UnsignedInt j = 1; j != i; ++j)
+                drflac_close(handles[j]);
+            threadCount = 1;
+            break;
+        }
+    }
 
-        _data = Utility::move(floatData);
+    /* Single-threaded decoding through the already opened handle */
+    if(threadCount == 1)
+        decodeSamples(handle, samples, normalizedBytesPerSample, out);
+
+    else {
+        auto worker = [&](const UnsignedInt thread) {
+            const UnsignedLong begin = rangeOffsets[thread]*numChannels;
+            const UnsignedLong end = rangeOffsets[thread + 1]*numChannels;
+            /* If the seek fails, the range stays zero-filled, consistently
+               with a failure in the single-threaded case */
+            if(begin != 0 && !drflac_seek_to_sample(handles[thread], begin))
+                return;
+            decodeSamples(handles[thread], end - begin, normalizedBytesPerSample, out + begin*sampleSize);
+        };
+
+        Containers::Array<std::thread> threads{threadCount - 1};
+        for(UnsignedInt i = 0; i != threads.size(); ++i)
+            threads[i] = std::thread{worker, i + 1};
+        worker(0);
+        for(std::thread& thread: threads)
+            thread.join();
+
+        for(UnsignedInt i = 1; i != threadCount; ++i)
+            drflac_close(handles[i]);
     }
+
+    /* Remix and resample the decoded data if requested, the output is
+       floats then */
+    if(outputChannelCount != numChannels || outputFrequency != _frequency) {
+        out = Implementation::remixResampleAudio(out,
+            normalizedBytesPerSample == 1 ? Implementation::AudioSampleType::UnsignedByte :
+            normalizedBytesPerSample == 2 ? Implementation::AudioSampleType::Short :
+                                            Implementation::AudioSampleType::Float,
+            numChannels, _frequency, outputChannelCount, outputFrequency);
+        _frequency = outputFrequency;
+        _format = flacFormatTable[outputChannelCount-1][2];
+        _channelCount = outputChannelCount;
+        _sampleSize = sizeof(Float);
+        _frameCount = out.size()/(outputChannelCount*sizeof(Float));
+    }
+
+    _data = Utility::move(out);
 }
 
-void DrFlacImporter::doClose() { _data = Containers::NullOpt; }
+void DrFlacImporter::doClose() {
+    _data = Containers::NullOpt;
+    _stream = nullptr;
+}
 
 BufferFormat DrFlacImporter::doFormat() const { return _format; }
 
 UnsignedInt DrFlacImporter::doFrequency() const { return _frequency; }
 
 Containers::Array<char> DrFlacImporter::doData() {
+    /* In the streaming mode decode everything from the start and then go
+       back to where the stream was. If decoding fails midway, the rest stays
+       zero-filled, which is consistent with what happens in the
+       non-streaming mode. */
+    if(_stream) {
+        const UnsignedLong frameOffset = _frameOffset;
+        Containers::Array<char> out{ValueInit, std::size_t(_frameCount*_channelCount*_sampleSize)};
+        if(!seek(0)) return {};
+        readFrames(out);
+        seek(frameOffset);
+        return out;
+    }
+
     Containers::Array<char> copy{NoInit, _data->size()};
     Utility::copy(*_data, copy);
     return copy;
 }
 
+Containers::Array<char> DrFlacImporter::releaseData() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrFlacImporter::releaseData(): no file opened", {});
+
+    /* In the streaming mode there's nothing to release, decode everything */
+    Containers::Array<char> out = _stream ? doData() : *Utility::move(_data);
+    close();
+    return out;
+}
+
+UnsignedLong DrFlacImporter::frameCount() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrFlacImporter::frameCount(): no file opened", {});
+    return _frameCount;
+}
+
+UnsignedLong DrFlacImporter::frameOffset() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrFlacImporter::frameOffset(): no file opened", {});
+    return _frameOffset;
+}
+
+std::size_t DrFlacImporter::readFrames(const Containers::ArrayView<char> data) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrFlacImporter::readFrames(): no file opened", {});
+    const std::size_t sampleSize = _sampleSize;
+    const std::size_t frameSize = _channelCount*sampleSize;
+    CORRADE_ASSERT(data.size() % frameSize == 0,
+        "Audio::DrFlacImporter::readFrames(): expected size to be a multiple of" << frameSize << "bytes but got" << data.size(), {});
+
+    const std::size_t frameCount = Math::min(UnsignedLong(data.size()/frameSize), _frameCount - _frameOffset);
+
+    /* Non-streaming mode, copy the already decoded data */
+    if(!_stream) {
+        Utility::copy(_data->sliceSize(_frameOffset*frameSize, frameCount*frameSize),
+            data.prefix(frameCount*frameSize));
+        _frameOffset += frameCount;
+        return frameCount;
+    }
+
+    /* Decode in fixed-size chunks of whole frames to a temporary buffer on
+       stack and convert from there */
+    Int samples[4096];
+    const std::size_t sampleCount = frameCount*_channelCount;
+    std::size_t decodedSampleCount = 0;
+    while(decodedSampleCount != sampleCount) {
+        const std::size_t chunkSampleCount = Math::min(sampleCount - decodedSampleCount, Containers::arraySize(samples) - Containers::arraySize(samples) % _channelCount);
+        const std::size_t read = drflac_read_s32(_stream->handle, chunkSampleCount, samples);
+        convertSamples(Containers::arrayView(samples).prefix(read), _bytesPerSample, data.data() + decodedSampleCount*sampleSize);
+        decodedSampleCount += read;
+        if(read != chunkSampleCount) break;
+    }
+
+    const std::size_t decodedFrameCount = decodedSampleCount/_channelCount;
+    _frameOffset += decodedFrameCount;
+    return decodedFrameCount;
+}
+
+bool DrFlacImporter::seek(const UnsignedLong frame) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrFlacImporter::seek(): no file opened", {});
+    if(frame > _frameCount) {
+        Error{} << "Audio::DrFlacImporter::seek(): frame" << frame << "out of range for" << _frameCount << "frames";
+        return false;
+    }
+
+    /* dr_flac clamps the sample index to the last sample, which is fine as
+       readFrames() doesn't read past _frameCount anyway */
+    if(_stream && frame != _frameCount && !drflac_seek_to_sample(_stream->handle, frame*_channelCount)) {
+        Error{} << "Audio::DrFlacImporter::seek(): seek to frame" << frame << "failed";
+        return false;
+    }
+
+    _frameOffset = frame;
+    return true;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(DrFlacAudioImporter, Magnum::Audio::DrFlacImporter,
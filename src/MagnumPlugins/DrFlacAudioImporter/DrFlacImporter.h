@@ -33,6 +33,7 @@
 
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "MagnumPlugins/DrFlacAudioImporter/configure.h"
@@ -137,6 +138,79 @@ Although technically FLAC supports 32 bits per channel as well,
 [not even the reference encoder supports that](https://xiph.org/flac/format.html#metadata_block_streaminfo),
 which makes it impossible to verify whether dr_flac is capable of importing
 such files, and thus handling of such files is not implemented.
+
+@subsection Audio-DrFlacImporter-behavior-streaming Streaming decode
+
+By default the whole file is decoded in @ref openData() and @ref data()
+returns a copy of it. Enabling the @cb{.ini} streaming @ce
+@ref Audio-DrFlacImporter-configuration "configuration option" makes
+@ref openData() and @ref openFile() parse just the header and keep the decoder
+open instead. With @ref openFile() the compressed data are read from the file
+only as the decoder needs them, with @ref openData() the decoder operates on a
+copy of the data passed to it. Frames are then decoded in chunks of arbitrary
+size with @ref readFrames() into a buffer supplied by the caller and
+@ref seek() can be used to jump to an arbitrary frame, making it possible to
+play back long files with just a small amount of memory. The output format is
+the same as with @ref data(). Calling @ref data() in streaming mode decodes
+the whole file without affecting the read position.
+
+The @ref readFrames(), @ref seek(), @ref frameOffset() and @ref frameCount()
+APIs work in the non-streaming mode as well, operating on the already decoded
+data. Because they're not a part of the @ref AbstractImporter interface, you
+need to link to the plugin directly and cast the importer instance to
+@ref DrFlacImporter in order to call them.
+
+@subsection Audio-DrFlacImporter-behavior-threads Multi-threaded decoding
+
+FLAC frames can be decoded independently of each other. Setting the
+@cb{.ini} threads @ce @ref Audio-DrFlacImporter-configuration "configuration option"
+to a value other than @cpp 1 @ce splits the stream into contiguous ranges of
+frames that are then decoded in parallel, each into a disjoint part of the
+output, with @cpp 0 @ce meaning all available hardware threads. The output is
+the same as with single-threaded decoding. The range boundaries are taken from
+the SEEKTABLE metadata block, as seeking without it would scan all frame
+headers from the start of the stream. Files without a seek table are thus
+always decoded on a single thread, and files with fewer seek points than the
+requested thread count use fewer threads. The option has no effect in the
+streaming mode.
+
+@subsection Audio-DrFlacImporter-behavior-remix Remixing and resampling
+
+Setting the @cb{.ini} outputFrequency @ce and @cb{.ini} outputChannelCount @ce
+@ref Audio-DrFlacImporter-configuration "configuration options" to a non-zero
+value converts the decoded data to given frequency and channel count in
+@ref openData(), for example to match the output device or to turn a surround
+file into a stereo or mono one for positional playback. If any conversion
+happens, the data are imported as @ref BufferFormat::MonoFloat,
+@ref BufferFormat::StereoFloat, @ref BufferFormat::Quad32,
+@ref BufferFormat::Surround51Channel32, @ref BufferFormat::Surround61Channel32
+or @ref BufferFormat::Surround71Channel32 and @ref frequency() and
+@ref frameCount() report the converted values.
+
+Resampling uses a windowed sinc filter, mono files can be remixed to stereo
+and stereo, quad and surround files to stereo or mono, with the LFE channel
+dropped. Other remixing combinations fail to import. The options have no
+effect in the streaming mode, where a warning is printed instead.
+
+@subsection Audio-DrFlacImporter-behavior-release Taking over the decoded data
+
+As the @ref AbstractImporter interface allows @ref data() to be called
+repeatedly, it always returns a copy of the decoded data. If the data are
+needed just once, for example to be uploaded to an audio buffer,
+@ref releaseData() hands over the internal buffer without copying and closes
+the file, avoiding a temporary that's as large as the whole decoded file.
+Same as with the streaming APIs, you need to link to the plugin directly in
+order to call it.
+
+@section Audio-DrFlacImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration().
+See below for all options and their default values:
+
+@snippet MagnumPlugins/DrFlacAudioImporter/DrFlacImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_DRFLACAUDIOIMPORTER_EXPORT DrFlacImporter: public AbstractImporter {
     public:
@@ -153,10 +227,67 @@ class MAGNUM_DRFLACAUDIOIMPORTER_EXPORT DrFlacImporter: public AbstractImporter
         /** @brief Plugin manager constructor */
         explicit DrFlacImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        ~DrFlacImporter();
+
+        /**
+         * @brief Frame count
+         *
+         * Count of frames in the file, i.e. count of samples for each
+         * channel. Expects that a file is opened. See
+         * @ref Audio-DrFlacImporter-behavior-streaming for more information.
+         */
+        UnsignedLong frameCount() const;
+
+        /**
+         * @brief Read position in frames
+         *
+         * Index of the frame that will be decoded by the next
+         * @ref readFrames() call. Is @cpp 0 @ce right after opening a file,
+         * equal to @ref frameCount() once everything is read. Expects that a
+         * file is opened.
+         */
+        UnsignedLong frameOffset() const;
+
+        /**
+         * @brief Decode next frames
+         *
+         * Decodes as many frames as fit into @p data, or less if the end of
+         * the file is reached, in the same @ref format() as @ref data()
+         * returns, and advances @ref frameOffset() by the count of decoded
+         * frames. Returns the count of decoded frames, @cpp 0 @ce at the end
+         * of the file. Expects that a file is opened and that size of
+         * @p data is a multiple of the frame size.
+         */
+        std::size_t readFrames(Containers::ArrayView<char> data);
+
+        /**
+         * @brief Seek to a frame
+         *
+         * Sets @ref frameOffset() to @p frame. If @p frame is larger than
+         * @ref frameCount() or seeking fails, prints a message to
+         * @relativeref{Magnum,Error}, returns @cpp false @ce and the read
+         * position is unspecified. Expects that a file is opened.
+         */
+        bool seek(UnsignedLong frame);
+
+        /**
+         * @brief Release the decoded data
+         *
+         * Unlike @ref data(), which returns a copy, gives up ownership of the
+         * decoded data and closes the file. In the streaming mode the whole
+         * file is decoded first, same as with @ref data(). Expects that a file
+         * is opened.
+         */
+        Containers::Array<char> releaseData();
+
     private:
+        struct Stream;
+
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL void doOpenData(Containers::ArrayView<const char> data) override;
+        MAGNUM_DRFLACAUDIOIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        MAGNUM_DRFLACAUDIOIMPORTER_LOCAL void openInternal(Containers::Pointer<Stream>&& stream, Containers::ArrayView<const char> data, const char* prefix);
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL void doClose() override;
 
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL BufferFormat doFormat() const override;
@@ -164,8 +295,14 @@ class MAGNUM_DRFLACAUDIOIMPORTER_EXPORT DrFlacImporter: public AbstractImporter
         MAGNUM_DRFLACAUDIOIMPORTER_LOCAL Containers::Array<char> doData() override;
 
         Containers::Optional<Containers::Array<char>> _data;
+        Containers::Pointer<Stream> _stream;
         BufferFormat _format;
         UnsignedInt _frequency;
+        UnsignedInt _channelCount;
+        UnsignedInt _bytesPerSample;
+        UnsignedInt _sampleSize;
+        UnsignedLong _frameCount;
+        UnsignedLong _frameOffset;
 };
 
 }}
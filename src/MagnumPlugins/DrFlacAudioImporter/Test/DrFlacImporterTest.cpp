@@ -27,15 +27,22 @@
 
 #include <string> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringStl.h> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "configure.h"
 
+#ifdef MAGNUM_DRFLACAUDIOIMPORTER_BUILD_STATIC
+#include "MagnumPlugins/DrFlacAudioImporter/DrFlacImporter.h"
+#endif
+
 namespace Magnum { namespace Audio { namespace Test { namespace {
 
 struct DrFlacImporterTest: TestSuite::Tester {
@@ -62,13 +69,102 @@ struct DrFlacImporterTest: TestSuite::Tester {
 
     void surround71Channel24();
 
+    void streaming();
+    void streamingSeek();
+    void streamingData();
+    void streamingFileNotFound();
+    void releaseData();
+
+    void threads();
+
+    void remixResample();
+    void remixUnsupported();
+    void remixResampleStreaming();
+
     void openTwice();
     void importTwice();
 
+    void threadsBenchmark();
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    BufferFormat format;
+    std::size_t frameSize;
+} StreamingData[]{
+    {"8-bit mono", "mono8.flac", BufferFormat::Mono8, 1},
+    {"8-bit stereo", "stereo8.flac", BufferFormat::Stereo8, 2},
+    {"16-bit mono", "mono16.flac", BufferFormat::Mono16, 2},
+    {"24-bit mono", "mono24.flac", BufferFormat::MonoFloat, 4},
+    {"zero samples", "zeroSamples.flac", BufferFormat::Mono16, 2},
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt threads;
+} ThreadsData[]{
+    /* Files without a seek table, or with a seek table pointing just to the
+       first frame, are decoded on a single thread */
+    {"quad, 4 threads", "quad16.flac", 4},
+    {"stereo, 3 threads", "stereo24.flac", 3},
+    /* Six channels don't divide the decoding chunk size */
+    {"5.1, 2 threads", "surround51Channel16.flac", 2},
+    {"7.1, all hardware threads", "surround71Channel24.flac", 0},
+    {"more threads than blocks", "mono8.flac", 4},
+    {"zero samples, 4 threads", "zeroSamples.flac", 4},
+    {"many frames, 2 threads", "manyFrames.flac", 2},
+    /* The seek points don't divide the stream evenly into five ranges */
+    {"many frames, 5 threads", "manyFrames.flac", 5},
+    {"many frames, more threads than seek points", "manyFrames.flac", 64},
+    {"many frames, all hardware threads", "manyFrames.flac", 0},
+};
+
+const Float RemixStereoToMonoData[]{
+    0.618377685546875f
+};
+
+const Float RemixMonoToStereoData[]{
+    0.125885009765625f, 0.125885009765625f,
+    -0.457489013671875f, -0.457489013671875f
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt outputChannelCount, outputFrequency;
+    BufferFormat format;
+    UnsignedInt frequency;
+    std::size_t size;
+    Containers::ArrayView<const Float> data;
+} RemixResampleData[]{
+    {"stereo to mono", "stereo16.flac", 1, 0,
+        BufferFormat::MonoFloat, 44100, 4, RemixStereoToMonoData},
+    {"mono to stereo", "mono16.flac", 2, 0,
+        BufferFormat::StereoFloat, 44000, 16, RemixMonoToStereoData},
+    {"5.1 to stereo", "surround51Channel16.flac", 2, 0,
+        BufferFormat::StereoFloat, 48000, 27157*2*4, {}},
+    {"48 kHz to 44.1 kHz", "mono24.flac", 0, 44100,
+        BufferFormat::MonoFloat, 44100, 849*4, {}},
+    {"5.1 to mono, 48 kHz to 44.1 kHz", "surround51Channel16.flac", 1, 44100,
+        BufferFormat::MonoFloat, 44100, 24951*4, {}},
+    {"same channel count and frequency", "stereo16.flac", 2, 44100,
+        BufferFormat::Stereo16, 44100, 4, {}},
+};
+
+const struct {
+    const char* name;
+    UnsignedInt threads;
+} ThreadsBenchmarkData[]{
+    {"1 thread", 1},
+    {"2 threads", 2},
+    {"all hardware threads", 0},
+};
+
 DrFlacImporterTest::DrFlacImporterTest() {
     addTests({&DrFlacImporterTest::empty,
 
@@ -89,11 +185,31 @@ DrFlacImporterTest::DrFlacImporterTest() {
               &DrFlacImporterTest::surround51Channel16,
               &DrFlacImporterTest::surround51Channel24,
 
-              &DrFlacImporterTest::surround71Channel24,
+              &DrFlacImporterTest::surround71Channel24});
+
+    addInstancedTests({&DrFlacImporterTest::streaming},
+        Containers::arraySize(StreamingData));
+
+    addTests({&DrFlacImporterTest::streamingSeek,
+              &DrFlacImporterTest::streamingData,
+              &DrFlacImporterTest::streamingFileNotFound,
+              &DrFlacImporterTest::releaseData});
+
+    addInstancedTests({&DrFlacImporterTest::threads},
+        Containers::arraySize(ThreadsData));
+
+    addInstancedTests({&DrFlacImporterTest::remixResample},
+        Containers::arraySize(RemixResampleData));
 
-              &DrFlacImporterTest::openTwice,
+    addTests({&DrFlacImporterTest::remixUnsupported,
+              &DrFlacImporterTest::remixResampleStreaming});
+
+    addTests({&DrFlacImporterTest::openTwice,
               &DrFlacImporterTest::importTwice});
 
+    addInstancedBenchmarks({&DrFlacImporterTest::threadsBenchmark}, 10,
+        Containers::arraySize(ThreadsBenchmarkData));
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef DRFLACAUDIOIMPORTER_PLUGIN_FILENAME
@@ -160,12 +276,9 @@ void DrFlacImporterTest::mono24() {
 
     Containers::Array<char> data = importer->data();
     CORRADE_COMPARE(data.size(), 3696);
-    #if defined(CORRADE_TARGET_ARM) && !defined(CORRADE_TARGET_APPLE)
-    CORRADE_EXPECT_FAIL("Gives a wrong result on ARM, but only on Linux and not on Mac.");
-    #endif
     CORRADE_COMPARE_AS(Containers::arrayCast<Float>(data).prefix(4),
         Containers::arrayView<Float>({
-            -0.000548482f, -3.45707e-06f, -0.00179672f, 0.000154614f
+            -0.000548482f, -0.00143778f, -0.00179672f, 0.000154614f
         }), TestSuite::Compare::Container);
 }
 
@@ -264,6 +377,208 @@ void DrFlacImporterTest::surround71Channel24() {
     CORRADE_COMPARE(importer->frequency(), 48000);
 }
 
+void DrFlacImporterTest::streaming() {
+    auto&& data = StreamingData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, data.filename)));
+    const UnsignedInt frequency = importer->frequency();
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Pointer<AbstractImporter> streamingImporter = _manager.instantiate("DrFlacAudioImporter");
+    streamingImporter->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(streamingImporter->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(streamingImporter->format(), data.format);
+    CORRADE_COMPARE(streamingImporter->frequency(), frequency);
+
+    /* Decoding everything in the streaming mode should give the same result
+       as in the non-streaming mode */
+    CORRADE_COMPARE_AS(streamingImporter->data(), expected,
+        TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_DRFLACAUDIOIMPORTER_BUILD_STATIC
+    DrFlacImporter& drFlacImporter = static_cast<DrFlacImporter&>(*streamingImporter);
+    CORRADE_COMPARE(drFlacImporter.frameOffset(), 0);
+
+    /* Decode in chunks of 100 frames, the last chunk is shorter */
+    const std::size_t frameSize = data.frameSize;
+    const UnsignedLong frameCount = drFlacImporter.frameCount();
+    Containers::Array<char> out{NoInit, 100*frameSize};
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = drFlacImporter.readFrames(out)); )
+        arrayAppend(actual, out.prefix(read*frameSize));
+    CORRADE_COMPARE(drFlacImporter.frameOffset(), frameCount);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+    #endif
+}
+
+void DrFlacImporterTest::streamingSeek() {
+    #ifndef MAGNUM_DRFLACAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "mono8.flac")));
+    Containers::Array<char> expected = importer->data();
+
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "mono8.flac")));
+    DrFlacImporter& drFlacImporter = static_cast<DrFlacImporter&>(*importer);
+    CORRADE_COMPARE(drFlacImporter.frameCount(), 2136);
+
+    char out[200];
+    CORRADE_VERIFY(drFlacImporter.seek(1068));
+    CORRADE_COMPARE(drFlacImporter.frameOffset(), 1068);
+    CORRADE_COMPARE(drFlacImporter.readFrames(out), 200);
+    CORRADE_COMPARE(drFlacImporter.frameOffset(), 1268);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(1068, 200),
+        TestSuite::Compare::Container);
+
+    /* Seeking back */
+    CORRADE_VERIFY(drFlacImporter.seek(10));
+    CORRADE_COMPARE(drFlacImporter.readFrames(out), 200);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(10, 200),
+        TestSuite::Compare::Container);
+
+    /* Calling data() doesn't affect the read position */
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drFlacImporter.frameOffset(), 210);
+
+    /* Reading at the end gives back a partial chunk and then nothing */
+    CORRADE_VERIFY(drFlacImporter.seek(2036));
+    CORRADE_COMPARE(drFlacImporter.readFrames(out), 100);
+    CORRADE_COMPARE_AS(Containers::arrayView(out).prefix(100),
+        expected.exceptPrefix(2036),
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drFlacImporter.readFrames(out), 0);
+
+    /* Seeking to the end is fine, past it not */
+    CORRADE_VERIFY(drFlacImporter.seek(2136));
+    CORRADE_COMPARE(drFlacImporter.readFrames(out), 0);
+
+    Containers::String outError;
+    Error redirectError{&outError};
+    CORRADE_VERIFY(!drFlacImporter.seek(2137));
+    CORRADE_COMPARE(outError, "Audio::DrFlacImporter::seek(): frame 2137 out of range for 2136 frames\n");
+    #endif
+}
+
+void DrFlacImporterTest::streamingData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "stereo8.flac")));
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "stereo8.flac"));
+    CORRADE_VERIFY(data);
+
+    /* Unlike with openFile(), the decoder operates on a copy of the data, so
+       it should work even after the original memory is gone */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openData(*data));
+    *data = Containers::Array<char>{};
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void DrFlacImporterTest::streamingFileNotFound() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    importer->configuration().setValue("streaming", true);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile("nonexistent.flac"));
+    CORRADE_COMPARE(out, "Audio::DrFlacImporter::openFile(): cannot open file nonexistent.flac\n");
+}
+
+void DrFlacImporterTest::releaseData() {
+    #ifndef MAGNUM_DRFLACAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("DrFlacImporter::releaseData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "mono16.flac")));
+    Containers::Array<char> expected = importer->data();
+
+    /* The released data should be the same as the copy and the file gets
+       closed */
+    DrFlacImporter& drFlacImporter = static_cast<DrFlacImporter&>(*importer);
+    CORRADE_COMPARE_AS(drFlacImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+
+    /* In the streaming mode it decodes everything */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "mono16.flac")));
+    CORRADE_COMPARE_AS(drFlacImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+    #endif
+}
+
+void DrFlacImporterTest::threads() {
+    auto&& data = ThreadsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, data.filename)));
+    const BufferFormat format = importer->format();
+    Containers::Array<char> expected = importer->data();
+
+    /* Decoding in parallel should give the same result as single-threaded */
+    Containers::Pointer<AbstractImporter> threadedImporter = _manager.instantiate("DrFlacAudioImporter");
+    threadedImporter->configuration().setValue("threads", data.threads);
+    CORRADE_VERIFY(threadedImporter->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(threadedImporter->format(), format);
+    CORRADE_COMPARE_AS(threadedImporter->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void DrFlacImporterTest::remixResample() {
+    auto&& data = RemixResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    importer->configuration().setValue("outputChannelCount", data.outputChannelCount);
+    importer->configuration().setValue("outputFrequency", data.outputFrequency);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, data.filename)));
+
+    CORRADE_COMPARE(importer->format(), data.format);
+    CORRADE_COMPARE(importer->frequency(), data.frequency);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), data.size);
+    if(!data.data.isEmpty())
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out), data.data,
+            TestSuite::Compare::Container);
+}
+
+void DrFlacImporterTest::remixUnsupported() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    importer->configuration().setValue("outputChannelCount", 6);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "quad16.flac")));
+    CORRADE_COMPARE(out, "Audio::DrFlacImporter::openData(): can't remix 4 channels to 6\n");
+}
+
+void DrFlacImporterTest::remixResampleStreaming() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    importer->configuration().setValue("streaming", true);
+    importer->configuration().setValue("outputFrequency", 22050);
+
+    /* The options are ignored, the file is imported as-is */
+    Containers::String out;
+    Warning redirectWarning{&out};
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "mono16.flac")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Mono16);
+    CORRADE_COMPARE(importer->frequency(), 44000);
+    CORRADE_COMPARE(out, "Audio::DrFlacImporter::openFile(): outputFrequency and outputChannelCount options are ignored in the streaming mode\n");
+}
+
 void DrFlacImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
 
@@ -298,6 +613,25 @@ void DrFlacImporterTest::importTwice() {
     }
 }
 
+void DrFlacImporterTest::threadsBenchmark() {
+    auto&& data = ThreadsBenchmarkData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrFlacAudioImporter");
+    importer->configuration().setValue("threads", data.threads);
+
+    /* A file with 128 frames and a seek point every four of them, so it can
+       be split across threads. Reading the file is done outside of the
+       benchmark so only the decoding is measured. */
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(DRFLACAUDIOIMPORTER_TEST_DIR, "manyFrames.flac"));
+    CORRADE_VERIFY(file);
+
+    CORRADE_BENCHMARK(5)
+        importer->openData(*file);
+
+    CORRADE_VERIFY(importer->isOpened());
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Audio::Test::DrFlacImporterTest)
@@ -27,3 +27,4 @@
 
 #cmakedefine DRFLACAUDIOIMPORTER_PLUGIN_FILENAME "${DRFLACAUDIOIMPORTER_PLUGIN_FILENAME}"
 #define DRFLACAUDIOIMPORTER_TEST_DIR "${DRFLACAUDIOIMPORTER_TEST_DIR}"
+#cmakedefine MAGNUM_DRFLACAUDIOIMPORTER_BUILD_STATIC
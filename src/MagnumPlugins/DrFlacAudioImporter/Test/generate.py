@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+
+#
+#   This file is part of Magnum.
+#
+#   Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+#               2020, 2021, 2022, 2023, 2024, 2025
+#             Vladimír Vondruš <mosra@centrum.cz>
+#
+#   Permission is hereby granted, free of charge, to any person obtaining a
+#   copy of this software and associated documentation files (the "Software"),
+#   to deal in the Software without restriction, including without limitation
+#   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+#   and/or sell copies of the Software, and to permit persons to whom the
+#   Software is furnished to do so, subject to the following conditions:
+#
+#   The above copyright notice and this permission notice shall be included
+#   in all copies or substantial portions of the Software.
+#
+#   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+#   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+#   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+#   DEALINGS IN THE SOFTWARE.
+#
+# There's no FLAC encoder that would allow to make files with many small
+# frames and a dense SEEKTABLE easily, so this writes one directly. Produces a
+# mono 16-bit 44.1 kHz file with a low-amplitude sine, encoded as FIXED
+# order-2 subframes with Rice-coded residuals, and a seek point every four
+# frames. Usage:
+#
+#   ./generate.py manyFrames.flac
+
+import hashlib
+import math
+import struct
+import sys
+
+fileOut = sys.argv[1]
+
+FrameCount = 128
+BlockSize = 1024
+SampleRate = 44100
+SeekPointEvery = 4
+
+samples = [int(round(1000.0*math.sin(2.0*math.pi*110.0*i/SampleRate)))
+    for i in range(FrameCount*BlockSize)]
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for i in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xff if crc & 0x80 else (crc << 1) & 0xff
+    return crc
+
+def crc16(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for i in range(8):
+            crc = ((crc << 1) ^ 0x8005) & 0xffff if crc & 0x8000 else (crc << 1) & 0xffff
+    return crc
+
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def write(self, value, count):
+        for i in reversed(range(count)):
+            self.bits += [(value >> i) & 1]
+
+    def writeSigned(self, value, count):
+        self.write(value & ((1 << count) - 1), count)
+
+    def bytes(self):
+        bits = self.bits + [0]*(-len(self.bits) % 8)
+        return bytes(int(''.join(map(str, bits[i:i + 8])), 2)
+            for i in range(0, len(bits), 8))
+
+def riceSize(residuals, k):
+    return sum((((r << 1) ^ (r >> 63)) >> k) + 1 + k for r in residuals)
+
+def frame(index):
+    block = samples[index*BlockSize:(index + 1)*BlockSize]
+
+    # Frame header. Fixed-blocksize stream, 1024-sample blocks, 44.1 kHz,
+    # mono, 16 bits per sample, frame number below 128 so it fits into a
+    # single UTF-8 byte
+    assert index < 0x80
+    header = bytes([0xff, 0xf8, 0b1010_1001, 0b0000_1000, index])
+    header += bytes([crc8(header)])
+
+    # FIXED order-2 subframe: two verbatim warm-up samples followed by
+    # residuals of the second-order difference
+    residuals = [block[i] - 2*block[i - 1] + block[i - 2]
+        for i in range(2, len(block))]
+    k = min(range(15), key=lambda k: riceSize(residuals, k))
+
+    bits = BitWriter()
+    bits.write(0b0_001010_0, 8)
+    bits.writeSigned(block[0], 16)
+    bits.writeSigned(block[1], 16)
+    # Rice coding with a 4-bit parameter, partition order 0
+    bits.write(0b00, 2)
+    bits.write(0, 4)
+    bits.write(k, 4)
+    for r in residuals:
+        u = (r << 1) ^ (r >> 63)
+        bits.write(1, (u >> k) + 1)
+        bits.write(u & ((1 << k) - 1), k)
+
+    data = header + bits.bytes()
+    return data + struct.pack('>H', crc16(data))
+
+frames = [frame(i) for i in range(FrameCount)]
+
+seekPoints = bytearray()
+offset = 0
+for i in range(FrameCount):
+    if i % SeekPointEvery == 0:
+        seekPoints += struct.pack('>QQH', i*BlockSize, offset, BlockSize)
+    offset += len(frames[i])
+
+md5 = hashlib.md5(b''.join(struct.pack('<h', s) for s in samples)).digest()
+
+streamInfo = struct.pack('>HH', BlockSize, BlockSize)
+streamInfo += struct.pack('>I', min(map(len, frames)))[1:]
+streamInfo += struct.pack('>I', max(map(len, frames)))[1:]
+# 20 bits sample rate, 3 bits channel count - 1, 5 bits bits per sample - 1,
+# 36 bits total sample count
+streamInfo += struct.pack('>Q', (SampleRate << 44)|(0 << 41)|(15 << 36)|len(samples))
+streamInfo += md5
+
+print("Writing", fileOut)
+
+with open(fileOut, 'wb') as output:
+    output.write(b'fLaC')
+    output.write(struct.pack('>I', (0 << 24)|len(streamInfo)))
+    output.write(streamInfo)
+    output.write(struct.pack('>I', (1 << 31)|(3 << 24)|len(seekPoints)))
+    output.write(seekPoints)
+    for f in frames:
+        output.write(f)
@@ -27,67 +27,404 @@
 
 #include "DrMp3Importer.h"
 
+#include <cstring>
+#include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Endianness.h>
 
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Packing.h>
 
+#include "Magnum/Implementation/audioFileStream.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
+
 #define DR_MP3_IMPLEMENTATION
 #include "dr_mp3.h"
 
 namespace Magnum { namespace Audio {
 
+namespace {
+
+drmp3_bool32 seekFile(void* const userData, const int offset, const drmp3_seek_origin origin) {
+    return Implementation::seekAudioFile(userData, offset, origin == drmp3_seek_origin_current);
+}
+
+/* Frame count that gets calculated on first use */
+constexpr UnsignedLong UnknownFrameCount = ~UnsignedLong{};
+
+/* Size of an ID3v2 tag at the start of the data, 0 if there's none */
+std::size_t id3v2TagSize(const Containers::ArrayView<const char> data) {
+    if(data.size() < 10 || data[0] != 'I' || data[1] != 'D' || data[2] != '3')
+        return 0;
+
+    /* The size is stored in four bytes with seven bits each and doesn't
+       include the header or the optional footer */
+    return 10 + (data[5] & 0x10 ? 10 : 0) +
+        (std::size_t(data[6] & 0x7f) << 21 |
+         std::size_t(data[7] & 0x7f) << 14 |
+         std::size_t(data[8] & 0x7f) << 7 |
+         std::size_t(data[9] & 0x7f));
+}
+
+UnsignedInt bigEndianUnsignedInt(const char* const data) {
+    UnsignedInt value;
+    std::memcpy(&value, data, sizeof(UnsignedInt));
+    return Utility::Endianness::bigEndian(value);
+}
+
+/* MP3 files don't store the total frame count, but encoders usually put the
+   count of MP3 frames into a Xing, Info or VBRI header in the first frame.
+   Returns UnknownFrameCount if there's no such header. */
+UnsignedLong headerFrameCount(const Containers::ArrayView<const char> frame) {
+    if(frame.size() < 4)
+        return UnknownFrameCount;
+
+    /* Frame sync, MPEG version 1, 2 or 2.5 and layer I, II or III */
+    const UnsignedByte* const header = reinterpret_cast<const UnsignedByte*>(frame.data());
+    const UnsignedInt version = (header[1] >> 3) & 0x03;
+    const UnsignedInt layer = (header[1] >> 1) & 0x03;
+    if(header[0] != 0xff || (header[1] & 0xe0) != 0xe0 || version == 1 || layer == 0)
+        return UnknownFrameCount;
+    const bool mpeg1 = version == 3;
+    const UnsignedInt samplesPerFrame =
+        layer == 3 ? 384 : layer == 2 || mpeg1 ? 1152 : 576;
+
+    /* Xing and Info headers follow the optional CRC and side information,
+       whose size depends on the MPEG version and channel count. VBRI
+       headers are always 32 bytes after the frame header. */
+    const bool mono = (header[3] >> 6) == 3;
+    const std::size_t xingOffset = 4 + (header[1] & 0x01 ? 0 : 2) +
+        (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+    UnsignedLong count;
+    if(frame.size() >= xingOffset + 12 &&
+       (std::memcmp(frame.data() + xingOffset, "Xing", 4) == 0 ||
+        std::memcmp(frame.data() + xingOffset, "Info", 4) == 0) &&
+       (bigEndianUnsignedInt(frame.data() + xingOffset + 4) & 0x01))
+        count = bigEndianUnsignedInt(frame.data() + xingOffset + 8);
+    else if(frame.size() >= 36 + 18 &&
+       std::memcmp(frame.data() + 36, "VBRI", 4) == 0)
+        count = bigEndianUnsignedInt(frame.data() + 36 + 14);
+    else return UnknownFrameCount;
+
+    /* The count doesn't include the frame with the header, which dr_mp3
+       decodes as well, as silence */
+    return (count + 1)*samplesPerFrame;
+}
+
+/* Reads the first MP3 frame from the file to get the frame count and seeks
+   back to the start */
+UnsignedLong fileHeaderFrameCount(std::FILE* const file) {
+    char data[64];
+    const std::size_t tagSize = id3v2TagSize({data, std::fread(data, 1, 10, file)});
+    UnsignedLong count = UnknownFrameCount;
+    if(std::fseek(file, long(tagSize), SEEK_SET) == 0)
+        count = headerFrameCount({data, std::fread(data, 1, sizeof(data), file)});
+    std::fseek(file, 0, SEEK_SET);
+    return count;
+}
+
+}
+
+struct DrMp3Importer::Stream {
+    /* Decoding from a copy of the data passed to openData() */
+    explicit Stream(const Containers::ArrayView<const char> input): data{NoInit, input.size()} {
+        Utility::copy(input, data);
+    }
+
+    /* Decoding from a file passed to openFile(), takes ownership of it */
+    explicit Stream(std::FILE* const file): file{file} {}
+
+    ~Stream() {
+        if(initialized) drmp3_uninit(&decoder);
+        if(file) std::fclose(file);
+    }
+
+    Containers::Array<char> data;
+    std::FILE* file{};
+    /* Contains pointers to itself, so it can't be moved */
+    drmp3 decoder;
+    bool initialized = false;
+
+    /* dr_mp3 gives back different results when reading in chunks that
+       aren't whole MP3 frames, so the decoding is always done in chunks of
+       1152 frames, aligned to 1152 frames from the start, and readFrames()
+       copies from there */
+    Short buffer[1152*2];
+    std::size_t bufferFrameOffset = 0;
+    std::size_t bufferFrameCount = 0;
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 DrMp3Importer::DrMp3Importer() = default; /* LCOV_EXCL_LINE */
 #endif
 
 DrMp3Importer::DrMp3Importer(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
+DrMp3Importer::~DrMp3Importer() = default;
+
 ImporterFeatures DrMp3Importer::doFeatures() const { return ImporterFeature::OpenData; }
 
-bool DrMp3Importer::doIsOpened() const { return !!_data; }
+bool DrMp3Importer::doIsOpened() const { return _data || _stream; }
 
 void DrMp3Importer::doOpenData(Containers::ArrayView<const char> data) {
-    drmp3_config config{};
-    drmp3_uint64 frameCount;
-    drmp3_int16* const decodedPointer = drmp3_open_memory_and_read_s16(data.data(), data.size(), &config, &frameCount);
-    if(!decodedPointer) {
+    /* In the streaming mode the decoder stays open after this function exits,
+       so it has to operate on a copy of the data */
+    if(configuration().value<bool>("streaming")) {
+        openStream(Containers::Pointer<Stream>{InPlaceInit, data}, "Audio::DrMp3Importer::openData():");
+        return;
+    }
+
+    drmp3 decoder;
+    if(!drmp3_init_memory(&decoder, data.data(), data.size(), nullptr)) {
         Error() << "Audio::DrMp3Importer::openData(): failed to open and decode MP3 data";
         return;
     }
+    Containers::ScopeGuard decoderUninit{&decoder, drmp3_uninit};
 
     /* Even though I think there are multi-channel MP3s, dr_mp3 implements just
        mono and stereo: https://github.com/mackron/dr_libs/blob/9891b6354904c87136b5b89d867a6dcc63d21afa/dr_mp3.h#L2828-L2831 */
-    if(config.outputChannels == 1)
+    if(decoder.channels == 1)
         _format = BufferFormat::Mono16;
-    else if(config.outputChannels == 2)
+    else if(decoder.channels == 2)
         _format = BufferFormat::Stereo16;
     else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
 
-    _frequency = config.outputSampleRate;
+    UnsignedInt outputFrequency = configuration().value<UnsignedInt>("outputFrequency");
+    UnsignedInt outputChannelCount = configuration().value<UnsignedInt>("outputChannelCount");
+    if(!outputFrequency) outputFrequency = decoder.sampleRate;
+    if(!outputChannelCount) outputChannelCount = decoder.channels;
+    if(!Implementation::canRemixAudio(decoder.channels, outputChannelCount)) {
+        Error{} << "Audio::DrMp3Importer::openData(): can't remix" << decoder.channels << "channels to" << outputChannelCount;
+        return;
+    }
+
+    _frequency = decoder.sampleRate;
+    _channelCount = decoder.channels;
+    _sampleSize = sizeof(Short);
+    /* The decoder is positioned back at the start after this */
+    _frameCount = drmp3_get_pcm_frame_count(&decoder);
+    _frameOffset = 0;
+
+    /* Decode directly into an output of an exact size instead of letting
+       drmp3_open_memory_and_read_s16() grow a buffer through a temporary and
+       then copying it in doData(). The output depends on how the frames are
+       split into drmp3_read_pcm_frames_s16() calls, so it's done in the same
+       chunks that function uses. If decoding fails midway, the rest stays
+       zero-filled. */
+    Containers::Array<char> out{ValueInit, std::size_t(_frameCount*_channelCount*sizeof(Short))};
+    const Containers::ArrayView<Short> samples = Containers::arrayCast<Short>(out);
+    const std::size_t chunkFrameCount = 4096/_channelCount;
+    for(std::size_t offset = 0; offset != _frameCount; ) {
+        const std::size_t read = drmp3_read_pcm_frames_s16(&decoder, Math::min(std::size_t(_frameCount - offset), chunkFrameCount), samples.data() + offset*_channelCount);
+        if(!read) break;
+        offset += read;
+    }
 
-    Containers::Array<char> decodedData{reinterpret_cast<char*>(decodedPointer), std::size_t(frameCount*sizeof(Short)*config.outputChannels), [](char* data, std::size_t) {
-        drmp3_free(data);
-    }};
+    /* Remix and resample the decoded data if requested, the output is
+       floats then */
+    if(outputChannelCount != _channelCount || outputFrequency != _frequency) {
+        out = Implementation::remixResampleAudio(out,
+            Implementation::AudioSampleType::Short, _channelCount, _frequency,
+            outputChannelCount, outputFrequency);
+        _format = outputChannelCount == 1 ? BufferFormat::MonoFloat : BufferFormat::StereoFloat;
+        _frequency = outputFrequency;
+        _channelCount = outputChannelCount;
+        _sampleSize = sizeof(Float);
+        _frameCount = out.size()/(outputChannelCount*sizeof(Float));
+    }
 
     /* All good, save the data */
-    _data = Utility::move(decodedData);
+    _data = Utility::move(out);
+}
+
+void DrMp3Importer::doOpenFile(const Containers::StringView filename) {
+    /* Without streaming everything is decoded upfront, so read the whole file
+       to memory */
+    if(!configuration().value<bool>("streaming"))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* Otherwise keep the file open and let the decoder read from it only
+       what it needs, instead of having a copy of the whole file in memory */
+    std::FILE* const file = Implementation::openAudioFile(filename);
+    if(!file) {
+        Error{} << "Audio::DrMp3Importer::openFile(): cannot open file" << filename;
+        return;
+    }
+
+    openStream(Containers::Pointer<Stream>{InPlaceInit, file}, "Audio::DrMp3Importer::openFile():");
+}
+
+void DrMp3Importer::openStream(Containers::Pointer<Stream>&& stream, const char* const prefix) {
+    /* Remixing and resampling is done on the whole decoded data, so it's
+       ignored in the streaming mode */
+    if(configuration().value<UnsignedInt>("outputFrequency") || configuration().value<UnsignedInt>("outputChannelCount"))
+        Warning{} << prefix << "outputFrequency and outputChannelCount options are ignored in the streaming mode";
+
+    if(!(stream->file ?
+        drmp3_init(&stream->decoder, Implementation::readAudioFile, seekFile, stream->file, nullptr) :
+        drmp3_init_memory(&stream->decoder, stream->data.data(), stream->data.size(), nullptr)))
+    {
+        Error() << prefix << "failed to open and decode MP3 data";
+        return;
+    }
+    stream->initialized = true;
+
+    /* Same as in doOpenData() */
+    if(stream->decoder.channels == 1)
+        _format = BufferFormat::Mono16;
+    else if(stream->decoder.channels == 2)
+        _format = BufferFormat::Stereo16;
+    else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+
+    _frequency = stream->decoder.sampleRate;
+    _channelCount = stream->decoder.channels;
+    _sampleSize = sizeof(Short);
+    /* Take the frame count from the header if there's any. Otherwise it's
+       calculated only once actually needed, as that means going through the
+       whole file. */
+    _frameCount = stream->file ?
+        fileHeaderFrameCount(stream->file) :
+        headerFrameCount(stream->data.exceptPrefix(Math::min(id3v2TagSize(stream->data), stream->data.size())));
+    _frameOffset = 0;
+    _stream = Utility::move(stream);
 }
 
-void DrMp3Importer::doClose() { _data = Containers::NullOpt; }
+void DrMp3Importer::doClose() {
+    _data = Containers::NullOpt;
+    _stream = nullptr;
+}
 
 BufferFormat DrMp3Importer::doFormat() const { return _format; }
 
 UnsignedInt DrMp3Importer::doFrequency() const { return _frequency; }
 
 Containers::Array<char> DrMp3Importer::doData() {
+    /* In the streaming mode decode everything from the start and then go
+       back to where the stream was */
+    if(_stream) {
+        const UnsignedLong frameOffset = _frameOffset;
+        Containers::Array<char> out{ValueInit, std::size_t(frameCount()*_channelCount*_sampleSize)};
+        if(!seek(0)) return {};
+        readFrames(out);
+        seek(frameOffset);
+        return out;
+    }
+
     Containers::Array<char> copy{NoInit, _data->size()};
     Utility::copy(*_data, copy);
     return copy;
 }
 
+Containers::Array<char> DrMp3Importer::releaseData() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrMp3Importer::releaseData(): no file opened", {});
+
+    /* In the streaming mode there's nothing to release, decode everything */
+    Containers::Array<char> out = _stream ? doData() : *Utility::move(_data);
+    close();
+    return out;
+}
+
+UnsignedLong DrMp3Importer::frameCount() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrMp3Importer::frameCount(): no file opened", {});
+
+    /* The decoder is put back to the frame it was at after this, so the
+       decoded chunk in the buffer stays valid */
+    if(_frameCount == UnknownFrameCount)
+        _frameCount = drmp3_get_pcm_frame_count(&_stream->decoder);
+    return _frameCount;
+}
+
+UnsignedLong DrMp3Importer::frameOffset() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrMp3Importer::frameOffset(): no file opened", {});
+    return _frameOffset;
+}
+
+std::size_t DrMp3Importer::readFrames(const Containers::ArrayView<char> data) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrMp3Importer::readFrames(): no file opened", {});
+    const std::size_t frameSize = _channelCount*_sampleSize;
+    CORRADE_ASSERT(data.size() % frameSize == 0,
+        "Audio::DrMp3Importer::readFrames(): expected size to be a multiple of" << frameSize << "bytes but got" << data.size(), {});
+
+    /* If the frame count isn't known yet, decode until the end of the
+       file */
+    const std::size_t frameCount = _frameCount == UnknownFrameCount ?
+        data.size()/frameSize :
+        Math::min(UnsignedLong(data.size()/frameSize), _frameCount - _frameOffset);
+
+    /* Non-streaming mode, copy the already decoded data */
+    if(!_stream) {
+        Utility::copy(_data->sliceSize(_frameOffset*frameSize, frameCount*frameSize),
+            data.prefix(frameCount*frameSize));
+        _frameOffset += frameCount;
+        return frameCount;
+    }
+
+    std::size_t decodedFrameCount = 0;
+    while(decodedFrameCount != frameCount) {
+        /* Decode next MP3 frame if the previous one was consumed */
+        if(_stream->bufferFrameOffset == _stream->bufferFrameCount) {
+            _stream->bufferFrameCount = drmp3_read_pcm_frames_s16(&_stream->decoder, Containers::arraySize(_stream->buffer)/2, _stream->buffer);
+            _stream->bufferFrameOffset = 0;
+            /* If the frame count wasn't known, it is now */
+            if(!_stream->bufferFrameCount) {
+                _frameCount = _frameOffset + decodedFrameCount;
+                break;
+            }
+        }
+
+        const std::size_t count = Math::min(frameCount - decodedFrameCount, _stream->bufferFrameCount - _stream->bufferFrameOffset);
+        Utility::copy(
+            Containers::arrayCast<const char>(Containers::arrayView(_stream->buffer).sliceSize(_stream->bufferFrameOffset*_channelCount, count*_channelCount)),
+            data.sliceSize(decodedFrameCount*frameSize, count*frameSize));
+        _stream->bufferFrameOffset += count;
+        decodedFrameCount += count;
+    }
+
+    _frameOffset += decodedFrameCount;
+    return decodedFrameCount;
+}
+
+bool DrMp3Importer::seek(const UnsignedLong frame) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrMp3Importer::seek(): no file opened", {});
+    if(_frameCount != UnknownFrameCount && frame > _frameCount) {
+        Error{} << "Audio::DrMp3Importer::seek(): frame" << frame << "out of range for" << _frameCount << "frames";
+        return false;
+    }
+
+    /* Seek to the start of the aligned chunk containing the frame, decode
+       it and skip what's before */
+    if(_stream) {
+        const std::size_t chunkFrameCount = Containers::arraySize(_stream->buffer)/2;
+        const UnsignedLong chunkFrame = frame - frame % chunkFrameCount;
+        if(!drmp3_seek_to_pcm_frame(&_stream->decoder, chunkFrame)) {
+            Error{} << "Audio::DrMp3Importer::seek(): seek to frame" << frame << "failed";
+            return false;
+        }
+
+        _stream->bufferFrameCount = drmp3_read_pcm_frames_s16(&_stream->decoder, chunkFrameCount, _stream->buffer);
+
+        /* If the frame count isn't known yet, a seek past the end is
+           detected only here, and the count is known after */
+        if(frame - chunkFrame > _stream->bufferFrameCount) {
+            _frameCount = chunkFrame + _stream->bufferFrameCount;
+            Error{} << "Audio::DrMp3Importer::seek(): frame" << frame << "out of range for" << _frameCount << "frames";
+            return false;
+        }
+        _stream->bufferFrameOffset = frame - chunkFrame;
+    }
+
+    _frameOffset = frame;
+    return true;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(DrMp3AudioImporter, Magnum::Audio::DrMp3Importer,
@@ -34,6 +34,7 @@
 
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "MagnumPlugins/DrMp3AudioImporter/configure.h"
@@ -124,6 +125,68 @@ information.
 
 The files are imported as @ref BufferFormat::Mono16 or
 @ref BufferFormat::Stereo16.
+
+@subsection Audio-DrMp3Importer-behavior-streaming Streaming decode
+
+By default the whole file is decoded in @ref openData() and @ref data()
+returns a copy of it. Enabling the @cb{.ini} streaming @ce
+@ref Audio-DrMp3Importer-configuration "configuration option" makes
+@ref openData() and @ref openFile() parse just the header and keep the decoder
+open instead. With @ref openFile() the data are read from the file only as the
+decoder needs them, with @ref openData() the decoder operates on a copy of the
+data passed to it. Frames are then decoded in chunks of arbitrary size
+with @ref readFrames() into a buffer supplied by the caller and @ref seek()
+can be used to jump to an arbitrary frame. The output format is the same as
+with @ref data(). Calling @ref data() in streaming mode decodes the whole file
+without affecting the read position.
+
+MP3 files don't contain the total frame count. In the streaming mode it's
+taken from a Xing, Info or VBRI header if the file has one, otherwise it's
+calculated by going through the whole file, but only once @ref frameCount()
+or @ref data() is called, or the end of the file is reached by
+@ref readFrames() or @ref seek(). MP3 files also don't have any
+seek index, so @ref seek() decodes the file from the current position or, when
+seeking backwards, from the beginning.
+
+The @ref readFrames(), @ref seek(), @ref frameOffset() and @ref frameCount()
+APIs work in the non-streaming mode as well, operating on the already decoded
+data. Because they're not a part of the @ref AbstractImporter interface, you
+need to link to the plugin directly and cast the importer instance to
+@ref DrMp3Importer in order to call them.
+
+@subsection Audio-DrMp3Importer-behavior-remix Remixing and resampling
+
+Setting the @cb{.ini} outputFrequency @ce and @cb{.ini} outputChannelCount @ce
+@ref Audio-DrMp3Importer-configuration "configuration options" to a non-zero
+value converts the decoded data to given frequency and channel count in
+@ref openData(), which is useful for example when the files come in a mixture
+of sample rates but the output device expects just one. The conversion uses a
+windowed sinc filter and mono files can be remixed to stereo and vice versa,
+converting to a different channel count fails to import. If the data get
+converted, they're imported as @ref BufferFormat::MonoFloat or
+@ref BufferFormat::StereoFloat and @ref frequency() and @ref frameCount()
+report the converted values. The options have no effect in the streaming mode,
+where a warning is printed instead.
+
+@subsection Audio-DrMp3Importer-behavior-release Taking over the decoded data
+
+As the @ref AbstractImporter interface allows @ref data() to be called
+repeatedly, it always returns a copy of the decoded data. If the data are
+needed just once, for example to be uploaded to an audio buffer,
+@ref releaseData() hands over the internal buffer without copying and closes
+the file, avoiding a temporary that's as large as the whole decoded file.
+Same as with the streaming APIs, you need to link to the plugin directly in
+order to call it.
+
+@section Audio-DrMp3Importer-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration().
+See below for all options and their default values:
+
+@snippet MagnumPlugins/DrMp3AudioImporter/DrMp3Importer.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_DRMP3AUDIOIMPORTER_EXPORT DrMp3Importer: public AbstractImporter {
     public:
@@ -140,10 +203,69 @@ class MAGNUM_DRMP3AUDIOIMPORTER_EXPORT DrMp3Importer: public AbstractImporter {
         /** @brief Plugin manager constructor */
         explicit DrMp3Importer(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        ~DrMp3Importer();
+
+        /**
+         * @brief Frame count
+         *
+         * Count of frames in the file, i.e. count of samples for each
+         * channel. Expects that a file is opened. In the streaming mode, if
+         * the file doesn't have a header containing the frame count, the
+         * first call scans the whole file. See
+         * @ref Audio-DrMp3Importer-behavior-streaming for more information.
+         */
+        UnsignedLong frameCount();
+
+        /**
+         * @brief Read position in frames
+         *
+         * Index of the frame that will be decoded by the next
+         * @ref readFrames() call. Is @cpp 0 @ce right after opening a file,
+         * is equal to @ref frameCount() once everything is read. Expects that
+         * a file is opened.
+         */
+        UnsignedLong frameOffset() const;
+
+        /**
+         * @brief Decode next frames
+         *
+         * Decodes as many frames as fit into @p data, or less if the end of
+         * the file is reached, in the same @ref format() as @ref data()
+         * returns, and advances @ref frameOffset() by the count of decoded
+         * frames. Returns the count of decoded frames, @cpp 0 @ce at the end
+         * of the file. Expects that a file is opened and that size of
+         * @p data is a multiple of the frame size.
+         */
+        std::size_t readFrames(Containers::ArrayView<char> data);
+
+        /**
+         * @brief Seek to a frame
+         *
+         * Sets @ref frameOffset() to @p frame. If @p frame is larger than
+         * @ref frameCount() or seeking fails, prints a message to
+         * @relativeref{Magnum,Error}, returns @cpp false @ce and the read
+         * position is unspecified. Expects that a file is opened.
+         */
+        bool seek(UnsignedLong frame);
+
+        /**
+         * @brief Release the decoded data
+         *
+         * Unlike @ref data(), which returns a copy, gives up ownership of the
+         * decoded data and closes the file. In the streaming mode the whole
+         * file is decoded first, same as with @ref data(). Expects that a file
+         * is opened.
+         */
+        Containers::Array<char> releaseData();
+
     private:
+        struct Stream;
+
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL void doOpenData(Containers::ArrayView<const char> data) override;
+        MAGNUM_DRMP3AUDIOIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        MAGNUM_DRMP3AUDIOIMPORTER_LOCAL void openStream(Containers::Pointer<Stream>&& stream, const char* prefix);
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL void doClose() override;
 
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL BufferFormat doFormat() const override;
@@ -151,8 +273,13 @@ class MAGNUM_DRMP3AUDIOIMPORTER_EXPORT DrMp3Importer: public AbstractImporter {
         MAGNUM_DRMP3AUDIOIMPORTER_LOCAL Containers::Array<char> doData() override;
 
         Containers::Optional<Containers::Array<char>> _data;
+        Containers::Pointer<Stream> _stream;
         BufferFormat _format;
         UnsignedInt _frequency;
+        UnsignedInt _channelCount;
+        UnsignedInt _sampleSize;
+        UnsignedLong _frameCount;
+        UnsignedLong _frameOffset;
 };
 
 }}
@@ -27,16 +27,23 @@
 
 #include <string> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringStl.h> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "configure.h"
 
+#ifdef MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
+#include "MagnumPlugins/DrMp3AudioImporter/DrMp3Importer.h"
+#endif
+
 namespace Magnum { namespace Audio { namespace Test { namespace {
 
 struct DrMp3ImporterTest: TestSuite::Tester {
@@ -49,6 +56,17 @@ struct DrMp3ImporterTest: TestSuite::Tester {
     void mono16();
     void stereo16();
 
+    void streaming();
+    void streamingSeek();
+    void streamingNoFrameCountHeader();
+    void streamingData();
+    void streamingFileNotFound();
+    void releaseData();
+
+    void remixResample();
+    void remixUnsupported();
+    void remixResampleStreaming();
+
     void openTwice();
     void importTwice();
 
@@ -56,13 +74,57 @@ struct DrMp3ImporterTest: TestSuite::Tester {
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    BufferFormat format;
+    std::size_t frameSize;
+} StreamingData[]{
+    {"mono", "mono16.mp3", BufferFormat::Mono16, 2},
+    {"stereo", "stereo16.mp3", BufferFormat::Stereo16, 4},
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt outputChannelCount, outputFrequency;
+    BufferFormat format;
+    UnsignedInt frequency;
+    std::size_t size;
+    Containers::ArrayView<const Float> data;
+} RemixResampleData[]{
+    {"mono to stereo", "mono16.mp3", 2, 0,
+        BufferFormat::StereoFloat, 44100, 6912*2*4, {}},
+    {"stereo to mono", "stereo16.mp3", 1, 0,
+        BufferFormat::MonoFloat, 44100, 6912*4, {}},
+    {"44.1 kHz to 48 kHz", "mono16.mp3", 0, 48000,
+        BufferFormat::MonoFloat, 48000, 7524*4, {}},
+    {"same channel count and frequency", "stereo16.mp3", 2, 44100,
+        BufferFormat::Stereo16, 44100, 6912*2*2, {}},
+};
+
 DrMp3ImporterTest::DrMp3ImporterTest() {
     addTests({&DrMp3ImporterTest::empty,
 
               &DrMp3ImporterTest::zeroSamples,
 
               &DrMp3ImporterTest::mono16,
-              &DrMp3ImporterTest::stereo16,
+              &DrMp3ImporterTest::stereo16});
+
+    addInstancedTests({&DrMp3ImporterTest::streaming},
+        Containers::arraySize(StreamingData));
+
+    addTests({&DrMp3ImporterTest::streamingSeek,
+              &DrMp3ImporterTest::streamingNoFrameCountHeader,
+              &DrMp3ImporterTest::streamingData,
+              &DrMp3ImporterTest::streamingFileNotFound,
+              &DrMp3ImporterTest::releaseData});
+
+    addInstancedTests({&DrMp3ImporterTest::remixResample},
+        Containers::arraySize(RemixResampleData));
+
+    addTests({&DrMp3ImporterTest::remixUnsupported,
+              &DrMp3ImporterTest::remixResampleStreaming,
 
               &DrMp3ImporterTest::openTwice,
               &DrMp3ImporterTest::importTwice});
@@ -129,6 +191,235 @@ void DrMp3ImporterTest::stereo16() {
         }), TestSuite::Compare::Container);
 }
 
+void DrMp3ImporterTest::streaming() {
+    auto&& data = StreamingData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, data.filename)));
+    const UnsignedInt frequency = importer->frequency();
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Pointer<AbstractImporter> streamingImporter = _manager.instantiate("DrMp3AudioImporter");
+    streamingImporter->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(streamingImporter->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(streamingImporter->format(), data.format);
+    CORRADE_COMPARE(streamingImporter->frequency(), frequency);
+
+    /* Decoding everything in the streaming mode should give the same result
+       as in the non-streaming mode */
+    CORRADE_COMPARE_AS(streamingImporter->data(), expected,
+        TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
+    DrMp3Importer& drMp3Importer = static_cast<DrMp3Importer&>(*streamingImporter);
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 0);
+
+    /* Decode in chunks of 100 frames, the last chunk is shorter */
+    const std::size_t frameSize = data.frameSize;
+    const UnsignedLong frameCount = drMp3Importer.frameCount();
+    Containers::Array<char> out{NoInit, 100*frameSize};
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = drMp3Importer.readFrames(out)); )
+        arrayAppend(actual, out.prefix(read*frameSize));
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), frameCount);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+    #endif
+}
+
+void DrMp3ImporterTest::streamingSeek() {
+    #ifndef MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16.mp3")));
+    Containers::Array<char> expected = importer->data();
+
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16.mp3")));
+    DrMp3Importer& drMp3Importer = static_cast<DrMp3Importer&>(*importer);
+    CORRADE_COMPARE(drMp3Importer.frameCount(), 6912);
+
+    char out[200*2];
+    CORRADE_VERIFY(drMp3Importer.seek(3456));
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 3456);
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 200);
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 3656);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(3456*2, 200*2),
+        TestSuite::Compare::Container);
+
+    /* Seeking back */
+    CORRADE_VERIFY(drMp3Importer.seek(10));
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 200);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(10*2, 200*2),
+        TestSuite::Compare::Container);
+
+    /* Calling data() doesn't affect the read position */
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 210);
+
+    /* Reading at the end gives back a partial chunk and then nothing */
+    CORRADE_VERIFY(drMp3Importer.seek(6812));
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 100);
+    CORRADE_COMPARE_AS(Containers::arrayView(out).prefix(100*2),
+        expected.exceptPrefix(6812*2),
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 0);
+
+    /* Seeking to the end is fine, past it not */
+    CORRADE_VERIFY(drMp3Importer.seek(6912));
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 0);
+
+    Containers::String outError;
+    Error redirectError{&outError};
+    CORRADE_VERIFY(!drMp3Importer.seek(6913));
+    CORRADE_COMPARE(outError, "Audio::DrMp3Importer::seek(): frame 6913 out of range for 6912 frames\n");
+    #endif
+}
+
+void DrMp3ImporterTest::streamingNoFrameCountHeader() {
+    #ifndef MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16NoInfo.mp3")));
+    Containers::Array<char> expected = importer->data();
+    CORRADE_COMPARE(expected.size(), 5760*2);
+
+    /* Without the Info header the frame count gets known only once the whole
+       file is read */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16NoInfo.mp3")));
+    DrMp3Importer& drMp3Importer = static_cast<DrMp3Importer&>(*importer);
+    Containers::Array<char> out{NoInit, 1000*2};
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = drMp3Importer.readFrames(out)); )
+        arrayAppend(actual, out.prefix(read*2));
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 5760);
+    CORRADE_COMPARE(drMp3Importer.frameCount(), 5760);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+
+    /* Or once it's queried */
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16NoInfo.mp3")));
+    CORRADE_VERIFY(drMp3Importer.seek(3456));
+    CORRADE_COMPARE(drMp3Importer.frameCount(), 5760);
+    CORRADE_COMPARE(drMp3Importer.frameOffset(), 3456);
+    CORRADE_COMPARE(drMp3Importer.readFrames(out), 1000);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(3456*2, 1000*2),
+        TestSuite::Compare::Container);
+
+    /* Or once seeking past the end */
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16NoInfo.mp3")));
+    Containers::String outError;
+    {
+        Error redirectError{&outError};
+        CORRADE_VERIFY(!drMp3Importer.seek(5761));
+    }
+    CORRADE_COMPARE(outError, "Audio::DrMp3Importer::seek(): frame 5761 out of range for 5760 frames\n");
+    CORRADE_COMPARE(drMp3Importer.frameCount(), 5760);
+    #endif
+}
+
+void DrMp3ImporterTest::streamingData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "stereo16.mp3")));
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "stereo16.mp3"));
+    CORRADE_VERIFY(data);
+
+    /* Unlike with openFile(), the decoder operates on a copy of the data, so
+       it should work even after the original memory is gone */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openData(*data));
+    *data = Containers::Array<char>{};
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void DrMp3ImporterTest::streamingFileNotFound() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    importer->configuration().setValue("streaming", true);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile("nonexistent.mp3"));
+    CORRADE_COMPARE(out, "Audio::DrMp3Importer::openFile(): cannot open file nonexistent.mp3\n");
+}
+
+void DrMp3ImporterTest::releaseData() {
+    #ifndef MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("DrMp3Importer::releaseData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16.mp3")));
+    Containers::Array<char> expected = importer->data();
+
+    /* The released data should be the same as the copy and the file gets
+       closed */
+    DrMp3Importer& drMp3Importer = static_cast<DrMp3Importer&>(*importer);
+    CORRADE_COMPARE_AS(drMp3Importer.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+
+    /* In the streaming mode it decodes everything */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16.mp3")));
+    CORRADE_COMPARE_AS(drMp3Importer.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+    #endif
+}
+
+void DrMp3ImporterTest::remixResample() {
+    auto&& data = RemixResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    importer->configuration().setValue("outputChannelCount", data.outputChannelCount);
+    importer->configuration().setValue("outputFrequency", data.outputFrequency);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, data.filename)));
+
+    CORRADE_COMPARE(importer->format(), data.format);
+    CORRADE_COMPARE(importer->frequency(), data.frequency);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), data.size);
+    if(!data.data.isEmpty())
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out), data.data,
+            TestSuite::Compare::Container);
+}
+
+void DrMp3ImporterTest::remixUnsupported() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    importer->configuration().setValue("outputChannelCount", 4);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "stereo16.mp3")));
+    CORRADE_COMPARE(out, "Audio::DrMp3Importer::openData(): can't remix 2 channels to 4\n");
+}
+
+void DrMp3ImporterTest::remixResampleStreaming() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
+    importer->configuration().setValue("streaming", true);
+    importer->configuration().setValue("outputFrequency", 22050);
+
+    /* The options are ignored, the file is imported as-is */
+    Containers::String out;
+    Warning redirectWarning{&out};
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRMP3AUDIOIMPORTER_TEST_DIR, "mono16.mp3")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Mono16);
+    CORRADE_COMPARE(importer->frequency(), 44100);
+    CORRADE_COMPARE(out, "Audio::DrMp3Importer::openFile(): outputFrequency and outputChannelCount options are ignored in the streaming mode\n");
+}
+
 void DrMp3ImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrMp3AudioImporter");
 
@@ -27,3 +27,4 @@
 
 #cmakedefine DRMP3AUDIOIMPORTER_PLUGIN_FILENAME "${DRMP3AUDIOIMPORTER_PLUGIN_FILENAME}"
 #define DRMP3AUDIOIMPORTER_TEST_DIR "${DRMP3AUDIOIMPORTER_TEST_DIR}"
+#cmakedefine MAGNUM_DRMP3AUDIOIMPORTER_BUILD_STATIC
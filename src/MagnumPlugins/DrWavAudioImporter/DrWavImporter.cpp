@@ -27,11 +27,17 @@
 
 #include "DrWavImporter.h"
 
+#include <cstring>
 #include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Endianness.h>
+#include <Magnum/Math/Functions.h>
+
+#include "Magnum/Implementation/audioFileStream.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
 
 #define DR_WAV_IMPLEMENTATION
 #include "dr_wav.h"
@@ -78,31 +84,41 @@ constexpr const BufferFormat MuLawFormatTable[2][1] = {
 };
 #undef _v
 
-/* Converts 32-bit PCM into lower bit levels by skipping bytes */
-Containers::Array<char> convert32Pcm(const Containers::ArrayView<const char> container, const UnsignedInt samples, const UnsignedInt size) {
-    Containers::Array<char> convertData{NoInit, samples*size};
-
-    /* Incrementing `skip` for the first time makes it 0 */
-    UnsignedInt skip = ~UnsignedInt{}, index = 0;
-    for(char item: container) {
-        ++skip;
+/* Narrows 32-bit PCM into 8- or 16-bit output samples. The loops are kept
+   trivial and branch-free so the compiler can vectorize them. */
+void convertSamples(const Containers::ArrayView<const Int> samples, const UnsignedInt size, char* const out) {
+    /* 8-bit needs to become unsigned */
+    if(size == 1) {
+        for(std::size_t i = 0; i != samples.size(); ++i)
+            out[i] = char((samples[i] >> 24) + 128);
+
+    } else if(size == 2) {
+        for(std::size_t i = 0; i != samples.size(); ++i) {
+            const Short value = Short(samples[i] >> 16);
+            std::memcpy(out + i*sizeof(Short), &value, sizeof(Short));
+        }
 
-        if(skip > 3)
-            skip = 0;
-        if(skip < 4 - size)
-            continue;
+    } else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+}
 
-        convertData[index] = item;
-        ++index;
+/* Reads 32-bit PCM in chunks of whole frames on stack, narrowing each
+   directly into the output */
+Containers::Array<char> readNarrowPcm(drwav* const handle, const std::size_t samples, const UnsignedInt channelCount, const UnsignedInt size) {
+    Containers::Array<char> data{ValueInit, samples*size};
+    Int chunk[4096];
+    const std::size_t maxChunkSampleCount = Containers::arraySize(chunk) - Containers::arraySize(chunk) % channelCount;
+    for(std::size_t offset = 0; offset != samples; ) {
+        const std::size_t read = drwav_read_s32(handle, Math::min(samples - offset, maxChunkSampleCount), chunk);
+        if(!read) break;
+        convertSamples(Containers::arrayView(chunk).prefix(read), size, data + offset*size);
+        offset += read;
     }
 
-    return convertData;
+    return data;
 }
 
-/* Reads generic audio into most compatible format; also adjusts format */
-Containers::Array<char> read32fPcm(drwav* const handle, const UnsignedInt samples, const UnsignedInt numChannels, BufferFormat& format) {
-    format = IeeeFormatTable[numChannels-1][0];
-
+/* Reads generic audio into most compatible format */
+Containers::Array<char> read32fPcm(drwav* const handle, const UnsignedInt samples) {
     Containers::Array<char> tempData(samples*sizeof(Float));
     drwav_read_f32(handle, samples, reinterpret_cast<float*>(tempData.begin()));
 
@@ -117,22 +133,87 @@ Containers::Array<char> readRaw(drwav* const handle, const UnsignedInt samples,
     return tempData;
 }
 
+drwav_bool32 seekFile(void* const userData, const int offset, const drwav_seek_origin origin) {
+    return Implementation::seekAudioFile(userData, offset, origin == drwav_seek_origin_current);
+}
+
 }
 
+enum class DrWavImporter::ReadMode: UnsignedByte {
+    /* Data is copied as-is */
+    Raw,
+    /* Data is read as 32-bit PCM and narrowed to 8 or 16 bits */
+    Narrow,
+    /* Data is read as 32-bit float */
+    Float
+};
+
+struct DrWavImporter::Stream {
+    /* Decoding from a copy of the data passed to openData() */
+    explicit Stream(const Containers::ArrayView<const char> input): data{NoInit, input.size()} {
+        Utility::copy(input, data);
+    }
+
+    /* Decoding from a file passed to openFile(), takes ownership of it */
+    explicit Stream(std::FILE* const file): file{file} {}
+
+    ~Stream() {
+        if(handle) drwav_close(handle);
+        if(file) std::fclose(file);
+    }
+
+    Containers::Array<char> data;
+    std::FILE* file{};
+    drwav* handle{};
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 DrWavImporter::DrWavImporter() = default; /* LCOV_EXCL_LINE */
 #endif
 
 DrWavImporter::DrWavImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
+DrWavImporter::~DrWavImporter() = default;
+
 ImporterFeatures DrWavImporter::doFeatures() const { return ImporterFeature::OpenData; }
 
-bool DrWavImporter::doIsOpened() const { return !!_data; }
+bool DrWavImporter::doIsOpened() const { return _data || _stream; }
+
+void DrWavImporter::doOpenData(Containers::ArrayView<const char> data) {
+    /* In the streaming mode the decoder stays open after this function exits,
+       so it has to operate on a copy of the data */
+    Containers::Pointer<Stream> stream;
+    if(configuration().value<bool>("streaming")) {
+        stream.emplace(data);
+        data = stream->data;
+    }
+
+    openInternal(Utility::move(stream), data, "Audio::DrWavImporter::openData():");
+}
 
-void DrWavImporter::doOpenData(const Containers::ArrayView<const char> data) {
-    drwav* const handle = drwav_open_memory(data.data(), data.size());
+void DrWavImporter::doOpenFile(const Containers::StringView filename) {
+    /* Without streaming everything is decoded upfront, so read the whole file
+       to memory */
+    if(!configuration().value<bool>("streaming"))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* Otherwise keep the file open and let the decoder read from it only
+       what it needs, instead of having a copy of the whole file in memory */
+    std::FILE* const file = Implementation::openAudioFile(filename);
+    if(!file) {
+        Error{} << "Audio::DrWavImporter::openFile(): cannot open file" << filename;
+        return;
+    }
+
+    openInternal(Containers::Pointer<Stream>{InPlaceInit, file}, nullptr, "Audio::DrWavImporter::openFile():");
+}
+
+void DrWavImporter::openInternal(Containers::Pointer<Stream>&& stream, const Containers::ArrayView<const char> data, const char* const prefix) {
+    drwav* const handle = stream && stream->file ?
+        drwav_open(Implementation::readAudioFile, seekFile, stream->file) :
+        drwav_open_memory(data.data(), data.size());
     if(!handle) {
-        Error() << "Audio::DrWavImporter::openData(): failed to open and decode WAV data";
+        Error() << prefix << "failed to open and decode WAV data";
         return;
     }
     Containers::ScopeGuard drwavClose{handle, drwav_close};
@@ -150,41 +231,53 @@ void DrWavImporter::doOpenData(const Containers::ArrayView<const char> data) {
 
     if(numChannels == 0 || numChannels == 3 || numChannels == 5 || numChannels > 8 ||
        normalizedBytesPerSample == 0 || normalizedBytesPerSample > 8) {
-        Error() << "Audio::DrWavImporter::openData(): unsupported channel count"
+        Error() << prefix << "unsupported channel count"
                 << numChannels << "with" << bitsPerSample
                 << "bits per sample";
         return;
     }
 
+    /* Remixing and resampling is done on the whole decoded data, so it's
+       ignored in the streaming mode */
+    UnsignedInt outputFrequency = configuration().value<UnsignedInt>("outputFrequency");
+    UnsignedInt outputChannelCount = configuration().value<UnsignedInt>("outputChannelCount");
+    if(stream && (outputFrequency || outputChannelCount)) {
+        Warning{} << prefix << "outputFrequency and outputChannelCount options are ignored in the streaming mode";
+        outputFrequency = outputChannelCount = 0;
+    }
+    if(!outputFrequency) outputFrequency = frequency;
+    if(!outputChannelCount) outputChannelCount = numChannels;
+    if(!Implementation::canRemixAudio(numChannels, outputChannelCount)) {
+        Error{} << prefix << "can't remix" << numChannels << "channels to" << outputChannelCount;
+        return;
+    }
+
     _frequency = frequency;
+    _channelCount = numChannels;
+    _frameCount = samples/numChannels;
+    _frameOffset = 0;
+
+    /* If we don't know what the format is, read it out as 32 bit float for
+       compatibility */
+    _format = IeeeFormatTable[numChannels-1][0];
+    _readMode = ReadMode::Float;
+    _sampleSize = sizeof(Float);
 
     /* PCM has a lot of special cases, as we can read many formats directly */
     if(handle->translatedFormatTag == DR_WAVE_FORMAT_PCM) {
-        _format = PcmFormatTable[numChannels-1][normalizedBytesPerSample-1];
-        CORRADE_INTERNAL_ASSERT(_format != BufferFormat{});
-
         /* If the data is exactly 8 or 16 bits, we can read it raw */
         if(!notExactBitsPerSample && normalizedBytesPerSample < 3) {
-            _data = readRaw(handle, samples, normalizedBytesPerSample);
-            return;
-
-        /* If the data is approximately 24 bits or has many channels, a float is more than enough */
-        } else if(normalizedBytesPerSample == 3 || (normalizedBytesPerSample > 3 && numChannels > 3)) {
-            _data = read32fPcm(handle, samples, numChannels, _format);
-            return;
-
-        /* If the data is close to 8 or 16 bits, we can convert it from 32-bit PCM */
-        } else if(normalizedBytesPerSample == 1 || normalizedBytesPerSample == 2) {
-            Containers::Array<char> tempData(samples*sizeof(Int));
-            drwav_read_s32(handle, samples, reinterpret_cast<Int*>(tempData.begin()));
-
-            /* 32-bit PCM can be sliced down to 8 or 16 for direct reading */
-            _data = convert32Pcm(tempData, samples, normalizedBytesPerSample);
-
-            /* Convert 8 bit data to unsigned */
-            if(normalizedBytesPerSample == 1)
-                for(char& item: *_data) item = item - 128;
-            return;
+            _format = PcmFormatTable[numChannels-1][normalizedBytesPerSample-1];
+            _readMode = ReadMode::Raw;
+            _sampleSize = normalizedBytesPerSample;
+
+        /* If the data is close to 8 or 16 bits, we can convert it from 32-bit
+           PCM. Approximately 24 bits or more are read as a float, which is
+           more than enough. */
+        } else if(normalizedBytesPerSample < 3) {
+            _format = PcmFormatTable[numChannels-1][normalizedBytesPerSample-1];
+            _readMode = ReadMode::Narrow;
+            _sampleSize = normalizedBytesPerSample;
         }
 
         /** @todo Allow loading of 32/64 bit streams to Double format to preserve all information */
@@ -193,43 +286,187 @@ void DrWavImporter::doOpenData(const Containers::ArrayView<const char> data) {
     } else if(handle->translatedFormatTag == DR_WAVE_FORMAT_ALAW) {
         if(numChannels < 3 && !notExactBitsPerSample && (bitsPerSample == 8 || bitsPerSample == 16) ) {
             _format = ALawFormatTable[numChannels-1][normalizedBytesPerSample-1];
-            _data = readRaw(handle, samples, normalizedBytesPerSample);
-            return;
+            _readMode = ReadMode::Raw;
+            _sampleSize = normalizedBytesPerSample;
         }
 
     /* MuLaw of 8/16 bits with 1/2 channels can be loaded directly */
     } else if(handle->translatedFormatTag == DR_WAVE_FORMAT_MULAW) {
         if(numChannels < 3 && !notExactBitsPerSample && (bitsPerSample == 8 || bitsPerSample == 16) ) {
             _format = MuLawFormatTable[numChannels-1][normalizedBytesPerSample-1];
-            _data = readRaw(handle, samples, normalizedBytesPerSample);
-            return;
+            _readMode = ReadMode::Raw;
+            _sampleSize = normalizedBytesPerSample;
         }
 
     /* IEEE float or double can be loaded directly */
     } else if(handle->translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT) {
         if(!notExactBitsPerSample && (bitsPerSample == 32 || bitsPerSample == 64)) {
             _format = IeeeFormatTable[numChannels-1][(normalizedBytesPerSample / 4)-1];
-            _data = readRaw(handle, samples, normalizedBytesPerSample);
-            return;
+            _readMode = ReadMode::Raw;
+            _sampleSize = normalizedBytesPerSample;
         }
     }
 
-    /* If we don't know what the format is, read it out as 32 bit float for compatibility */
-    _data = read32fPcm(handle, samples, numChannels, _format);
+    CORRADE_INTERNAL_ASSERT(_format != BufferFormat{});
+
+    /* In the streaming mode just keep the decoder open, frames get decoded
+       in readFrames() */
+    if(stream) {
+        drwavClose.release();
+        stream->handle = handle;
+        _stream = Utility::move(stream);
+        return;
+    }
+
+    /* If remixing or resampling, read everything as floats, which also takes
+       care of ALaw and MuLaw, and convert that. The output is floats as
+       well. */
+    if(outputChannelCount != numChannels || outputFrequency != frequency) {
+        _data = Implementation::remixResampleAudio(read32fPcm(handle, samples),
+            Implementation::AudioSampleType::Float, numChannels, frequency,
+            outputChannelCount, outputFrequency);
+        _frequency = outputFrequency;
+        _format = IeeeFormatTable[outputChannelCount-1][0];
+        _readMode = ReadMode::Float;
+        _channelCount = outputChannelCount;
+        _sampleSize = sizeof(Float);
+        _frameCount = _data->size()/(outputChannelCount*sizeof(Float));
+
+    } else if(_readMode == ReadMode::Raw) {
+        _data = readRaw(handle, samples, _sampleSize);
+
+    } else if(_readMode == ReadMode::Narrow) {
+        _data = readNarrowPcm(handle, samples, numChannels, _sampleSize);
+
+    } else if(_readMode == ReadMode::Float) {
+        _data = read32fPcm(handle, samples);
+
+    } else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
 }
 
-void DrWavImporter::doClose() { _data = Containers::NullOpt; }
+void DrWavImporter::doClose() {
+    _data = Containers::NullOpt;
+    _stream = nullptr;
+}
 
 BufferFormat DrWavImporter::doFormat() const { return _format; }
 
 UnsignedInt DrWavImporter::doFrequency() const { return _frequency; }
 
 Containers::Array<char> DrWavImporter::doData() {
+    /* In the streaming mode decode everything from the start and then go
+       back to where the stream was. If decoding fails midway, the rest stays
+       zero-filled, which is consistent with what happens in the
+       non-streaming mode. */
+    if(_stream) {
+        const UnsignedLong frameOffset = _frameOffset;
+        Containers::Array<char> out{ValueInit, std::size_t(_frameCount*_channelCount*_sampleSize)};
+        if(!seek(0)) return {};
+        readFrames(out);
+        seek(frameOffset);
+        return out;
+    }
+
     Containers::Array<char> copy{NoInit, _data->size()};
     Utility::copy(*_data, copy);
     return copy;
 }
 
+Containers::Array<char> DrWavImporter::releaseData() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrWavImporter::releaseData(): no file opened", {});
+
+    /* In the streaming mode there's nothing to release, decode everything */
+    Containers::Array<char> out = _stream ? doData() : *Utility::move(_data);
+    close();
+    return out;
+}
+
+UnsignedLong DrWavImporter::frameCount() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrWavImporter::frameCount(): no file opened", {});
+    return _frameCount;
+}
+
+UnsignedLong DrWavImporter::frameOffset() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrWavImporter::frameOffset(): no file opened", {});
+    return _frameOffset;
+}
+
+std::size_t DrWavImporter::readFrames(const Containers::ArrayView<char> data) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrWavImporter::readFrames(): no file opened", {});
+    const std::size_t frameSize = _channelCount*_sampleSize;
+    CORRADE_ASSERT(data.size() % frameSize == 0,
+        "Audio::DrWavImporter::readFrames(): expected size to be a multiple of" << frameSize << "bytes but got" << data.size(), {});
+
+    const std::size_t frameCount = Math::min(UnsignedLong(data.size()/frameSize), _frameCount - _frameOffset);
+
+    /* Non-streaming mode, copy the already decoded data */
+    if(!_stream) {
+        Utility::copy(_data->sliceSize(_frameOffset*frameSize, frameCount*frameSize),
+            data.prefix(frameCount*frameSize));
+        _frameOffset += frameCount;
+        return frameCount;
+    }
+
+    const std::size_t sampleCount = frameCount*_channelCount;
+    std::size_t decodedSampleCount;
+
+    /* Raw data can be read directly into the output */
+    if(_readMode == ReadMode::Raw) {
+        decodedSampleCount = drwav_read_raw(_stream->handle, sampleCount*_sampleSize, data.data())/_sampleSize;
+
+    /* Otherwise decode in fixed-size chunks to a temporary buffer on stack
+       and convert from there */
+    } else {
+        union {
+            Int s32[4096];
+            Float f32[4096];
+        } samples;
+        const std::size_t maxChunkSampleCount = 4096 - 4096 % _channelCount;
+        decodedSampleCount = 0;
+        while(decodedSampleCount != sampleCount) {
+            const std::size_t chunkSampleCount = Math::min(sampleCount - decodedSampleCount, maxChunkSampleCount);
+            char* const out = data.data() + decodedSampleCount*_sampleSize;
+            std::size_t read;
+            if(_readMode == ReadMode::Narrow) {
+                read = drwav_read_s32(_stream->handle, chunkSampleCount, samples.s32);
+                convertSamples(Containers::arrayView(samples.s32).prefix(read), _sampleSize, out);
+            } else if(_readMode == ReadMode::Float) {
+                read = drwav_read_f32(_stream->handle, chunkSampleCount, samples.f32);
+                std::memcpy(out, samples.f32, read*sizeof(Float));
+            } else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+            decodedSampleCount += read;
+            if(read != chunkSampleCount) break;
+        }
+    }
+
+    const std::size_t decodedFrameCount = decodedSampleCount/_channelCount;
+    _frameOffset += decodedFrameCount;
+    return decodedFrameCount;
+}
+
+bool DrWavImporter::seek(const UnsignedLong frame) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::DrWavImporter::seek(): no file opened", {});
+    if(frame > _frameCount) {
+        Error{} << "Audio::DrWavImporter::seek(): frame" << frame << "out of range for" << _frameCount << "frames";
+        return false;
+    }
+
+    /* dr_wav clamps the sample index to the last sample, which is fine as
+       readFrames() doesn't read past _frameCount anyway */
+    if(_stream && frame != _frameCount && !drwav_seek_to_sample(_stream->handle, frame*_channelCount)) {
+        Error{} << "Audio::DrWavImporter::seek(): seek to frame" << frame << "failed";
+        return false;
+    }
+
+    _frameOffset = frame;
+    return true;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(DrWavAudioImporter, Magnum::Audio::DrWavImporter,
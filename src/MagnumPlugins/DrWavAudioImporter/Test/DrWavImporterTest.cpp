@@ -28,15 +28,22 @@
 
 #include <string> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringStl.h> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "configure.h"
 
+#ifdef MAGNUM_DRWAVAUDIOIMPORTER_BUILD_STATIC
+#include "MagnumPlugins/DrWavAudioImporter/DrWavImporter.h"
+#endif
+
 namespace Magnum { namespace Audio { namespace Test { namespace {
 
 struct DrWavImporterTest: TestSuite::Tester {
@@ -85,6 +92,16 @@ struct DrWavImporterTest: TestSuite::Tester {
     void extensions32f();
     void extensions64f();
 
+    void streaming();
+    void streamingSeek();
+    void streamingData();
+    void streamingFileNotFound();
+    void releaseData();
+
+    void remixResample();
+    void remixUnsupported();
+    void remixResampleStreaming();
+
     void openTwice();
     void importTwice();
 
@@ -92,6 +109,53 @@ struct DrWavImporterTest: TestSuite::Tester {
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    BufferFormat format;
+    std::size_t frameSize;
+} StreamingData[]{
+    {"8-bit mono", "mono8.wav", BufferFormat::Mono8, 1},
+    {"8-bit A-law mono", "mono8ALaw.wav", BufferFormat::MonoALaw, 1},
+    {"12-bit stereo", "stereo12.wav", BufferFormat::Stereo16, 4},
+    {"24-bit stereo", "stereo24.wav", BufferFormat::StereoFloat, 8},
+    {"64-bit float stereo", "stereo64f.wav", BufferFormat::StereoDouble, 16},
+    {"24-bit 7.1 surround", "surround71Channel24.wav", BufferFormat::Surround71Channel32, 32},
+    {"zero samples", "zeroSamples.wav", BufferFormat::MonoFloat, 4},
+};
+
+const Float RemixStereoToMonoData[]{
+    0.618377685546875f
+};
+
+const Float RemixMonoToStereoData[]{
+    0.125885009765625f, 0.125885009765625f,
+    -0.457489013671875f, -0.457489013671875f
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt outputChannelCount, outputFrequency;
+    BufferFormat format;
+    UnsignedInt frequency;
+    std::size_t size;
+    Containers::ArrayView<const Float> data;
+} RemixResampleData[]{
+    {"stereo to mono", "stereo16.wav", 1, 0,
+        BufferFormat::MonoFloat, 44100, 4, RemixStereoToMonoData},
+    {"mono to stereo", "mono16.wav", 2, 0,
+        BufferFormat::StereoFloat, 44000, 16, RemixMonoToStereoData},
+    {"A-law mono to stereo", "mono8ALaw.wav", 2, 0,
+        BufferFormat::StereoFloat, 8000, 4096*2*4, {}},
+    {"7.1 to stereo", "surround71Channel24.wav", 2, 0,
+        BufferFormat::StereoFloat, 48000, 4930*2*4, {}},
+    {"5.1 to mono, 48 kHz to 44.1 kHz", "surround51Channel16.wav", 1, 44100,
+        BufferFormat::MonoFloat, 44100, 24951*4, {}},
+    {"same channel count and frequency", "stereo16.wav", 2, 44100,
+        BufferFormat::Stereo16, 44100, 4, {}},
+};
+
 DrWavImporterTest::DrWavImporterTest() {
     addTests({&DrWavImporterTest::empty,
               &DrWavImporterTest::wrongSignature,
@@ -135,7 +199,21 @@ DrWavImporterTest::DrWavImporterTest() {
               &DrWavImporterTest::extensions32,
 
               &DrWavImporterTest::extensions32f,
-              &DrWavImporterTest::extensions64f,
+              &DrWavImporterTest::extensions64f});
+
+    addInstancedTests({&DrWavImporterTest::streaming},
+        Containers::arraySize(StreamingData));
+
+    addTests({&DrWavImporterTest::streamingSeek,
+              &DrWavImporterTest::streamingData,
+              &DrWavImporterTest::streamingFileNotFound,
+              &DrWavImporterTest::releaseData});
+
+    addInstancedTests({&DrWavImporterTest::remixResample},
+        Containers::arraySize(RemixResampleData));
+
+    addTests({&DrWavImporterTest::remixUnsupported,
+              &DrWavImporterTest::remixResampleStreaming,
 
               &DrWavImporterTest::openTwice,
               &DrWavImporterTest::importTwice});
@@ -610,6 +688,190 @@ void DrWavImporterTest::extensions64f() {
     }), TestSuite::Compare::Container);
 }
 
+void DrWavImporterTest::streaming() {
+    auto&& data = StreamingData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, data.filename)));
+    const UnsignedInt frequency = importer->frequency();
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Pointer<AbstractImporter> streamingImporter = _manager.instantiate("DrWavAudioImporter");
+    streamingImporter->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(streamingImporter->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(streamingImporter->format(), data.format);
+    CORRADE_COMPARE(streamingImporter->frequency(), frequency);
+
+    /* Decoding everything in the streaming mode should give the same result
+       as in the non-streaming mode */
+    CORRADE_COMPARE_AS(streamingImporter->data(), expected,
+        TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_DRWAVAUDIOIMPORTER_BUILD_STATIC
+    DrWavImporter& drWavImporter = static_cast<DrWavImporter&>(*streamingImporter);
+    CORRADE_COMPARE(drWavImporter.frameOffset(), 0);
+
+    /* Decode in chunks of 100 frames, the last chunk is shorter */
+    const std::size_t frameSize = data.frameSize;
+    const UnsignedLong frameCount = drWavImporter.frameCount();
+    Containers::Array<char> out{NoInit, 100*frameSize};
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = drWavImporter.readFrames(out)); )
+        arrayAppend(actual, out.prefix(read*frameSize));
+    CORRADE_COMPARE(drWavImporter.frameOffset(), frameCount);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+    #endif
+}
+
+void DrWavImporterTest::streamingSeek() {
+    #ifndef MAGNUM_DRWAVAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo24.wav")));
+    Containers::Array<char> expected = importer->data();
+
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo24.wav")));
+    DrWavImporter& drWavImporter = static_cast<DrWavImporter&>(*importer);
+    CORRADE_COMPARE(drWavImporter.frameCount(), 23493);
+
+    char out[200*8];
+    CORRADE_VERIFY(drWavImporter.seek(11746));
+    CORRADE_COMPARE(drWavImporter.frameOffset(), 11746);
+    CORRADE_COMPARE(drWavImporter.readFrames(out), 200);
+    CORRADE_COMPARE(drWavImporter.frameOffset(), 11946);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(11746*8, 200*8),
+        TestSuite::Compare::Container);
+
+    /* Seeking back */
+    CORRADE_VERIFY(drWavImporter.seek(10));
+    CORRADE_COMPARE(drWavImporter.readFrames(out), 200);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(10*8, 200*8),
+        TestSuite::Compare::Container);
+
+    /* Calling data() doesn't affect the read position */
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drWavImporter.frameOffset(), 210);
+
+    /* Reading at the end gives back a partial chunk and then nothing */
+    CORRADE_VERIFY(drWavImporter.seek(23393));
+    CORRADE_COMPARE(drWavImporter.readFrames(out), 100);
+    CORRADE_COMPARE_AS(Containers::arrayView(out).prefix(100*8),
+        expected.exceptPrefix(23393*8),
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(drWavImporter.readFrames(out), 0);
+
+    /* Seeking to the end is fine, past it not */
+    CORRADE_VERIFY(drWavImporter.seek(23493));
+    CORRADE_COMPARE(drWavImporter.readFrames(out), 0);
+
+    Containers::String outError;
+    Error redirectError{&outError};
+    CORRADE_VERIFY(!drWavImporter.seek(23494));
+    CORRADE_COMPARE(outError, "Audio::DrWavImporter::seek(): frame 23494 out of range for 23493 frames\n");
+    #endif
+}
+
+void DrWavImporterTest::streamingData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo12.wav")));
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo12.wav"));
+    CORRADE_VERIFY(data);
+
+    /* Unlike with openFile(), the decoder operates on a copy of the data, so
+       it should work even after the original memory is gone */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openData(*data));
+    *data = Containers::Array<char>{};
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void DrWavImporterTest::streamingFileNotFound() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    importer->configuration().setValue("streaming", true);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile("nonexistent.wav"));
+    CORRADE_COMPARE(out, "Audio::DrWavImporter::openFile(): cannot open file nonexistent.wav\n");
+}
+
+void DrWavImporterTest::releaseData() {
+    #ifndef MAGNUM_DRWAVAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("DrWavImporter::releaseData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo24.wav")));
+    Containers::Array<char> expected = importer->data();
+
+    /* The released data should be the same as the copy and the file gets
+       closed */
+    DrWavImporter& drWavImporter = static_cast<DrWavImporter&>(*importer);
+    CORRADE_COMPARE_AS(drWavImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+
+    /* In the streaming mode it decodes everything */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "stereo24.wav")));
+    CORRADE_COMPARE_AS(drWavImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+    #endif
+}
+
+void DrWavImporterTest::remixResample() {
+    auto&& data = RemixResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    importer->configuration().setValue("outputChannelCount", data.outputChannelCount);
+    importer->configuration().setValue("outputFrequency", data.outputFrequency);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, data.filename)));
+
+    CORRADE_COMPARE(importer->format(), data.format);
+    CORRADE_COMPARE(importer->frequency(), data.frequency);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), data.size);
+    if(!data.data.isEmpty())
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out), data.data,
+            TestSuite::Compare::Container);
+}
+
+void DrWavImporterTest::remixUnsupported() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    importer->configuration().setValue("outputChannelCount", 4);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "surround51Channel16.wav")));
+    CORRADE_COMPARE(out, "Audio::DrWavImporter::openData(): can't remix 6 channels to 4\n");
+}
+
+void DrWavImporterTest::remixResampleStreaming() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
+    importer->configuration().setValue("streaming", true);
+    importer->configuration().setValue("outputFrequency", 22050);
+
+    /* The options are ignored, the file is imported as-is */
+    Containers::String out;
+    Warning redirectWarning{&out};
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(DRWAVAUDIOIMPORTER_TEST_DIR, "mono16.wav")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Mono16);
+    CORRADE_COMPARE(importer->frequency(), 44000);
+    CORRADE_COMPARE(out, "Audio::DrWavImporter::openFile(): outputFrequency and outputChannelCount options are ignored in the streaming mode\n");
+}
+
 void DrWavImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("DrWavAudioImporter");
 
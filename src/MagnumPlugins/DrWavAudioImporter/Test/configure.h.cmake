@@ -26,3 +26,4 @@
 
 #cmakedefine DRWAVAUDIOIMPORTER_PLUGIN_FILENAME "${DRWAVAUDIOIMPORTER_PLUGIN_FILENAME}"
 #define DRWAVAUDIOIMPORTER_TEST_DIR "${DRWAVAUDIOIMPORTER_TEST_DIR}"
+#cmakedefine MAGNUM_DRWAVAUDIOIMPORTER_BUILD_STATIC
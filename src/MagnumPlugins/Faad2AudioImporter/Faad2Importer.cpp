@@ -26,46 +26,191 @@
 
 #include "Faad2Importer.h"
 
+#include <cstring>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
+#include <Magnum/Math/Functions.h>
 
 #include <neaacdec.h>
 
+#include "Magnum/Implementation/audioFileStream.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
+
 namespace Magnum { namespace Audio {
 
+namespace {
+
+long initDecoder(const NeAACDecHandle decoder, const Containers::ArrayView<const char> data, unsigned long& samplerate, unsigned char& channels) {
+    /* Decide what's the sample format. For some reason this doesn't depend on
+       the file. */
+    /** @todo how do I detect what format is actually stored?! */
+    CORRADE_INTERNAL_ASSERT(NeAACDecGetCurrentConfiguration(decoder)->outputFormat = FAAD_FMT_16BIT);
+
+    /* Open the file. I expected anything but a need for a const_cast. Ugh. */
+    /* For raw AAC files it returns always 0, not skipping any header:
+       https://github.com/knik0/faad2/blob/7da4a83b230d069a9d731b1e64f6e6b52802576a/libfaad/decoder.c#L327-L339 */
+    return NeAACDecInit(decoder, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data.data())), data.size(), &samplerate, &channels);
+}
+
+void closeDecoder(NeAACDecHandle* const decoder) {
+    if(*decoder) NeAACDecClose(*decoder);
+}
+
+}
+
+struct Faad2Importer::Stream {
+    /* Decoding from a copy of the data passed to openData() */
+    explicit Stream(const Containers::ArrayView<const char> input): data{NoInit, input.size()}, size{input.size()} {
+        Utility::copy(input, data);
+    }
+
+    /* Decoding from a file passed to openFile(), takes ownership of it. The
+       data are then a window into the file that gets refilled as the frames
+       are consumed, large enough for the largest possible AAC frame with
+       eight channels. */
+    explicit Stream(std::FILE* const file): data{NoInit, FAAD_MIN_STREAMSIZE*8}, file{file}, size{} {}
+
+    ~Stream() {
+        if(decoder) NeAACDecClose(decoder);
+        if(file) std::fclose(file);
+    }
+
+    /* Moves the not yet consumed data to the front of the window and fills
+       the rest from the file. Does nothing when decoding from memory. */
+    void refill() {
+        if(!file) return;
+        const std::size_t remaining = size - position;
+        std::memmove(data.data(), data.data() + position, remaining);
+        size = remaining + Implementation::readAudioFile(file, data.data() + remaining, data.size() - remaining);
+        position = 0;
+    }
+
+    /* Opens the decoder and goes to the first frame */
+    bool start() {
+        if(decoder) NeAACDecClose(decoder);
+        decoder = NeAACDecOpen();
+
+        /* When decoding from a file, go back to its beginning */
+        if(file) {
+            if(!Implementation::seekAudioFile(file, 0, false)) return false;
+            position = size = 0;
+            refill();
+        }
+
+        const long result = initDecoder(decoder, data.prefix(size), samplerate, channels);
+        if(result < 0) return false;
+
+        position = result;
+        samples = {};
+        sampleOffset = 0;
+        failed = false;
+        return true;
+    }
+
+    /* Returns false at the end of the file or on failure, in which case it
+       prints a message and sets the failed flag */
+    bool decodeNextFrame(const char* const prefix) {
+        refill();
+        if(position >= size) return false;
+
+        NeAACDecFrameInfo info;
+        void* const sampleBuffer = NeAACDecDecode(decoder, &info, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data.data())) + position, size - position);
+        if(info.error) {
+            Error{} << prefix << "decoding error";
+            position = size;
+            failed = true;
+            return false;
+        }
+
+        /* The buffer is owned by the decoder and is valid until the next
+           NeAACDecDecode() call */
+        samples = {reinterpret_cast<const UnsignedShort*>(sampleBuffer), info.samples};
+        sampleOffset = 0;
+        position += info.bytesconsumed;
+        return true;
+    }
+
+    Containers::Array<char> data;
+    std::FILE* file{};
+    /* Count of valid bytes in data */
+    std::size_t size;
+    NeAACDecHandle decoder{};
+    unsigned long samplerate = 0;
+    unsigned char channels = 0;
+    std::size_t position = 0;
+    Containers::ArrayView<const UnsignedShort> samples;
+    std::size_t sampleOffset;
+    bool failed;
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 Faad2Importer::Faad2Importer() = default; /* LCOV_EXCL_LINE */
 #endif
 
 Faad2Importer::Faad2Importer(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
+Faad2Importer::~Faad2Importer() = default;
+
 ImporterFeatures Faad2Importer::doFeatures() const { return ImporterFeature::OpenData; }
 
-bool Faad2Importer::doIsOpened() const { return !_samples.isEmpty(); }
+bool Faad2Importer::doIsOpened() const { return !_data.isEmpty() || _stream; }
 
 void Faad2Importer::doOpenData(Containers::ArrayView<const char> data) {
-    /* Init the library */
-    const NeAACDecHandle decoder = NeAACDecOpen();
-    Containers::ScopeGuard exit{decoder, NeAACDecClose};
+    /* In the streaming mode the decoder stays open after this function exits,
+       so it has to operate on a copy of the data */
+    Containers::Pointer<Stream> stream;
+    if(configuration().value<bool>("streaming"))
+        stream.emplace(data);
 
-    /* Decide what's the sample format. For some reason this doesn't depend on
-       the file. */
-    /** @todo how do I detect what format is actually stored?! */
-    CORRADE_INTERNAL_ASSERT(NeAACDecGetCurrentConfiguration(decoder)->outputFormat = FAAD_FMT_16BIT);
+    openInternal(Utility::move(stream), data, "Audio::Faad2Importer::openData():");
+}
+
+void Faad2Importer::doOpenFile(const Containers::StringView filename) {
+    /* Without streaming everything is decoded upfront, so read the whole file
+       to memory */
+    if(!configuration().value<bool>("streaming"))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* Otherwise keep the file open and let the decoder read from it only
+       what it needs, instead of having a copy of the whole file in memory */
+    std::FILE* const file = Implementation::openAudioFile(filename);
+    if(!file) {
+        Error{} << "Audio::Faad2Importer::openFile(): cannot open file" << filename;
+        return;
+    }
+
+    openInternal(Containers::Pointer<Stream>{InPlaceInit, file}, nullptr, "Audio::Faad2Importer::openFile():");
+}
+
+void Faad2Importer::openInternal(Containers::Pointer<Stream>&& stream, const Containers::ArrayView<const char> data, const char* const prefix) {
+    /* In the streaming mode the decoder is owned by the stream and stays open
+       after this function exits, otherwise a temporary one is used to decode
+       everything here */
+    NeAACDecHandle decoder{};
+    Containers::ScopeGuard exit{&decoder, closeDecoder};
 
-    /* Open the file. I expected anything but a need for a const_cast. Ugh. */
-    /* For raw AAC files it returns always 0, not skipping any header:
-       https://github.com/knik0/faad2/blob/7da4a83b230d069a9d731b1e64f6e6b52802576a/libfaad/decoder.c#L327-L339 */
     unsigned long samplerate = 0;
     unsigned char channels = 0;
-    long result = NeAACDecInit(decoder, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data.data())), data.size(), &samplerate, &channels);
-    if(result < 0) {
-        Error{} << "Audio::Faad2Importer::openData(): can't read file header";
-        return;
+    long result = 0;
+    if(stream) {
+        if(!stream->start()) {
+            Error{} << prefix << "can't read file header";
+            return;
+        }
+        samplerate = stream->samplerate;
+        channels = stream->channels;
+    } else {
+        decoder = NeAACDecOpen();
+        result = initDecoder(decoder, data, samplerate, channels);
+        if(result < 0) {
+            Error{} << prefix << "can't read file header";
+            return;
+        }
     }
 
     _frequency = samplerate;
@@ -76,45 +221,209 @@ void Faad2Importer::doOpenData(Containers::ArrayView<const char> data) {
         /* Mono files are always upgraded to stereo for some reason, so I
            always assume stereo anyway:
            https://github.com/knik0/faad2/blob/7da4a83b230d069a9d731b1e64f6e6b52802576a/libfaad/decoder.c#L353-L358 */
-        Error{} << "Audio::Faad2Importer::openData(): unsupported channel count"
+        Error{} << prefix << "unsupported channel count"
                 << channels << "with" << 16 << "bits per sample";
         return;
     }
 
+    /* Remixing and resampling is done on the whole decoded data, so it's
+       ignored in the streaming mode */
+    UnsignedInt outputFrequency = configuration().value<UnsignedInt>("outputFrequency");
+    UnsignedInt outputChannelCount = configuration().value<UnsignedInt>("outputChannelCount");
+    if(stream && (outputFrequency || outputChannelCount)) {
+        Warning{} << prefix << "outputFrequency and outputChannelCount options are ignored in the streaming mode";
+        outputFrequency = outputChannelCount = 0;
+    }
+    if(!outputFrequency) outputFrequency = samplerate;
+    if(!outputChannelCount) outputChannelCount = channels;
+    if(!Implementation::canRemixAudio(channels, outputChannelCount)) {
+        Error{} << prefix << "can't remix" << channels << "channels to" << outputChannelCount;
+        return;
+    }
+
+    /* The output is 16-bit stereo unless converted below */
+    _frameSize = 2*sizeof(UnsignedShort);
+    _frameOffset = 0;
+
+    /* In the streaming mode just keep the decoder open, frames get decoded
+       in readFrames() */
+    if(stream) {
+        _stream = Utility::move(stream);
+        return;
+    }
+
     /** @todo s there any way to get the sample count beforehand? the faad
         fronted does it by manually parsing the headers and NO WAY IN HELL i
         am doing that here: https://github.com/knik0/faad2/blob/7da4a83b230d069a9d731b1e64f6e6b52802576a/frontend/main.c#L613-L630 */
     std::size_t pos = result;
-    Containers::Array<UnsignedShort> samples;
+    Containers::Array<char> out;
     while(pos < data.size()) {
         NeAACDecFrameInfo info;
         void* sampleBuffer = NeAACDecDecode(decoder, &info, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data.data())) + pos, data.size() - pos);
         if(info.error) {
-            Error{} << "Audio::Faad2Importer::openData(): decoding error";
+            Error{} << prefix << "decoding error";
             return;
         }
 
-        Utility::copy(
-            {reinterpret_cast<UnsignedShort*>(sampleBuffer), info.samples},
-            arrayAppend(samples, NoInit, info.samples));
+        /* The samples are always 16-bit */
+        arrayAppend(out, {static_cast<const char*>(sampleBuffer), info.samples*2});
         pos += info.bytesconsumed;
     }
 
-    _samples = Utility::move(samples);
+    /* Remix and resample the decoded data if requested, the output is
+       floats then */
+    if(outputChannelCount != channels || outputFrequency != _frequency) {
+        out = Implementation::remixResampleAudio(out,
+            Implementation::AudioSampleType::Short, channels, _frequency,
+            outputChannelCount, outputFrequency);
+        _format = outputChannelCount == 1 ? BufferFormat::MonoFloat : BufferFormat::StereoFloat;
+        _frequency = outputFrequency;
+        _frameSize = outputChannelCount*sizeof(Float);
+    }
+
+    _data = Utility::move(out);
 }
 
-void Faad2Importer::doClose() { _samples = nullptr; }
+void Faad2Importer::doClose() {
+    _data = nullptr;
+    _stream = nullptr;
+}
 
 BufferFormat Faad2Importer::doFormat() const { return _format; }
 
 UnsignedInt Faad2Importer::doFrequency() const { return _frequency; }
 
 Containers::Array<char> Faad2Importer::doData() {
-    Containers::Array<char> copy{NoInit, _samples.size()*2};
-    Utility::copy(Containers::arrayCast<char>(_samples), copy);
+    /* In the streaming mode decode everything from the start and then go
+       back to where the stream was. The frame count isn't known upfront, so
+       the output has to be grown. */
+    if(_stream) {
+        const UnsignedLong frameOffset = _frameOffset;
+        if(!seek(0)) return {};
+        Containers::Array<char> out;
+        char chunk[4096*4];
+        for(std::size_t read; (read = readFrames(chunk)); )
+            arrayAppend(out, Containers::arrayView(chunk).prefix(read*4));
+        seek(frameOffset);
+        /* Convert to a default deleter to make plugin unloading safe */
+        arrayShrink(out, DefaultInit);
+        return out;
+    }
+
+    Containers::Array<char> copy{NoInit, _data.size()};
+    Utility::copy(_data, copy);
     return copy;
 }
 
+Containers::Array<char> Faad2Importer::releaseData() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::Faad2Importer::releaseData(): no file opened", {});
+
+    /* In the streaming mode there's nothing to release, decode everything */
+    Containers::Array<char> out;
+    if(_stream) out = doData();
+    else {
+        /* The data were assembled in a growable array, convert to a default
+           deleter to make plugin unloading safe */
+        out = Utility::move(_data);
+        arrayShrink(out, DefaultInit);
+    }
+
+    close();
+    return out;
+}
+
+UnsignedLong Faad2Importer::frameOffset() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::Faad2Importer::frameOffset(): no file opened", {});
+    return _frameOffset;
+}
+
+std::size_t Faad2Importer::readFrames(const Containers::ArrayView<char> data) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::Faad2Importer::readFrames(): no file opened", {});
+    /* In the streaming mode the output is always 16-bit stereo */
+    const std::size_t frameSize = _frameSize;
+    CORRADE_ASSERT(data.size() % frameSize == 0,
+        "Audio::Faad2Importer::readFrames(): expected size to be a multiple of" << frameSize << "bytes but got" << data.size(), {});
+
+    /* Non-streaming mode, copy the already decoded data */
+    if(!_stream) {
+        const std::size_t frameCount = Math::min(UnsignedLong(data.size()/frameSize), _data.size()/frameSize - _frameOffset);
+        Utility::copy(_data.sliceSize(_frameOffset*frameSize, frameCount*frameSize),
+            data.prefix(frameCount*frameSize));
+        _frameOffset += frameCount;
+        return frameCount;
+    }
+
+    const std::size_t frameCount = data.size()/frameSize;
+    std::size_t decodedFrameCount = 0;
+    while(decodedFrameCount != frameCount) {
+        /* Decode next AAC frame if the previous one was consumed. Frames can
+           have no samples, so this is done in a loop. */
+        if(_stream->sampleOffset == _stream->samples.size()) {
+            if(!_stream->decodeNextFrame("Audio::Faad2Importer::readFrames():"))
+                break;
+            continue;
+        }
+
+        const std::size_t count = Math::min(frameCount - decodedFrameCount, (_stream->samples.size() - _stream->sampleOffset)/2);
+        Utility::copy(
+            Containers::arrayCast<const char>(_stream->samples.sliceSize(_stream->sampleOffset, count*2)),
+            data.sliceSize(decodedFrameCount*frameSize, count*frameSize));
+        _stream->sampleOffset += count*2;
+        decodedFrameCount += count;
+    }
+
+    _frameOffset += decodedFrameCount;
+    return decodedFrameCount;
+}
+
+bool Faad2Importer::seek(const UnsignedLong frame) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::Faad2Importer::seek(): no file opened", {});
+
+    /* Non-streaming mode, just check the bounds */
+    if(!_stream) {
+        if(frame > _data.size()/_frameSize) {
+            Error{} << "Audio::Faad2Importer::seek(): frame" << frame << "out of range for" << _data.size()/_frameSize << "frames";
+            return false;
+        }
+
+        _frameOffset = frame;
+        return true;
+    }
+
+    /* There's no seek index, so when going back the decoding has to start
+       from the beginning. The header was successfully read already, but
+       with a file the seek or the read can still fail. */
+    if(frame < _frameOffset) {
+        if(!_stream->start()) {
+            Error{} << "Audio::Faad2Importer::seek(): seek to frame" << frame << "failed";
+            return false;
+        }
+        _frameOffset = 0;
+    }
+
+    /* Then decode and discard frames until the desired one is reached */
+    while(_frameOffset != frame) {
+        if(_stream->sampleOffset == _stream->samples.size()) {
+            if(!_stream->decodeNextFrame("Audio::Faad2Importer::seek():")) {
+                if(!_stream->failed)
+                    Error{} << "Audio::Faad2Importer::seek(): frame" << frame << "out of range for" << _frameOffset << "frames";
+                return false;
+            }
+            continue;
+        }
+
+        const std::size_t count = Math::min(std::size_t(frame - _frameOffset), (_stream->samples.size() - _stream->sampleOffset)/2);
+        _stream->sampleOffset += count*2;
+        _frameOffset += count;
+    }
+
+    return true;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(Faad2AudioImporter, Magnum::Audio::Faad2Importer,
@@ -31,6 +31,7 @@
  */
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "MagnumPlugins/Faad2AudioImporter/configure.h"
@@ -117,6 +118,62 @@ information.
 @section Audio-Faad2Importer-behavior Behavior and limitations
 
 The files are always imported with @ref BufferFormat::Stereo16.
+
+@subsection Audio-Faad2Importer-behavior-streaming Streaming decode
+
+By default the whole file is decoded in @ref openData() and @ref data()
+returns a copy of it. Enabling the @cb{.ini} streaming @ce
+@ref Audio-Faad2Importer-configuration "configuration option" makes
+@ref openData() and @ref openFile() parse just the header and keep the decoder
+open instead. With @ref openFile() the data are read from the file only as the
+decoder needs them, with @ref openData() the decoder operates on a copy of the
+data passed to it. Frames are then decoded in chunks of arbitrary size
+with @ref readFrames() into a buffer supplied by the caller and @ref seek()
+can be used to jump to an arbitrary frame. The output format is the same as
+with @ref data(). Calling @ref data() in streaming mode decodes the whole file
+without affecting the read position.
+
+Raw AAC streams contain neither the total frame count nor any seek index, so
+there's no @cpp frameCount() @ce function and @ref seek() decodes the file from
+the current position or, when seeking backwards, from the beginning.
+
+The @ref readFrames(), @ref seek() and @ref frameOffset() APIs work in the
+non-streaming mode as well, operating on the already decoded data. Because
+they're not a part of the @ref AbstractImporter interface, you need to link to
+the plugin directly and cast the importer instance to @ref Faad2Importer in
+order to call them.
+
+@subsection Audio-Faad2Importer-behavior-remix Remixing and resampling
+
+Setting the @cb{.ini} outputFrequency @ce and @cb{.ini} outputChannelCount @ce
+@ref Audio-Faad2Importer-configuration "configuration options" to a non-zero
+value converts the decoded data to given frequency and channel count in
+@ref openData(). As FAAD2 always decodes to stereo, only @cpp 1 @ce and
+@cpp 2 @ce are accepted for the channel count, which makes it possible to get
+the mono files back as actual mono. Converted data are imported as
+@ref BufferFormat::MonoFloat or @ref BufferFormat::StereoFloat and
+@ref frequency() reports the converted value. The options have no effect in
+the streaming mode, where a warning is printed instead.
+
+@subsection Audio-Faad2Importer-behavior-release Taking over the decoded data
+
+As the @ref AbstractImporter interface allows @ref data() to be called
+repeatedly, it always returns a copy of the decoded data. If the data are
+needed just once, for example to be uploaded to an audio buffer,
+@ref releaseData() hands over the internal buffer without copying and closes
+the file, avoiding a temporary that's as large as the whole decoded file.
+Same as with the streaming APIs, you need to link to the plugin directly in
+order to call it.
+
+@section Audio-Faad2Importer-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration().
+See below for all options and their default values:
+
+@snippet MagnumPlugins/Faad2AudioImporter/Faad2Importer.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_FAAD2AUDIOIMPORTER_EXPORT Faad2Importer: public AbstractImporter {
     public:
@@ -133,19 +190,69 @@ class MAGNUM_FAAD2AUDIOIMPORTER_EXPORT Faad2Importer: public AbstractImporter {
         /** @brief Plugin manager constructor */
         explicit Faad2Importer(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        ~Faad2Importer();
+
+        /**
+         * @brief Read position in frames
+         *
+         * Index of the frame that will be decoded by the next
+         * @ref readFrames() call. Is @cpp 0 @ce right after opening a file.
+         * Expects that a file is opened.
+         */
+        UnsignedLong frameOffset() const;
+
+        /**
+         * @brief Decode next frames
+         *
+         * Decodes as many frames as fit into @p data, or less if the end of
+         * the file is reached, in the same @ref format() as @ref data()
+         * returns, and advances @ref frameOffset() by the count of decoded
+         * frames. Returns the count of decoded frames, @cpp 0 @ce at the end
+         * of the file. Expects that a file is opened and that size of
+         * @p data is a multiple of the frame size.
+         */
+        std::size_t readFrames(Containers::ArrayView<char> data);
+
+        /**
+         * @brief Seek to a frame
+         *
+         * Sets @ref frameOffset() to @p frame. If @p frame is past the end
+         * of the file, decoding or seeking fails, prints a message to
+         * @relativeref{Magnum,Error}, returns @cpp false @ce and the read
+         * position is unspecified. Expects that a file is opened.
+         */
+        bool seek(UnsignedLong frame);
+
+        /**
+         * @brief Release the decoded data
+         *
+         * Unlike @ref data(), which returns a copy, gives up ownership of the
+         * decoded data and closes the file. In the streaming mode the whole
+         * file is decoded first, same as with @ref data(). Expects that a file
+         * is opened.
+         */
+        Containers::Array<char> releaseData();
+
     private:
+        struct Stream;
+
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL void doOpenData(Containers::ArrayView<const char> data) override;
+        MAGNUM_FAAD2AUDIOIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        MAGNUM_FAAD2AUDIOIMPORTER_LOCAL void openInternal(Containers::Pointer<Stream>&& stream, Containers::ArrayView<const char> data, const char* prefix);
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL void doClose() override;
 
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL BufferFormat doFormat() const override;
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL UnsignedInt doFrequency() const override;
         MAGNUM_FAAD2AUDIOIMPORTER_LOCAL Containers::Array<char> doData() override;
 
-        Containers::Array<UnsignedShort> _samples;
+        Containers::Array<char> _data;
+        Containers::Pointer<Stream> _stream;
         BufferFormat _format;
         UnsignedInt _frequency;
+        UnsignedInt _frameSize;
+        UnsignedLong _frameOffset;
 };
 
 }}
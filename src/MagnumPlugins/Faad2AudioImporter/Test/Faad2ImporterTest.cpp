@@ -26,9 +26,13 @@
 
 #include <string> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringStl.h> /** @todo remove once AbstractImporter is <string>-free */
+#include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
@@ -37,6 +41,10 @@
 
 #include "configure.h"
 
+#ifdef MAGNUM_FAAD2AUDIOIMPORTER_BUILD_STATIC
+#include "MagnumPlugins/Faad2AudioImporter/Faad2Importer.h"
+#endif
+
 namespace Magnum { namespace Audio { namespace Test { namespace {
 
 struct Faad2ImporterTest: TestSuite::Tester {
@@ -48,6 +56,16 @@ struct Faad2ImporterTest: TestSuite::Tester {
     void mono();
     void stereo();
 
+    void streaming();
+    void streamingSeek();
+    void streamingData();
+    void streamingFileNotFound();
+    void releaseData();
+
+    void remixResample();
+    void remixUnsupported();
+    void remixResampleStreaming();
+
     void openTwice();
     void importTwice();
 
@@ -55,12 +73,53 @@ struct Faad2ImporterTest: TestSuite::Tester {
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+} StreamingData[]{
+    {"mono", "mono.aac"},
+    {"stereo", "stereo.aac"},
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt outputChannelCount, outputFrequency;
+    BufferFormat format;
+    UnsignedInt frequency;
+    std::size_t size;
+    Containers::ArrayView<const Float> data;
+} RemixResampleData[]{
+    {"stereo to mono", "stereo.aac", 1, 0,
+        BufferFormat::MonoFloat, 44100, 1024*4, {}},
+    {"96 kHz to 48 kHz", "mono.aac", 0, 48000,
+        BufferFormat::StereoFloat, 48000, 512*2*4, {}},
+    {"back to mono, 96 kHz to 44.1 kHz", "mono.aac", 1, 44100,
+        BufferFormat::MonoFloat, 44100, 471*4, {}},
+    {"same channel count and frequency", "stereo.aac", 2, 44100,
+        BufferFormat::Stereo16, 44100, 1024*2*2, {}},
+};
+
 Faad2ImporterTest::Faad2ImporterTest() {
     addTests({&Faad2ImporterTest::empty,
 
               &Faad2ImporterTest::error,
               &Faad2ImporterTest::mono,
-              &Faad2ImporterTest::stereo,
+              &Faad2ImporterTest::stereo});
+
+    addInstancedTests({&Faad2ImporterTest::streaming},
+        Containers::arraySize(StreamingData));
+
+    addTests({&Faad2ImporterTest::streamingSeek,
+              &Faad2ImporterTest::streamingData,
+              &Faad2ImporterTest::streamingFileNotFound,
+              &Faad2ImporterTest::releaseData});
+
+    addInstancedTests({&Faad2ImporterTest::remixResample},
+        Containers::arraySize(RemixResampleData));
+
+    addTests({&Faad2ImporterTest::remixUnsupported,
+              &Faad2ImporterTest::remixResampleStreaming,
 
               &Faad2ImporterTest::openTwice,
               &Faad2ImporterTest::importTwice});
@@ -146,6 +205,189 @@ void Faad2ImporterTest::stereo() {
         (DebugTools::CompareImage{1.0f, 0.625f}));
 }
 
+void Faad2ImporterTest::streaming() {
+    auto&& data = StreamingData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, data.filename)));
+    const UnsignedInt frequency = importer->frequency();
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Pointer<AbstractImporter> streamingImporter = _manager.instantiate("Faad2AudioImporter");
+    streamingImporter->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(streamingImporter->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(streamingImporter->format(), BufferFormat::Stereo16);
+    CORRADE_COMPARE(streamingImporter->frequency(), frequency);
+
+    /* Decoding everything in the streaming mode should give the same result
+       as in the non-streaming mode. Both use the same decoder, so there's no
+       need for fuzzy comparison. */
+    CORRADE_COMPARE_AS(streamingImporter->data(), expected,
+        TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_FAAD2AUDIOIMPORTER_BUILD_STATIC
+    Faad2Importer& faad2Importer = static_cast<Faad2Importer&>(*streamingImporter);
+    CORRADE_COMPARE(faad2Importer.frameOffset(), 0);
+
+    /* Decode in chunks of 100 frames, the last chunk is shorter */
+    char out[100*4];
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = faad2Importer.readFrames(out)); )
+        arrayAppend(actual, Containers::arrayView(out).prefix(read*4));
+    CORRADE_COMPARE(faad2Importer.frameOffset(), 1024);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+    #endif
+}
+
+void Faad2ImporterTest::streamingSeek() {
+    #ifndef MAGNUM_FAAD2AUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    Containers::Array<char> expected = importer->data();
+
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    Faad2Importer& faad2Importer = static_cast<Faad2Importer&>(*importer);
+
+    char out[200*4];
+    CORRADE_VERIFY(faad2Importer.seek(512));
+    CORRADE_COMPARE(faad2Importer.frameOffset(), 512);
+    CORRADE_COMPARE(faad2Importer.readFrames(out), 200);
+    CORRADE_COMPARE(faad2Importer.frameOffset(), 712);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(512*4, 200*4),
+        TestSuite::Compare::Container);
+
+    /* Seeking back restarts the decoding from the beginning */
+    CORRADE_VERIFY(faad2Importer.seek(10));
+    CORRADE_COMPARE(faad2Importer.readFrames(out), 200);
+    CORRADE_COMPARE_AS(Containers::arrayView(out),
+        expected.sliceSize(10*4, 200*4),
+        TestSuite::Compare::Container);
+
+    /* Calling data() doesn't affect the read position */
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(faad2Importer.frameOffset(), 210);
+
+    /* Reading at the end gives back a partial chunk and then nothing */
+    CORRADE_VERIFY(faad2Importer.seek(924));
+    CORRADE_COMPARE(faad2Importer.readFrames(out), 100);
+    CORRADE_COMPARE_AS(Containers::arrayView(out).prefix(100*4),
+        expected.exceptPrefix(924*4),
+        TestSuite::Compare::Container);
+    CORRADE_COMPARE(faad2Importer.readFrames(out), 0);
+
+    /* Seeking to the end is fine, past it not. The frame count isn't known
+       upfront, so it's discovered by decoding. */
+    CORRADE_VERIFY(faad2Importer.seek(1024));
+    CORRADE_COMPARE(faad2Importer.readFrames(out), 0);
+
+    Containers::String outError;
+    Error redirectError{&outError};
+    CORRADE_VERIFY(!faad2Importer.seek(1025));
+    CORRADE_COMPARE(outError, "Audio::Faad2Importer::seek(): frame 1025 out of range for 1024 frames\n");
+    #endif
+}
+
+void Faad2ImporterTest::streamingData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac"));
+    CORRADE_VERIFY(data);
+
+    /* Unlike with openFile(), the decoder operates on a copy of the data, so
+       it should work even after the original memory is gone */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openData(*data));
+    *data = Containers::Array<char>{};
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void Faad2ImporterTest::streamingFileNotFound() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    importer->configuration().setValue("streaming", true);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile("nonexistent.aac"));
+    CORRADE_COMPARE(out, "Audio::Faad2Importer::openFile(): cannot open file nonexistent.aac\n");
+}
+
+void Faad2ImporterTest::releaseData() {
+    #ifndef MAGNUM_FAAD2AUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Faad2Importer::releaseData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    Containers::Array<char> expected = importer->data();
+
+    /* The released data should be the same as the copy and the file gets
+       closed */
+    Faad2Importer& faad2Importer = static_cast<Faad2Importer&>(*importer);
+    CORRADE_COMPARE_AS(faad2Importer.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+
+    /* In the streaming mode it decodes everything */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    CORRADE_COMPARE_AS(faad2Importer.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+    #endif
+}
+
+void Faad2ImporterTest::remixResample() {
+    auto&& data = RemixResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    importer->configuration().setValue("outputChannelCount", data.outputChannelCount);
+    importer->configuration().setValue("outputFrequency", data.outputFrequency);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, data.filename)));
+
+    CORRADE_COMPARE(importer->format(), data.format);
+    CORRADE_COMPARE(importer->frequency(), data.frequency);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), data.size);
+    if(!data.data.isEmpty())
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out), data.data,
+            TestSuite::Compare::Container);
+}
+
+void Faad2ImporterTest::remixUnsupported() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    importer->configuration().setValue("outputChannelCount", 6);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    CORRADE_COMPARE(out, "Audio::Faad2Importer::openData(): can't remix 2 channels to 6\n");
+}
+
+void Faad2ImporterTest::remixResampleStreaming() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
+    importer->configuration().setValue("streaming", true);
+    importer->configuration().setValue("outputFrequency", 22050);
+
+    /* The options are ignored, the file is imported as-is */
+    Containers::String out;
+    Warning redirectWarning{&out};
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(FAAD2AUDIOIMPORTER_TEST_DIR, "stereo.aac")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Stereo16);
+    CORRADE_COMPARE(importer->frequency(), 44100);
+    CORRADE_COMPARE(out, "Audio::Faad2Importer::openFile(): outputFrequency and outputChannelCount options are ignored in the streaming mode\n");
+}
+
 void Faad2ImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("Faad2AudioImporter");
 
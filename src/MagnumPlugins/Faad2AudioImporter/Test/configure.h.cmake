@@ -26,3 +26,4 @@
 
 #cmakedefine FAAD2AUDIOIMPORTER_PLUGIN_FILENAME "${FAAD2AUDIOIMPORTER_PLUGIN_FILENAME}"
 #define FAAD2AUDIOIMPORTER_TEST_DIR "${FAAD2AUDIOIMPORTER_TEST_DIR}"
+#cmakedefine MAGNUM_FAAD2AUDIOIMPORTER_BUILD_STATIC
@@ -26,22 +26,34 @@
 
 #include "FreeTypeFont.h"
 
+#include <atomic>
+#include <thread>
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
+#include FT_ADVANCES_H
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
+#include <Corrade/Containers/Triple.h>
 #include <Corrade/PluginManager/AbstractManager.h>
 #include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Unicode.h>
 #include <Magnum/Image.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/Text/AbstractGlyphCache.h>
 #include <Magnum/Text/AbstractShaper.h>
 #include <Magnum/TextureTools/Atlas.h>
 
+/* FT_RENDER_MODE_SDF and the sdf / bsdf renderer modules are since 2.11 */
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define MAGNUM_FREETYPEFONT_HAS_SDF
+#endif
+
 namespace Magnum { namespace Text {
 
 #ifndef FT_CONFIG_OPTION_ERROR_STRINGS
@@ -130,11 +142,62 @@ void FreeTypeFont::doClose() {
     CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Done_Face(_ftFont) == 0);
     _data = nullptr;
     _ftFont = nullptr;
+    _bmpGlyphIds = nullptr;
+    _glyphAdvances = nullptr;
+    _glyphAdvanceBatchesLoaded = Containers::BitArray{};
+}
+
+UnsignedInt FreeTypeFont::glyphIdForCharacter(const char32_t character) {
+    /* Characters outside of BMP and fonts with glyph IDs not fitting into 16
+       bits go through FreeType directly */
+    if(character >= 0x10000 || _ftFont->num_glyphs > 0x10000)
+        return FT_Get_Char_Index(_ftFont, character);
+
+    /* On first use, populate the whole BMP table from the active charmap.
+       Iterating the charmap visits just the characters that are actually
+       mapped, characters not in the font stay at glyph 0 same as what
+       FT_Get_Char_Index() returns for them. */
+    if(_bmpGlyphIds.isEmpty()) {
+        _bmpGlyphIds = Containers::Array<UnsignedShort>{ValueInit, 0x10000};
+        FT_UInt glyph;
+        for(FT_ULong c = FT_Get_First_Char(_ftFont, &glyph); glyph && c < 0x10000; c = FT_Get_Next_Char(_ftFont, c, &glyph))
+            _bmpGlyphIds[c] = glyph;
+    }
+
+    return _bmpGlyphIds[character];
+}
+
+Float FreeTypeFont::glyphAdvanceX(const UnsignedInt glyph) {
+    /* Advances are queried in batches of this many glyphs, which amortizes
+       the per-call overhead of FT_Get_Advances() */
+    constexpr UnsignedInt BatchSize = 64;
+
+    if(_glyphAdvances.isEmpty()) {
+        _glyphAdvances = Containers::Array<Float>{NoInit, std::size_t(_ftFont->num_glyphs)};
+        _glyphAdvanceBatchesLoaded = Containers::BitArray{ValueInit, (std::size_t(_ftFont->num_glyphs) + BatchSize - 1)/BatchSize};
+    }
+
+    const UnsignedInt batch = glyph/BatchSize;
+    if(!_glyphAdvanceBatchesLoaded[batch]) {
+        const UnsignedInt begin = batch*BatchSize;
+        const UnsignedInt count = Math::min(BatchSize, UnsignedInt(_ftFont->num_glyphs) - begin);
+        /* With hinting enabled, which is the case for FT_LOAD_DEFAULT, this
+           loads the glyphs internally to get the same advances as
+           FT_Load_Glyph() would. The returned values are 16.16 fixed
+           point. */
+        FT_Fixed advances[BatchSize];
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Get_Advances(_ftFont, begin, count, FT_LOAD_DEFAULT, advances) == 0);
+        for(UnsignedInt i = 0; i != count; ++i)
+            _glyphAdvances[begin + i] = advances[i]/65536.0f;
+        _glyphAdvanceBatchesLoaded.set(batch);
+    }
+
+    return _glyphAdvances[glyph];
 }
 
 void FreeTypeFont::doGlyphIdsInto(const Containers::StridedArrayView1D<const char32_t>& characters, const Containers::StridedArrayView1D<UnsignedInt>& glyphs) {
     for(std::size_t i = 0; i != characters.size(); ++i)
-        glyphs[i] = FT_Get_Char_Index(_ftFont, characters[i]);
+        glyphs[i] = glyphIdForCharacter(characters[i]);
 }
 
 Containers::String FreeTypeFont::doGlyphName(const UnsignedInt glyph) {
@@ -162,8 +225,8 @@ Vector2 FreeTypeFont::doGlyphSize(const UnsignedInt glyph) {
 }
 
 Vector2 FreeTypeFont::doGlyphAdvance(const UnsignedInt glyph) {
-    CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Load_Glyph(_ftFont, glyph, FT_LOAD_DEFAULT) == 0);
-    return Vector2(_ftFont->glyph->advance.x, _ftFont->glyph->advance.y)/64.0f;
+    /* The layout is always horizontal, so there's no Y advance */
+    return {glyphAdvanceX(glyph), 0.0f};
 }
 
 bool FreeTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containers::StridedArrayView1D<const UnsignedInt>& glyphIndices) {
@@ -172,21 +235,102 @@ bool FreeTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containers:
         return {};
     }
 
+    /* If distance field spread is set, glyphs are rendered as signed distance
+       fields directly */
+    const UnsignedInt distanceFieldSpread = configuration().value<UnsignedInt>("distanceFieldSpread");
+    #ifdef MAGNUM_FREETYPEFONT_HAS_SDF
+    if(distanceFieldSpread) {
+        /* The limits are what the sdf module accepts */
+        if(distanceFieldSpread < 2 || distanceFieldSpread > 32) {
+            Error{} << "Text::FreeTypeFont::fillGlyphCache(): expected distance field spread to be between 2 and 32 pixels but got" << distanceFieldSpread;
+            return {};
+        }
+
+        /* The spread is a property of the renderer module, which is shared
+           by all faces in the library. Set it for both the outline and
+           bitmap variant. */
+        const FT_Int spread = distanceFieldSpread;
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Property_Set(_library, "sdf", "spread", &spread) == 0);
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Property_Set(_library, "bsdf", "spread", &spread) == 0);
+    }
+    const FT_Render_Mode renderMode = distanceFieldSpread ? FT_RENDER_MODE_SDF : FT_RENDER_MODE_NORMAL;
+    #else
+    if(distanceFieldSpread) {
+        Error{} << "Text::FreeTypeFont::fillGlyphCache(): distance field rendering requires FreeType 2.11 or newer";
+        return {};
+    }
+    const FT_Render_Mode renderMode = FT_RENDER_MODE_NORMAL;
+    #endif
+
     /* Register this font, if not in the cache yet */
     Containers::Optional<UnsignedInt> fontId = cache.findFont(*this);
     if(!fontId)
         fontId = cache.addFont(_ftFont->num_glyphs, this);
 
-    /* Get sizes of all glyphs to pack into the cache */
+    /* Value of 0 means all available cores, there's no point in having more
+       threads than there are glyphs */
+    UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+    if(!threadCount)
+        threadCount = std::thread::hardware_concurrency();
+    threadCount = Math::clamp<UnsignedInt>(threadCount, 1, Math::max(glyphIndices.size(), std::size_t{1}));
+
+    /* An FT_Face can't be used from multiple threads at once, so each
+       additional thread gets its own face on the same memory. Creating faces
+       isn't thread-safe either, so it's done here. */
+    Containers::Array<FT_Face> faces{ValueInit, threadCount};
+    faces[0] = _ftFont;
+    for(UnsignedInt i = 1; i != threadCount; ++i) {
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_New_Memory_Face(_library, _data.begin(), _data.size(), 0, &faces[i]) == 0);
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Set_Char_Size(faces[i], 0, size()*64, 0, 0) == 0);
+    }
+
+    /* Each worker picks the next glyph that isn't taken yet, loads and
+       renders it and appends the bitmap, Y-flipped and without row padding,
+       to its own storage. The packed location isn't known yet, so the glyphs
+       get copied to the atlas only after all are rendered, which means each
+       glyph is loaded just once and the layout is calculated from the exact
+       rendered sizes. */
     struct Glyph {
         Vector2i size;
         Vector3i offset;
+        Vector2i position;
+        UnsignedInt thread;
+        std::size_t dataOffset;
     };
     Containers::Array<Glyph> glyphs{NoInit, glyphIndices.size()};
-    for(std::size_t i = 0; i != glyphIndices.size(); ++i) {
-        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Load_Glyph(_ftFont, glyphIndices[i], FT_LOAD_DEFAULT) == 0);
-        glyphs[i].size = Vector2i{Int(_ftFont->glyph->metrics.width), Int(_ftFont->glyph->metrics.height)}/64;
-    }
+    Containers::Array<Containers::Array<char>> glyphData{threadCount};
+    std::atomic<std::size_t> nextGlyph{0};
+    auto worker = [&](const UnsignedInt thread) {
+        const FT_GlyphSlot slot = faces[thread]->glyph;
+        std::size_t i;
+        while((i = nextGlyph++) < glyphs.size()) {
+            /** @todo B&W only if radius != 0 */
+            CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Load_Glyph(faces[thread], glyphIndices[i], FT_LOAD_DEFAULT) == 0);
+            CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Render_Glyph(slot, renderMode) == 0);
+
+            const FT_Bitmap& bitmap = slot->bitmap;
+            Glyph& glyph = glyphs[i];
+            glyph.size = {Int(bitmap.width), Int(bitmap.rows)};
+            glyph.position = {slot->bitmap_left, slot->bitmap_top - Int(bitmap.rows)};
+            glyph.thread = thread;
+            glyph.dataOffset = glyphData[thread].size();
+
+            const Containers::Size2D size{bitmap.rows, bitmap.width};
+            Utility::copy(
+                Containers::StridedArrayView2D<const char>{{reinterpret_cast<const char*>(bitmap.buffer), ~std::size_t{}}, size, {std::ptrdiff_t(bitmap.pitch), 1}}.flipped<0>(),
+                Containers::StridedArrayView2D<char>{arrayAppend(glyphData[thread], NoInit, size.product()), size});
+        }
+    };
+
+    Containers::Array<std::thread> threads{threadCount - 1};
+    for(UnsignedInt i = 0; i != threads.size(); ++i)
+        threads[i] = std::thread{worker, i + 1};
+    worker(0);
+    for(std::thread& thread: threads)
+        thread.join();
+
+    for(UnsignedInt i = 1; i != threadCount; ++i)
+        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Done_Face(faces[i]) == 0);
 
     /* Pack the cache */
     const Vector3i cacheFilledSize = cache.atlas().filledSize();
@@ -203,29 +347,24 @@ bool FreeTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containers:
         return {};
     }
 
-    /* Render all glyphs to the atlas and create a glyph map */
+    /* Copy the rendered bitmaps to their packed locations */
     const Containers::StridedArrayView3D<char> dst = cache.image().pixels<char>();
-    for(std::size_t i = 0; i != glyphs.size(); ++i) {
-        /* Load and render the glyph */
-        const FT_GlyphSlot glyph = _ftFont->glyph;
-        /** @todo B&W only if radius != 0 */
-        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Load_Glyph(_ftFont, glyphIndices[i], FT_LOAD_DEFAULT) == 0);
-        CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL) == 0);
-
-        /* Copy the rendered glyph Y-flipped to the destination image */
-        const FT_Bitmap& bitmap = glyph->bitmap;
-        const Containers::Size2D glyphSize{bitmap.rows, bitmap.width};
+    for(const Glyph& glyph: glyphs) {
+        const Containers::Size2D size{std::size_t(glyph.size.y()),
+                                      std::size_t(glyph.size.x())};
         Utility::copy(
-            Containers::StridedArrayView2D<const char>{{reinterpret_cast<const char*>(bitmap.buffer), ~std::size_t{}}, glyphSize}.flipped<0>(),
-            dst[glyphs[i].offset.z()]
-                .sliceSize({std::size_t(glyphs[i].offset.y()),
-                            std::size_t(glyphs[i].offset.x())}, glyphSize));
-
-        /* Insert glyph parameters into the cache */
-        cache.addGlyph(*fontId, glyphIndices[i],
-            Vector2i{glyph->bitmap_left, glyph->bitmap_top - glyphs[i].size.y()},
-            glyphs[i].offset.z(),
-            Range2Di::fromSize(glyphs[i].offset.xy(), glyphs[i].size));
+            Containers::StridedArrayView2D<const char>{glyphData[glyph.thread].sliceSize(glyph.dataOffset, size.product()), size},
+            dst[glyph.offset.z()]
+                .sliceSize({std::size_t(glyph.offset.y()),
+                            std::size_t(glyph.offset.x())}, size));
+    }
+
+    /* Insert glyph parameters into the cache */
+    for(std::size_t i = 0; i != glyphs.size(); ++i) {
+        const Glyph& glyph = glyphs[i];
+        cache.addGlyph(*fontId, glyphIndices[i], glyph.position,
+            glyph.offset.z(),
+            Range2Di::fromSize(glyph.offset.xy(), glyph.size));
     }
 
     /* Flush the updated cache image */
@@ -239,17 +378,20 @@ Containers::Pointer<AbstractShaper> FreeTypeFont::doCreateShaper() {
         using AbstractShaper::AbstractShaper;
 
         UnsignedInt doShape(const Containers::StringView textFull, const UnsignedInt begin, const UnsignedInt end, Containers::ArrayView<const FeatureRange>) override {
-            const FT_Face ftFont = static_cast<const FreeTypeFont&>(font())._ftFont;
+            FreeTypeFont& font = static_cast<FreeTypeFont&>(this->font());
             const Containers::StringView text = textFull.slice(begin, end == ~UnsignedInt{} ? textFull.size() : end);
 
-            /* Get glyph codes from characters */
+            /* Get glyph codes from characters, and their advances, both
+               going through the lookup tables in the font */
             arrayResize(_glyphs, 0);
             arrayReserve(_glyphs, text.size());
             for(std::size_t i = 0; i != text.size(); ) {
                 const Containers::Pair<char32_t, std::size_t> codepointNext = Utility::Unicode::nextChar(text, i);
+                const UnsignedInt glyph = font.glyphIdForCharacter(codepointNext.first());
                 arrayAppend(_glyphs, InPlaceInit,
-                    FT_Get_Char_Index(ftFont, codepointNext.first()),
-                    begin + UnsignedInt(i));
+                    glyph,
+                    begin + UnsignedInt(i),
+                    font.glyphAdvanceX(glyph));
                 i = codepointNext.second();
             }
 
@@ -257,32 +399,24 @@ Containers::Pointer<AbstractShaper> FreeTypeFont::doCreateShaper() {
         }
 
         void doGlyphIdsInto(const Containers::StridedArrayView1D<UnsignedInt>& ids) const override {
-            Utility::copy(stridedArrayView(_glyphs).slice(&Containers::Pair<UnsignedInt, UnsignedInt>::first), ids);
+            Utility::copy(stridedArrayView(_glyphs).slice(&Containers::Triple<UnsignedInt, UnsignedInt, Float>::first), ids);
         }
         void doGlyphOffsetsAdvancesInto(const Containers::StridedArrayView1D<Vector2>& offsets, const Containers::StridedArrayView1D<Vector2>& advances) const override {
-            const FT_Face ftFont = static_cast<const FreeTypeFont&>(font())._ftFont;
-
             for(std::size_t i = 0; i != _glyphs.size(); ++i) {
                 /* There's no glyph offsets in addition to advances */
                 /** @todo there's horiBearingX and horiBearingY in
                     FT_Glyph_Metrics, isn't that the offset? */
                 offsets[i] = {};
-
-                /* Load the glyph to get its advance */
-                /** @todo HarfBuzz uses Ft_Get_Advance instead of
-                    FT_Load_Glyph, might be faster and with less allocations?
-                    https://freetype.org/freetype2/docs/reference/ft2-quick_advance.html */
-                CORRADE_INTERNAL_ASSERT_OUTPUT(FT_Load_Glyph(ftFont, _glyphs[i].first(), FT_LOAD_DEFAULT) == 0);
-                const FT_GlyphSlot slot = ftFont->glyph;
-                advances[i] = Vector2{Float(slot->advance.x),
-                                      Float(slot->advance.y)}/64.0f;
+                /* The layout is always horizontal, so there's no Y advance */
+                advances[i] = {_glyphs[i].third(), 0.0f};
             }
         }
         void doGlyphClustersInto(const Containers::StridedArrayView1D<UnsignedInt>& clusters) const override {
-            Utility::copy(stridedArrayView(_glyphs).slice(&Containers::Pair<UnsignedInt, UnsignedInt>::second), clusters);
+            Utility::copy(stridedArrayView(_glyphs).slice(&Containers::Triple<UnsignedInt, UnsignedInt, Float>::second), clusters);
         }
 
-        Containers::Array<Containers::Pair<UnsignedInt, UnsignedInt>> _glyphs;
+        /* Glyph ID, cluster and advance */
+        Containers::Array<Containers::Triple<UnsignedInt, UnsignedInt, Float>> _glyphs;
     };
 
     return Containers::pointer<Shaper>(*this);
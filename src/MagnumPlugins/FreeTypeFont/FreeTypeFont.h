@@ -31,6 +31,7 @@
  */
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/BitArray.h>
 #include <Corrade/Utility/Macros.h> /* CORRADE_THREAD_LOCAL */
 #include <Corrade/Utility/VisibilityMacros.h>
 #include <Magnum/Text/AbstractFont.h>
@@ -154,6 +155,42 @@ need these.
 While FreeType provides access to font kerning tables, the plugin doesn't use
 them at the moment. The feature list passed to @ref AbstractShaper::shape() is
 ignored.
+
+@subsection Text-FreeTypeFont-behavior-glyph-cache Glyph cache filling
+
+In @ref fillGlyphCache(), each glyph is loaded and rendered just once, with
+the rendered bitmaps kept in a temporary buffer until the atlas layout is
+calculated from their sizes and then copied to the cache. By default the
+glyphs are rendered on the calling thread. Setting the @cb{.ini} threads @ce
+@ref Text-FreeTypeFont-configuration "configuration option" to a value other
+than @cpp 1 @ce distributes the rendering across multiple threads, each of them
+using its own FreeType face created on the same font data. Setting it to
+@cpp 0 @ce uses all available hardware threads.
+
+@subsection Text-FreeTypeFont-behavior-distance-field Distance field rendering
+
+If the @cb{.ini} distanceFieldSpread @ce
+@ref Text-FreeTypeFont-configuration "configuration option" is set to a
+non-zero value, @ref fillGlyphCache() renders the glyphs directly as signed
+distance fields using @m_class{m-doc-external} [FT_RENDER_MODE_SDF](https://freetype.org/freetype2/docs/reference/ft2-glyph_retrieval.html#ft_render_mode),
+instead of rendering coverage that would need a separate distance field pass
+over a large upscaled glyph cache. Each glyph rectangle is then larger by the
+spread on each side, the glyph edge is at the value of @cpp 0.5 @ce and values
+above are inside the glyph. The spread is expected to be between @cpp 2 @ce
+and @cpp 32 @ce, which is what FreeType supports. The feature is available
+only with FreeType 2.11 and newer, with older versions
+@ref fillGlyphCache() prints a message to @relativeref{Magnum,Error} and
+returns @cpp false @ce if the option is set.
+
+@section Text-FreeTypeFont-configuration Plugin-specific configuration
+
+It's possible to tune various options mainly for glyph cache filling through
+@ref configuration(). See below for all options and their default values:
+
+@snippet MagnumPlugins/FreeTypeFont/FreeTypeFont.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_FREETYPEFONT_EXPORT FreeTypeFont: public AbstractFont {
     public:
@@ -213,6 +250,15 @@ class MAGNUM_FREETYPEFONT_EXPORT FreeTypeFont: public AbstractFont {
         bool doFillGlyphCache(AbstractGlyphCache& cache, const Containers::StridedArrayView1D<const UnsignedInt>& glyphs) override;
 
         MAGNUM_FREETYPEFONT_LOCAL Containers::Pointer<AbstractShaper> doCreateShaper() override;
+
+        MAGNUM_FREETYPEFONT_LOCAL UnsignedInt glyphIdForCharacter(char32_t character);
+        MAGNUM_FREETYPEFONT_LOCAL Float glyphAdvanceX(UnsignedInt glyph);
+
+        /* Lazily populated lookup tables, glyph IDs for the whole Basic
+           Multilingual Plane and glyph advances filled in batches */
+        Containers::Array<UnsignedShort> _bmpGlyphIds;
+        Containers::Array<Float> _glyphAdvances;
+        Containers::BitArray _glyphAdvanceBatchesLoaded;
 };
 
 }}
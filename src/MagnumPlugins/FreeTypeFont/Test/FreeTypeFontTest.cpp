@@ -24,6 +24,7 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
@@ -31,8 +32,11 @@
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/ImageView.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/DebugTools/CompareImage.h>
 #include <Magnum/Text/AbstractFont.h>
@@ -40,6 +44,9 @@
 #include <Magnum/Text/AbstractShaper.h>
 #include <Magnum/Trade/AbstractImporter.h>
 
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
 #include "configure.h"
 
 namespace Magnum { namespace Text { namespace Test { namespace {
@@ -62,6 +69,8 @@ struct FreeTypeFontTest: TestSuite::Tester {
     void fillGlyphCacheArray();
     void fillGlyphCacheInvalidFormat();
     void fillGlyphCacheCannotFit();
+    void fillGlyphCacheDistanceField();
+    void fillGlyphCacheDistanceFieldInvalidSpread();
 
     void openTwice();
 
@@ -97,18 +106,25 @@ const struct {
 const struct {
     const char* name;
     const char* characters;
+    UnsignedInt threads;
 } FillGlyphCacheData[]{
     {"",
         /* Including also UTF-8 characters to be sure they're handled
            properly */
-        "abcdefghijklmnopqrstuvwxyzěšč"},
+        "abcdefghijklmnopqrstuvwxyzěšč", 1},
     {"shuffled order",
-        "mvxěipbryzdhfnqlčjšswutokeacg"},
+        "mvxěipbryzdhfnqlčjšswutokeacg", 1},
     {"duplicates",
-        "mvexěipbbrzzyčbjzdgšhhfnqljswutokeakcg"},
+        "mvexěipbbrzzyčbjzdgšhhfnqljswutokeakcg", 1},
     {"characters not in font",
         /* ☃ */
-        "abcdefghijkl\xe2\x98\x83mnopqrstuvwxyzěšč"},
+        "abcdefghijkl\xe2\x98\x83mnopqrstuvwxyzěšč", 1},
+    {"three threads",
+        "abcdefghijklmnopqrstuvwxyzěšč", 3},
+    {"more threads than glyphs",
+        "abcdefghijklmnopqrstuvwxyzěšč", 64},
+    {"all hardware threads",
+        "mvexěipbbrzzyčbjzdgšhhfnqljswutokeakcg", 0},
 };
 
 FreeTypeFontTest::FreeTypeFontTest() {
@@ -133,6 +149,8 @@ FreeTypeFontTest::FreeTypeFontTest() {
               &FreeTypeFontTest::fillGlyphCacheArray,
               &FreeTypeFontTest::fillGlyphCacheInvalidFormat,
               &FreeTypeFontTest::fillGlyphCacheCannotFit,
+              &FreeTypeFontTest::fillGlyphCacheDistanceField,
+              &FreeTypeFontTest::fillGlyphCacheDistanceFieldInvalidSpread,
 
               &FreeTypeFontTest::openTwice});
 
@@ -187,6 +205,35 @@ void FreeTypeFontTest::properties() {
     CORRADE_COMPARE(font->glyphId(U'W'), 58);
     CORRADE_COMPARE(font->glyphSize(58), Vector2(18.0f, 12.0f));
     CORRADE_COMPARE(font->glyphAdvance(58), Vector2(17.0f, 0.0f));
+
+    /* Characters not in the font map to glyph 0 both inside and outside of
+       the BMP, which are looked up differently */
+    CORRADE_COMPARE(font->glyphId(U'\u2603'), 0);
+    CORRADE_COMPARE(font->glyphId(U'\U0001F600'), 0);
+
+    /* The last glyph is in a batch of advances that's shorter than the
+       others. The advances are queried with FT_Get_Advances(), verify they
+       match what FT_Load_Glyph() gives for the same glyph and size. */
+    {
+        Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"));
+        CORRADE_VERIFY(data);
+
+        FT_Library library;
+        CORRADE_COMPARE(FT_Init_FreeType(&library), 0);
+        FT_Face face;
+        CORRADE_COMPARE(FT_New_Memory_Face(library, reinterpret_cast<const FT_Byte*>(data->data()), data->size(), 0, &face), 0);
+        CORRADE_COMPARE(FT_Set_Char_Size(face, 0, 16*64, 0, 0), 0);
+
+        for(UnsignedInt glyph: {58u, 670u}) {
+            CORRADE_ITERATION(glyph);
+            CORRADE_COMPARE(FT_Load_Glyph(face, glyph, FT_LOAD_DEFAULT), 0);
+            CORRADE_COMPARE(font->glyphAdvance(glyph), Vector2(face->glyph->advance.x/64.0f, 0.0f));
+        }
+        CORRADE_COMPARE(font->glyphAdvance(670), Vector2(7.0f, 0.0f));
+
+        CORRADE_COMPARE(FT_Done_Face(face), 0);
+        CORRADE_COMPARE(FT_Done_FreeType(library), 0);
+    }
 }
 
 void FreeTypeFontTest::glyphNames() {
@@ -381,6 +428,7 @@ void FreeTypeFontTest::fillGlyphCache() {
         CORRADE_SKIP("PngImporter plugin not found, cannot test");
 
     Containers::Pointer<AbstractFont> font = _manager.instantiate("FreeTypeFont");
+    font->configuration().setValue("threads", data.threads);
     CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
 
     struct GlyphCache: AbstractGlyphCache {
@@ -657,6 +705,79 @@ void FreeTypeFontTest::fillGlyphCacheCannotFit() {
     CORRADE_COMPARE(out, "Text::FreeTypeFont::fillGlyphCache(): cannot fit 5 glyphs with a total area of 535 pixels into a cache of size Vector(16, 32, 1) and Vector(16, 0, 1) filled so far\n");
 }
 
+void FreeTypeFontTest::fillGlyphCacheDistanceField() {
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("FreeTypeFont");
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    struct GlyphCache: AbstractGlyphCache {
+        explicit GlyphCache(PixelFormat format, const Vector2i& size, const Vector2i& padding): AbstractGlyphCache{format, size, padding} {}
+
+        GlyphCacheFeatures doFeatures() const override { return {}; }
+        void doSetImage(const Vector3i&, const ImageView3D&) override {}
+    } coverageCache{PixelFormat::R8Unorm, {64, 64}, {}},
+      cache{PixelFormat::R8Unorm, {64, 64}, {}};
+
+    /* Fill a coverage cache first to compare the glyph properties to */
+    CORRADE_VERIFY(font->fillGlyphCache(coverageCache, "k"));
+
+    font->configuration().setValue("distanceFieldSpread", 4);
+    {
+        Containers::String out;
+        Error redirectError{&out};
+        bool filled = font->fillGlyphCache(cache, "k");
+        if(!filled && out.contains("requires FreeType 2.11"))
+            CORRADE_SKIP("FreeType 2.11+ is needed for distance field rendering.");
+        CORRADE_VERIFY(filled);
+    }
+
+    /* The glyph rectangle is larger by the spread on each side and the offset
+       is shifted by it */
+    Containers::Triple<Vector2i, Int, Range2Di> coverage = coverageCache.glyph(0, font->glyphId('k'));
+    Containers::Triple<Vector2i, Int, Range2Di> k = cache.glyph(0, font->glyphId('k'));
+    CORRADE_COMPARE(k.first(), coverage.first() - Vector2i{4});
+    CORRADE_COMPARE(k.third().size(), coverage.third().size() + Vector2i{8});
+
+    /* The rectangle corners are further than the spread from the outline,
+       thus fully outside, while the stems are inside */
+    const Containers::StridedArrayView2D<const UnsignedByte> pixels = cache.image().pixels<UnsignedByte>()[0].sliceSize(
+        {std::size_t(k.third().min().y()),
+         std::size_t(k.third().min().x())},
+        {std::size_t(k.third().sizeY()),
+         std::size_t(k.third().sizeX())});
+    CORRADE_COMPARE(pixels[0][0], 0);
+    CORRADE_COMPARE(pixels[pixels.size()[0] - 1][pixels.size()[1] - 1], 0);
+    UnsignedByte max = 0;
+    for(Containers::StridedArrayView1D<const UnsignedByte> row: pixels)
+        for(UnsignedByte value: row)
+            max = Math::max(max, value);
+    CORRADE_COMPARE_AS(max, 128,
+        TestSuite::Compare::Greater);
+}
+
+void FreeTypeFontTest::fillGlyphCacheDistanceFieldInvalidSpread() {
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("FreeTypeFont");
+    font->configuration().setValue("distanceFieldSpread", 33);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    struct GlyphCache: AbstractGlyphCache {
+        explicit GlyphCache(PixelFormat format, const Vector2i& size, const Vector2i& padding): AbstractGlyphCache{format, size, padding} {}
+
+        GlyphCacheFeatures doFeatures() const override { return {}; }
+        void doSetImage(const Vector3i&, const ImageView3D&) override {
+            CORRADE_FAIL("This shouldn't be called.");
+        }
+    } cache{PixelFormat::R8Unorm, {16, 16}, {}};
+
+    Containers::String out;
+    {
+        Error redirectError{&out};
+        CORRADE_VERIFY(!font->fillGlyphCache(cache, "k"));
+    }
+    if(out.contains("requires FreeType 2.11"))
+        CORRADE_SKIP("FreeType 2.11+ is needed for distance field rendering.");
+    CORRADE_COMPARE(out, "Text::FreeTypeFont::fillGlyphCache(): expected distance field spread to be between 2 and 32 pixels but got 33\n");
+}
+
 void FreeTypeFontTest::openTwice() {
     Containers::Pointer<AbstractFont> font = _manager.instantiate("FreeTypeFont");
 
@@ -26,6 +26,11 @@
 
 #include "GlslangConverter.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayView.h>
@@ -35,11 +40,14 @@
 #include <Corrade/Containers/StaticArray.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringIterable.h>
+#include <Corrade/Containers/StringStl.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/FormatStl.h>
 #include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/Sha1.h>
 #include <Magnum/FileCallback.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/ShaderTools/Stage.h>
 
 #include <glslang/Public/ShaderLang.h> /* Haha what the fuck this name */
@@ -84,6 +92,9 @@ struct GlslangConverter::State {
     std::string definitions;
 
     Containers::String debugInfo;
+
+    /* Compilation cache statistics, reported in verbose mode */
+    std::size_t cacheHits{}, cacheMisses{};
 };
 
 void GlslangConverter::initialize() {
@@ -374,59 +385,7 @@ struct Includer: glslang::TShader::Includer {
         std::unordered_map<std::string, Containers::Pair<Containers::ArrayView<const char>, std::size_t>> _references;
 };
 
-Containers::Pair<bool, bool> compileAndLinkShader(glslang::TShader& shader, glslang::TProgram& program, const Utility::ConfigurationGroup& configuration, const ConverterFlags flags, const Containers::Pair<int, EProfile> inputVersion, const OutputVersion outputVersion, const bool versionExplicitlySpecified, const Containers::StringView definitions, const Containers::StringView filename, Containers::Optional<Containers::ArrayView<const char>>(*const fileCallback)(const std::string&, InputFileCallbackPolicy, void*), void* const fileCallbackUserData, const Containers::ArrayView<const char> data, Int messages) {
-    /* Add preprocessor definitions */
-    shader.setPreamble(definitions.data());
-
-    /* Add the actual shader source. We're not making use of the
-       multiple-source inputs here, it would only further complicate the plugin
-       interface. Google's shaderc does the same, and glslangValidator (WHAT A
-       NAME!!) seems to do that also, but its API is too confusing so I can't
-       tell for sure. If we're validating/compiling a file, the name gets used
-       in potential error messages. */
-    const char* string = data.data();
-    int length = data.size();
-    const char* filenames = filename.data();
-    shader.setStringsWithLengthsAndNames(&string, &length, filename.isEmpty() ? nullptr : &filenames, 1);
-
-    /* Set up the includer -- if we have callbacks, simply use those */
-    Containers::Optional<Includer> includer;
-    std::unordered_map<std::string, Containers::Array<char>> files;
-    if(fileCallback) {
-        includer.emplace(fileCallback, fileCallbackUserData);
-
-    /* Otherwise, if we have filename, build an includer from the filesystem */
-    } else if(!filename.isEmpty()) {
-        includer.emplace([](const std::string& filename, InputFileCallbackPolicy policy, void* userData) -> Containers::Optional<Containers::ArrayView<const char>> {
-            auto& files = *static_cast<std::unordered_map<std::string, Containers::Array<char>>*>(userData);
-            auto found = files.find(filename);
-
-            /* Discard the loaded file, if not needed anymore */
-            if(policy == InputFileCallbackPolicy::Close) {
-                CORRADE_INTERNAL_ASSERT(found != files.end());
-                files.erase(found);
-                return {};
-            }
-
-            /* Read if not there yet */
-            if(found == files.end()) {
-                Containers::Optional<Containers::Array<char>> file = Utility::Path::read(filename);
-                if(!file)
-                    return {};
-
-                found = files.emplace(filename, *Utility::move(file)).first;
-            }
-
-            return Containers::ArrayView<const char>{found->second};
-        }, &files);
-
-    /* Otherwise we can't load files in any way */
-    }
-
-    /** @todo ability to override entrypoint name (for linking multiple same
-        stages together), for some reason not working in glslang, only for
-        hlsl */
-
+TBuiltInResource builtinResources(const Utility::ConfigurationGroup& configuration) {
     /* Set up builtin values and resource limits. There's no default
        constructor for that thing so we'd have to populate it either way, even
        if not exposing any of these. Sigh.
@@ -436,6 +395,10 @@ Containers::Pair<bool, bool> compileAndLinkShader(glslang::TShader& shader, glsl
        Update when neccessary -- the last member is commented out because it's
        not in 8.13.3743 yet */
     TBuiltInResource resources;
+    /* Zero-initialize everything including padding and members not
+       populated below, so the whole struct can be hashed for the compilation
+       cache key */
+    std::memset(&resources, 0, sizeof(TBuiltInResource));
     const Utility::ConfigurationGroup* builtins = configuration.group("builtins");
     CORRADE_INTERNAL_ASSERT(builtins);
     #define _c(name) resources.name = builtins->value<Int>(#name);
@@ -548,6 +511,65 @@ Containers::Pair<bool, bool> compileAndLinkShader(glslang::TShader& shader, glsl
     _c(generalConstantMatrixVectorIndexing)
     #undef _c
 
+    return resources;
+}
+
+/* If preprocessed is not null, the source is only preprocessed into it, with
+   includes resolved, and the function returns right after. The second value
+   is false in that case. */
+Containers::Pair<bool, bool> compileAndLinkShader(glslang::TShader& shader, glslang::TProgram& program, const Utility::ConfigurationGroup& configuration, const TBuiltInResource& resources, const ConverterFlags flags, const Containers::Pair<int, EProfile> inputVersion, const OutputVersion outputVersion, const bool versionExplicitlySpecified, const Containers::StringView definitions, const Containers::StringView filename, Containers::Optional<Containers::ArrayView<const char>>(*const fileCallback)(const std::string&, InputFileCallbackPolicy, void*), void* const fileCallbackUserData, const Containers::ArrayView<const char> data, Int messages, std::string* const preprocessed) {
+    /* Add preprocessor definitions */
+    shader.setPreamble(definitions.data());
+
+    /* Add the actual shader source. We're not making use of the
+       multiple-source inputs here, it would only further complicate the plugin
+       interface. Google's shaderc does the same, and glslangValidator (WHAT A
+       NAME!!) seems to do that also, but its API is too confusing so I can't
+       tell for sure. If we're validating/compiling a file, the name gets used
+       in potential error messages. */
+    const char* string = data.data();
+    int length = data.size();
+    const char* filenames = filename.data();
+    shader.setStringsWithLengthsAndNames(&string, &length, filename.isEmpty() ? nullptr : &filenames, 1);
+
+    /* Set up the includer -- if we have callbacks, simply use those */
+    Containers::Optional<Includer> includer;
+    std::unordered_map<std::string, Containers::Array<char>> files;
+    if(fileCallback) {
+        includer.emplace(fileCallback, fileCallbackUserData);
+
+    /* Otherwise, if we have filename, build an includer from the filesystem */
+    } else if(!filename.isEmpty()) {
+        includer.emplace([](const std::string& filename, InputFileCallbackPolicy policy, void* userData) -> Containers::Optional<Containers::ArrayView<const char>> {
+            auto& files = *static_cast<std::unordered_map<std::string, Containers::Array<char>>*>(userData);
+            auto found = files.find(filename);
+
+            /* Discard the loaded file, if not needed anymore */
+            if(policy == InputFileCallbackPolicy::Close) {
+                CORRADE_INTERNAL_ASSERT(found != files.end());
+                files.erase(found);
+                return {};
+            }
+
+            /* Read if not there yet */
+            if(found == files.end()) {
+                Containers::Optional<Containers::Array<char>> file = Utility::Path::read(filename);
+                if(!file)
+                    return {};
+
+                found = files.emplace(filename, *Utility::move(file)).first;
+            }
+
+            return Containers::ArrayView<const char>{found->second};
+        }, &files);
+
+    /* Otherwise we can't load files in any way */
+    }
+
+    /** @todo ability to override entrypoint name (for linking multiple same
+        stages together), for some reason not working in glslang, only for
+        hlsl */
+
     /* Decide on the client based on output version */
     glslang::EShClient client{};
     switch(outputVersion.client) {
@@ -640,9 +662,23 @@ Containers::Pair<bool, bool> compileAndLinkShader(glslang::TShader& shader, glsl
         EShMsgHlslEnable16BitTypes, EShMsgHlslLegalization,
         EShMsgHlslDX9Compatible once HLSL support is in */
 
+    glslang::TShader::ForbidIncluder whyTheHellIsThisNotAPointer;
+
+    /* If we're only preprocessing for the compilation cache, do that and exit
+       early. The includes are resolved by the preprocessor, so the output
+       contains everything the compilation depends on. */
+    if(preprocessed) {
+        const bool preprocessingSucceeded = shader.preprocess(&resources,
+            inputVersion.first(), inputVersion.second(),
+            versionExplicitlySpecified,
+            configuration.value<bool>("forwardCompatible"),
+            EShMessages(messages), preprocessed,
+            includer ? *includer : static_cast<glslang::TShader::Includer&>(whyTheHellIsThisNotAPointer));
+        return {preprocessingSucceeded, false};
+    }
+
     /* Compile. Why the hell is it called "parse" is beyond me. Don't even
        bother going further if compilation didn't succeed. */
-    glslang::TShader::ForbidIncluder whyTheHellIsThisNotAPointer;
     const bool compilingSucceeded = shader.parse(&resources,
         inputVersion.first(), inputVersion.second(),
         /* Force version and profile. If the input version is specified by the
@@ -791,7 +827,7 @@ Containers::Pair<bool, Containers::String> GlslangConverter::doValidateData(cons
        function is shared between doValidateData() and doConvertDataToData()
        and does the same in both. Here we use just the output log. */
     glslang::TProgram program;
-    const Containers::Pair<bool, bool> success = compileAndLinkShader(shader, program, configuration(), flags(), inputVersion, outputVersion, !_state->inputVersion.isEmpty(), _state->definitions, inputFilename, inputFileCallback(), inputFileCallbackUserData(), data, 0);
+    const Containers::Pair<bool, bool> success = compileAndLinkShader(shader, program, configuration(), builtinResources(configuration()), flags(), inputVersion, outputVersion, !_state->inputVersion.isEmpty(), _state->definitions, inputFilename, inputFileCallback(), inputFileCallbackUserData(), data, 0, nullptr);
 
     /* Trim excessive newlines and spaces from the output. What the fuck, did
        nobody ever verify what mess it spits out?! */
@@ -827,44 +863,47 @@ bool GlslangConverter::doConvertFileToFile(const Stage stage, const Containers::
         from, to);
 }
 
-Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToData(const Stage stage, const Containers::ArrayView<const char> data) {
-    /* If we're converting a file, save the input filename for use in a
-       potential error message. Clear it so next time plain data is validated
-       the error messages aren't based on stale information. This is done as
-       early as possible so the early exits don't leave it in inconsistent
-       state. */
-    const Containers::String inputFilename = Utility::move(_state->inputFilename);
-    _state->inputFilename = {};
+namespace {
 
-    /** @todo implement this, should also have EShMsgOnlyPreprocessor set (or
-        it's done by default?) */
-    if(flags() & ConverterFlag::PreprocessOnly) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): PreprocessOnly is not implemented yet, sorry";
-        return {};
-    }
+enum class CacheResult {
+    Disabled,
+    Hit,
+    Miss
+};
 
-    /* Check input/output format validity */
-    /** @todo allow HLSL once we implement support for it */
-    if(_state->inputFormat != Format::Unspecified &&
-       _state->inputFormat != Format::Glsl) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): input format should be Glsl or Unspecified but got" << _state->inputFormat;
-        return {};
-    }
-    if(_state->outputFormat != Format::Unspecified &&
-       _state->outputFormat != Format::Spirv) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): output format should be Spirv or Unspecified but got" << _state->outputFormat;
+/* Validates the debug info level, returning whether debug info should be
+   generated */
+Containers::Optional<bool> parseDebugInfoLevel(const char* const prefix, const Containers::StringView level) {
+    if(level == "1"_s)
+        return true;
+
+    /* There's also a stripDebugInfo option since version 10-11.0.0 (yes, a
+       DASH, WTAF!!) (see https://github.com/KhronosGroup/glslang/pull/2278 ),
+       however even after spending half an hour investigating what it actually
+       does I fail to see its purpose -- if I don't generate any debug info in
+       the first place, there's no debug info to strip later, no?! The purpose
+       of the PR is to add -g0 analogously to GCC, but for GCC it's simply
+
+        Level 0 produces no debug information at all. Thus, -g0 negates -g.
+
+       So here we do the same. If the user specifies -g0, it'll act as a reset
+       for -g1 specified earlier and -g0 alone will have the same effect as not
+       doing anything at all because by default, no debug info is generated. */
+    if(level != "0"_s && level != ""_s) {
+        Error{} << prefix << "debug info level should be 0, 1 or empty but got" << level;
         return {};
     }
 
-    /* Decide on stage and input version, fail early if those don't work
-       (translateStage() asserts, parseInputVersion() and parseOutputVersion()
-       prints an error message on its own) */
-    const EShLanguage translatedStage = translateStage(stage);
-    const Containers::Pair<int, EProfile> inputVersion = parseInputVersion("ShaderTools::GlslangConverter::convertDataToData():", _state->inputVersion);
-    const OutputVersion outputVersion = parseOutputVersion("ShaderTools::GlslangConverter::convertDataToData():", Format::Spirv, _state->outputVersion);
-    if(!inputVersion.first() || !outputVersion.client)
-        return {};
+    return false;
+}
 
+/* Compiles a single stage with given definitions to SPIR-V, going through the
+   compilation cache if enabled. Shared between doConvertDataToData() and
+   convertDataToDataBatch(), and because the latter calls it from multiple
+   threads at once, it doesn't touch any converter state -- the cache
+   statistics are updated by the caller based on cacheResult. The definitions
+   are expected to be null-terminated. */
+Containers::Optional<Containers::Array<char>> compileToSpirv(const char* const prefix, const Utility::ConfigurationGroup& configuration, const ConverterFlags flags, const EShLanguage translatedStage, const Containers::Pair<int, EProfile> inputVersion, const OutputVersion outputVersion, const Containers::StringView inputVersionString, const Containers::StringView outputVersionString, const bool debugInfo, const Containers::StringView definitions, const Containers::StringView filename, Containers::Optional<Containers::ArrayView<const char>>(*const fileCallback)(const std::string&, InputFileCallbackPolicy, void*), void* const fileCallbackUserData, const Containers::ArrayView<const char> data, CacheResult& cacheResult) {
     /* Compilation and SPIR-V options */
     Int messages = 0;
     glslang::SpvOptions spvOptions;
@@ -878,7 +917,7 @@ Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToD
     spvOptions.generateDebugInfo = false;
 
     /* Debug info level */
-    if(_state->debugInfo == "1"_s) {
+    if(debugInfo) {
         /* My expectations for glslang can't get much lower anymore but
            nevertheless, for some reason, there isn't a single option that
            enables debug info -- one has to set *two* options in sync. Behold:
@@ -922,22 +961,6 @@ Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToD
            info at all. */
         spvOptions.generateDebugInfo = true;
         messages |= EShMsgDebugInfo;
-
-    /* There's also a stripDebugInfo option since version 10-11.0.0 (yes, a
-       DASH, WTAF!!) (see https://github.com/KhronosGroup/glslang/pull/2278 ),
-       however even after spending half an hour investigating what it actually
-       does I fail to see its purpose -- if I don't generate any debug info in
-       the first place, there's no debug info to strip later, no?! The purpose
-       of the PR is to add -g0 analogously to GCC, but for GCC it's simply
-
-        Level 0 produces no debug information at all. Thus, -g0 negates -g.
-
-       So here we do the same. If the user specifies -g0, it'll act as a reset
-       for -g1 specified earlier and -g0 alone will have the same effect as not
-       doing anything at all because by default, no debug info is generated. */
-    } else if(_state->debugInfo != "0"_s && _state->debugInfo != ""_s) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): debug info level should be 0, 1 or empty but got" << _state->debugInfo;
-        return {};
     }
 
     /* Amazing, why some enums have the glslang:: namespace and some don't /
@@ -949,6 +972,73 @@ Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToD
        set a SPIR-V target because that's what we want. */
     shader.setEnvTarget(glslang::EShTargetSpv, outputVersion.language);
 
+    const TBuiltInResource resources = builtinResources(configuration);
+
+    /* If the compilation cache is enabled, preprocess the source first and
+       look for a file keyed by a hash of the preprocessed source and
+       everything else that affects the output. Preprocessing resolves all
+       includes, so a change in any included file results in a cache miss as
+       well. */
+    const Containers::StringView cacheDirectory = configuration.value<Containers::StringView>("cacheDirectory");
+    Containers::String cacheFilename;
+    cacheResult = CacheResult::Disabled;
+    if(!cacheDirectory.isEmpty()) {
+        /* The preprocessing is done on a dedicated shader instance as the
+           shader can't be reused for compilation afterwards */
+        glslang::TShader preprocessShader{translatedStage};
+        preprocessShader.setEnvTarget(glslang::EShTargetSpv, outputVersion.language);
+        glslang::TProgram preprocessProgram;
+        std::string preprocessed;
+        /* If preprocessing fails, skip the cache and let the compilation
+           below produce a proper error message */
+        if(compileAndLinkShader(preprocessShader, preprocessProgram, configuration, resources, flags, inputVersion, outputVersion, !inputVersionString.isEmpty(), definitions, filename, fileCallback, fileCallbackUserData, data, messages, &preprocessed).first()) {
+            /* With debug info, the SPIR-V contains the filename and the
+               original source including comments, neither of which is in the
+               preprocessed output, so they're hashed as well. The sizes of all
+               variable-length inputs are hashed too so their concatenation is
+               unambiguous. */
+            const Containers::StringView debugFilename = debugInfo ? filename : Containers::StringView{};
+            const Containers::ArrayView<const char> debugSource = debugInfo ? data : Containers::ArrayView<const char>{};
+            const std::string header = Utility::format("{}.{}.{} {} {} {} {} {} {} {} {} {}{}{}{}\n",
+                #ifdef GLSLANG_VERSION_MAJOR
+                GLSLANG_VERSION_MAJOR, GLSLANG_VERSION_MINOR, GLSLANG_VERSION_PATCH,
+                #else
+                0, 0, GLSLANG_PATCH_LEVEL,
+                #endif
+                Int(translatedStage),
+                inputVersionString.size(),
+                outputVersionString.size(),
+                Int(debugInfo),
+                definitions.size(),
+                preprocessed.size(),
+                debugFilename.size(),
+                debugSource.size(),
+                Int(configuration.value<bool>("cascadingErrors")),
+                Int(configuration.value<bool>("permissive")),
+                Int(configuration.value<bool>("forwardCompatible")),
+                Int(!!(flags & ConverterFlag::WarningAsError)));
+            Utility::Sha1 sha1;
+            sha1 << Containers::arrayView(header.data(), header.size())
+                 << Containers::arrayView(inputVersionString.data(), inputVersionString.size())
+                 << Containers::arrayView(outputVersionString.data(), outputVersionString.size())
+                 << Containers::arrayView(definitions.data(), definitions.size())
+                 << Containers::arrayView(preprocessed.data(), preprocessed.size())
+                 << Containers::arrayView(debugFilename.data(), debugFilename.size())
+                 << debugSource
+                 << Containers::arrayView(reinterpret_cast<const char*>(&resources), sizeof(TBuiltInResource));
+            cacheFilename = Utility::Path::join(cacheDirectory, sha1.digest().hexString() + ".spv");
+
+            /* Cache hit, return the file directly. Warnings emitted during
+               the original compilation are not printed again. */
+            if(Utility::Path::exists(cacheFilename)) {
+                if(Containers::Optional<Containers::Array<char>> cached = Utility::Path::read(cacheFilename)) {
+                    cacheResult = CacheResult::Hit;
+                    return cached;
+                }
+            }
+        }
+    }
+
     /* Add preprocessor definitions, input source, configure limits,
        input/output formats, targets and versions, compile and "link". This
        function is shared between doValidateData() and doConvertDataToData()
@@ -959,33 +1049,33 @@ Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToD
        enforcing SPIR-V specific rules such as presence of explicit locations
        and bindings. */
     glslang::TProgram program;
-    Containers::Pair<bool, bool> success = compileAndLinkShader(shader, program, configuration(), flags(), inputVersion, outputVersion, !_state->inputVersion.isEmpty(), _state->definitions, inputFilename, inputFileCallback(), inputFileCallbackUserData(), data, messages);
+    Containers::Pair<bool, bool> success = compileAndLinkShader(shader, program, configuration, resources, flags, inputVersion, outputVersion, !inputVersionString.isEmpty(), definitions, filename, fileCallback, fileCallbackUserData, data, messages, nullptr);
 
     /* Trim excessive newlines and spaces from the output. What the fuck, did
        nobody ever verify what mess it spits out?! */
     /** @todo clean up also trailing newlines inside, ffs */
     const auto shaderLog = Containers::StringView{shader.getInfoLog()}.trimmedSuffix();
     if(!success.first()) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): compilation failed:" << Debug::newline << shaderLog;
+        Error{} << prefix << "compilation failed:" << Debug::newline << shaderLog;
         return {};
     }
 
     /* Assertions in compileAndLinkShader() should have checked that we get
        warnings only if Quiet is not enabled */
     if(!shaderLog.isEmpty())
-        Warning{} << "ShaderTools::GlslangConverter::convertDataToData(): compilation succeeded with the following message:" << Debug::newline << shaderLog;
+        Warning{} << prefix << "compilation succeeded with the following message:" << Debug::newline << shaderLog;
 
     /* Trim excessive newlines and spaces here as well */
     const auto programLog =  Containers::StringView{program.getInfoLog()}.trimmedSuffix();
     if(!success.second()) {
-        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): linking failed:" << Debug::newline << programLog;
+        Error{} << prefix << "linking failed:" << Debug::newline << programLog;
         return {};
     }
 
     /* Assertions in compileAndLinkShader() should have checked that we get
        warnings only if Quiet is not enabled */
     if(!programLog.isEmpty())
-        Warning{} << "ShaderTools::GlslangConverter::convertDataToData(): linking succeeded with the following message:" << Debug::newline << programLog;
+        Warning{} << prefix << "linking succeeded with the following message:" << Debug::newline << programLog;
 
     /* Translate the glslang IR to SPIR-V. Yes, this goes separately for each
        stage, so the actual "linking" is no linking at all (and no, it doesn't
@@ -1004,10 +1094,209 @@ Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToD
     Containers::Array<char> out{NoInit, spirvBytes.size()};
     Utility::copy(spirvBytes, out);
 
+    /* Save the output to the cache, if enabled. It's first written to a
+       temporary file that's then moved over, so concurrent conversions of the
+       same input, either from multiple threads or multiple processes sharing
+       the cache directory, never see a partially written file. The address
+       of a local is unique among concurrently running threads and the
+       current time makes it unique among processes as well. Failures aren't
+       fatal, the compiled output is still returned. */
+    if(!cacheFilename.isEmpty()) {
+        cacheResult = CacheResult::Miss;
+        const Containers::String temporaryFilename = cacheFilename + Utility::format(".{:x}.{:x}.tmp", reinterpret_cast<std::uintptr_t>(&out), UnsignedLong(std::chrono::steady_clock::now().time_since_epoch().count()));
+        if(!Utility::Path::make(cacheDirectory) || !Utility::Path::write(temporaryFilename, out) || !Utility::Path::move(temporaryFilename, cacheFilename))
+            Warning{} << prefix << "can't save the output to cache file" << cacheFilename;
+    }
+
     /* GCC 4.8 needs extra help here */
     return Containers::optional(Utility::move(out));
 }
 
+/* Wraps a user-provided file callback for convertDataToDataBatch() so it's
+   never called from more than one thread at a time */
+struct SerializedFileCallback {
+    Containers::Optional<Containers::ArrayView<const char>>(*callback)(const std::string&, InputFileCallbackPolicy, void*);
+    void* userData;
+    std::mutex mutex;
+};
+
+Containers::Optional<Containers::ArrayView<const char>> serializedFileCallback(const std::string& filename, const InputFileCallbackPolicy policy, void* const userData) {
+    SerializedFileCallback& callback = *static_cast<SerializedFileCallback*>(userData);
+    std::lock_guard<std::mutex> lock{callback.mutex};
+    return callback.callback(filename, policy, callback.userData);
+}
+
+}
+
+Containers::Optional<Containers::Array<char>> GlslangConverter::doConvertDataToData(const Stage stage, const Containers::ArrayView<const char> data) {
+    /* If we're converting a file, save the input filename for use in a
+       potential error message. Clear it so next time plain data is validated
+       the error messages aren't based on stale information. This is done as
+       early as possible so the early exits don't leave it in inconsistent
+       state. */
+    const Containers::String inputFilename = Utility::move(_state->inputFilename);
+    _state->inputFilename = {};
+
+    /** @todo implement this, should also have EShMsgOnlyPreprocessor set (or
+        it's done by default?) */
+    if(flags() & ConverterFlag::PreprocessOnly) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): PreprocessOnly is not implemented yet, sorry";
+        return {};
+    }
+
+    /* Check input/output format validity */
+    /** @todo allow HLSL once we implement support for it */
+    if(_state->inputFormat != Format::Unspecified &&
+       _state->inputFormat != Format::Glsl) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): input format should be Glsl or Unspecified but got" << _state->inputFormat;
+        return {};
+    }
+    if(_state->outputFormat != Format::Unspecified &&
+       _state->outputFormat != Format::Spirv) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToData(): output format should be Spirv or Unspecified but got" << _state->outputFormat;
+        return {};
+    }
+
+    /* Decide on stage and input version, fail early if those don't work
+       (translateStage() asserts, parseInputVersion() and parseOutputVersion()
+       prints an error message on its own) */
+    const EShLanguage translatedStage = translateStage(stage);
+    const Containers::Pair<int, EProfile> inputVersion = parseInputVersion("ShaderTools::GlslangConverter::convertDataToData():", _state->inputVersion);
+    const OutputVersion outputVersion = parseOutputVersion("ShaderTools::GlslangConverter::convertDataToData():", Format::Spirv, _state->outputVersion);
+    if(!inputVersion.first() || !outputVersion.client)
+        return {};
+
+    const Containers::Optional<bool> debugInfo = parseDebugInfoLevel("ShaderTools::GlslangConverter::convertDataToData():", _state->debugInfo);
+    if(!debugInfo)
+        return {};
+
+    CacheResult cacheResult;
+    Containers::Optional<Containers::Array<char>> out = compileToSpirv("ShaderTools::GlslangConverter::convertDataToData():", configuration(), flags(), translatedStage, inputVersion, outputVersion, _state->inputVersion, _state->outputVersion, *debugInfo, _state->definitions, inputFilename, inputFileCallback(), inputFileCallbackUserData(), data, cacheResult);
+
+    if(cacheResult == CacheResult::Hit) ++_state->cacheHits;
+    else if(cacheResult == CacheResult::Miss) ++_state->cacheMisses;
+    if(cacheResult != CacheResult::Disabled && (flags() & ConverterFlag::Verbose))
+        Debug{} << "ShaderTools::GlslangConverter::convertDataToData(): cache" << (cacheResult == CacheResult::Hit ? "hit," : "miss,") << _state->cacheHits << "hits and" << _state->cacheMisses << "misses so far";
+
+    return out;
+}
+
+Containers::Array<Containers::Optional<Containers::Array<char>>> GlslangConverter::convertDataToDataBatch(const Containers::ArrayView<const Stage> stages, const Containers::ArrayView<const Containers::ArrayView<const Containers::Pair<Containers::StringView, Containers::StringView>>> definitions, const Containers::ArrayView<const char> data) {
+    CORRADE_ASSERT(stages.size() == definitions.size(),
+        "ShaderTools::GlslangConverter::convertDataToDataBatch(): expected stage and definition lists to have the same size but got" << stages.size() << "and" << definitions.size(), {});
+
+    /* Results for items that fail stay NullOpt, which is also the case for
+       all of them if any of the checks below fail */
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out{std::size_t(stages.size())};
+
+    if(flags() & ConverterFlag::PreprocessOnly) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToDataBatch(): PreprocessOnly is not implemented yet, sorry";
+        return out;
+    }
+
+    /* Check input/output format validity */
+    if(_state->inputFormat != Format::Unspecified &&
+       _state->inputFormat != Format::Glsl) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToDataBatch(): input format should be Glsl or Unspecified but got" << _state->inputFormat;
+        return out;
+    }
+    if(_state->outputFormat != Format::Unspecified &&
+       _state->outputFormat != Format::Spirv) {
+        Error{} << "ShaderTools::GlslangConverter::convertDataToDataBatch(): output format should be Spirv or Unspecified but got" << _state->outputFormat;
+        return out;
+    }
+
+    /* The input and output version as well as debug info level is the same
+       for all items, so parse it just once */
+    const Containers::Pair<int, EProfile> inputVersion = parseInputVersion("ShaderTools::GlslangConverter::convertDataToDataBatch():", _state->inputVersion);
+    const OutputVersion outputVersion = parseOutputVersion("ShaderTools::GlslangConverter::convertDataToDataBatch():", Format::Spirv, _state->outputVersion);
+    if(!inputVersion.first() || !outputVersion.client)
+        return out;
+    const Containers::Optional<bool> debugInfo = parseDebugInfoLevel("ShaderTools::GlslangConverter::convertDataToDataBatch():", _state->debugInfo);
+    if(!debugInfo)
+        return out;
+
+    /* Translate the stages upfront as translateStage() asserts, and concatenate
+       the definitions the same way as doSetDefinitions() does */
+    Containers::Array<EShLanguage> translatedStages{NoInit, stages.size()};
+    Containers::Array<std::string> preambles{std::size_t(stages.size())};
+    for(std::size_t i = 0; i != stages.size(); ++i) {
+        translatedStages[i] = translateStage(stages[i]);
+        for(const Containers::Pair<Containers::StringView, Containers::StringView>& definition: definitions[i]) {
+            if(!definition.second().data())
+                Utility::formatInto(preambles[i], preambles[i].size(), "#undef {}\n", definition.first());
+            else if(definition.second().isEmpty())
+                Utility::formatInto(preambles[i], preambles[i].size(), "#define {}\n", definition.first());
+            else
+                Utility::formatInto(preambles[i], preambles[i].size(), "#define {} {}\n", definition.first(), definition.second());
+        }
+    }
+
+    /* Glslang is thread-safe after InitializeProcess(), which was done in
+       initialize(), so items are compiled in parallel, each thread picking the
+       next one not yet taken. Messages printed during compilation of each item
+       are captured and printed on the calling thread after, in input order,
+       which relies on the Debug output redirection being thread-local. That's
+       not the case if Corrade isn't built with multithreading support, in
+       which case everything is compiled on the calling thread. */
+    #ifdef CORRADE_BUILD_MULTITHREADED
+    UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+    if(!threadCount)
+        threadCount = std::thread::hardware_concurrency();
+    threadCount = UnsignedInt(Math::clamp<std::size_t>(threadCount, 1, Math::max(stages.size(), std::size_t{1})));
+    #else
+    const UnsignedInt threadCount = 1;
+    #endif
+
+    Containers::Array<Containers::String> debugOutput{std::size_t(stages.size())};
+    Containers::Array<Containers::String> warningOutput{std::size_t(stages.size())};
+    Containers::Array<Containers::String> errorOutput{std::size_t(stages.size())};
+    Containers::Array<CacheResult> cacheResults{DirectInit, stages.size(), CacheResult::Disabled};
+    const Utility::ConfigurationGroup& config = configuration();
+
+    /* File callbacks aren't expected to be thread-safe, so if there's one,
+       calls to it are serialized */
+    SerializedFileCallback fileCallback;
+    fileCallback.callback = inputFileCallback();
+    fileCallback.userData = inputFileCallbackUserData();
+    const auto fileCallbackFunction = fileCallback.callback ? serializedFileCallback : nullptr;
+
+    std::atomic<std::size_t> next{0};
+    auto worker = [&]() {
+        for(std::size_t i; (i = next++) < stages.size(); ) {
+            Debug redirectDebug{&debugOutput[i]};
+            Warning redirectWarning{&warningOutput[i]};
+            Error redirectError{&errorOutput[i]};
+            out[i] = compileToSpirv("ShaderTools::GlslangConverter::convertDataToDataBatch():", config, flags(), translatedStages[i], inputVersion, outputVersion, _state->inputVersion, _state->outputVersion, *debugInfo, preambles[i], {}, fileCallbackFunction, &fileCallback, data, cacheResults[i]);
+        }
+    };
+
+    Containers::Array<std::thread> threads{threadCount - 1};
+    for(std::thread& thread: threads)
+        thread = std::thread{worker};
+    worker();
+    for(std::thread& thread: threads)
+        thread.join();
+
+    /* Print the captured messages and update cache statistics in input
+       order */
+    for(std::size_t i = 0; i != stages.size(); ++i) {
+        if(!debugOutput[i].isEmpty())
+            Debug{Debug::Flag::NoNewlineAtTheEnd} << debugOutput[i];
+        if(!warningOutput[i].isEmpty())
+            Warning{Debug::Flag::NoNewlineAtTheEnd} << warningOutput[i];
+        if(!errorOutput[i].isEmpty())
+            Error{Debug::Flag::NoNewlineAtTheEnd} << errorOutput[i];
+
+        if(cacheResults[i] == CacheResult::Hit) ++_state->cacheHits;
+        else if(cacheResults[i] == CacheResult::Miss) ++_state->cacheMisses;
+        if(cacheResults[i] != CacheResult::Disabled && (flags() & ConverterFlag::Verbose))
+            Debug{} << "ShaderTools::GlslangConverter::convertDataToDataBatch(): cache" << (cacheResults[i] == CacheResult::Hit ? "hit," : "miss,") << _state->cacheHits << "hits and" << _state->cacheMisses << "misses so far";
+    }
+
+    return out;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(GlslangShaderConverter, Magnum::ShaderTools::GlslangConverter,
@@ -313,6 +313,48 @@ can control this using @ref setDebugInfoLevel():
     providing line info for the instructions and `OpModuleProcessed` describing
     what all processing steps were taken by Glslang
 
+@section ShaderTools-GlslangConverter-cache Compilation cache
+
+If the @cb{.ini} cacheDirectory @ce
+@ref ShaderTools-GlslangConverter-configuration "configuration option" is set
+to a non-empty path, successfully compiled SPIR-V is saved there and returned
+directly on subsequent conversions of the same input. The cache key is a SHA-1
+hash of the preprocessed source, which includes contents of all files pulled
+in via @cpp #include @ce, together with preprocessor definitions, input and
+output version, debug info level, the @cb{.ini} [builtins] @ce group and other
+options that affect the compilation. The directory is created on first use.
+
+Only successful compilations are cached and warnings produced by the original
+compilation are not printed again on a cache hit. With
+@ref ConverterFlag::Verbose enabled, the plugin prints the cache hit and miss
+counts on every conversion. The cache is used only for conversion, validation
+is always done from scratch.
+
+@section ShaderTools-GlslangConverter-batch Batch compilation of permutations
+
+The @ref convertDataToDataBatch() function compiles many permutations of the
+same source, each with a different stage and preprocessor definitions, in
+parallel. Items are distributed among the number of threads given by the
+@cb{.ini} threads @ce
+@ref ShaderTools-GlslangConverter-configuration "configuration option", with
+@cpp 0 @ce meaning all available hardware threads. The input and output
+format and version, debug info level, flags and the
+@ref ShaderTools-GlslangConverter-cache "compilation cache" are shared by all
+items and the previously set definitions are ignored. The source has no
+filename, so @cpp #include @ce directives work only if a file callback is set.
+The callback is called from all threads, but the calls are serialized, so it
+doesn't need to be thread-safe. It however shouldn't rely on being called
+from the thread that called @ref convertDataToDataBatch(), and the order in
+which files are requested by different items is unspecified.
+
+Results are returned in input order. Messages printed during compilation of
+each item are collected and printed after all items are compiled, also in
+input order. If Corrade isn't built with @ref CORRADE_BUILD_MULTITHREADED,
+all items are compiled on the calling thread. Because the function isn't a
+part of the @ref AbstractConverter interface, you need to link to the plugin
+directly and cast the converter instance to @ref GlslangConverter in order to
+call it.
+
 @section ShaderTools-GlslangConverter-configuration Plugin-specific configuration
 
 It's possible to tune various compiler and validator options through
@@ -336,6 +378,24 @@ class MAGNUM_GLSLANGSHADERCONVERTER_EXPORT GlslangConverter: public AbstractConv
         /** @brief Plugin manager constructor */
         explicit GlslangConverter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        /**
+         * @brief Compile a batch of permutations of a single source
+         * @param stages        Stage for each permutation
+         * @param definitions   Preprocessor definitions for each
+         *      permutation, in the same format as @ref setDefinitions().
+         *      Expected to have the same size as @p stages.
+         * @param data          Source shared by all permutations
+         * @m_since_latest_{plugins}
+         *
+         * Equivalent to calling @ref setDefinitions() and
+         * @ref convertDataToData() for each permutation but the permutations
+         * are compiled in parallel. Returns a list with compiled SPIR-V for
+         * each permutation in the same order as the input, with failed
+         * permutations being @relativeref{Corrade,Containers::NullOpt}. See
+         * @ref ShaderTools-GlslangConverter-batch for more information.
+         */
+        Containers::Array<Containers::Optional<Containers::Array<char>>> convertDataToDataBatch(Containers::ArrayView<const Stage> stages, Containers::ArrayView<const Containers::ArrayView<const Containers::Pair<Containers::StringView, Containers::StringView>>> definitions, Containers::ArrayView<const char> data);
+
     private:
         MAGNUM_GLSLANGSHADERCONVERTER_LOCAL ConverterFeatures doFeatures() const override;
         MAGNUM_GLSLANGSHADERCONVERTER_LOCAL void doSetInputFormat(Format format, Containers::StringView version) override;
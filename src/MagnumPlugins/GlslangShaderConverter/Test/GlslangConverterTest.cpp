@@ -24,6 +24,9 @@
     DEALINGS IN THE SOFTWARE.
 */
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <unordered_map>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/GrowableArray.h>
@@ -31,12 +34,14 @@
 #include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/TestSuite/Compare/String.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/DebugStl.h> /** @todo remove once file callbacks are <string>-free */
 #include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/String.h>
 #include <Magnum/FileCallback.h>
 #include <Magnum/ShaderTools/AbstractConverter.h>
 #include <Magnum/ShaderTools/Stage.h>
@@ -54,6 +59,10 @@
 
 #include "configure.h"
 
+#ifdef MAGNUM_GLSLANGSHADERCONVERTER_BUILD_STATIC
+#include "MagnumPlugins/GlslangShaderConverter/GlslangConverter.h"
+#endif
+
 namespace Magnum { namespace ShaderTools { namespace Test { namespace {
 
 struct GlslangConverterTest: TestSuite::Tester {
@@ -91,6 +100,14 @@ struct GlslangConverterTest: TestSuite::Tester {
     void convertFailWrongStage();
     void convertFailFileWrongStage();
 
+    void convertCache();
+    void convertCacheDebugInfo();
+    void convertCacheIncludes();
+
+    void convertBatch();
+    void convertBatchFailed();
+    void convertBatchFileCallback();
+
     void vulkanNoExplicitLayout();
 
     /* Explicitly forbid system-wide plugin dependencies */
@@ -346,6 +363,15 @@ const struct {
         VulkanNoExplicitLocationError},
 };
 
+const struct {
+    const char* name;
+    UnsignedInt threads;
+} ConvertBatchData[] {
+    {"single thread", 1},
+    {"two threads", 2},
+    {"all hardware threads", 0},
+};
+
 GlslangConverterTest::GlslangConverterTest() {
     addInstancedTests({&GlslangConverterTest::validate},
         Containers::arraySize(ValidateData));
@@ -385,7 +411,17 @@ GlslangConverterTest::GlslangConverterTest() {
         Containers::arraySize(ConvertFailData));
 
     addTests({&GlslangConverterTest::convertFailWrongStage,
-              &GlslangConverterTest::convertFailFileWrongStage});
+              &GlslangConverterTest::convertFailFileWrongStage,
+
+              &GlslangConverterTest::convertCache,
+              &GlslangConverterTest::convertCacheDebugInfo,
+              &GlslangConverterTest::convertCacheIncludes});
+
+    addInstancedTests({&GlslangConverterTest::convertBatch},
+        Containers::arraySize(ConvertBatchData));
+
+    addTests({&GlslangConverterTest::convertBatchFailed,
+              &GlslangConverterTest::convertBatchFileCallback});
 
     addInstancedTests({&GlslangConverterTest::vulkanNoExplicitLayout},
         Containers::arraySize(VulkanNoExplicitLayoutData));
@@ -1022,6 +1058,365 @@ void GlslangConverterTest::vulkanNoExplicitLayout() {
     CORRADE_COMPARE(out, Utility::format("ShaderTools::GlslangConverter::convertDataToData(): compilation failed:\n{}\n", data.error));
 }
 
+Containers::String emptyCacheDirectory(const Containers::StringView name) {
+    const Containers::String cacheDirectory = Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_OUTPUT_DIR, name);
+    if(Utility::Path::exists(cacheDirectory)) {
+        Containers::Optional<Containers::Array<Containers::String>> files = Utility::Path::list(cacheDirectory, Utility::Path::ListFlag::SkipDotAndDotDot|Utility::Path::ListFlag::SkipDirectories);
+        CORRADE_INTERNAL_ASSERT(files);
+        for(const Containers::String& file: *files)
+            CORRADE_INTERNAL_ASSERT_OUTPUT(Utility::Path::remove(Utility::Path::join(cacheDirectory, file)));
+    }
+    return cacheDirectory;
+}
+
+void GlslangConverterTest::convertCache() {
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+
+    /* The directory doesn't need to exist, it gets created on first use */
+    const Containers::String cacheDirectory = emptyCacheDirectory("cache");
+    converter->configuration().setValue("cacheDirectory", cacheDirectory);
+    converter->setFlags(ConverterFlag::Verbose);
+    converter->setDefinitions({
+        {"A_DEFINE", ""}
+    });
+
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, "shader.vk.frag"));
+    CORRADE_VERIFY(file);
+
+    /* First conversion is a miss and populates the cache */
+    Containers::Optional<Containers::Array<char>> first;
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        first = converter->convertDataToData(Stage::Fragment, *file);
+        CORRADE_VERIFY(first);
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 0 hits and 1 misses so far\n");
+    }
+    {
+        Containers::Optional<Containers::Array<Containers::String>> files = Utility::Path::list(cacheDirectory, Utility::Path::ListFlag::SkipDotAndDotDot);
+        CORRADE_VERIFY(files);
+        CORRADE_COMPARE(files->size(), 1);
+    }
+
+    /* Second conversion of the same is a hit, with the same output */
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        Containers::Optional<Containers::Array<char>> second = converter->convertDataToData(Stage::Fragment, *file);
+        CORRADE_VERIFY(second);
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache hit, 1 hits and 1 misses so far\n");
+        CORRADE_COMPARE(Containers::StringView{*second}, Containers::StringView{*first});
+    }
+
+    /* Different definitions or debug info level result in a miss */
+    converter->setDefinitions({
+        {"A_DEFINE", ""},
+        {"ANOTHER_DEFINE", "1"}
+    });
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertDataToData(Stage::Fragment, *file));
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 1 hits and 2 misses so far\n");
+    }
+    converter->setDebugInfoLevel("1");
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertDataToData(Stage::Fragment, *file));
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 1 hits and 3 misses so far\n");
+    }
+
+    /* A different builtin limit as well */
+    converter->configuration().group("builtins")->setValue("maxDrawBuffers", 16);
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertDataToData(Stage::Fragment, *file));
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 1 hits and 4 misses so far\n");
+    }
+}
+
+void GlslangConverterTest::convertCacheDebugInfo() {
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+
+    const Containers::String cacheDirectory = emptyCacheDirectory("cache-debug-info");
+    converter->configuration().setValue("cacheDirectory", cacheDirectory);
+    converter->setFlags(ConverterFlag::Verbose);
+    converter->setDefinitions({
+        {"A_DEFINE", ""}
+    });
+
+    /* Two sources that differ only in a comment, thus preprocessing to the
+       same output, served under two different filenames */
+    std::unordered_map<std::string, Containers::String> files;
+    {
+        Containers::Optional<Containers::String> file = Utility::Path::readString(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, "shader.vk.frag"));
+        CORRADE_VERIFY(file);
+        CORRADE_VERIFY(file->contains("Uniform and output locations"));
+        files.emplace("a.frag", *file);
+        files.emplace("b.frag", *file);
+        files.emplace("commented.frag", Utility::String::replaceFirst(*file, "Uniform and output locations", "Uniform and output location"));
+    }
+    converter->setInputFileCallback([](const std::string& filename, InputFileCallbackPolicy, std::unordered_map<std::string, Containers::String>& files) -> Containers::Optional<Containers::ArrayView<const char>> {
+        auto found = files.find(filename);
+        if(found == files.end()) return {};
+        return Containers::ArrayView<const char>{found->second};
+    }, files);
+
+    /* Without debug info, neither the filename nor comments make it into
+       the output, so all three are the same cache entry */
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertFileToData(Stage::Fragment, "a.frag"));
+        CORRADE_VERIFY(converter->convertFileToData(Stage::Fragment, "b.frag"));
+        CORRADE_VERIFY(converter->convertFileToData(Stage::Fragment, "commented.frag"));
+        CORRADE_COMPARE(out,
+            "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 0 hits and 1 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache hit, 1 hits and 1 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache hit, 2 hits and 1 misses so far\n");
+    }
+
+    /* With debug info, the SPIR-V contains both, so each is a separate entry
+       and the output for each is what a conversion without the cache gives */
+    converter->setDebugInfoLevel("1");
+    Containers::Pointer<AbstractConverter> uncachedConverter = _converterManager.instantiate("GlslangShaderConverter");
+    uncachedConverter->setDebugInfoLevel("1");
+    uncachedConverter->setDefinitions({
+        {"A_DEFINE", ""}
+    });
+    uncachedConverter->setInputFileCallback([](const std::string& filename, InputFileCallbackPolicy, std::unordered_map<std::string, Containers::String>& files) -> Containers::Optional<Containers::ArrayView<const char>> {
+        auto found = files.find(filename);
+        if(found == files.end()) return {};
+        return Containers::ArrayView<const char>{found->second};
+    }, files);
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        for(const char* filename: {"a.frag", "b.frag", "commented.frag", "b.frag"}) {
+            CORRADE_ITERATION(filename);
+            Containers::Optional<Containers::Array<char>> cached = converter->convertFileToData(Stage::Fragment, filename);
+            Containers::Optional<Containers::Array<char>> uncached = uncachedConverter->convertFileToData(Stage::Fragment, filename);
+            CORRADE_VERIFY(cached);
+            CORRADE_VERIFY(uncached);
+            CORRADE_COMPARE(Containers::StringView{*cached}, Containers::StringView{*uncached});
+        }
+        CORRADE_COMPARE(out,
+            "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 2 hits and 2 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 2 hits and 3 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 2 hits and 4 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache hit, 3 hits and 4 misses so far\n");
+    }
+}
+
+void GlslangConverterTest::convertCacheIncludes() {
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+
+    const Containers::String cacheDirectory = emptyCacheDirectory("cache-includes");
+    converter->configuration().setValue("cacheDirectory", cacheDirectory);
+    converter->setFlags(ConverterFlag::Verbose);
+
+    /* Provide the top-level file and includes via a callback so the contents
+       of an included file can be changed between conversions. The paths are
+       what the includer asks for, see validateIncludesCallback() above. */
+    std::unordered_map<std::string, Containers::String> files;
+    for(const char* filename: {"includes.vert", "sub/directory/basics.glsl", "sub/directory/definitions.glsl", "sub/directory/../relative.glsl"}) {
+        Containers::Optional<Containers::String> file = Utility::Path::readString(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, filename));
+        CORRADE_VERIFY(file);
+        files.emplace(filename, *Utility::move(file));
+    }
+    converter->setInputFileCallback([](const std::string& filename, InputFileCallbackPolicy, std::unordered_map<std::string, Containers::String>& files) -> Containers::Optional<Containers::ArrayView<const char>> {
+        auto found = files.find(filename);
+        if(found == files.end()) return {};
+        return Containers::ArrayView<const char>{found->second};
+    }, files);
+
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertFileToData({}, "includes.vert"));
+        CORRADE_VERIFY(converter->convertFileToData({}, "includes.vert"));
+        CORRADE_COMPARE(out,
+            "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 0 hits and 1 misses so far\n"
+            "ShaderTools::GlslangConverter::convertDataToData(): cache hit, 1 hits and 1 misses so far\n");
+    }
+
+    /* Changing just the included file results in a miss */
+    CORRADE_COMPARE(files["sub/directory/../relative.glsl"], "#define FLOAT_ZERO 0.0\n");
+    files["sub/directory/../relative.glsl"] = "#define FLOAT_ZERO 0.00\n";
+    {
+        Containers::String out;
+        Debug redirectOutput{&out};
+        CORRADE_VERIFY(converter->convertFileToData({}, "includes.vert"));
+        CORRADE_COMPARE(out, "ShaderTools::GlslangConverter::convertDataToData(): cache miss, 1 hits and 2 misses so far\n");
+    }
+}
+
+void GlslangConverterTest::convertBatch() {
+    auto&& data = ConvertBatchData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef MAGNUM_GLSLANGSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("GlslangConverter::convertDataToDataBatch() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+    converter->configuration().setValue("threads", data.threads);
+
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, "shader.vk.frag"));
+    CORRADE_VERIFY(file);
+
+    /* Some permutations are repeated to verify that the outputs don't get
+       mixed up */
+    const Containers::Pair<Containers::StringView, Containers::StringView> definitions0[]{
+        {"A_DEFINE", ""}
+    };
+    const Containers::Pair<Containers::StringView, Containers::StringView> definitions1[]{
+        {"A_DEFINE", ""},
+        {"AN_UNDEFINE", nullptr}
+    };
+    const Containers::Pair<Containers::StringView, Containers::StringView> definitions2[]{
+        {"A_DEFINE", "1"},
+        {"SOMETHING_ELSE", "2"}
+    };
+    const Containers::ArrayView<const Containers::Pair<Containers::StringView, Containers::StringView>> definitions[]{
+        definitions0, definitions1, definitions2, definitions0, definitions2
+    };
+    const Stage stages[]{
+        Stage::Fragment, Stage::Fragment, Stage::Fragment, Stage::Fragment, Stage::Fragment
+    };
+
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out = static_cast<GlslangConverter&>(*converter).convertDataToDataBatch(stages, definitions, *file);
+    CORRADE_COMPARE(out.size(), 5);
+
+    /* Each output should be the same as when compiled alone */
+    for(std::size_t i = 0; i != out.size(); ++i) {
+        CORRADE_ITERATION(i);
+        converter->setDefinitions(definitions[i]);
+        Containers::Optional<Containers::Array<char>> expected = converter->convertDataToData(stages[i], *file);
+        CORRADE_VERIFY(expected);
+        CORRADE_VERIFY(out[i]);
+        CORRADE_COMPARE(Containers::StringView{*out[i]}, Containers::StringView{*expected});
+    }
+    #endif
+}
+
+void GlslangConverterTest::convertBatchFailed() {
+    #ifndef MAGNUM_GLSLANGSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("GlslangConverter::convertDataToDataBatch() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+    converter->configuration().setValue("threads", 2);
+    /* We're interested in the first error only */
+    converter->configuration().setValue("cascadingErrors", false);
+
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, "shader.vk.frag"));
+    CORRADE_VERIFY(file);
+
+    const Containers::Pair<Containers::StringView, Containers::StringView> good[]{
+        {"A_DEFINE", ""}
+    };
+    const Containers::Pair<Containers::StringView, Containers::StringView> bad1[]{
+        {"A_DEFINE", ""},
+        {"AN_UNDEFINE", ""}
+    };
+    const Containers::Pair<Containers::StringView, Containers::StringView> bad2[]{
+        {"A_DEFINE", ""},
+        {"NO_EXPLICIT_LOCATION", ""}
+    };
+    const Containers::ArrayView<const Containers::Pair<Containers::StringView, Containers::StringView>> definitions[]{
+        good, bad1, good, bad2
+    };
+    const Stage stages[]{
+        Stage::Fragment, Stage::Fragment, Stage::Fragment, Stage::Fragment
+    };
+
+    /* The errors should be the same as when compiled alone, and printed in
+       input order */
+    Containers::String expected;
+    {
+        Error redirectError{&expected};
+        converter->setDefinitions(bad1);
+        CORRADE_VERIFY(!converter->convertDataToData(Stage::Fragment, *file));
+        converter->setDefinitions(bad2);
+        CORRADE_VERIFY(!converter->convertDataToData(Stage::Fragment, *file));
+    }
+
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out;
+    Containers::String error;
+    {
+        Error redirectError{&error};
+        out = static_cast<GlslangConverter&>(*converter).convertDataToDataBatch(stages, definitions, *file);
+    }
+    CORRADE_COMPARE(out.size(), 4);
+    CORRADE_VERIFY(out[0]);
+    CORRADE_VERIFY(!out[1]);
+    CORRADE_VERIFY(out[2]);
+    CORRADE_VERIFY(!out[3]);
+    CORRADE_COMPARE(error, Utility::String::replaceAll(expected,
+        "convertDataToData():",
+        "convertDataToDataBatch():"));
+    #endif
+}
+
+void GlslangConverterTest::convertBatchFileCallback() {
+    #ifndef MAGNUM_GLSLANGSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("GlslangConverter::convertDataToDataBatch() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("GlslangShaderConverter");
+    converter->configuration().setValue("threads", 4);
+
+    /* The callback isn't thread-safe, modifying the map on every call. It
+       records if it got entered while another call was still in progress, and
+       sleeps a bit to make such overlap likely if the calls weren't
+       serialized. */
+    struct Callback {
+        std::unordered_map<std::string, Containers::Array<char>> files;
+        std::atomic<Int> inside{};
+        bool overlapped{};
+        std::size_t callCount{};
+    } callback;
+    converter->setInputFileCallback([](const std::string& filename, InputFileCallbackPolicy policy, Callback& callback) -> Containers::Optional<Containers::ArrayView<const char>> {
+        if(callback.inside++) callback.overlapped = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        ++callback.callCount;
+
+        Containers::Optional<Containers::ArrayView<const char>> out;
+        if(policy == InputFileCallbackPolicy::Close) {
+            callback.files.erase(filename);
+        } else if(Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, filename))) {
+            Containers::Array<char>& stored = callback.files[filename];
+            stored = *Utility::move(file);
+            out = Containers::ArrayView<const char>{stored};
+        }
+
+        --callback.inside;
+        return out;
+    }, callback);
+
+    Containers::Optional<Containers::Array<char>> file = Utility::Path::read(Utility::Path::join(GLSLANGSHADERCONVERTER_TEST_DIR, "includes.vert"));
+    CORRADE_VERIFY(file);
+
+    const Containers::ArrayView<const Containers::Pair<Containers::StringView, Containers::StringView>> definitions[8]{};
+    const Stage stages[]{
+        Stage::Vertex, Stage::Vertex, Stage::Vertex, Stage::Vertex,
+        Stage::Vertex, Stage::Vertex, Stage::Vertex, Stage::Vertex
+    };
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out = static_cast<GlslangConverter&>(*converter).convertDataToDataBatch(stages, definitions, *file);
+    CORRADE_COMPARE(out.size(), 8);
+    for(std::size_t i = 0; i != out.size(); ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_VERIFY(out[i]);
+    }
+
+    /* Each item includes several files, all of them should have gone through
+       the callback without any two calls overlapping */
+    CORRADE_COMPARE_AS(callback.callCount, 8,
+        TestSuite::Compare::Greater);
+    CORRADE_VERIFY(!callback.overlapped);
+    #endif
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::ShaderTools::Test::GlslangConverterTest)
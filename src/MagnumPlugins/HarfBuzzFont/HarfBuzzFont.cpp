@@ -26,11 +26,19 @@
 
 #include "HarfBuzzFont.h"
 
+#include <cstring>
+#include <list>
+#include <unordered_map>
 #include <hb-ft.h>
+#include <hb-ot.h>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
-#include <Corrade/Containers/StringView.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringStlHash.h>
 #include <Corrade/PluginManager/AbstractManager.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Endianness.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/Text/AbstractGlyphCache.h>
@@ -41,6 +49,28 @@
 
 namespace Magnum { namespace Text {
 
+struct HarfBuzzFont::ShapeCache {
+    struct Entry {
+        /* Key in the format produced by Shaper::doShape(), the lookup table
+           references it */
+        Containers::String key;
+        hb_segment_properties_t properties;
+        Containers::Array<hb_glyph_info_t> glyphInfos;
+        Containers::Array<hb_glyph_position_t> glyphPositions;
+        std::size_t memoryUsage;
+    };
+
+    explicit ShapeCache(std::size_t maxMemoryUsage): maxMemoryUsage{maxMemoryUsage} {}
+
+    /* Most recently used entry is first, evicting from the back */
+    std::list<Entry> entries;
+    std::unordered_map<Containers::StringView, std::list<Entry>::iterator> lookup;
+    std::size_t maxMemoryUsage;
+    std::size_t memoryUsage = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 /* Tt warns also for the deprecated FreeTypeFont constructor otherwise */
 CORRADE_IGNORE_DEPRECATED_PUSH
@@ -64,18 +94,60 @@ auto HarfBuzzFont::doOpenData(const Containers::ArrayView<const char> data, cons
     auto ret = FreeTypeFont::doOpenData(data, size);
 
     /* Create Harfbuzz font */
-    if(FreeTypeFont::doIsOpened())
-        _hbFont = hb_ft_font_create(_ftFont, nullptr);
+    if(FreeTypeFont::doIsOpened()) {
+        /* Either use HarfBuzz's own OpenType implementation directly on the
+           font data, with FreeType used only for rasterization, or go through
+           FreeType for everything */
+        if(configuration().value<bool>("openTypeFunctions")) {
+            hb_blob_t* const blob = hb_blob_create(reinterpret_cast<const char*>(_data.data()), _data.size(), HB_MEMORY_MODE_READONLY, nullptr, nullptr);
+            hb_face_t* const face = hb_face_create(blob, 0);
+            _hbFont = hb_font_create(face);
+            hb_face_destroy(face);
+            hb_blob_destroy(blob);
+            hb_ot_font_set_funcs(_hbFont);
+
+            /* Use the same scale and ppem as hb_ft_font_create() would, so
+               positions are in 26.6 fixed point in both cases */
+            const FT_Size_Metrics& metrics = _ftFont->size->metrics;
+            hb_font_set_scale(_hbFont,
+                Int((UnsignedLong(metrics.x_scale)*UnsignedLong(_ftFont->units_per_EM) + (1u << 15)) >> 16),
+                Int((UnsignedLong(metrics.y_scale)*UnsignedLong(_ftFont->units_per_EM) + (1u << 15)) >> 16));
+            hb_font_set_ppem(_hbFont, metrics.x_ppem, metrics.y_ppem);
+        } else _hbFont = hb_ft_font_create(_ftFont, nullptr);
+
+        /* Create a shape cache, if enabled */
+        if(const std::size_t shapeCacheSize = configuration().value<std::size_t>("shapeCacheSize"))
+            _shapeCache.emplace(shapeCacheSize);
+    }
 
     return ret;
 }
 
 void HarfBuzzFont::doClose() {
+    _shapeCache = nullptr;
     hb_font_destroy(_hbFont);
     _hbFont = nullptr;
     FreeTypeFont::doClose();
 }
 
+std::size_t HarfBuzzFont::shapeCacheHits() const {
+    return _shapeCache ? _shapeCache->hits : 0;
+}
+
+std::size_t HarfBuzzFont::shapeCacheMisses() const {
+    return _shapeCache ? _shapeCache->misses : 0;
+}
+
+std::size_t HarfBuzzFont::shapeCacheMemoryUsage() const {
+    return _shapeCache ? _shapeCache->memoryUsage : 0;
+}
+
+void HarfBuzzFont::resetShapeCacheStatistics() {
+    if(!_shapeCache) return;
+    _shapeCache->hits = 0;
+    _shapeCache->misses = 0;
+}
+
 Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
     struct Shaper: AbstractShaper {
         explicit Shaper(AbstractFont& font): AbstractShaper{font} {
@@ -193,7 +265,103 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
             CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
         }
 
-        UnsignedInt doShape(const Containers::StringView text, const UnsignedInt begin, const UnsignedInt end, const Containers::ArrayView<const FeatureRange> features) override {
+        UnsignedInt doShape(const Containers::StringView textFull, UnsignedInt begin, UnsignedInt end, const Containers::ArrayView<const FeatureRange> features) override {
+            HarfBuzzFont::ShapeCache* const cache = static_cast<HarfBuzzFont&>(font())._shapeCache.get();
+            _glyphsFromCache = false;
+
+            /* With a cache, the text is cut to just the shaped range and the
+               context HarfBuzz looks at around it, which is at most five
+               characters on either side. That way the same run with the same
+               surroundings produces the same key regardless of the rest of
+               the text. Clusters and feature ranges are then relative to the
+               cut. */
+            Containers::StringView text = textFull;
+            _clusterOffset = 0;
+            if(cache) {
+                /* A plain shape(text) passes the end unresolved, turn it into
+                   an actual offset so the context and the key can be
+                   calculated from it */
+                if(end == ~UnsignedInt{})
+                    end = textFull.size();
+
+                std::size_t contextBegin = begin;
+                for(std::size_t i = 0; i != 5 && contextBegin; ++i) {
+                    do --contextBegin;
+                    while(contextBegin && (textFull[contextBegin] & 0xc0) == 0x80);
+                }
+                std::size_t contextEnd = end;
+                for(std::size_t i = 0; i != 5 && contextEnd < textFull.size(); ++i) {
+                    do ++contextEnd;
+                    while(contextEnd < textFull.size() && (textFull[contextEnd] & 0xc0) == 0x80);
+                }
+
+                text = textFull.slice(contextBegin, contextEnd);
+                begin -= contextBegin;
+                end -= contextBegin;
+                _clusterOffset = contextBegin;
+            }
+
+            /* Allocate a temporary array for hb_feature_t entries. The
+               FeatureRange has the same layout, but unfortunately like with
+               script values, the feature tags are endian-dependent in HarfBuzz
+               so we have to modify them. Sigh. */
+            /** @todo use some stack allocator or DynamicArray when that's a
+                thing to avoid the allocation */
+            Containers::Array<hb_feature_t> hbFeatures{NoInit, features.size()};
+            for(std::size_t i = 0; i != features.size(); ++i) {
+                hbFeatures[i].tag = UnsignedInt(Utility::Endianness::bigEndian(features[i].feature()));
+                hbFeatures[i].value = features[i].value();
+                hbFeatures[i].start = features[i].begin();
+                hbFeatures[i].end = features[i].end();
+                if(_clusterOffset) {
+                    hbFeatures[i].start = hbFeatures[i].start > _clusterOffset ? hbFeatures[i].start - _clusterOffset : 0;
+                    if(hbFeatures[i].end != ~UnsignedInt{})
+                        hbFeatures[i].end = hbFeatures[i].end > _clusterOffset ? hbFeatures[i].end - _clusterOffset : 0;
+                }
+            }
+
+            /* Look up the run in the cache. The key consists of the script,
+               language and direction as set by the user, the features, the
+               shaped range and the text. The language is an interned pointer
+               so it can be compared directly. */
+            if(cache) {
+                const std::size_t keySize = sizeof(hb_script_t) + sizeof(hb_language_t) + sizeof(hb_direction_t) + sizeof(UnsignedInt)*2 + hbFeatures.size()*sizeof(hb_feature_t) + text.size();
+                arrayResize(_key, NoInit, keySize);
+                char* out = _key.data();
+                const auto append = [&out](const void* data, std::size_t size) {
+                    if(size) std::memcpy(out, data, size);
+                    out += size;
+                };
+                append(&_script, sizeof(hb_script_t));
+                append(&_language, sizeof(hb_language_t));
+                append(&_direction, sizeof(hb_direction_t));
+                append(&begin, sizeof(UnsignedInt));
+                append(&end, sizeof(UnsignedInt));
+                append(hbFeatures.data(), hbFeatures.size()*sizeof(hb_feature_t));
+                append(text.data(), text.size());
+                CORRADE_INTERNAL_ASSERT(out == _key.end());
+
+                /* On a hit, make the entry most recently used and copy the
+                   glyph data out of it. A copy and not a reference because
+                   another shaper for the same font could evict the entry
+                   before this one gets queried. */
+                const auto found = cache->lookup.find(Containers::StringView{_key});
+                if(found != cache->lookup.end()) {
+                    ++cache->hits;
+                    cache->entries.splice(cache->entries.begin(), cache->entries, found->second);
+                    const HarfBuzzFont::ShapeCache::Entry& entry = *found->second;
+                    _cachedProperties = entry.properties;
+                    arrayResize(_cachedGlyphInfos, NoInit, entry.glyphInfos.size());
+                    arrayResize(_cachedGlyphPositions, NoInit, entry.glyphPositions.size());
+                    Utility::copy(entry.glyphInfos, _cachedGlyphInfos);
+                    Utility::copy(entry.glyphPositions, _cachedGlyphPositions);
+                    _glyphsFromCache = true;
+                    return entry.glyphInfos.size();
+                }
+
+                ++cache->misses;
+            }
+
             /* If shaping was performed already, the buffer type is
                HB_BUFFER_CONTENT_TYPE_GLYPHS, need to reset it to accept
                Unicode input again. */
@@ -212,34 +380,66 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
                _direction == HB_DIRECTION_INVALID)
                 hb_buffer_guess_segment_properties(_buffer);
 
-            /* Allocate a temporary array for hb_feature_t entries. The
-               FeatureRange has the same layout, but unfortunately like with
-               script values, the feature tags are endian-dependent in HarfBuzz
-               so we have to modify them. Sigh. */
-            /** @todo use some stack allocator or DynamicArray when that's a
-                thing to avoid the allocation */
-            Containers::Array<hb_feature_t> hbFeatures{NoInit, features.size()};
-            for(std::size_t i = 0; i != features.size(); ++i) {
-                hbFeatures[i].tag = UnsignedInt(Utility::Endianness::bigEndian(features[i].feature()));
-                hbFeatures[i].value = features[i].value();
-                hbFeatures[i].start = features[i].begin();
-                hbFeatures[i].end = features[i].end();
-            }
-
             hb_shape(static_cast<const HarfBuzzFont&>(font())._hbFont, _buffer, hbFeatures.data(), hbFeatures.size());
 
-            return hb_buffer_get_length(_buffer);
+            const UnsignedInt glyphCount = hb_buffer_get_length(_buffer);
+
+            /* Put the result into the cache, evicting least recently used
+               entries until it fits. Runs that are larger than the whole
+               cache aren't stored at all. */
+            if(cache) {
+                const std::size_t memoryUsage = sizeof(HarfBuzzFont::ShapeCache::Entry) + _key.size() + glyphCount*(sizeof(hb_glyph_info_t) + sizeof(hb_glyph_position_t));
+                if(memoryUsage <= cache->maxMemoryUsage) {
+                    while(cache->memoryUsage + memoryUsage > cache->maxMemoryUsage) {
+                        const HarfBuzzFont::ShapeCache::Entry& last = cache->entries.back();
+                        cache->memoryUsage -= last.memoryUsage;
+                        cache->lookup.erase(last.key);
+                        cache->entries.pop_back();
+                    }
+
+                    cache->entries.emplace_front();
+                    HarfBuzzFont::ShapeCache::Entry& entry = cache->entries.front();
+                    entry.key = Containers::String{Containers::StringView{_key}};
+                    hb_buffer_get_segment_properties(_buffer, &entry.properties);
+                    entry.glyphInfos = Containers::Array<hb_glyph_info_t>{NoInit, glyphCount};
+                    entry.glyphPositions = Containers::Array<hb_glyph_position_t>{NoInit, glyphCount};
+                    Utility::copy(Containers::arrayView(hb_buffer_get_glyph_infos(_buffer, nullptr), glyphCount), entry.glyphInfos);
+                    Utility::copy(Containers::arrayView(hb_buffer_get_glyph_positions(_buffer, nullptr), glyphCount), entry.glyphPositions);
+                    entry.memoryUsage = memoryUsage;
+                    cache->lookup.emplace(entry.key, cache->entries.begin());
+                    cache->memoryUsage += memoryUsage;
+                }
+            }
+
+            return glyphCount;
         }
 
-        Script doScript() const override {
+        hb_segment_properties_t segmentProperties() const {
+            if(_glyphsFromCache)
+                return _cachedProperties;
+
             hb_segment_properties_t props;
             hb_buffer_get_segment_properties(_buffer, &props);
+            return props;
+        }
+
+        const hb_glyph_info_t* glyphInfos() const {
+            return _glyphsFromCache ? _cachedGlyphInfos.data() :
+                hb_buffer_get_glyph_infos(_buffer, nullptr);
+        }
+
+        const hb_glyph_position_t* glyphPositions() const {
+            return _glyphsFromCache ? _cachedGlyphPositions.data() :
+                hb_buffer_get_glyph_positions(_buffer, nullptr);
+        }
+
+        Script doScript() const override {
+            const hb_segment_properties_t props = segmentProperties();
             return Script(Utility::Endianness::bigEndian(props.script));
         }
 
         Containers::StringView doLanguage() const override {
-            hb_segment_properties_t props;
-            hb_buffer_get_segment_properties(_buffer, &props);
+            const hb_segment_properties_t props = segmentProperties();
             /* The string most probably isn't global as
                hb_buffer_set_language() accepts any string, but it should
                definitely stay in scope for at least as long as HarfBuzz is
@@ -248,8 +448,7 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
         }
 
         ShapeDirection doDirection() const override {
-            hb_segment_properties_t props;
-            hb_buffer_get_segment_properties(_buffer, &props);
+            const hb_segment_properties_t props = segmentProperties();
 
             switch(props.direction) {
                 case HB_DIRECTION_LTR: return ShapeDirection::LeftToRight;
@@ -263,17 +462,15 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
         }
 
         void doGlyphIdsInto(const Containers::StridedArrayView1D<UnsignedInt>& ids) const override {
-            UnsignedInt glyphCount;
-            hb_glyph_info_t* const glyphInfos = hb_buffer_get_glyph_infos(_buffer, &glyphCount);
-            CORRADE_INTERNAL_ASSERT(glyphCount == this->glyphCount());
+            const UnsignedInt glyphCount = this->glyphCount();
+            const hb_glyph_info_t* const glyphInfos = this->glyphInfos();
 
             for(std::size_t i = 0; i != glyphCount; ++i)
                 ids[i] = glyphInfos[i].codepoint;
         }
         void doGlyphOffsetsAdvancesInto(const Containers::StridedArrayView1D<Vector2>& offsets, const Containers::StridedArrayView1D<Vector2>& advances) const override {
-            UnsignedInt glyphCount;
-            hb_glyph_position_t* const glyphPositions = hb_buffer_get_glyph_positions(_buffer, &glyphCount);
-            CORRADE_INTERNAL_ASSERT(glyphCount == this->glyphCount());
+            const UnsignedInt glyphCount = this->glyphCount();
+            const hb_glyph_position_t* const glyphPositions = this->glyphPositions();
 
             for(std::size_t i = 0; i != glyphCount; ++i) {
                 offsets[i] = Vector2{Float(glyphPositions[i].x_offset),
@@ -283,12 +480,11 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
             }
         }
         void doGlyphClustersInto(const Containers::StridedArrayView1D<UnsignedInt>& clusters) const override {
-            UnsignedInt glyphCount;
-            hb_glyph_info_t* const glyphInfos = hb_buffer_get_glyph_infos(_buffer, &glyphCount);
-            CORRADE_INTERNAL_ASSERT(glyphCount == this->glyphCount());
+            const UnsignedInt glyphCount = this->glyphCount();
+            const hb_glyph_info_t* const glyphInfos = this->glyphInfos();
 
             for(std::size_t i = 0; i != glyphCount; ++i)
-                clusters[i] = glyphInfos[i].cluster;
+                clusters[i] = _clusterOffset + glyphInfos[i].cluster;
         }
 
         hb_buffer_t* _buffer;
@@ -299,6 +495,16 @@ Containers::Pointer<AbstractShaper> HarfBuzzFont::doCreateShaper() {
         hb_script_t _script = HB_SCRIPT_INVALID;
         hb_language_t _language = HB_LANGUAGE_INVALID;
         hb_direction_t _direction = HB_DIRECTION_INVALID;
+
+        /* Used only if the font has a shape cache. The key is kept to avoid
+           reallocating it for every lookup, the glyph data are filled on a
+           cache hit. */
+        Containers::Array<char> _key;
+        bool _glyphsFromCache = false;
+        UnsignedInt _clusterOffset = 0;
+        hb_segment_properties_t _cachedProperties;
+        Containers::Array<hb_glyph_info_t> _cachedGlyphInfos;
+        Containers::Array<hb_glyph_position_t> _cachedGlyphPositions;
     };
 
     return Containers::pointer<Shaper>(*this);
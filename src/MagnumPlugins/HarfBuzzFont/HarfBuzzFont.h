@@ -30,6 +30,8 @@
  * @brief Class @ref Magnum::Text::HarfBuzzFont
  */
 
+#include <Corrade/Containers/Pointer.h>
+
 #include "MagnumPlugins/FreeTypeFont/FreeTypeFont.h"
 
 #include "MagnumPlugins/HarfBuzzFont/configure.h"
@@ -177,6 +179,51 @@ HarfBuzz enables @ref Feature::VerticalWriting by default.
 For @ref Script::Hangul, HarfBuzz disables @ref Feature::ContextualAlternates
 by default. For Indic scripts and @ref Script::Khmer, HarfBuzz disables
 @ref Feature::StandardLigatures by default.
+
+@subsection Text-HarfBuzzFont-behavior-opentype-functions OpenType font functions
+
+By default, the HarfBuzz font is created with
+@m_class{m-doc-external} [hb_ft_font_create()](https://harfbuzz.github.io/harfbuzz-hb-ft.html#hb-ft-font-create),
+which means every glyph advance and extents query done during shaping goes
+through FreeType and loads the glyph. Enabling the
+@cb{.ini} openTypeFunctions @ce
+@ref Text-HarfBuzzFont-configuration "configuration option" before opening a
+font makes the plugin create the font directly from the file data and use
+HarfBuzz's built-in OpenType font functions instead, which are considerably
+faster. FreeType is then used only in @ref fillGlyphCache(). The font scale
+is set to match the FreeType variant, however the OpenType functions don't
+apply hinting, so advances may differ by a fraction of a pixel compared to
+the default.
+
+@subsection Text-HarfBuzzFont-behavior-shape-cache Shape cache
+
+By setting the @cb{.ini} shapeCacheSize @ce
+@ref Text-HarfBuzzFont-configuration "configuration option" to a non-zero
+amount of bytes before opening a font, shaped runs get cached. The cache is
+shared by all shapers created from given font and is keyed by the shaped
+text, including up to five characters of context on either side that HarfBuzz
+uses, the script, language and direction set on the shaper and the feature
+list. Shaping a run that's in the cache then only copies the cached glyph IDs,
+offsets, advances and clusters, skipping HarfBuzz entirely. When the cache is
+full, least recently used runs are evicted.
+
+Cache efficiency can be checked with @ref shapeCacheHits(),
+@ref shapeCacheMisses() and @ref shapeCacheMemoryUsage(). Because these are
+not a part of the @ref AbstractFont interface, you need to link to the plugin
+directly and cast the font instance to @ref HarfBuzzFont in order to call
+them.
+
+@section Text-HarfBuzzFont-configuration Plugin-specific configuration
+
+Glyph cache filling is delegated to @ref FreeTypeFont, see
+@ref Text-FreeTypeFont-behavior-glyph-cache for details. The plugin exposes
+the same options through @ref configuration() together with options for the
+shape cache, see below for all options and their default values:
+
+@snippet MagnumPlugins/HarfBuzzFont/HarfBuzzFont.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_HARFBUZZFONT_EXPORT HarfBuzzFont: public FreeTypeFont {
     public:
@@ -211,7 +258,49 @@ class MAGNUM_HARFBUZZFONT_EXPORT HarfBuzzFont: public FreeTypeFont {
 
         ~HarfBuzzFont();
 
+        /**
+         * @brief Shape cache hit count
+         *
+         * Count of @ref AbstractShaper::shape() calls that were satisfied
+         * from the shape cache since the font was opened or since
+         * @ref resetShapeCacheStatistics() was called. Returns @cpp 0 @ce if
+         * the cache isn't enabled. See @ref Text-HarfBuzzFont-behavior-shape-cache
+         * for more information.
+         */
+        std::size_t shapeCacheHits() const;
+
+        /**
+         * @brief Shape cache miss count
+         *
+         * Count of @ref AbstractShaper::shape() calls that had to be shaped
+         * by HarfBuzz since the font was opened or since
+         * @ref resetShapeCacheStatistics() was called. Returns @cpp 0 @ce if
+         * the cache isn't enabled.
+         */
+        std::size_t shapeCacheMisses() const;
+
+        /**
+         * @brief Shape cache memory usage
+         *
+         * Approximate count of bytes used by the cached runs, never larger
+         * than the @cb{.ini} shapeCacheSize @ce
+         * @ref Text-HarfBuzzFont-configuration "configuration option".
+         * Returns @cpp 0 @ce if the cache isn't enabled.
+         */
+        std::size_t shapeCacheMemoryUsage() const;
+
+        /**
+         * @brief Reset shape cache statistics
+         *
+         * Resets values returned by @ref shapeCacheHits() and
+         * @ref shapeCacheMisses() to @cpp 0 @ce. Cached runs are kept. Does
+         * nothing if the cache isn't enabled.
+         */
+        void resetShapeCacheStatistics();
+
     private:
+        struct ShapeCache;
+
         MAGNUM_HARFBUZZFONT_LOCAL FontFeatures doFeatures() const override;
         MAGNUM_HARFBUZZFONT_LOCAL bool doIsOpened() const override;
         MAGNUM_HARFBUZZFONT_LOCAL Properties doOpenData(Containers::ArrayView<const char> data, Float size) override;
@@ -219,6 +308,7 @@ class MAGNUM_HARFBUZZFONT_EXPORT HarfBuzzFont: public FreeTypeFont {
         MAGNUM_HARFBUZZFONT_LOCAL Containers::Pointer<AbstractShaper> doCreateShaper() override;
 
         hb_font_t* _hbFont;
+        Containers::Pointer<ShapeCache> _shapeCache;
 };
 
 }}
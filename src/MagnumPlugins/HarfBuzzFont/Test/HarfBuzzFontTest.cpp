@@ -30,6 +30,8 @@
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Endianness.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Math/Vector2.h>
@@ -42,6 +44,10 @@
 
 #include "configure.h"
 
+#ifdef MAGNUM_HARFBUZZFONT_BUILD_STATIC
+#include "MagnumPlugins/HarfBuzzFont/HarfBuzzFont.h"
+#endif
+
 namespace Magnum { namespace Text { namespace Test { namespace {
 
 struct HarfBuzzFontTest: TestSuite::Tester {
@@ -59,6 +65,11 @@ struct HarfBuzzFontTest: TestSuite::Tester {
     void shapeMultipleAutodetection();
 
     void shapeFeatures();
+    void shapeOpenTypeFunctions();
+
+    void shapeCache();
+    void shapeCacheWholeTextImplicit();
+    void shapeCacheEviction();
 
     void openTwice();
 
@@ -227,6 +238,27 @@ const struct {
     }},
 };
 
+const struct {
+    const char* name;
+    const char* string;
+    UnsignedInt begin, end;
+    Containers::Array<FeatureRange> features;
+} ShapeCacheData[]{
+    {"whole text", "Wěave", 0, ~UnsignedInt{}, {}},
+    {"part of a text", "Some Wěave text", 5, 11, {}},
+    {"part of a text with more than five characters of context",
+        "A longer Wěave text here", 9, 15, {}},
+    {"features", "Wěave", 0, ~UnsignedInt{}, {InPlaceInit, {
+        {Feature::Kerning, false}
+    }}},
+    {"features for a part of a text", "A longer Wěave text here", 9, 15, {InPlaceInit, {
+        /* These get shifted to be relative to the context the cache uses */
+        {Feature::Kerning, 0, 11, false},
+        {Feature::Kerning, 13, 15, false},
+        {Feature::StandardLigatures, 12, ~UnsignedInt{}, false}
+    }}},
+};
+
 HarfBuzzFontTest::HarfBuzzFontTest() {
     addTests({&HarfBuzzFontTest::scriptMapping});
 
@@ -249,7 +281,15 @@ HarfBuzzFontTest::HarfBuzzFontTest() {
     addInstancedTests({&HarfBuzzFontTest::shapeFeatures},
         Containers::arraySize(ShapeFeaturesData));
 
-    addTests({&HarfBuzzFontTest::openTwice});
+    addTests({&HarfBuzzFontTest::shapeOpenTypeFunctions});
+
+    addInstancedTests({&HarfBuzzFontTest::shapeCache},
+        Containers::arraySize(ShapeCacheData));
+
+    addTests({&HarfBuzzFontTest::shapeCacheWholeTextImplicit,
+              &HarfBuzzFontTest::shapeCacheEviction,
+
+              &HarfBuzzFontTest::openTwice});
 
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
@@ -702,6 +742,213 @@ void HarfBuzzFontTest::shapeFeatures() {
         TestSuite::Compare::Container);
 }
 
+void HarfBuzzFontTest::shapeOpenTypeFunctions() {
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("HarfBuzzFont");
+    font->configuration().setValue("openTypeFunctions", true);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    /* Font properties come from FreeType in both cases, so they should be
+       the same as in FreeTypeFont */
+    CORRADE_COMPARE(font->size(), 16.0f);
+    CORRADE_COMPARE(font->glyphCount(), 671);
+
+    Containers::Pointer<AbstractShaper> shaper = font->createShaper();
+    CORRADE_COMPARE(shaper->shape("Wěave"), 5);
+    UnsignedInt ids[5];
+    Vector2 offsets[5];
+    Vector2 advances[5];
+    UnsignedInt clusters[5];
+    shaper->glyphIdsInto(ids);
+    shaper->glyphOffsetsAdvancesInto(offsets, advances);
+    shaper->glyphClustersInto(clusters);
+    CORRADE_COMPARE_AS(Containers::arrayView(ids), Containers::arrayView({
+        58u,  /* 'W' */
+        220u, /* 'ě' */
+        68u,  /* 'a' */
+        89u,  /* 'v' */
+        72u   /* 'e' */
+    }), TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(Containers::arrayView(offsets), Containers::arrayView<Vector2>({
+        {}, {}, {}, {}, {}
+    }), TestSuite::Compare::Container);
+    CORRADE_COMPARE_AS(Containers::arrayView(clusters), Containers::arrayView({
+        0u, 1u, 3u, 4u, 5u
+    }), TestSuite::Compare::Container);
+
+    /* The advances aren't hinted, so they differ slightly from what's
+       returned through FreeType in shapeMultiple() */
+    const Float expectedAdvances[]{
+        16.6562f,
+        8.34375f,
+        8.26562f,
+        8.0f,
+        8.34375f
+    };
+    for(std::size_t i = 0; i != Containers::arraySize(advances); ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_COMPARE_WITH(advances[i].x(), expectedAdvances[i],
+            TestSuite::Compare::around(0.5f));
+        CORRADE_COMPARE(advances[i].y(), 0.0f);
+    }
+}
+
+void HarfBuzzFontTest::shapeCache() {
+    auto&& data = ShapeCacheData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Shape with a font without a cache to have something to compare to */
+    Containers::Pointer<AbstractFont> uncachedFont = _manager.instantiate("HarfBuzzFont");
+    CORRADE_VERIFY(uncachedFont->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+    Containers::Pointer<AbstractShaper> uncachedShaper = uncachedFont->createShaper();
+    const UnsignedInt glyphCount = uncachedShaper->shape(data.string, data.begin, data.end, data.features);
+    CORRADE_VERIFY(glyphCount);
+    Containers::Array<UnsignedInt> expectedIds{NoInit, glyphCount};
+    Containers::Array<Vector2> expectedOffsets{NoInit, glyphCount};
+    Containers::Array<Vector2> expectedAdvances{NoInit, glyphCount};
+    Containers::Array<UnsignedInt> expectedClusters{NoInit, glyphCount};
+    uncachedShaper->glyphIdsInto(expectedIds);
+    uncachedShaper->glyphOffsetsAdvancesInto(expectedOffsets, expectedAdvances);
+    uncachedShaper->glyphClustersInto(expectedClusters);
+
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("HarfBuzzFont");
+    font->configuration().setValue("shapeCacheSize", 65536);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    /* First time it gets shaped and put into the cache, second time it's
+       taken from there, with a different shaper to verify the cache is
+       shared. The output should be the same in both cases. */
+    for(std::size_t i = 0; i != 2; ++i) {
+        CORRADE_ITERATION(i);
+
+        Containers::Pointer<AbstractShaper> shaper = font->createShaper();
+        CORRADE_COMPARE(shaper->shape(data.string, data.begin, data.end, data.features), glyphCount);
+        CORRADE_COMPARE(shaper->script(), uncachedShaper->script());
+        CORRADE_COMPARE(shaper->language(), uncachedShaper->language());
+        CORRADE_COMPARE(shaper->direction(), uncachedShaper->direction());
+
+        Containers::Array<UnsignedInt> ids{NoInit, glyphCount};
+        Containers::Array<Vector2> offsets{NoInit, glyphCount};
+        Containers::Array<Vector2> advances{NoInit, glyphCount};
+        Containers::Array<UnsignedInt> clusters{NoInit, glyphCount};
+        shaper->glyphIdsInto(ids);
+        shaper->glyphOffsetsAdvancesInto(offsets, advances);
+        shaper->glyphClustersInto(clusters);
+        CORRADE_COMPARE_AS(ids, expectedIds,
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE_AS(offsets, expectedOffsets,
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE_AS(advances, expectedAdvances,
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE_AS(clusters, expectedClusters,
+            TestSuite::Compare::Container);
+    }
+
+    #ifdef MAGNUM_HARFBUZZFONT_BUILD_STATIC
+    HarfBuzzFont& harfBuzzFont = static_cast<HarfBuzzFont&>(*font);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 1);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 1);
+    CORRADE_VERIFY(harfBuzzFont.shapeCacheMemoryUsage());
+
+    harfBuzzFont.resetShapeCacheStatistics();
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 0);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 0);
+    CORRADE_VERIFY(harfBuzzFont.shapeCacheMemoryUsage());
+    #endif
+}
+
+void HarfBuzzFontTest::shapeCacheWholeTextImplicit() {
+    /* Like shapeCache(), but calling shape() without begin and end, which
+       passes the end through to the plugin unresolved */
+    Containers::Pointer<AbstractFont> uncachedFont = _manager.instantiate("HarfBuzzFont");
+    CORRADE_VERIFY(uncachedFont->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+    Containers::Pointer<AbstractShaper> uncachedShaper = uncachedFont->createShaper();
+    const UnsignedInt glyphCount = uncachedShaper->shape("Wěave");
+    CORRADE_COMPARE(glyphCount, 5);
+    Containers::Array<UnsignedInt> expectedIds{NoInit, glyphCount};
+    Containers::Array<UnsignedInt> expectedClusters{NoInit, glyphCount};
+    uncachedShaper->glyphIdsInto(expectedIds);
+    uncachedShaper->glyphClustersInto(expectedClusters);
+
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("HarfBuzzFont");
+    font->configuration().setValue("shapeCacheSize", 65536);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    for(std::size_t i = 0; i != 2; ++i) {
+        CORRADE_ITERATION(i);
+
+        Containers::Pointer<AbstractShaper> shaper = font->createShaper();
+        CORRADE_COMPARE(shaper->shape("Wěave"), glyphCount);
+
+        Containers::Array<UnsignedInt> ids{NoInit, glyphCount};
+        Containers::Array<UnsignedInt> clusters{NoInit, glyphCount};
+        shaper->glyphIdsInto(ids);
+        shaper->glyphClustersInto(clusters);
+        CORRADE_COMPARE_AS(ids, expectedIds,
+            TestSuite::Compare::Container);
+        CORRADE_COMPARE_AS(clusters, expectedClusters,
+            TestSuite::Compare::Container);
+    }
+
+    #ifdef MAGNUM_HARFBUZZFONT_BUILD_STATIC
+    HarfBuzzFont& harfBuzzFont = static_cast<HarfBuzzFont&>(*font);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 1);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 1);
+    #endif
+}
+
+void HarfBuzzFontTest::shapeCacheEviction() {
+    #ifndef MAGNUM_HARFBUZZFONT_BUILD_STATIC
+    CORRADE_SKIP("Cache statistics can be queried only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("HarfBuzzFont");
+    HarfBuzzFont& harfBuzzFont = static_cast<HarfBuzzFont&>(*font);
+
+    /* Memory used by the entries depends on the platform, so first measure
+       how much two runs take with a large enough cache */
+    font->configuration().setValue("shapeCacheSize", 65536);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+    Containers::Pointer<AbstractShaper> shaper = font->createShaper();
+    CORRADE_COMPARE(shaper->shape("Wave"), 4);
+    CORRADE_COMPARE(shaper->shape("ave"), 3);
+    const std::size_t cacheSize = harfBuzzFont.shapeCacheMemoryUsage();
+
+    /* Reopening the font applies the new size and starts from scratch */
+    font->configuration().setValue("shapeCacheSize", cacheSize);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMemoryUsage(), 0);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 0);
+
+    /* Both runs fit, making the first one most recently used */
+    shaper = font->createShaper();
+    CORRADE_COMPARE(shaper->shape("Wave"), 4);
+    CORRADE_COMPARE(shaper->shape("ave"), 3);
+    CORRADE_COMPARE(shaper->shape("Wave"), 4);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 1);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 2);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMemoryUsage(), cacheSize);
+
+    /* A run that doesn't fit into the cache at all isn't cached and doesn't
+       evict anything */
+    CORRADE_COMPARE(shaper->shape("Waves and waves of text"), 23);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 3);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMemoryUsage(), cacheSize);
+    CORRADE_COMPARE(shaper->shape("Wave"), 4);
+    CORRADE_COMPARE(shaper->shape("ave"), 3);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 3);
+
+    /* A run of the same size as the second evicts the least recently used
+       one, which is now the first */
+    CORRADE_COMPARE(shaper->shape("eva"), 3);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 4);
+    CORRADE_COMPARE_AS(harfBuzzFont.shapeCacheMemoryUsage(), cacheSize,
+        TestSuite::Compare::Less);
+    CORRADE_COMPARE(shaper->shape("ave"), 3);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheHits(), 4);
+    CORRADE_COMPARE(shaper->shape("Wave"), 4);
+    CORRADE_COMPARE(harfBuzzFont.shapeCacheMisses(), 5);
+    #endif
+}
+
 void HarfBuzzFontTest::openTwice() {
     Containers::Pointer<AbstractFont> font = _manager.instantiate("HarfBuzzFont");
 
@@ -27,3 +27,4 @@
 #cmakedefine FREETYPEFONT_PLUGIN_FILENAME "${FREETYPEFONT_PLUGIN_FILENAME}"
 #cmakedefine HARFBUZZFONT_PLUGIN_FILENAME "${HARFBUZZFONT_PLUGIN_FILENAME}"
 #define FREETYPEFONT_TEST_DIR "${FREETYPEFONT_TEST_DIR}"
+#cmakedefine MAGNUM_HARFBUZZFONT_BUILD_STATIC
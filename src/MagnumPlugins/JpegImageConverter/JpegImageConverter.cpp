@@ -31,6 +31,7 @@
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
@@ -69,6 +70,10 @@ using namespace Containers::Literals;
 #ifdef MAGNUM_BUILD_DEPRECATED /* LCOV_EXCL_START */
 JpegImageConverter::JpegImageConverter() {
     configuration().setValue("jpegQuality", 0.8f);
+    configuration().setValue("progressive", false);
+    configuration().setValue("optimizeHuffman", false);
+    configuration().setValue("dctMethod", "islow");
+    configuration().setValue("chromaSubsampling", "4:2:0");
 }
 #endif /* LCOV_EXCL_STOP */
 
@@ -117,13 +122,50 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
             return {};
     }
 
+    /* DCT method */
+    J_DCT_METHOD dctMethod;
+    const Containers::StringView dctMethodString = configuration().value<Containers::StringView>("dctMethod");
+    if(dctMethodString == "islow"_s)
+        dctMethod = JDCT_ISLOW;
+    else if(dctMethodString == "ifast"_s)
+        dctMethod = JDCT_IFAST;
+    else if(dctMethodString == "float"_s)
+        dctMethod = JDCT_FLOAT;
+    else {
+        Error{} << "Trade::JpegImageConverter::convertToData(): expected dctMethod to be islow, ifast or float, got" << dctMethodString;
+        return {};
+    }
+
+    /* Luma sampling factors, with chroma sampling factors being always 1 */
+    Int lumaSamplingX, lumaSamplingY;
+    const Containers::StringView chromaSubsampling = configuration().value<Containers::StringView>("chromaSubsampling");
+    if(chromaSubsampling == "4:4:4"_s) {
+        lumaSamplingX = 1;
+        lumaSamplingY = 1;
+    } else if(chromaSubsampling == "4:2:2"_s) {
+        lumaSamplingX = 2;
+        lumaSamplingY = 1;
+    } else if(chromaSubsampling == "4:2:0"_s) {
+        lumaSamplingX = 2;
+        lumaSamplingY = 2;
+    } else {
+        Error{} << "Trade::JpegImageConverter::convertToData(): expected chromaSubsampling to be 4:4:4, 4:2:2 or 4:2:0, got" << chromaSubsampling;
+        return {};
+    }
+
     /* Initialize structures. Needs to be before the setjmp crap in order to
        avoid leaks on error. */
     jpeg_compress_struct info;
     struct DestinationManager {
         jpeg_destination_mgr jpegDestinationManager;
+        std::size_t initialSize;
         Containers::Array<char> output;
     } destinationManager;
+    /* Guess the initial output size to avoid repeated reallocations for the
+       common case. An eighth of the uncompressed size is roughly what's
+       produced for photos at the default quality, the extra kilobyte is for
+       the headers, quantization and Huffman tables. */
+    destinationManager.initialSize = std::size_t(image.size().product())*components/8 + 1024;
 
     Containers::Array<JSAMPROW> rows;
     Containers::Array<char> data;
@@ -152,8 +194,7 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
     info.dest = reinterpret_cast<jpeg_destination_mgr*>(&destinationManager);
     info.dest->init_destination = [](j_compress_ptr info) {
         auto& destinationManager = *reinterpret_cast<DestinationManager*>(info->dest);
-        /* It crashes if the buffer has zero free space */
-        arrayAppend(destinationManager.output, NoInit, 1);
+        arrayAppend(destinationManager.output, NoInit, destinationManager.initialSize);
         info->dest->next_output_byte = reinterpret_cast<JSAMPLE*>(destinationManager.output.data());
         info->dest->free_in_buffer = destinationManager.output.size()/sizeof(JSAMPLE);
     };
@@ -181,6 +222,19 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
 
     jpeg_set_defaults(&info);
     jpeg_set_quality(&info, Int(configuration().value<Float>("jpegQuality")*100.0f), boolean(true));
+    info.dct_method = dctMethod;
+    info.optimize_coding = boolean(configuration().value<bool>("optimizeHuffman"));
+    /* Chroma subsampling is expressed through the luma sampling factors. For
+       grayscale images there's no chroma and the single component has to
+       stay at 1x1, otherwise the output would differ from before. */
+    if(components > 1) {
+        info.comp_info[0].h_samp_factor = lumaSamplingX;
+        info.comp_info[0].v_samp_factor = lumaSamplingY;
+    }
+    /* Needs to be called after jpeg_set_defaults(), as that resets the scan
+       script */
+    if(configuration().value<bool>("progressive"))
+        jpeg_simple_progression(&info);
     jpeg_start_compress(&info, boolean(true));
 
     /* Write rows in reverse order. While the rows may have some padding after,
@@ -188,15 +242,17 @@ Containers::Optional<Containers::Array<char>> JpegImageConverter::doConvertToDat
        to pass a pointer to the first byte of each. */
     const Containers::StridedArrayView3D<const char> pixelsFlipped = image.pixels().flipped<0>();
     CORRADE_INTERNAL_ASSERT(pixelsFlipped.isContiguous<1>());
-    while(info.next_scanline < info.image_height) {
+    rows = Containers::Array<JSAMPROW>{NoInit, info.image_height};
+    for(std::size_t i = 0; i != rows.size(); ++i)
         /* libJPEG HAVE YOU EVER HEARD ABOUT CONST ARGUMENTS?! IT'S NOT 1978
            ANYMORE */
-        JSAMPROW row = static_cast<JSAMPROW>(const_cast<void*>(pixelsFlipped[info.next_scanline].data()));
-        /** @todo would it be any faster to pass more than one at a time? 64,
-            for example? needs benchmarking, docs don't really suggest it as
-            being good for perf, just "may be more convenient" */
-        jpeg_write_scanlines(&info, &row, 1);
-    }
+        rows[i] = static_cast<JSAMPROW>(const_cast<void*>(pixelsFlipped[i].data()));
+
+    /* Pass all rows at once, letting libJPEG process as many as it can in a
+       single call instead of going through the whole call stack again for
+       each row. Usually it consumes all of them right away. */
+    while(info.next_scanline < info.image_height)
+        jpeg_write_scanlines(&info, rows.data() + info.next_scanline, info.image_height - info.next_scanline);
 
     jpeg_finish_compress(&info);
     jpeg_destroy_compress(&info);
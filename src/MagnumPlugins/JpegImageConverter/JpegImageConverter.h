@@ -142,6 +142,20 @@ implementations:
 -   [MozJPEG](https://github.com/mozilla/mozjpeg), optimized for quality/size
     ratio, though generally much slower than libjpeg-turbo
 
+@subsection Trade-JpegImageConverter-behavior-encoding-options Encoding options
+
+By default, the output is a baseline JPEG with 4:2:0 chroma subsampling and
+default Huffman tables. The @cb{.ini} progressive @ce and
+@cb{.ini} optimizeHuffman @ce
+@ref Trade-JpegImageConverter-configuration "configuration options" produce
+smaller files at the cost of slower encoding, without affecting the decoded
+pixels. The @cb{.ini} dctMethod @ce option trades accuracy for speed and
+@cb{.ini} chromaSubsampling @ce color fidelity for file size.
+
+The output buffer is initially allocated based on an estimate of the
+compressed size and grown if the estimate isn't enough, and all rows are passed
+to libJPEG at once, minimizing per-row overhead.
+
 @subsection Trade-JpegImageConverter-behavior-arithmetic-coding Arithmetic JPEG encoding
 
 Libjpeg has a switch to enable [arithmetic coding](https://en.wikipedia.org/wiki/Arithmetic_coding)
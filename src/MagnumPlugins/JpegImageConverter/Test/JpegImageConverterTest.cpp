@@ -27,6 +27,7 @@
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
@@ -67,6 +68,9 @@ struct JpegImageConverterTest: TestSuite::Tester {
 
     void unsupportedMetadata();
 
+    void encodingOptions();
+    void encodingOptionsInvalid();
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
     PluginManager::Manager<AbstractImporter> _importerManager{"nonexistent"};
@@ -93,6 +97,38 @@ const struct {
         nullptr},
 };
 
+const struct {
+    const char* name;
+    bool grayscale;
+    bool progressive, optimizeHuffman;
+    const char* dctMethod;
+    const char* chromaSubsampling;
+    char startOfFrame, lumaSampling;
+    bool smaller;
+} EncodingOptionsData[]{
+    {"progressive", false, true, false, "islow", "4:2:0", '\xc2', '\x22', true},
+    {"optimized Huffman", false, false, true, "islow", "4:2:0", '\xc0', '\x22', true},
+    {"fast DCT", false, false, false, "ifast", "4:2:0", '\xc0', '\x22', false},
+    {"float DCT", false, false, false, "float", "4:2:0", '\xc0', '\x22', false},
+    {"4:4:4", false, false, false, "islow", "4:4:4", '\xc0', '\x11', false},
+    {"4:2:2", false, false, false, "islow", "4:2:2", '\xc0', '\x21', false},
+    /* Chroma subsampling has no effect on grayscale images */
+    {"grayscale", true, false, false, "islow", "4:2:0", '\xc0', '\x11', false},
+    {"grayscale, 4:2:2", true, false, false, "islow", "4:2:2", '\xc0', '\x11', false},
+};
+
+const struct {
+    const char* name;
+    const char* option;
+    const char* value;
+    const char* message;
+} EncodingOptionsInvalidData[]{
+    {"DCT method", "dctMethod", "fastest",
+        "expected dctMethod to be islow, ifast or float, got fastest"},
+    {"chroma subsampling", "chromaSubsampling", "4:1:1",
+        "expected chromaSubsampling to be 4:4:4, 4:2:2 or 4:2:0, got 4:1:1"},
+};
+
 JpegImageConverterTest::JpegImageConverterTest() {
     addTests({&JpegImageConverterTest::wrongFormat,
               &JpegImageConverterTest::conversionError,
@@ -109,6 +145,12 @@ JpegImageConverterTest::JpegImageConverterTest() {
     addInstancedTests({&JpegImageConverterTest::unsupportedMetadata},
         Containers::arraySize(UnsupportedMetadataData));
 
+    addInstancedTests({&JpegImageConverterTest::encodingOptions},
+        Containers::arraySize(EncodingOptionsData));
+
+    addInstancedTests({&JpegImageConverterTest::encodingOptionsInvalid},
+        Containers::arraySize(EncodingOptionsInvalidData));
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef JPEGIMAGECONVERTER_PLUGIN_FILENAME
@@ -423,6 +465,70 @@ void JpegImageConverterTest::unsupportedMetadata() {
         CORRADE_COMPARE(out, Utility::format("Trade::JpegImageConverter::convertToData(): {}\n", data.message));
 }
 
+void JpegImageConverterTest::encodingOptions() {
+    auto&& data = EncodingOptionsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    const ImageView2D& original = data.grayscale ? OriginalGrayscale : OriginalRgb;
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    Containers::Optional<Containers::Array<char>> defaultData = converter->convertToData(original);
+    CORRADE_VERIFY(defaultData);
+
+    converter->configuration().setValue("progressive", data.progressive);
+    converter->configuration().setValue("optimizeHuffman", data.optimizeHuffman);
+    converter->configuration().setValue("dctMethod", data.dctMethod);
+    converter->configuration().setValue("chromaSubsampling", data.chromaSubsampling);
+    Containers::Optional<Containers::Array<char>> imageData = converter->convertToData(original);
+    CORRADE_VERIFY(imageData);
+
+    /* Check the frame type and luma sampling factors in the SOF marker. The
+       marker is followed by a 2-byte length, precision, 2-byte height and
+       width, component count, ID of the first component and its sampling
+       factors. */
+    const Containers::StringView string{*imageData};
+    const Containers::StringView startOfFrame = string.find(Containers::StringView{"\xff\xc0", 2});
+    const Containers::StringView progressiveStartOfFrame = string.find(Containers::StringView{"\xff\xc2", 2});
+    CORRADE_VERIFY(!startOfFrame != !progressiveStartOfFrame);
+    const char* const frame = startOfFrame ? startOfFrame.data() : progressiveStartOfFrame.data();
+    CORRADE_COMPARE(frame[1], data.startOfFrame);
+    CORRADE_COMPARE(frame[11], data.lumaSampling);
+
+    if(data.smaller)
+        CORRADE_COMPARE_AS(imageData->size(), defaultData->size(),
+            TestSuite::Compare::Less);
+
+    /* Grayscale output with just the subsampling changed is the same as
+       with the defaults */
+    if(data.grayscale)
+        CORRADE_COMPARE_AS(*imageData, *defaultData,
+            TestSuite::Compare::Container);
+
+    if(_importerManager.loadState("JpegImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("JpegImporter plugin not found, cannot test");
+
+    /* Compared to the 80% test above, the difference is similar */
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->openData(*imageData));
+    Containers::Optional<Trade::ImageData2D> converted = importer->image2D(0);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE_WITH(*converted, original,
+        (DebugTools::CompareImage{15.0f, 7.0f}));
+}
+
+void JpegImageConverterTest::encodingOptionsInvalid() {
+    auto&& data = EncodingOptionsInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("JpegImageConverter");
+    converter->configuration().setValue(data.option, data.value);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!converter->convertToData(OriginalRgb));
+    CORRADE_COMPARE(out, Utility::format("Trade::JpegImageConverter::convertToData(): {}\n", data.message));
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::JpegImageConverterTest)
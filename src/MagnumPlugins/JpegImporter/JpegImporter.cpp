@@ -27,10 +27,17 @@
 #include "JpegImporter.h"
 
 #include <csetjmp>
+#include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringView.h>
 #include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/DebugStl.h> /** @todo remove once Configuration is <string>-free */
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/ImageData.h>
 
 #ifdef CORRADE_TARGET_WINDOWS
@@ -62,6 +69,30 @@
 
 namespace Magnum { namespace Trade {
 
+using namespace Containers::Literals;
+
+namespace {
+
+/* Fugly error handling stuff */
+/** @todo Get rid of this crap */
+struct ErrorManager {
+    jpeg_error_mgr jpegErrorManager;
+    std::jmp_buf setjmpBuffer;
+    char message[JMSG_LENGTH_MAX]{};
+};
+
+void errorExit(j_common_ptr info) {
+    auto& errorManager = *reinterpret_cast<ErrorManager*>(info->err);
+    info->err->format_message(info, errorManager.message);
+    std::longjmp(errorManager.setjmpBuffer, 1);
+}
+
+/* Value of VK_FORMAT_B8G8R8A8_UNORM, used for the implementation-specific
+   format of BGRA output as there's no generic BGRA pixel format */
+constexpr UnsignedInt VkFormatB8G8R8A8Unorm = 44;
+
+}
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 JpegImporter::JpegImporter() = default; /* LCOV_EXCL_LINE */
 #endif
@@ -74,7 +105,10 @@ ImporterFeatures JpegImporter::doFeatures() const { return ImporterFeature::Open
 
 bool JpegImporter::doIsOpened() const { return _in; }
 
-void JpegImporter::doClose() { _in = nullptr; }
+void JpegImporter::doClose() {
+    _in = nullptr;
+    _planes = nullptr;
+}
 
 void JpegImporter::doOpenData(Containers::Array<char>&& data, const DataFlags dataFlags) {
     /* Because here we're copying the data and using the _in to check if file
@@ -96,28 +130,163 @@ void JpegImporter::doOpenData(Containers::Array<char>&& data, const DataFlags da
         _in = Containers::Array<char>{NoInit, data.size()};
         Utility::copy(data, _in);
     }
+
+    /* In the YUV mode all planes are decoded at once, so do that here instead
+       of decoding the whole file again for each plane in doImage2D() */
+    if(configuration().value<Containers::StringView>("outputFormat") != "YUV"_s)
+        return;
+
+    const UnsignedInt scale = configuration().value<UnsignedInt>("scale");
+    if(scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        Error{} << "Trade::JpegImporter::openData(): expected scale to be 1, 2, 4 or 8, got" << scale;
+        _in = nullptr;
+        return;
+    }
+    if(!configuration().value<Containers::StringView>("region").isEmpty()) {
+        Error{} << "Trade::JpegImporter::openData(): region decoding isn't supported for YUV output";
+        _in = nullptr;
+        return;
+    }
+
+    /* Initialize structures */
+    jpeg_decompress_struct file;
+    Containers::Array<ImageData2D> planes;
+    Containers::Array<char> scratch;
+    Containers::Array<JSAMPROW> rows;
+
+    ErrorManager errorManager;
+    file.err = jpeg_std_error(&errorManager.jpegErrorManager);
+    errorManager.jpegErrorManager.error_exit = errorExit;
+    if(setjmp(errorManager.setjmpBuffer)) {
+        Error() << "Trade::JpegImporter::openData(): error:" << errorManager.message;
+        jpeg_destroy_decompress(&file);
+        _in = nullptr;
+        return;
+    }
+
+    jpeg_create_decompress(&file);
+    jpeg_mem_src(&file, reinterpret_cast<unsigned char*>(_in.begin()), _in.size());
+    jpeg_read_header(&file, boolean(true));
+
+    /* Only grayscale and YCbCr have a well-defined meaning of the planes */
+    if(file.jpeg_color_space != JCS_GRAYSCALE && file.jpeg_color_space != JCS_YCbCr) {
+        Error{} << "Trade::JpegImporter::openData(): unsupported color space" << file.jpeg_color_space << "for YUV output";
+        jpeg_destroy_decompress(&file);
+        _in = nullptr;
+        return;
+    }
+
+    /* Output the downsampled component data directly, without upsampling and
+       color conversion */
+    file.scale_num = 1;
+    file.scale_denom = scale;
+    file.raw_data_out = boolean(true);
+    jpeg_start_decompress(&file);
+
+    /* The raw data are output one iMCU row at a time, with each component
+       having its own row count and padded to whole blocks. Allocate a scratch
+       buffer for one iMCU row of all components and the output planes, with
+       rows aligned to four bytes. */
+    JSAMPARRAY componentRows[MAX_COMPONENTS];
+    std::size_t componentRowCount[MAX_COMPONENTS];
+    std::size_t componentStride[MAX_COMPONENTS];
+    std::size_t scratchSize = 0;
+    std::size_t rowCount = 0;
+    for(Int i = 0; i != file.num_components; ++i) {
+        const jpeg_component_info& component = file.comp_info[i];
+        #if JPEG_LIB_VERSION >= 70
+        componentRowCount[i] = component.v_samp_factor*component.DCT_v_scaled_size;
+        componentStride[i] = component.width_in_blocks*component.DCT_h_scaled_size;
+        #else
+        componentRowCount[i] = component.v_samp_factor*component.DCT_scaled_size;
+        componentStride[i] = component.width_in_blocks*component.DCT_scaled_size;
+        #endif
+        scratchSize += componentRowCount[i]*componentStride[i];
+        rowCount += componentRowCount[i];
+
+        const Vector2i size(component.downsampled_width, component.downsampled_height);
+        arrayAppend(planes, InPlaceInit, PixelFormat::R8Unorm, size, Containers::Array<char>{ValueInit, ((size.x() + 3)/4)*4*std::size_t(size.y())});
+    }
+    scratch = Containers::Array<char>{NoInit, scratchSize};
+    rows = Containers::Array<JSAMPROW>{NoInit, rowCount};
+    for(std::size_t i = 0, row = 0, offset = 0; i != std::size_t(file.num_components); ++i) {
+        componentRows[i] = rows.data() + row;
+        for(std::size_t j = 0; j != componentRowCount[i]; ++j, ++row, offset += componentStride[i])
+            rows[row] = reinterpret_cast<JSAMPROW>(scratch.data() + offset);
+    }
+
+    /* Read the data, flipping each plane to have the origin at bottom left */
+    #if JPEG_LIB_VERSION >= 70
+    const JDIMENSION linesPerIMCURow = file.max_v_samp_factor*file.min_DCT_v_scaled_size;
+    #else
+    const JDIMENSION linesPerIMCURow = file.max_v_samp_factor*file.min_DCT_scaled_size;
+    #endif
+    while(file.output_scanline < file.output_height) {
+        const std::size_t iMCURow = file.output_scanline/linesPerIMCURow;
+        jpeg_read_raw_data(&file, componentRows, linesPerIMCURow);
+        for(Int i = 0; i != file.num_components; ++i) {
+            const std::size_t width = planes[i].size().x();
+            const std::size_t height = planes[i].size().y();
+            const std::size_t stride = ((width + 3)/4)*4;
+            const std::size_t first = iMCURow*componentRowCount[i];
+            const std::size_t end = Math::min(first + componentRowCount[i], height);
+            for(std::size_t j = first; j < end; ++j)
+                Utility::copy(
+                    Containers::arrayView(reinterpret_cast<const char*>(componentRows[i][j - first]), width),
+                    planes[i].mutableData().sliceSize((height - j - 1)*stride, width));
+        }
+    }
+
+    jpeg_finish_decompress(&file);
+    jpeg_destroy_decompress(&file);
+
+    _planes = Utility::move(planes);
 }
 
-UnsignedInt JpegImporter::doImage2DCount() const { return 1; }
+UnsignedInt JpegImporter::doImage2DCount() const {
+    return _planes.isEmpty() ? 1 : _planes.size();
+}
+
+Containers::Optional<ImageData2D> JpegImporter::doImage2D(const UnsignedInt id, UnsignedInt) {
+    /* YUV planes were decoded already on opening, return a copy */
+    if(!_planes.isEmpty()) {
+        const ImageData2D& plane = _planes[id];
+        Containers::Array<char> data{NoInit, plane.data().size()};
+        Utility::copy(plane.data(), data);
+        return ImageData2D{plane.format(), plane.size(), Utility::move(data)};
+    }
+
+    const Containers::StringView outputFormat = configuration().value<Containers::StringView>("outputFormat");
+    if(outputFormat == "YUV"_s) {
+        Error{} << "Trade::JpegImporter::image2D(): YUV output has to be enabled before opening the file";
+        return Containers::NullOpt;
+    }
+    if(outputFormat && outputFormat != "RGBA"_s && outputFormat != "BGRA"_s) {
+        Error{} << "Trade::JpegImporter::image2D(): expected outputFormat to be empty, RGBA, BGRA or YUV, got" << outputFormat;
+        return Containers::NullOpt;
+    }
+    #ifndef JCS_ALPHA_EXTENSIONS
+    if(outputFormat) {
+        Error{} << "Trade::JpegImporter::image2D():" << outputFormat << "output requires libjpeg-turbo";
+        return Containers::NullOpt;
+    }
+    #endif
+
+    /* All libJPEG versions support at least these scales */
+    const UnsignedInt scale = configuration().value<UnsignedInt>("scale");
+    if(scale != 1 && scale != 2 && scale != 4 && scale != 8) {
+        Error{} << "Trade::JpegImporter::image2D(): expected scale to be 1, 2, 4 or 8, got" << scale;
+        return Containers::NullOpt;
+    }
 
-Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedInt) {
     /* Initialize structures */
     jpeg_decompress_struct file;
     Containers::Array<char> data;
+    Containers::Array<char> scratch;
 
-    /* Fugly error handling stuff */
-    /** @todo Get rid of this crap */
-    struct ErrorManager {
-        jpeg_error_mgr jpegErrorManager;
-        std::jmp_buf setjmpBuffer;
-        char message[JMSG_LENGTH_MAX]{};
-    } errorManager;
+    ErrorManager errorManager;
     file.err = jpeg_std_error(&errorManager.jpegErrorManager);
-    errorManager.jpegErrorManager.error_exit = [](j_common_ptr info) {
-        auto& errorManager = *reinterpret_cast<ErrorManager*>(info->err);
-        info->err->format_message(info, errorManager.message);
-        std::longjmp(errorManager.setjmpBuffer, 1);
-    };
+    errorManager.jpegErrorManager.error_exit = errorExit;
     if(setjmp(errorManager.setjmpBuffer)) {
         Error() << "Trade::JpegImporter::image2D(): error:" << errorManager.message;
         jpeg_destroy_decompress(&file);
@@ -129,15 +298,30 @@ Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedI
     /* Older libjpegs want a mutable pointer, can't const here */
     jpeg_mem_src(&file, reinterpret_cast<unsigned char*>(_in.begin()), _in.size());
 
-    /* Read file header, start decompression. On macOS (Travis, with Xcode 7.3)
-       the compilation fails because "no known conversion from 'bool' to
-       'boolean' for 2nd argument" (boolean is an enum instead of a typedef to
-       int there) so doing the conversion implicitly. */
+    /* Read file header. On macOS (Travis, with Xcode 7.3) the compilation
+       fails because "no known conversion from 'bool' to 'boolean' for 2nd
+       argument" (boolean is an enum instead of a typedef to int there) so
+       doing the conversion implicitly. */
     jpeg_read_header(&file, boolean(true));
+
+    /* Decode at a reduced size directly in the DCT domain if requested */
+    file.scale_num = 1;
+    file.scale_denom = scale;
+
+    /* Let libjpeg-turbo expand to four channels if requested, which is
+       significantly faster than doing that on the decoded data */
+    #ifdef JCS_ALPHA_EXTENSIONS
+    if(outputFormat == "RGBA"_s)
+        file.out_color_space = JCS_EXT_RGBA;
+    else if(outputFormat == "BGRA"_s)
+        file.out_color_space = JCS_EXT_BGRA;
+    #endif
+
+    /* Start decompression */
     jpeg_start_decompress(&file);
 
     /* Image size and type */
-    const Vector2i size(file.output_width, file.output_height);
+    const Vector2i imageSize(file.output_width, file.output_height);
     static_assert(BITS_IN_JSAMPLE == 8, "Only 8-bit JPEG is supported");
 
     /* Image format */
@@ -152,7 +336,16 @@ Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedI
             format = PixelFormat::RGB8Unorm;
             break;
 
-        /** @todo RGBA (only in libjpeg-turbo and probably ignored) */
+        #ifdef JCS_ALPHA_EXTENSIONS
+        case JCS_EXT_RGBA:
+            CORRADE_INTERNAL_ASSERT(file.out_color_components == 4);
+            format = PixelFormat::RGBA8Unorm;
+            break;
+        case JCS_EXT_BGRA:
+            CORRADE_INTERNAL_ASSERT(file.out_color_components == 4);
+            format = pixelFormatWrap(VkFormatB8G8R8A8Unorm);
+            break;
+        #endif
 
         default:
             Error() << "Trade::JpegImporter::image2D(): unsupported color space" << file.out_color_space;
@@ -161,21 +354,84 @@ Containers::Optional<ImageData2D> JpegImporter::doImage2D(UnsignedInt, UnsignedI
             return Containers::NullOpt;
     }
 
+    /* Region to decode, with origin at bottom left like the imported image.
+       The whole image if not specified. */
+    const Range2Di region = configuration().value<Containers::StringView>("region").isEmpty() ?
+        Range2Di{{}, imageSize} :
+        configuration().value<Range2Di>("region");
+    if((region.min() < Vector2i{}).any() || (region.max() > imageSize).any() || (region.size() <= Vector2i{}).any()) {
+        Error{} << "Trade::JpegImporter::image2D(): region" << Debug::packed << region << "out of range for an image of size" << Debug::packed << imageSize;
+        jpeg_abort_decompress(&file);
+        jpeg_destroy_decompress(&file);
+        return Containers::NullOpt;
+    }
+    const Vector2i size = region.size();
+
+    /* Scanlines are ordered from top to bottom */
+    const JDIMENSION firstScanline = imageSize.y() - region.max().y();
+    const JDIMENSION endScanline = imageSize.y() - region.min().y();
+
+    /* With libjpeg-turbo, columns outside of the region are cropped away
+       (with the crop rounded to whole iMCUs) and rows above the region are
+       skipped without decoding them. One more column on each side is kept so
+       chroma upsampling at the region edges gives the same result as when
+       decoding the whole image. Otherwise full rows are decoded and the
+       region copied out of them. */
+    JDIMENSION cropOffset = 0;
+    #ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    if(size.x() != imageSize.x()) {
+        cropOffset = Math::max(region.min().x() - 1, 0);
+        JDIMENSION cropWidth = Math::min(region.max().x() + 1, imageSize.x()) - cropOffset;
+        jpeg_crop_scanline(&file, &cropOffset, &cropWidth);
+    }
+    if(firstScanline)
+        jpeg_skip_scanlines(&file, firstScanline);
+    #endif
+
     /* Initialize data array, align rows to four bytes */
-    const std::size_t stride = ((size.x()*file.out_color_components*BITS_IN_JSAMPLE/8 + 3)/4)*4;
+    const std::size_t pixelSize = file.out_color_components*BITS_IN_JSAMPLE/8;
+    const std::size_t rowSize = size.x()*pixelSize;
+    const std::size_t stride = ((rowSize + 3)/4)*4;
     data = Containers::Array<char>{stride*std::size_t(size.y())};
 
-    /* Read image row by row */
-    while(file.output_scanline < file.output_height) {
-        JSAMPROW row = reinterpret_cast<JSAMPROW>(data.data() + (size.y() - file.output_scanline - 1)*stride);
-        jpeg_read_scanlines(&file, &row, 1);
+    /* If the decoded rows are wider than the region, decode into a scratch
+       buffer first */
+    enum: std::size_t { BatchSize = 16 };
+    const std::size_t columnOffset = (region.min().x() - cropOffset)*pixelSize;
+    const std::size_t scratchStride = file.output_width*pixelSize;
+    const bool decodeToScratch = columnOffset || file.output_width != JDIMENSION(size.x());
+    if(decodeToScratch || file.output_scanline < firstScanline)
+        scratch = Containers::Array<char>{NoInit, BatchSize*scratchStride};
+
+    /* Read image in batches of rows, discarding the ones above the region if
+       they weren't skipped above */
+    JSAMPROW rows[BatchSize];
+    while(file.output_scanline < endScanline) {
+        const JDIMENSION scanline = file.output_scanline;
+        const bool discard = scanline < firstScanline;
+        const JDIMENSION count = Math::min(JDIMENSION(BatchSize), (discard ? firstScanline : endScanline) - scanline);
+        for(JDIMENSION i = 0; i != count; ++i)
+            rows[i] = reinterpret_cast<JSAMPROW>(discard || decodeToScratch ?
+                scratch.data() + i*scratchStride :
+                data.data() + (endScanline - scanline - i - 1)*stride);
+
+        const JDIMENSION read = jpeg_read_scanlines(&file, rows, count);
+        if(!discard && decodeToScratch) for(JDIMENSION i = 0; i != read; ++i)
+            Utility::copy(scratch.sliceSize(i*scratchStride + columnOffset, rowSize),
+                data.sliceSize((endScanline - scanline - i - 1)*stride, rowSize));
     }
 
-    /* Cleanup */
-    jpeg_finish_decompress(&file);
+    /* Cleanup. If the region doesn't reach the bottom of the image, the rest
+       of it isn't decoded at all. */
+    if(file.output_scanline == file.output_height)
+        jpeg_finish_decompress(&file);
+    else
+        jpeg_abort_decompress(&file);
     jpeg_destroy_decompress(&file);
 
     /* Always using the default 4-byte alignment */
+    if(isPixelFormatImplementationSpecific(format))
+        return Trade::ImageData2D{PixelStorage{}, pixelFormatUnwrap<UnsignedInt>(format), 0, UnsignedInt(pixelSize), size, Utility::move(data)};
     return Trade::ImageData2D{format, size, Utility::move(data)};
 }
 
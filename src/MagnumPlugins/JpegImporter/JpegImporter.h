@@ -114,14 +114,72 @@ See @ref building-plugins, @ref cmake-plugins, @ref plugins and
 @section Trade-JpegImporter-behavior Behavior and limitations
 
 The images are imported with @ref PixelFormat::RGB8Unorm or
-@ref PixelFormat::R8Unorm. All imported images use default @ref PixelStorage
-parameters.
+@ref PixelFormat::R8Unorm by default, see
+@ref Trade-JpegImporter-behavior-output-format below for other options. All
+imported images use default @ref PixelStorage parameters.
+
+@subsection Trade-JpegImporter-behavior-scale-region Scaled and partial decoding
+
+Setting the @cb{.ini} scale @ce
+@ref Trade-JpegImporter-configuration "configuration option" to @cpp 2 @ce,
+@cpp 4 @ce or @cpp 8 @ce decodes the image at given fraction of its size,
+rounded up. The downscaling is done directly in the DCT domain, making it
+significantly faster than decoding the full image and resizing it after, which
+is useful especially for generating thumbnails. Note that the result isn't
+exactly the same as when resizing the fully decoded image.
+
+The @cb{.ini} region @ce option then allows decoding just a part of the
+(scaled) image, specified in pixels with the origin at bottom left, consistently
+with the imported image orientation. Rows below the region are never decoded.
+With [libjpeg-turbo](https://libjpeg-turbo.org/) 2.0 and newer, rows above the
+region are skipped and only columns spanning the region are decoded, other
+implementations decode full rows and discard the extra data. In all cases the
+decoded region is the same as the corresponding part of a fully decoded image.
+
+@subsection Trade-JpegImporter-behavior-output-format Output format
+
+With [libjpeg-turbo](https://libjpeg-turbo.org/), setting the
+@cb{.ini} outputFormat @ce
+@ref Trade-JpegImporter-configuration "configuration option" to
+@cb{.ini} RGBA @ce makes the decoder output @ref PixelFormat::RGBA8Unorm
+directly, with the alpha channel set to @cpp 255 @ce. That's useful for
+uploading to GPUs that don't support three-component formats, avoiding a
+conversion pass over the decoded data. With other libJPEG implementations it
+fails to import.
+
+Setting the option to @cb{.ini} BGRA @ce is similar, but as there's no generic
+BGRA format, the image is imported with an implementation-specific format
+containing the value of @cpp VK_FORMAT_B8G8R8A8_UNORM @ce, see
+@ref pixelFormatWrap() for more information. This output is thus usable only
+with Vulkan, for example by passing the format to @ref Vk::pixelFormat(). The
+OpenGL wrapper, image converters and other generic code can't interpret it
+and will either fail or assert on it. Like with @cb{.ini} RGBA @ce, with
+libJPEG implementations other than libjpeg-turbo it fails to import.
+
+Setting the option to @cb{.ini} YUV @ce imports each plane of a grayscale or
+YCbCr image as a separate @ref PixelFormat::R8Unorm image, with the chroma
+planes at their subsampled size, skipping chroma upsampling and color
+conversion altogether. This is meant for doing the conversion on the GPU. In
+this case the planes are all decoded already during file opening, so the
+option has to be set before. The @cb{.ini} scale @ce option is supported for
+YUV output, the @cb{.ini} region @ce option isn't. CMYK and YCCK images fail to
+import.
 
 @subsection Trade-JpegImporter-behavior-implementations libJPEG implementations
 
 While some systems (such as macOS) still ship only with the vanilla libJPEG,
 you can get a much better decoding performance by using
 [libjpeg-turbo](https://libjpeg-turbo.org/).
+
+@section Trade-JpegImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration(). See
+below for all options and their default values:
+
+@snippet MagnumPlugins/JpegImporter/JpegImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_JPEGIMPORTER_EXPORT JpegImporter: public AbstractImporter {
     public:
@@ -150,6 +208,7 @@ class MAGNUM_JPEGIMPORTER_EXPORT JpegImporter: public AbstractImporter {
         MAGNUM_JPEGIMPORTER_LOCAL Containers::Optional<ImageData2D> doImage2D(UnsignedInt id, UnsignedInt level) override;
 
         Containers::Array<char> _in;
+        Containers::Array<ImageData2D> _planes;
 };
 
 }}
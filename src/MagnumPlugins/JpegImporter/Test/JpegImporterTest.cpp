@@ -29,13 +29,26 @@
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Math/ConfigurationValue.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/AbstractImporter.h>
 #include <Magnum/Trade/ImageData.h>
 
 #include "configure.h"
 
+/* jpeglib.h is needed to query if RGBA output is supported
+   (JCS_ALPHA_EXTENSIONS). See JpegImporter.cpp for details why the define
+   below, and the <cstdio> include, are needed. */
+#ifdef CORRADE_TARGET_WINDOWS
+#define XMD_H
+#endif
+#include <cstdio>
+#include <jpeglib.h>
+
 namespace Magnum { namespace Trade { namespace Test { namespace {
 
 struct JpegImporterTest: TestSuite::Tester {
@@ -48,6 +61,18 @@ struct JpegImporterTest: TestSuite::Tester {
     void rgb();
     void cmyk();
 
+    void scale();
+    void scaleInvalid();
+    void region();
+    void regionOutOfRange();
+
+    void outputFormat();
+    void outputFormatInvalid();
+    void yuv();
+    void yuvRegion();
+    void yuvUnsupportedColorSpace();
+    void yuvEnabledAfterOpen();
+
     void openMemory();
     void openTwice();
     void importTwice();
@@ -72,6 +97,84 @@ const struct {
     }},
 };
 
+const struct {
+    const char* name;
+    UnsignedInt scale;
+    Vector2i size;
+} ScaleData[]{
+    {"1/2", 2, {34, 22}},
+    {"1/4", 4, {17, 11}},
+    {"1/8", 8, {9, 6}}
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt scale;
+    Range2Di region;
+} RegionData[]{
+    {"grayscale, whole image", "gray.jpg", 1, {{0, 0}, {3, 2}}},
+    {"grayscale, top right", "gray.jpg", 1, {{1, 1}, {3, 2}}},
+    {"left", "rgb-large.jpg", 1, {{0, 0}, {20, 43}}},
+    {"middle", "rgb-large.jpg", 1, {{17, 5}, {50, 30}}},
+    {"top right", "rgb-large.jpg", 1, {{33, 20}, {67, 43}}},
+    {"single pixel", "rgb-large.jpg", 1, {{40, 13}, {41, 14}}},
+    {"scaled, middle", "rgb-large.jpg", 2, {{5, 3}, {20, 15}}}
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    const char* outputFormat;
+    PixelFormat format;
+    Containers::ArrayView<const char> data;
+} OutputFormatData[]{
+    {"RGBA", "rgb.jpg", "RGBA", PixelFormat::RGBA8Unorm, Containers::arrayView<char>({
+        '\xca', '\xfe', '\x76', '\xff',
+        '\xdf', '\xad', '\xb6', '\xff',
+        '\xca', '\xfe', '\x76', '\xff',
+
+        '\xe0', '\xad', '\xb6', '\xff',
+        '\xc9', '\xff', '\x76', '\xff',
+        '\xdf', '\xad', '\xb6', '\xff'
+    })},
+    {"BGRA", "rgb.jpg", "BGRA", pixelFormatWrap(44u), Containers::arrayView<char>({
+        '\x76', '\xfe', '\xca', '\xff',
+        '\xb6', '\xad', '\xdf', '\xff',
+        '\x76', '\xfe', '\xca', '\xff',
+
+        '\xb6', '\xad', '\xe0', '\xff',
+        '\x76', '\xff', '\xc9', '\xff',
+        '\xb6', '\xad', '\xdf', '\xff'
+    })},
+    {"RGBA, grayscale", "gray.jpg", "RGBA", PixelFormat::RGBA8Unorm, Containers::arrayView<char>({
+        '\xff', '\xff', '\xff', '\xff',
+        '\x88', '\x88', '\x88', '\xff',
+        '\x00', '\x00', '\x00', '\xff',
+
+        '\x88', '\x88', '\x88', '\xff',
+        '\x00', '\x00', '\x00', '\xff',
+        '\xff', '\xff', '\xff', '\xff'
+    })},
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt scale;
+    UnsignedInt count;
+    Vector2i lumaSize, chromaSize;
+} YuvData[]{
+    {"grayscale", "gray.jpg", 1, 1, {3, 2}, {}},
+    /* 4:2:0 subsampling, so the chroma planes are half the size, rounded up */
+    {"YCbCr", "rgb-large.jpg", 1, 3, {67, 43}, {34, 22}},
+    /* libjpeg-turbo upsamples the chroma planes in the DCT domain if scaling,
+       which isn't the case with other implementations */
+    #ifdef LIBJPEG_TURBO_VERSION_NUMBER
+    {"YCbCr, scaled", "rgb-large.jpg", 2, 3, {34, 22}, {34, 22}},
+    #endif
+};
+
 JpegImporterTest::JpegImporterTest() {
     addTests({&JpegImporterTest::empty,
               &JpegImporterTest::invalid,
@@ -80,6 +183,28 @@ JpegImporterTest::JpegImporterTest() {
               &JpegImporterTest::rgb,
               &JpegImporterTest::cmyk});
 
+    addInstancedTests({&JpegImporterTest::scale},
+        Containers::arraySize(ScaleData));
+
+    addTests({&JpegImporterTest::scaleInvalid});
+
+    addInstancedTests({&JpegImporterTest::region},
+        Containers::arraySize(RegionData));
+
+    addTests({&JpegImporterTest::regionOutOfRange});
+
+    addInstancedTests({&JpegImporterTest::outputFormat},
+        Containers::arraySize(OutputFormatData));
+
+    addTests({&JpegImporterTest::outputFormatInvalid});
+
+    addInstancedTests({&JpegImporterTest::yuv},
+        Containers::arraySize(YuvData));
+
+    addTests({&JpegImporterTest::yuvRegion,
+              &JpegImporterTest::yuvUnsupportedColorSpace,
+              &JpegImporterTest::yuvEnabledAfterOpen});
+
     addInstancedTests({&JpegImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
@@ -182,6 +307,196 @@ void JpegImporterTest::cmyk() {
     CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): unsupported color space 4\n");
 }
 
+void JpegImporterTest::scale() {
+    auto&& data = ScaleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("scale", data.scale);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb-large.jpg")));
+
+    /* The original size is 67x43, the scaled size is rounded up. The result
+       isn't the same as when resizing the full image, so not comparing the
+       data. */
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->size(), data.size);
+    CORRADE_COMPARE(image->format(), PixelFormat::RGB8Unorm);
+}
+
+void JpegImporterTest::scaleInvalid() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("scale", 3);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): expected scale to be 1, 2, 4 or 8, got 3\n");
+}
+
+void JpegImporterTest::region() {
+    auto&& data = RegionData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("scale", data.scale);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, data.filename)));
+
+    /* Import the whole image first to have something to compare to */
+    Containers::Optional<Trade::ImageData2D> full = importer->image2D(0);
+    CORRADE_VERIFY(full);
+
+    importer->configuration().setValue("region", data.region);
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->flags(), ImageFlags2D{});
+    CORRADE_COMPARE(image->size(), data.region.size());
+    CORRADE_COMPARE(image->format(), full->format());
+
+    /* The region should be exactly the same as the corresponding part of the
+       whole image, even with chroma subsampling */
+    for(Int y = 0; y != data.region.sizeY(); ++y) {
+        CORRADE_ITERATION(y);
+        if(full->format() == PixelFormat::R8Unorm)
+            CORRADE_COMPARE_AS(image->pixels<UnsignedByte>()[y],
+                full->pixels<UnsignedByte>()[data.region.min().y() + y].sliceSize(data.region.min().x(), data.region.sizeX()),
+                TestSuite::Compare::Container);
+        else
+            CORRADE_COMPARE_AS(image->pixels<Color3ub>()[y],
+                full->pixels<Color3ub>()[data.region.min().y() + y].sliceSize(data.region.min().x(), data.region.sizeX()),
+                TestSuite::Compare::Container);
+    }
+}
+
+void JpegImporterTest::regionOutOfRange() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("region", Range2Di{{1, 0}, {4, 2}});
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): region {{1, 0}, {4, 2}} out of range for an image of size {3, 2}\n");
+}
+
+void JpegImporterTest::outputFormat() {
+    auto&& data = OutputFormatData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("outputFormat", data.outputFormat);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, data.filename)));
+
+    /* If we don't have libjpeg-turbo, importing RGBA will fail */
+    #ifndef JCS_ALPHA_EXTENSIONS
+    {
+        Containers::String out;
+        Error redirectError{&out};
+        CORRADE_VERIFY(!importer->image2D(0));
+        CORRADE_COMPARE(out, Utility::format("Trade::JpegImporter::image2D(): {} output requires libjpeg-turbo\n", data.outputFormat));
+    }
+
+    CORRADE_SKIP("libjpeg-turbo is required for RGBA and BGRA output.");
+    #endif
+
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->flags(), ImageFlags2D{});
+    CORRADE_COMPARE(image->size(), Vector2i(3, 2));
+    CORRADE_COMPARE(image->format(), data.format);
+    CORRADE_COMPARE(image->pixelSize(), 4);
+
+    /* Four-byte pixels, so there's no row padding */
+    CORRADE_COMPARE_AS(image->data(), data.data,
+        TestSuite::Compare::Container);
+}
+
+void JpegImporterTest::outputFormatInvalid() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("outputFormat", "RGBX");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): expected outputFormat to be empty, RGBA, BGRA or YUV, got RGBX\n");
+}
+
+void JpegImporterTest::yuv() {
+    auto&& data = YuvData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("outputFormat", "YUV");
+    importer->configuration().setValue("scale", data.scale);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(importer->image2DCount(), data.count);
+
+    /* The luma plane should be the same as a grayscale import */
+    Containers::Optional<Trade::ImageData2D> luma = importer->image2D(0);
+    CORRADE_VERIFY(luma);
+    CORRADE_COMPARE(luma->flags(), ImageFlags2D{});
+    CORRADE_COMPARE(luma->size(), data.lumaSize);
+    CORRADE_COMPARE(luma->format(), PixelFormat::R8Unorm);
+    if(data.count == 1) {
+        /* Same as in gray(), clear the padding to deterministic values */
+        CORRADE_COMPARE(luma->data().size(), 8);
+        luma->mutableData()[3] = luma->mutableData()[7] = 0;
+        CORRADE_COMPARE_AS(luma->data(), Containers::arrayView<char>({
+            '\xff', '\x88', '\x00', 0,
+            '\x88', '\x00', '\xff', 0
+        }), TestSuite::Compare::Container);
+    }
+
+    for(UnsignedInt i = 1; i < data.count; ++i) {
+        CORRADE_ITERATION(i);
+        Containers::Optional<Trade::ImageData2D> chroma = importer->image2D(i);
+        CORRADE_VERIFY(chroma);
+        CORRADE_COMPARE(chroma->size(), data.chromaSize);
+        CORRADE_COMPARE(chroma->format(), PixelFormat::R8Unorm);
+    }
+
+    /* Importing a plane again gives back the same data. The padding is
+       zero-initialized in this case, so it's fine to compare it too. */
+    Containers::Optional<Trade::ImageData2D> luma2 = importer->image2D(0);
+    CORRADE_VERIFY(luma2);
+    CORRADE_COMPARE_AS(luma2->data(), luma->data(),
+        TestSuite::Compare::Container);
+}
+
+void JpegImporterTest::yuvRegion() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("outputFormat", "YUV");
+    importer->configuration().setValue("region", Range2Di{{1, 0}, {3, 2}});
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::openData(): region decoding isn't supported for YUV output\n");
+}
+
+void JpegImporterTest::yuvUnsupportedColorSpace() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    importer->configuration().setValue("outputFormat", "YUV");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "cmyk.jpg")));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::openData(): unsupported color space 5 for YUV output\n");
+}
+
+void JpegImporterTest::yuvEnabledAfterOpen() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("JpegImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(JPEGIMPORTER_TEST_DIR, "rgb.jpg")));
+    importer->configuration().setValue("outputFormat", "YUV");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->image2D(0));
+    CORRADE_COMPARE(out, "Trade::JpegImporter::image2D(): YUV output has to be enabled before opening the file\n");
+}
+
 void JpegImporterTest::openMemory() {
     /* same as gray() except that it uses openData() & openMemory() instead of
        openFile() to test data copying on import */
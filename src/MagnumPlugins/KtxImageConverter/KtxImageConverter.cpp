@@ -27,7 +27,9 @@
 
 #include "KtxImageConverter.h"
 
+#include <atomic>
 #include <string>
+#include <thread> /* std::thread::hardware_concurrency(), sigh */
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Pair.h>
@@ -46,6 +48,13 @@
 #include "Magnum/Implementation/formatPluginsVersion.h"
 #include "MagnumPlugins/KtxImporter/KtxHeader.h"
 
+#ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+#include <zlib.h>
+#endif
+
 namespace Magnum { namespace Trade {
 
 namespace {
@@ -684,6 +693,41 @@ void endianSwap(Containers::ArrayView<char> data, UnsignedInt typeSize) {
     CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
 }
 
+/* Supercompresses a single level. Returns nullptr on success or an error
+   string on failure. Called from worker threads, so it can't print anything
+   on its own -- Debug output redirection is thread-local. */
+const char* supercompressLevel(const Implementation::SuperCompressionScheme scheme, const Int level, const Containers::ArrayView<const char> in, Containers::Array<char>& out, std::size_t& outSize) {
+    #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+    if(scheme == Implementation::SuperCompressionScheme::Zstandard) {
+        out = Containers::Array<char>{NoInit, ZSTD_compressBound(in.size())};
+        const std::size_t result = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), level);
+        if(ZSTD_isError(result))
+            return ZSTD_getErrorName(result);
+        outSize = result;
+        return nullptr;
+    }
+    #endif
+
+    #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+    if(scheme == Implementation::SuperCompressionScheme::ZLIB) {
+        out = Containers::Array<char>{NoInit, compressBound(in.size())};
+        uLongf size = out.size();
+        const int result = compress2(reinterpret_cast<Bytef*>(out.data()), &size, reinterpret_cast<const Bytef*>(in.data()), in.size(), level);
+        if(result != Z_OK)
+            return zError(result);
+        outSize = size;
+        return nullptr;
+    }
+    #endif
+
+    /* Unavailable schemes are rejected in convertLevels() already */
+    static_cast<void>(level);
+    static_cast<void>(in);
+    static_cast<void>(out);
+    static_cast<void>(outSize);
+    CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+}
+
 using namespace Containers::Literals;
 
 /* Having this inside convertLevels() leads to errors with GCC 4.8 ("cannot
@@ -710,7 +754,7 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
         return {};
     }
 
-    const Containers::Array<char> dataFormatDescriptor = fillDataFormatDescriptor(format, vkFormat.second());
+    Containers::Array<char> dataFormatDescriptor = fillDataFormatDescriptor(format, vkFormat.second());
 
     /* Fill key/value data. Values can be any byte-string but we only write
        constant text strings. Keys must be sorted alphabetically.
@@ -758,6 +802,47 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
         return {};
     }
 
+    /* Supercompression scheme and level. An empty level means the library
+       default. */
+    const auto supercompression = configuration.value<Containers::StringView>("supercompression");
+    const bool supercompressionLevelSet = !configuration.value<Containers::StringView>("supercompressionLevel").isEmpty();
+    Implementation::SuperCompressionScheme supercompressionScheme = Implementation::SuperCompressionScheme::None;
+    Int supercompressionLevel = 0;
+    if(supercompression == "zstd"_s) {
+        #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+        supercompressionScheme = Implementation::SuperCompressionScheme::Zstandard;
+        supercompressionLevel = supercompressionLevelSet ? configuration.value<Int>("supercompressionLevel") : ZSTD_CLEVEL_DEFAULT;
+        if(supercompressionLevel < ZSTD_minCLevel() || supercompressionLevel > ZSTD_maxCLevel()) {
+            Error{} << "Trade::KtxImageConverter::convertToData(): expected zstd supercompression level between" << ZSTD_minCLevel() << "and" << ZSTD_maxCLevel() << "but got" << supercompressionLevel;
+            return {};
+        }
+        #else
+        Error{} << "Trade::KtxImageConverter::convertToData(): zstd supercompression is not available, the plugin was built without Zstd";
+        return {};
+        #endif
+    } else if(supercompression == "zlib"_s) {
+        #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+        supercompressionScheme = Implementation::SuperCompressionScheme::ZLIB;
+        supercompressionLevel = supercompressionLevelSet ? configuration.value<Int>("supercompressionLevel") : Z_DEFAULT_COMPRESSION;
+        if(supercompressionLevel < Z_DEFAULT_COMPRESSION || supercompressionLevel > Z_BEST_COMPRESSION) {
+            Error{} << "Trade::KtxImageConverter::convertToData(): expected zlib supercompression level between" << Z_DEFAULT_COMPRESSION << "and" << Z_BEST_COMPRESSION << "but got" << supercompressionLevel;
+            return {};
+        }
+        #else
+        Error{} << "Trade::KtxImageConverter::convertToData(): zlib supercompression is not available, the plugin was built without zlib";
+        return {};
+        #endif
+    } else if(supercompression) {
+        Error{} << "Trade::KtxImageConverter::convertToData(): invalid supercompression scheme" << supercompression << Debug::nospace << ", expected zstd, zlib or an empty value";
+        return {};
+    }
+    static_cast<void>(supercompressionLevelSet);
+
+    /* The spec requires bytesPlane0 to be zero for supercompressed data, as
+       the level data isn't directly addressable in that case */
+    if(supercompressionScheme != Implementation::SuperCompressionScheme::None)
+        reinterpret_cast<Implementation::KdfBasicBlockHeader*>(dataFormatDescriptor.exceptPrefix(sizeof(UnsignedInt)).data())->bytesPlane[0] = 0;
+
     /* Value has to be a String instead of a StringView due to the generated
        writer name. The orientation and swizzle are however fortunately small
        enough to fit into SSO. */
@@ -823,17 +908,12 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
     /* Fill level index */
     Containers::Array<Implementation::KtxLevel> levelIndex{numMipmaps};
 
-    const std::size_t levelIndexSize = numMipmaps*sizeof(Implementation::KtxLevel);
-    std::size_t levelOffset = sizeof(Implementation::KtxHeader) + levelIndexSize +
-        dataFormatDescriptor.size() + keyValueData.size();
-
     /* A "unit" is either a pixel or a block in a compressed format */
     const Vector3i unitSize = formatUnitSize(format);
     const UnsignedInt unitDataSize = formatUnitDataSize(format);
+    const UnsignedByte typeSize = formatTypeSize(format);
 
     for(UnsignedInt i = 0; i != levelIndex.size(); ++i) {
-        /* Mip levels are required to be stored from smallest to largest for
-           efficient streaming */
         const UnsignedInt mip = levelIndex.size() - 1 - i;
         const Math::Vector<dimensions, Int> mipSize = Math::max(size >> mip, 1)*mipMask + size*(Math::Vector<dimensions, Int>{1} - mipMask);
 
@@ -845,19 +925,84 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
             return {};
         }
 
-        /* Offset needs to be aligned to the least common multiple of the
-           texel/block size and 4. Not needed with supercompression. */
-        const std::size_t alignment = leastCommonMultiple(unitDataSize, 4);
-        levelOffset = (levelOffset + alignment - 1)/alignment*alignment;
-
         const Vector3i unitCount = (Vector3i::pad(mipSize, 1) + unitSize - Vector3i{1})/unitSize;
         const std::size_t levelSize = unitDataSize*unitCount.product();
 
-        levelIndex[mip].byteOffset = levelOffset;
         levelIndex[mip].byteLength = levelSize;
         levelIndex[mip].uncompressedByteLength = levelSize;
+    }
+
+    /* With supercompression, each level is compressed independently into a
+       separate array, with byteLength updated to the compressed size. The
+       arrays are allocated to the worst-case bound, only the byteLength prefix
+       gets copied to the output. */
+    Containers::Array<Containers::Array<char>> supercompressedLevels;
+    if(supercompressionScheme != Implementation::SuperCompressionScheme::None) {
+        supercompressedLevels = Containers::Array<Containers::Array<char>>{levelIndex.size()};
+        Containers::Array<const char*> errors{ValueInit, levelIndex.size()};
+
+        /* Value of 0 means all available cores, there's no point in having
+           more threads than there are levels */
+        UnsignedInt threadCount = configuration.value<UnsignedInt>("threads");
+        if(!threadCount) {
+            threadCount = std::thread::hardware_concurrency();
+            if(converterFlags & ImageConverterFlag::Verbose)
+                Debug{} << "Trade::KtxImageConverter::convertToData(): autodetected hardware concurrency to" << threadCount << "threads";
+        }
+        threadCount = Math::clamp<UnsignedInt>(threadCount, 1, levelIndex.size());
+
+        /* Each worker picks the next level that isn't taken yet. Largest
+           levels are first, which gives a reasonable load balance without any
+           explicit scheduling. */
+        std::atomic<std::size_t> nextLevel{0};
+        auto worker = [&]() {
+            Containers::Array<char> uncompressed;
+            std::size_t mip;
+            while((mip = nextLevel++) < levelIndex.size()) {
+                Implementation::KtxLevel& level = levelIndex[mip];
+                if(uncompressed.size() < level.uncompressedByteLength)
+                    uncompressed = Containers::Array<char>{NoInit, std::size_t(level.uncompressedByteLength)};
+                const Containers::ArrayView<char> pixels = uncompressed.prefix(level.uncompressedByteLength);
+                copyPixels(imageLevels[mip], pixels);
+                endianSwap(pixels, typeSize);
+
+                std::size_t compressedSize{};
+                errors[mip] = supercompressLevel(supercompressionScheme, supercompressionLevel, pixels, supercompressedLevels[mip], compressedSize);
+                level.byteLength = compressedSize;
+            }
+        };
+
+        Containers::Array<std::thread> threads{threadCount - 1};
+        for(std::thread& thread: threads)
+            thread = std::thread{worker};
+        worker();
+        for(std::thread& thread: threads)
+            thread.join();
+
+        for(UnsignedInt mip = 0; mip != levelIndex.size(); ++mip) {
+            if(errors[mip]) {
+                Error{} << "Trade::KtxImageConverter::convertToData(): supercompression of level" << mip << "failed:" << errors[mip];
+                return {};
+            }
+        }
+    }
+
+    const std::size_t levelIndexSize = numMipmaps*sizeof(Implementation::KtxLevel);
+    std::size_t levelOffset = sizeof(Implementation::KtxHeader) + levelIndexSize +
+        dataFormatDescriptor.size() + keyValueData.size();
+
+    /* Offset needs to be aligned to the least common multiple of the
+       texel/block size and 4. Not needed with supercompression. */
+    const std::size_t alignment = supercompressionScheme == Implementation::SuperCompressionScheme::None ? leastCommonMultiple(unitDataSize, 4) : 1;
+
+    for(UnsignedInt i = 0; i != levelIndex.size(); ++i) {
+        /* Mip levels are required to be stored from smallest to largest for
+           efficient streaming */
+        const UnsignedInt mip = levelIndex.size() - 1 - i;
 
-        levelOffset += levelSize;
+        levelOffset = (levelOffset + alignment - 1)/alignment*alignment;
+        levelIndex[mip].byteOffset = levelOffset;
+        levelOffset += levelIndex[mip].byteLength;
     }
 
     const std::size_t dataSize = levelOffset;
@@ -871,7 +1016,7 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
     Utility::copy(Containers::arrayView(Implementation::KtxFileIdentifier), Containers::arrayView(header.identifier));
 
     header.vkFormat = vkFormat.first();
-    header.typeSize = formatTypeSize(format);
+    header.typeSize = typeSize;
     header.imageSize = Vector3ui{Vector3i::pad(size, 0u)};
     /* Array and cube images have the last dimension 0, instead layer and face
        count is filled. Face count is 6 for cube maps, layer count != 0 only if
@@ -890,15 +1035,15 @@ template<UnsignedInt dimensions, template<UnsignedInt, typename> class View> Con
         header.faceCount = 1;
     }
     header.levelCount = levelIndex.size();
-    header.supercompressionScheme = Implementation::SuperCompressionScheme::None;
+    header.supercompressionScheme = supercompressionScheme;
 
     for(UnsignedInt i = 0; i != levelIndex.size(); ++i) {
-        const Implementation::KtxLevel& level = levelIndex[i];
-        const auto& image = imageLevels[i];
+        Implementation::KtxLevel& level = levelIndex[i];
         const auto pixels = data.sliceSize(level.byteOffset, level.byteLength);
-        copyPixels(image, pixels);
-
-        endianSwap(pixels, header.typeSize);
+        if(supercompressionScheme == Implementation::SuperCompressionScheme::None) {
+            copyPixels(imageLevels[i], pixels);
+            endianSwap(pixels, header.typeSize);
+        } else Utility::copy(supercompressedLevels[i].prefix(level.byteLength), pixels);
 
         Utility::Endianness::littleEndianInPlace(
             level.byteOffset, level.byteLength,
@@ -52,6 +52,26 @@
 #define MAGNUM_KTXIMAGECONVERTER_LOCAL
 #endif
 
+#ifdef DOXYGEN_GENERATING_OUTPUT
+/**
+@brief Whether Zstandard supercompression is available
+@m_since_latest_{plugins}
+
+Defined if the plugin was built with the Zstandard library. See
+@ref Trade-KtxImageConverter-behavior-supercompression for more information.
+*/
+#define MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+
+/**
+@brief Whether zlib supercompression is available
+@m_since_latest_{plugins}
+
+Defined if the plugin was built with the zlib library. See
+@ref Trade-KtxImageConverter-behavior-supercompression for more information.
+*/
+#define MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+#endif
+
 namespace Magnum { namespace Trade {
 
 /**
@@ -126,9 +146,21 @@ supported.
 
 @subsection Trade-KtxImageConverter-behavior-supercompression Supercompression
 
-Saving files with [supercompression](https://github.khronos.org/KTX-Specification/#supercompressionSchemes)
-is not supported. You can however use @ref BasisImageConverter to create
-Basis-supercompressed KTX2 files.
+Files can be saved with Zstandard or zlib [supercompression](https://github.khronos.org/KTX-Specification/#supercompressionSchemes)
+by setting the @cb{.ini} supercompression @ce
+@ref Trade-KtxImageConverter-configuration "configuration option" to
+@cb{.ini} zstd @ce or @cb{.ini} zlib @ce and optionally tuning
+@cb{.ini} supercompressionLevel @ce. The schemes are available only if the
+plugin is built with the [Zstandard](https://github.com/facebook/zstd)
+or [zlib](https://zlib.net/) library, respectively, which is done
+automatically if the libraries are found during CMake configuration. Use
+@ref MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD and
+@ref MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB to check for their presence.
+
+Each level is compressed independently, which allows the compression to be
+spread across multiple threads via the @cb{.ini} threads @ce option. Writing
+BasisLZ supercompression is not supported, you can however use
+@ref BasisImageConverter to create Basis-supercompressed KTX2 files.
 
 @section Trade-KtxImageConverter-configuration Plugin-specific configuration
 
@@ -33,6 +33,7 @@
 #include <Corrade/PluginManager/PluginMetadata.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Compare/String.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/Utility/Algorithms.h>
@@ -52,6 +53,14 @@
 #include <Magnum/Trade/ImageData.h>
 
 #include "MagnumPlugins/KtxImporter/KtxHeader.h"
+#include "MagnumPlugins/KtxImageConverter/configure.h"
+
+#ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 #include "configure.h"
 
@@ -123,6 +132,9 @@ struct KtxImageConverterTest: TestSuite::Tester {
     void configurationEmpty();
     void configurationSorted();
 
+    void supercompression();
+    void supercompressionInvalid();
+
     void convertTwice();
 
     /* Explicitly forbid system-wide plugin dependencies */
@@ -341,6 +353,45 @@ const struct {
     {"invalid characters", "1012", "invalid characters in swizzle 1012"}
 };
 
+const struct {
+    const char* name;
+    const char* supercompression;
+    const char* level;
+    UnsignedInt threads;
+    Implementation::SuperCompressionScheme scheme;
+} SupercompressionData[]{
+    {"zstd", "zstd", "", 1, Implementation::SuperCompressionScheme::Zstandard},
+    {"zstd, level 19", "zstd", "19", 1, Implementation::SuperCompressionScheme::Zstandard},
+    {"zstd, 2 threads", "zstd", "", 2, Implementation::SuperCompressionScheme::Zstandard},
+    {"zstd, all threads", "zstd", "", 0, Implementation::SuperCompressionScheme::Zstandard},
+    {"zlib", "zlib", "", 1, Implementation::SuperCompressionScheme::ZLIB},
+    {"zlib, level 9", "zlib", "9", 1, Implementation::SuperCompressionScheme::ZLIB},
+    {"zlib, all threads", "zlib", "", 0, Implementation::SuperCompressionScheme::ZLIB},
+};
+
+const struct {
+    const char* name;
+    const char* supercompression;
+    const char* level;
+    const char* message;
+} SupercompressionInvalidData[]{
+    {"invalid scheme", "basislz", "",
+        "invalid supercompression scheme basislz, expected zstd, zlib or an empty value"},
+    #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+    {"zlib level too small", "zlib", "-2",
+        "expected zlib supercompression level between -1 and 9 but got -2"},
+    {"zlib level too large", "zlib", "10",
+        "expected zlib supercompression level between -1 and 9 but got 10"},
+    #else
+    {"zlib not available", "zlib", "",
+        "zlib supercompression is not available, the plugin was built without zlib"},
+    #endif
+    #ifndef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+    {"zstd not available", "zstd", "",
+        "zstd supercompression is not available, the plugin was built without Zstd"},
+    #endif
+};
+
 Containers::Array<char> readDataFormatDescriptor(Containers::ArrayView<const char> fileData) {
     CORRADE_INTERNAL_ASSERT(fileData.size() >= sizeof(Implementation::KtxHeader));
     const Implementation::KtxHeader& header = *reinterpret_cast<const Implementation::KtxHeader*>(fileData.data());
@@ -365,6 +416,14 @@ Containers::String readKeyValueData(Containers::ArrayView<const char> fileData)
     return data;
 }
 
+Containers::ArrayView<const Implementation::KtxLevel> readLevelIndex(Containers::ArrayView<const char> fileData) {
+    CORRADE_INTERNAL_ASSERT(fileData.size() >= sizeof(Implementation::KtxHeader));
+    const Implementation::KtxHeader& header = *reinterpret_cast<const Implementation::KtxHeader*>(fileData.data());
+
+    const UnsignedInt levelCount = Utility::Endianness::littleEndian(header.levelCount);
+    return Containers::arrayCast<const Implementation::KtxLevel>(fileData.sliceSize(sizeof(Implementation::KtxHeader), levelCount*sizeof(Implementation::KtxLevel)));
+}
+
 KtxImageConverterTest::KtxImageConverterTest() {
     addTests({&KtxImageConverterTest::supportedFormat,
               &KtxImageConverterTest::supportedCompressedFormat,
@@ -443,9 +502,15 @@ KtxImageConverterTest::KtxImageConverterTest() {
     addInstancedTests({&KtxImageConverterTest::configurationEmpty},
         Containers::arraySize(QuietData));
 
-    addTests({&KtxImageConverterTest::configurationSorted,
+    addTests({&KtxImageConverterTest::configurationSorted});
+
+    addInstancedTests({&KtxImageConverterTest::supercompression},
+        Containers::arraySize(SupercompressionData));
+
+    addInstancedTests({&KtxImageConverterTest::supercompressionInvalid},
+        Containers::arraySize(SupercompressionInvalidData));
 
-              &KtxImageConverterTest::convertTwice});
+    addTests({&KtxImageConverterTest::convertTwice});
 
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
@@ -1467,6 +1532,106 @@ void KtxImageConverterTest::configurationSorted() {
     CORRADE_VERIFY(swizzleOffset.begin() < writerOffset.begin());
 }
 
+void KtxImageConverterTest::supercompression() {
+    auto&& data = SupercompressionData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+    if(data.scheme == Implementation::SuperCompressionScheme::Zstandard)
+        CORRADE_SKIP("KtxImageConverter was built without Zstd, can't test.");
+    #endif
+    #ifndef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+    if(data.scheme == Implementation::SuperCompressionScheme::ZLIB)
+        CORRADE_SKIP("KtxImageConverter was built without zlib, can't test.");
+    #endif
+
+    /* Large enough to not be dominated by the compression format overhead
+       and with enough levels to keep multiple threads busy */
+    Containers::Array<Color4ub> mip0{NoInit, 64*32};
+    Containers::Array<Color4ub> mip1{NoInit, 32*16};
+    Containers::Array<Color4ub> mip2{NoInit, 16*8};
+    for(std::size_t i = 0; i != mip0.size(); ++i)
+        mip0[i] = Color4ub{UnsignedByte(i%64), UnsignedByte(i/64), 0x7f, 0xff};
+    for(std::size_t i = 0; i != mip1.size(); ++i)
+        mip1[i] = Color4ub{UnsignedByte(i%32), UnsignedByte(i/32), 0x3f, 0xff};
+    for(std::size_t i = 0; i != mip2.size(); ++i)
+        mip2[i] = Color4ub{UnsignedByte(i%16), UnsignedByte(i/16), 0x1f, 0xff};
+    const ImageView2D inputImages[]{
+        ImageView2D{PixelFormat::RGBA8Unorm, {64, 32}, mip0},
+        ImageView2D{PixelFormat::RGBA8Unorm, {32, 16}, mip1},
+        ImageView2D{PixelFormat::RGBA8Unorm, {16, 8}, mip2},
+    };
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("KtxImageConverter");
+    Containers::Optional<Containers::Array<char>> uncompressed = converter->convertToData(inputImages);
+    CORRADE_VERIFY(uncompressed);
+
+    CORRADE_VERIFY(converter->configuration().setValue("supercompression", data.supercompression));
+    CORRADE_VERIFY(converter->configuration().setValue("supercompressionLevel", data.level));
+    CORRADE_VERIFY(converter->configuration().setValue("threads", data.threads));
+    Containers::Optional<Containers::Array<char>> compressed = converter->convertToData(inputImages);
+    CORRADE_VERIFY(compressed);
+    CORRADE_COMPARE_AS(compressed->size(), uncompressed->size(),
+        TestSuite::Compare::Less);
+
+    const Implementation::KtxHeader& header = *reinterpret_cast<const Implementation::KtxHeader*>(compressed->data());
+    CORRADE_COMPARE(Implementation::SuperCompressionScheme(Utility::Endianness::littleEndian(UnsignedInt(header.supercompressionScheme))), data.scheme);
+
+    /* bytesPlane0 is required to be zero with supercompression */
+    Containers::Array<char> dfd = readDataFormatDescriptor(*compressed);
+    const Implementation::KdfBasicBlockHeader& dfdHeader = *reinterpret_cast<const Implementation::KdfBasicBlockHeader*>(dfd.exceptPrefix(sizeof(UnsignedInt)).data());
+    CORRADE_COMPARE(dfdHeader.bytesPlane[0], 0);
+
+    /* Each level decompresses to the same data as written without
+       supercompression */
+    Containers::ArrayView<const Implementation::KtxLevel> uncompressedLevels = readLevelIndex(*uncompressed);
+    Containers::ArrayView<const Implementation::KtxLevel> compressedLevels = readLevelIndex(*compressed);
+    CORRADE_COMPARE(compressedLevels.size(), 3);
+    for(std::size_t i = 0; i != compressedLevels.size(); ++i) {
+        CORRADE_ITERATION(i);
+        const std::size_t expectedSize = Utility::Endianness::littleEndian(uncompressedLevels[i].byteLength);
+        const std::size_t compressedOffset = Utility::Endianness::littleEndian(compressedLevels[i].byteOffset);
+        const std::size_t compressedSize = Utility::Endianness::littleEndian(compressedLevels[i].byteLength);
+        CORRADE_COMPARE(Utility::Endianness::littleEndian(compressedLevels[i].uncompressedByteLength), expectedSize);
+        CORRADE_COMPARE_AS(compressedSize, expectedSize,
+            TestSuite::Compare::Less);
+
+        const Containers::ArrayView<const char> compressedData = compressed->sliceSize(compressedOffset, compressedSize);
+        Containers::Array<char> decompressed{NoInit, expectedSize};
+        #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+        if(data.scheme == Implementation::SuperCompressionScheme::Zstandard)
+            CORRADE_COMPARE(ZSTD_decompress(decompressed.data(), decompressed.size(), compressedData.data(), compressedData.size()), expectedSize);
+        #endif
+        #ifdef MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
+        if(data.scheme == Implementation::SuperCompressionScheme::ZLIB) {
+            uLongf size = decompressed.size();
+            CORRADE_COMPARE(uncompress(reinterpret_cast<Bytef*>(decompressed.data()), &size, reinterpret_cast<const Bytef*>(compressedData.data()), compressedData.size()), Z_OK);
+            CORRADE_COMPARE(size, expectedSize);
+        }
+        #endif
+
+        CORRADE_COMPARE_AS(decompressed,
+            uncompressed->sliceSize(Utility::Endianness::littleEndian(uncompressedLevels[i].byteOffset), expectedSize),
+            TestSuite::Compare::Container);
+    }
+}
+
+void KtxImageConverterTest::supercompressionInvalid() {
+    auto&& data = SupercompressionInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("KtxImageConverter");
+    CORRADE_VERIFY(converter->configuration().setValue("supercompression", data.supercompression));
+    CORRADE_VERIFY(converter->configuration().setValue("supercompressionLevel", data.level));
+
+    Containers::String out;
+    Error redirectError{&out};
+
+    const UnsignedByte bytes[4]{};
+    CORRADE_VERIFY(!converter->convertToData(ImageView2D{PixelFormat::RGBA8Unorm, {1, 1}, bytes}));
+    CORRADE_COMPARE(out, Utility::format("Trade::KtxImageConverter::convertToData(): {}\n", data.message));
+}
+
 void KtxImageConverterTest::convertTwice() {
     Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("KtxImageConverter");
 
@@ -26,3 +26,5 @@
 */
 
 #cmakedefine MAGNUM_KTXIMAGECONVERTER_BUILD_STATIC
+#cmakedefine MAGNUM_KTXIMAGECONVERTER_WITH_ZSTD
+#cmakedefine MAGNUM_KTXIMAGECONVERTER_WITH_ZLIB
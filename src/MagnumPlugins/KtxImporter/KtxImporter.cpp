@@ -42,12 +42,12 @@
 #include <Corrade/Utility/EndiannessBatch.h>
 #include <Magnum/PixelFormat.h>
 #include <Magnum/Math/BitVector.h>
-#include <Magnum/Math/ColorBatch.h>
 #include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Swizzle.h>
 #include <Magnum/Math/Vector3.h>
 #include <Magnum/Math/Vector4.h>
 #include <Magnum/Trade/ImageData.h>
+#include "Magnum/Implementation/yFlipCompressedBlocks.h"
 #include "MagnumPlugins/KtxImporter/KtxHeader.h"
 
 #ifdef MAGNUM_BUILD_DEPRECATED
@@ -266,6 +266,10 @@ struct KtxImporter::File {
     };
 
     Containers::Array<char> in;
+    /* DataFlag::ExternallyOwned if the memory passed to openData() was
+       taken over without a copy and outlives the importer, empty otherwise.
+       Used for zero-copy image views. */
+    DataFlags inDataFlags;
 
     /* Dimensions of the source image (1-3) */
     UnsignedByte numDimensions;
@@ -551,6 +555,7 @@ void KtxImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags
     /* Take over the existing array or copy the data if we can't */
     if(dataFlags & (DataFlag::Owned|DataFlag::ExternallyOwned)) {
         f->in = Utility::move(data);
+        f->inDataFlags = dataFlags & DataFlag::ExternallyOwned;
     } else {
         f->in = Containers::Array<char>{NoInit, data.size()};
         Utility::copy(data, f->in);
@@ -762,20 +767,14 @@ void KtxImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags
             f->flip.reset(0);
         }
 
-        if(f->flip[1] &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc1RGBUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc1RGBSrgb &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc1RGBAUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc1RGBASrgb &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc2RGBAUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc2RGBASrgb &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc3RGBAUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc3RGBASrgb &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc4RUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc4RSnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc5RGUnorm &&
-            f->pixelFormat.compressed != CompressedPixelFormat::Bc5RGSnorm
-        ) {
+        /* BC6H and BC7 can't be Y-flipped without re-encoding, fail instead
+           of importing the data with a wrong orientation */
+        if(f->flip[1] && Implementation::isBc6hOrBc7(f->pixelFormat.compressed)) {
+            Error{} << "Trade::KtxImporter::openData(): Y flip is not possible for" << f->pixelFormat.compressed << Debug::nospace << ", set the assumeOrientation option to import the data with the original orientation";
+            return;
+        }
+
+        if(f->flip[1] && !Implementation::isYFlipCompressedSupported(f->pixelFormat.compressed)) {
             if(!(flags() & ImporterFlag::Quiet))
                 Warning{} << "Trade::KtxImporter::openData(): Y flip is not yet implemented for" << f->pixelFormat.compressed << Debug::nospace << ", imported data will have wrong orientation. Set the assumeOrientation option to suppress this warning.";
             f->flip.reset(1);
@@ -866,6 +865,29 @@ void KtxImporter::doOpenData(Containers::Array<char>&& data, DataFlags dataFlags
 template<UnsignedInt dimensions> ImageData<dimensions> KtxImporter::doImage(const char* messagePrefix, UnsignedInt id, UnsignedInt level) {
     const File::LevelData& levelData = _f->imageData[id][level];
     const auto size = Math::Vector<dimensions, Int>::pad(levelData.size);
+
+    /* Adjust pixel storage if row size is not four byte aligned. Unused for
+       compressed images. */
+    PixelStorage storage;
+    if((levelData.size.x()*_f->pixelFormat.size)%4 != 0)
+        storage.setAlignment(1);
+
+    /* If no flipping, swizzling or endian swapping is needed, the file data
+       can be returned as-is. If requested, return just a non-owning view on
+       the data the importer holds, which is either the original memory passed
+       to openData() with DataFlag::Owned or DataFlag::ExternallyOwned, or the
+       importer's own copy. */
+    if(configuration().value<bool>("zeroCopy") &&
+       _f->flip.none() &&
+       _f->pixelFormat.swizzle == SwizzleType::None &&
+       (_f->pixelFormat.typeSize == 1 || !Utility::Endianness::isBigEndian()))
+    {
+        if(_f->pixelFormat.isCompressed)
+            return ImageData<dimensions>{_f->pixelFormat.compressed, size, _f->inDataFlags, levelData.data, ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+        else
+            return ImageData<dimensions>{storage, _f->pixelFormat.uncompressed, size, _f->inDataFlags, levelData.data, ImageFlag<dimensions>(UnsignedShort(_f->imageFlags))};
+    }
+
     Containers::Array<char> data{NoInit, levelData.data.size()};
 
     /* Block-compressed images don't have any flipping, swizzling or endian
@@ -894,24 +916,9 @@ template<UnsignedInt dimensions> ImageData<dimensions> KtxImporter::doImage(cons
             if(!(flags() & ImporterFlag::Quiet) && levelData.size.y() % blockSize.y() != 0)
                 Warning{} << messagePrefix << "Y-flipping a compressed image that's not whole blocks, the result will be shifted by" << (blockSize.y() - (levelData.size.y() % blockSize.y())) << "pixels";
 
-            if(format == CompressedPixelFormat::Bc1RGBAUnorm ||
-               format == CompressedPixelFormat::Bc1RGBASrgb)
-                Math::yFlipBc1InPlace(blocks);
-            else if(format == CompressedPixelFormat::Bc2RGBAUnorm ||
-                    format == CompressedPixelFormat::Bc2RGBASrgb)
-                Math::yFlipBc2InPlace(blocks);
-            else if(format == CompressedPixelFormat::Bc3RGBAUnorm ||
-                    format == CompressedPixelFormat::Bc3RGBASrgb)
-                Math::yFlipBc3InPlace(blocks);
-            else if(format == CompressedPixelFormat::Bc4RUnorm ||
-                    format == CompressedPixelFormat::Bc4RSnorm)
-                Math::yFlipBc4InPlace(blocks);
-            else if(format == CompressedPixelFormat::Bc5RGUnorm ||
-                    format == CompressedPixelFormat::Bc5RGSnorm)
-                Math::yFlipBc5InPlace(blocks);
-            /* For all other -- not yet supported -- formats the flip[1] bit
-               was reset so it shouldn't get here */
-            else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+            /* For formats that can't be flipped the flip[1] bit was reset
+               in openData() so it shouldn't get here */
+            Implementation::yFlipCompressedInPlace(format, blocks);
         }
         if(_f->flip[2])
             Utility::flipInPlace<0>(blocks);
@@ -946,11 +953,6 @@ template<UnsignedInt dimensions> ImageData<dimensions> KtxImporter::doImage(cons
 
     endianSwap(data, _f->pixelFormat.typeSize);
 
-    /* Adjust pixel storage if row size is not four byte aligned */
-    PixelStorage storage;
-    if((levelData.size.x()*_f->pixelFormat.size)%4 != 0)
-        storage.setAlignment(1);
-
     /** @todo the DFD block has KHR_DF_FLAG_ALPHA_PREMULTIPLIED, pass it
         through ImageFlags once such flag exists:
         https://github.khronos.org/KTX-Specification/#_providing_additional_information */
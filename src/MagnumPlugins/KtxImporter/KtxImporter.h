@@ -122,11 +122,22 @@ Imports images in the following formats:
 @par
     Flipping of block-compressed data is non-trivial and so far is implemented
     only on the Y axis for BC1, BC2, BC3, BC4 and BC5 formats with APIs from
-    @ref Magnum/Math/ColorBatch.h. Other compressed formats will print a
-    message to @relativeref{Magnum,Warning} and the data will not be Y-flipped.
-    A warning also gets printed in case the flip is performed on an image whose
-    height isn't whole blocks, as that causes the data to be shifted. Flipping
-    of block-compressed data on the X axis isn't supported and will print a
+    @ref Magnum/Math/ColorBatch.h and for ETC2 and EAC formats by rearranging
+    bits in each block. The flip is lossless except for two ETC2 cases. Blocks
+    in the differential mode with sub-blocks on top of each other and a color
+    delta of -4 get one of the sub-blocks off by at most 9 in given 8-bit
+    channel. Blocks in the planar mode get the color gradient recalculated,
+    which results in an error of at most 3 for red and blue and at most 2 for
+    green, except for steep gradients that got clamped to the 8-bit range in
+    the original, where the error can be arbitrarily large. BC6H and BC7, whose
+    multi-partition blocks can't be flipped without re-encoding, cause the
+    import to fail with a message printed to @relativeref{Magnum,Error} unless
+    the @cb{.ini} assumeOrientation @ce option is set to not flip the Y axis.
+    Other compressed formats, in particular ASTC, will print a message to
+    @relativeref{Magnum,Warning} and the data will not be Y-flipped. A warning
+    also gets printed in case the flip is performed on an image whose height
+    isn't whole blocks, as that causes the data to be shifted. Flipping of
+    block-compressed data on the X axis isn't supported and will print a
     warning. Flipping on the Z axis is performed for all 2D block-compressed
     formats, for 3D block-compressed formats (such as
     @ref CompressedPixelFormat::Astc4x4x4RGBASrgb) it's not implemented yet and
@@ -188,6 +199,20 @@ For reasons similar to the restriction on axis-flips, compressed formats don't
 support any swizzling, and the import fails if an image with a compressed
 format contains a swizzle that isn't RGBA.
 
+@subsection Trade-KtxImporter-behavior-zero-copy Zero-copy import
+
+By default, image data are copied out of the file on every @ref image1D(),
+@ref image2D() or @ref image3D() call. If the @cb{.ini} zeroCopy @ce
+@ref Trade-KtxImporter-configuration "configuration option" is enabled and the
+data don't need to be flipped, swizzled or endian-swapped, the returned image
+is instead a non-owning view pointing directly into the file data. This is
+useful especially in combination with @ref openMemory() on memory-mapped files,
+where no copy of the data is then made at all and @ref ImageData::dataFlags()
+contain @ref DataFlag::ExternallyOwned. If the file was opened with
+@ref openData() or @ref openFile(), the view points into the importer's own
+copy of the data and the data flags are empty. In both cases the view is valid
+only as long as the file stays opened.
+
 @subsection Trade-KtxImporter-behavior-basis Basis Universal compression
 
 When the importer detects a Basis Universal compressed file, it will forward
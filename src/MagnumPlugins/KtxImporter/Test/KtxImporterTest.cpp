@@ -121,6 +121,7 @@ struct KtxImporterTest: TestSuite::Tester {
     void orientationFlip();
     void orientationFlipCompressed();
     void orientationFlipCompressed3D();
+    void orientationFlipCompressedNotPossible();
 
     void swizzle();
     void swizzleMultipleBytes();
@@ -129,6 +130,7 @@ struct KtxImporterTest: TestSuite::Tester {
     void swizzleCompressed();
 
     void openMemory();
+    void zeroCopy();
     void openTwice();
     void openNormalAfterBasis();
     void importTwice();
@@ -582,12 +584,12 @@ const struct {
     {"BC5, incomplete blocks",
         "2d-compressed-bc5.ktx2", {}, nullptr, true,
         "Trade::KtxImporter::image2D(): Y-flipping a compressed image that's not whole blocks, the result will be shifted by 2 pixels\n"},
-    {"ETC2, flip not implemented",
-        "2d-compressed-etc2.ktx2", {}, nullptr, false,
-        "Trade::KtxImporter::openData(): Y flip is not yet implemented for CompressedPixelFormat::Etc2RGB8Srgb, imported data will have wrong orientation. Set the assumeOrientation option to suppress this warning.\n"},
-    {"ETC2, flip not implemented, quiet",
-        "2d-compressed-etc2.ktx2", ImporterFlag::Quiet, nullptr, false, nullptr},
-    {"ETC2, flip not implemented, assume Y up, verbose",
+    {"ETC2, incomplete blocks",
+        "2d-compressed-etc2.ktx2", {}, nullptr, true,
+        "Trade::KtxImporter::image2D(): Y-flipping a compressed image that's not whole blocks, the result will be shifted by 2 pixels\n"},
+    {"ETC2, incomplete blocks, quiet",
+        "2d-compressed-etc2.ktx2", ImporterFlag::Quiet, nullptr, true, nullptr},
+    {"ETC2, assume Y up, verbose",
         "2d-compressed-etc2.ktx2", ImporterFlag::Verbose, "ru", false, nullptr},
 };
 
@@ -617,9 +619,10 @@ const struct {
         "3d-compressed-bc1.ktx2", ImporterFlag::Verbose, "rdo", true, false,
         "Trade::KtxImporter::openData(): image will be flipped along Y\n"
         "Trade::KtxImporter::image3D(): Y-flipping a compressed image that's not whole blocks, the result will be shifted by 3 pixels\n"},
-    {"BC7, Y flip not implemented, verbose",
-        "3d-compressed-bc7.ktx2", ImporterFlag::Verbose, nullptr, false, true,
-        "Trade::KtxImporter::openData(): Y flip is not yet implemented for CompressedPixelFormat::Bc7RGBAUnorm, imported data will have wrong orientation. Set the assumeOrientation option to suppress this warning.\n"
+    /* BC7 can't be Y-flipped, the failure is tested in
+       orientationFlipCompressedNotPossible() */
+    {"BC7, assume Y up, verbose",
+        "3d-compressed-bc7.ktx2", ImporterFlag::Verbose, "rui", false, true,
         "Trade::KtxImporter::openData(): image will be flipped along Z\n"},
     {"ASTC 3D, neither Y nor Z flip implemented, verbose",
         "3d-compressed-astc3d.ktx2", ImporterFlag::Verbose, nullptr, false, false,
@@ -676,6 +679,18 @@ const struct {
     }},
 };
 
+const struct {
+    const char* name;
+    const char* file;
+    const char* assumeOrientation;
+    bool expectZeroCopy;
+} ZeroCopyData[]{
+    {"", "2d-rgba.ktx2", "ruo", true},
+    {"compressed", "2d-compressed-bc1.ktx2", "ruo", true},
+    {"flip needed", "2d-rgba.ktx2", "rd", false},
+    {"swizzle needed", "bgra.ktx2", "ruo", false},
+};
+
 Containers::Array<char> createKeyValueData(Containers::StringView key, Containers::ArrayView<const char> value, bool terminatingZero = false) {
     UnsignedInt size = key.size() + 1 + value.size() + UnsignedInt(terminatingZero);
     size = (size + 3)/4*4;
@@ -808,6 +823,8 @@ KtxImporterTest::KtxImporterTest() {
     addInstancedTests({&KtxImporterTest::orientationFlipCompressed3D},
         Containers::arraySize(FlipCompressed3DData));
 
+    addTests({&KtxImporterTest::orientationFlipCompressedNotPossible});
+
     addInstancedTests({&KtxImporterTest::swizzle},
         Containers::arraySize(SwizzleData));
 
@@ -819,6 +836,9 @@ KtxImporterTest::KtxImporterTest() {
     addInstancedTests({&KtxImporterTest::openMemory},
         Containers::arraySize(OpenMemoryData));
 
+    addInstancedTests({&KtxImporterTest::zeroCopy},
+        Containers::arraySize(ZeroCopyData));
+
     addTests({&KtxImporterTest::openTwice,
               &KtxImporterTest::openNormalAfterBasis,
               &KtxImporterTest::importTwice});
@@ -2407,6 +2427,15 @@ void KtxImporterTest::orientationFlipCompressed3D() {
     }
 }
 
+void KtxImporterTest::orientationFlipCompressedNotPossible() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("KtxImporter");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(KTXIMPORTER_TEST_DIR, "3d-compressed-bc7.ktx2")));
+    CORRADE_COMPARE(out, "Trade::KtxImporter::openData(): Y flip is not possible for CompressedPixelFormat::Bc7RGBAUnorm, set the assumeOrientation option to import the data with the original orientation\n");
+}
+
 void KtxImporterTest::swizzle() {
     auto&& data = SwizzleData[testCaseInstanceId()];
     setTestCaseDescription(data.name);
@@ -2554,6 +2583,48 @@ void KtxImporterTest::openMemory() {
     CORRADE_COMPARE_AS(image->data(), Containers::arrayCast<const char>(PatternRgba2DData), TestSuite::Compare::Container);
 }
 
+void KtxImporterTest::zeroCopy() {
+    auto&& data = ZeroCopyData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Optional<Containers::Array<char>> memory = Utility::Path::read(Utility::Path::join(KTXIMPORTER_TEST_DIR, data.file));
+    CORRADE_VERIFY(memory);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("KtxImporter");
+    importer->configuration().setValue("assumeOrientation", data.assumeOrientation);
+
+    /* Import a copy first to have something to compare to */
+    CORRADE_VERIFY(importer->openMemory(*memory));
+    Containers::Optional<Trade::ImageData2D> expected = importer->image2D(0);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(expected->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+
+    importer->configuration().setValue("zeroCopy", true);
+    Containers::Optional<Trade::ImageData2D> image = importer->image2D(0);
+    CORRADE_VERIFY(image);
+    CORRADE_COMPARE(image->isCompressed(), expected->isCompressed());
+    CORRADE_COMPARE(image->size(), expected->size());
+    CORRADE_COMPARE_AS(image->data(), expected->data(), TestSuite::Compare::Container);
+
+    if(data.expectZeroCopy) {
+        /* The data should point directly into the memory passed to
+           openMemory(), which is guaranteed to outlive the importer */
+        CORRADE_COMPARE(image->dataFlags(), DataFlag::ExternallyOwned);
+        CORRADE_VERIFY(image->data().begin() >= memory->begin());
+        CORRADE_VERIFY(image->data().end() <= memory->end());
+
+        /* With openData() it points into the importer's own copy, which has
+           no such guarantee */
+        CORRADE_VERIFY(importer->openData(*memory));
+        Containers::Optional<Trade::ImageData2D> imageFromData = importer->image2D(0);
+        CORRADE_VERIFY(imageFromData);
+        CORRADE_COMPARE(imageFromData->dataFlags(), DataFlags{});
+        CORRADE_COMPARE_AS(imageFromData->data(), expected->data(), TestSuite::Compare::Container);
+    } else {
+        CORRADE_COMPARE(image->dataFlags(), DataFlag::Owned|DataFlag::Mutable);
+    }
+}
+
 void KtxImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("KtxImporter");
 
@@ -40,6 +40,7 @@
 #include <Corrade/Utility/DebugStl.h> /** @todo remove once OpenDdl is <string>-free */
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Mesh.h>
+#include <Magnum/VertexFormat.h>
 #include <Magnum/Math/Matrix4.h>
 #include <Magnum/Math/Quaternion.h>
 #include <Magnum/Trade/CameraData.h>
@@ -137,6 +138,9 @@ void OpenGexImporter::doOpenData(Containers::Array<char>&& data, DataFlags) {
     Containers::Pointer<Document> d{InPlaceInit};
 
     /* Parse the document */
+    d->document
+        .setParseThreadCount(configuration().value<UnsignedInt>("threads"))
+        .setTopLevelDataContiguous(configuration().value<bool>("zeroCopy"));
     if(!d->document.parse(data, OpenGex::structures, OpenGex::properties)) return;
 
     /* Validate the document */
@@ -701,6 +705,7 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
     std::size_t attributeCount = 0;
     std::ptrdiff_t stride = 0;
     UnsignedInt vertexCount = 0;
+    bool hasPositions = false, hasNormals = false;
     for(const OpenDdl::Structure vertexArray: mesh.childrenOf(OpenGex::VertexArray)) {
         /* Skip unsupported ones */
         auto&& attrib = vertexArray.propertyOf(OpenGex::attrib).as<std::string>();
@@ -725,6 +730,7 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
             }
 
             stride += sizeof(Vector3);
+            hasPositions = true;
 
         } else if(attrib == "normal") {
             if(vertexArrayData.subArraySize() != 3) {
@@ -733,6 +739,7 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
             }
 
             stride += sizeof(Vector3);
+            hasNormals = true;
 
         } else if(attrib == "texcoord") {
             if(vertexArrayData.subArraySize() != 2) {
@@ -756,64 +763,120 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
         ++attributeCount;
     }
 
-    /* Allocate vertex data, fill attributes */
-    Containers::Array<char> vertexData{NoInit, std::size_t(stride)*vertexCount};
+    /* If requested, reference the data directly in the document instead of
+       copying them. The document keeps all data of a top-level structure
+       contiguous in that case, so the vertex data can be a single view
+       spanning all attributes. Not possible if the positions or normals need
+       to be converted, indices can be referenced always. */
+    const bool zeroCopy = _d->document.isTopLevelDataContiguous() && configuration().value<bool>("zeroCopy");
+    const bool zeroCopyVertices = zeroCopy &&
+        (!hasPositions || (_d->yUp && _d->distanceMultiplier == 1.0f)) &&
+        (!hasNormals || _d->yUp);
+
+    Containers::Array<char> vertexData;
+    Containers::ArrayView<const char> vertexDataView;
     Containers::Array<MeshAttributeData> attributeData{attributeCount};
-    std::size_t attributeIndex = 0;
-    std::size_t attributeOffset = 0;
-
-    for(const OpenDdl::Structure vertexArray: mesh.childrenOf(OpenGex::VertexArray)) {
-        /* Skip unsupported ones */
-        const OpenDdl::Structure vertexArrayData = vertexArray.firstChild();
-
-        /* Vertex positions */
-        auto&& attrib = vertexArray.propertyOf(OpenGex::attrib).as<std::string>();
-        if(attrib == "position") {
-            Containers::StridedArrayView1D<Vector3> positions{vertexData,
-                reinterpret_cast<Vector3*>(vertexData + attributeOffset),
-                vertexCount, stride};
-            Utility::copy(Containers::arrayCast<const Vector3>(vertexArrayData.asArray<Float>()), positions);
-            for(auto& i: positions) i *= _d->distanceMultiplier;
-            if(!_d->yUp) for(auto& i: positions) i = fixVectorZUp(i);
-
-            attributeData[attributeIndex++] = MeshAttributeData{
-                MeshAttribute::Position, positions};
-            attributeOffset += sizeof(Vector3);
-
-        /* Normals */
-        } else if(attrib == "normal") {
-            Containers::StridedArrayView1D<Vector3> normals{vertexData,
-                reinterpret_cast<Vector3*>(vertexData + attributeOffset),
-                vertexCount, stride};
-            Utility::copy(Containers::arrayCast<const Vector3>(vertexArrayData.asArray<Float>()), normals);
-            if(!_d->yUp) for(auto& i: normals) i = fixVectorZUp(i);
 
-            attributeData[attributeIndex++] = MeshAttributeData{
-                MeshAttribute::Normal, normals};
-            attributeOffset += sizeof(Vector3);
-
-        /* 2D texture coordinates */
-        } else if(attrib == "texcoord") {
-            Containers::StridedArrayView1D<Vector2> textureCoordinates{vertexData,
-                reinterpret_cast<Vector2*>(vertexData + attributeOffset),
-                vertexCount, stride};
-            Utility::copy(Containers::arrayCast<const Vector2>(vertexArrayData.asArray<Float>()), textureCoordinates);
+    /* Reference non-interleaved attributes directly */
+    if(zeroCopyVertices) {
+        std::size_t attributeIndex = 0;
+        const char* vertexDataBegin = nullptr;
+        const char* vertexDataEnd = nullptr;
+
+        for(const OpenDdl::Structure vertexArray: mesh.childrenOf(OpenGex::VertexArray)) {
+            MeshAttribute name;
+            VertexFormat format;
+            auto&& attrib = vertexArray.propertyOf(OpenGex::attrib).as<std::string>();
+            if(attrib == "position") {
+                name = MeshAttribute::Position;
+                format = VertexFormat::Vector3;
+            } else if(attrib == "normal") {
+                name = MeshAttribute::Normal;
+                format = VertexFormat::Vector3;
+            } else if(attrib == "texcoord") {
+                name = MeshAttribute::TextureCoordinates;
+                format = VertexFormat::Vector2;
+
+            /* Some other thing that wasn't handled above, ignore */
+            } else continue;
+
+            const Containers::ArrayView<const Float> src = vertexArray.firstChild().asArray<Float>();
+            attributeData[attributeIndex++] = MeshAttributeData{name, format,
+                Containers::StridedArrayView1D<const void>{src, src.data(),
+                    vertexCount, std::ptrdiff_t(vertexFormatSize(format))}};
+
+            if(src.isEmpty()) continue;
+            const char* const begin = reinterpret_cast<const char*>(src.begin());
+            const char* const end = reinterpret_cast<const char*>(src.end());
+            if(!vertexDataBegin || begin < vertexDataBegin)
+                vertexDataBegin = begin;
+            if(!vertexDataEnd || end > vertexDataEnd)
+                vertexDataEnd = end;
+        }
 
-            attributeData[attributeIndex++] = MeshAttributeData{
-                MeshAttribute::TextureCoordinates, textureCoordinates};
-            attributeOffset += sizeof(Vector2);
+        CORRADE_INTERNAL_ASSERT(attributeIndex == attributeCount);
+        vertexDataView = {vertexDataBegin, std::size_t(vertexDataEnd - vertexDataBegin)};
 
-        /* Some other thing that wasn't handled above, ignore */
+    /* Allocate vertex data, fill attributes */
+    } else {
+        vertexData = Containers::Array<char>{NoInit, std::size_t(stride)*vertexCount};
+        std::size_t attributeIndex = 0;
+        std::size_t attributeOffset = 0;
+
+        for(const OpenDdl::Structure vertexArray: mesh.childrenOf(OpenGex::VertexArray)) {
+            /* Skip unsupported ones */
+            const OpenDdl::Structure vertexArrayData = vertexArray.firstChild();
+
+            /* Vertex positions */
+            auto&& attrib = vertexArray.propertyOf(OpenGex::attrib).as<std::string>();
+            if(attrib == "position") {
+                Containers::StridedArrayView1D<Vector3> positions{vertexData,
+                    reinterpret_cast<Vector3*>(vertexData + attributeOffset),
+                    vertexCount, stride};
+                Utility::copy(Containers::arrayCast<const Vector3>(vertexArrayData.asArray<Float>()), positions);
+                for(auto& i: positions) i *= _d->distanceMultiplier;
+                if(!_d->yUp) for(auto& i: positions) i = fixVectorZUp(i);
+
+                attributeData[attributeIndex++] = MeshAttributeData{
+                    MeshAttribute::Position, positions};
+                attributeOffset += sizeof(Vector3);
+
+            /* Normals */
+            } else if(attrib == "normal") {
+                Containers::StridedArrayView1D<Vector3> normals{vertexData,
+                    reinterpret_cast<Vector3*>(vertexData + attributeOffset),
+                    vertexCount, stride};
+                Utility::copy(Containers::arrayCast<const Vector3>(vertexArrayData.asArray<Float>()), normals);
+                if(!_d->yUp) for(auto& i: normals) i = fixVectorZUp(i);
+
+                attributeData[attributeIndex++] = MeshAttributeData{
+                    MeshAttribute::Normal, normals};
+                attributeOffset += sizeof(Vector3);
+
+            /* 2D texture coordinates */
+            } else if(attrib == "texcoord") {
+                Containers::StridedArrayView1D<Vector2> textureCoordinates{vertexData,
+                    reinterpret_cast<Vector2*>(vertexData + attributeOffset),
+                    vertexCount, stride};
+                Utility::copy(Containers::arrayCast<const Vector2>(vertexArrayData.asArray<Float>()), textureCoordinates);
+
+                attributeData[attributeIndex++] = MeshAttributeData{
+                    MeshAttribute::TextureCoordinates, textureCoordinates};
+                attributeOffset += sizeof(Vector2);
+
+            /* Some other thing that wasn't handled above, ignore */
+            }
         }
-    }
 
-    /* Check we pre-calculated well */
-    CORRADE_INTERNAL_ASSERT(attributeOffset == std::size_t(stride));
-    CORRADE_INTERNAL_ASSERT(attributeIndex == attributeCount);
+        /* Check we pre-calculated well */
+        CORRADE_INTERNAL_ASSERT(attributeOffset == std::size_t(stride));
+        CORRADE_INTERNAL_ASSERT(attributeIndex == attributeCount);
+    }
 
     /* Mesh indices */
     MeshIndexData indices;
     Containers::Array<char> indexData;
+    Containers::ArrayView<const void> indexDataView;
     if(const Containers::Optional<OpenDdl::Structure> indexArray = mesh.findFirstChildOf(OpenGex::IndexArray)) {
         const OpenDdl::Structure indexArrayData = indexArray->firstChild();
 
@@ -826,26 +889,41 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
             case OpenDdl::Type::UnsignedByte: {
                 Containers::ArrayView<const UnsignedByte> src =
                     indexArrayData.asArray<UnsignedByte>();
-                indexData = Containers::Array<char>{src.size()};
-                auto indexData8 = Containers::arrayCast<UnsignedByte>(indexData);
-                Utility::copy(src, indexData8);
-                indices = MeshIndexData{indexData8};
+                if(zeroCopy) {
+                    indexDataView = src;
+                    indices = MeshIndexData{src};
+                } else {
+                    indexData = Containers::Array<char>{src.size()};
+                    auto indexData8 = Containers::arrayCast<UnsignedByte>(indexData);
+                    Utility::copy(src, indexData8);
+                    indices = MeshIndexData{indexData8};
+                }
             } break;
             case OpenDdl::Type::UnsignedShort: {
                 Containers::ArrayView<const UnsignedShort> src =
                     indexArrayData.asArray<UnsignedShort>();
-                indexData = Containers::Array<char>{src.size()*2};
-                auto indexData16 = Containers::arrayCast<UnsignedShort>(indexData);
-                Utility::copy(src, indexData16);
-                indices = MeshIndexData{indexData16};
+                if(zeroCopy) {
+                    indexDataView = src;
+                    indices = MeshIndexData{src};
+                } else {
+                    indexData = Containers::Array<char>{src.size()*2};
+                    auto indexData16 = Containers::arrayCast<UnsignedShort>(indexData);
+                    Utility::copy(src, indexData16);
+                    indices = MeshIndexData{indexData16};
+                }
             } break;
             case OpenDdl::Type::UnsignedInt: {
                 Containers::ArrayView<const UnsignedInt> src =
                     indexArrayData.asArray<UnsignedInt>();
-                indexData = Containers::Array<char>{src.size()*4};
-                auto indexData32 = Containers::arrayCast<UnsignedInt>(indexData);
-                Utility::copy(src, indexData32);
-                indices = MeshIndexData{indexData32};
+                if(zeroCopy) {
+                    indexDataView = src;
+                    indices = MeshIndexData{src};
+                } else {
+                    indexData = Containers::Array<char>{src.size()*4};
+                    auto indexData32 = Containers::arrayCast<UnsignedInt>(indexData);
+                    Utility::copy(src, indexData32);
+                    indices = MeshIndexData{indexData32};
+                }
             } break;
             #ifndef CORRADE_TARGET_EMSCRIPTEN
             case OpenDdl::Type::UnsignedLong:
@@ -857,6 +935,12 @@ Containers::Optional<MeshData> OpenGexImporter::doMesh(const UnsignedInt id, Uns
         }
     }
 
+    if(zeroCopyVertices) return MeshData{primitive,
+        DataFlags{}, indexDataView, indices,
+        DataFlags{}, vertexDataView, std::move(attributeData)};
+    if(zeroCopy) return MeshData{primitive,
+        DataFlags{}, indexDataView, indices,
+        std::move(vertexData), std::move(attributeData)};
     return MeshData{primitive,
         std::move(indexData), indices,
         std::move(vertexData), std::move(attributeData)};
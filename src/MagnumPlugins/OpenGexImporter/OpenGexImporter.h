@@ -129,6 +129,11 @@ While the importer doesn't recognize any @ref ImporterFlag itself, all
 @ref ImporterFlags are propagated to image importer plugins the importer
 delegates to.
 
+Large files with many top-level structures can be parsed on multiple threads
+using the @cb{.ini} threads @ce
+@ref Trade-OpenGexImporter-configuration "configuration option", see
+@ref OpenDdl::Document::setParseThreadCount() for details.
+
 @subsection Trade-OpenGexImporter-behavior-scenes Scene import
 
 -   OpenGEX supports only a single scene and has no way to assign a scene name.
@@ -200,6 +205,19 @@ delegates to.
 The imported mesh always has at least one vertex attribute, but positions are
 not required to be present. Indices are optional as well.
 
+By default, vertex data are copied out of the parsed document into a newly
+allocated interleaved buffer and index data into a buffer of their own. If the
+@cb{.ini} zeroCopy @ce
+@ref Trade-OpenGexImporter-configuration "configuration option" is enabled when
+opening the file, the document is parsed with
+@ref OpenDdl::Document::setTopLevelDataContiguous() enabled and the returned
+mesh is instead non-interleaved, with empty @ref MeshData::vertexDataFlags()
+and @ref MeshData::indexDataFlags() and attributes and indices pointing
+directly into the parsed document. Vertex data are still copied if positions
+need to be scaled based on the `distance` metric or positions and normals need
+to be converted from Z up to Y up, index data are referenced always. In both
+cases the views are valid only as long as the file stays opened.
+
 @subsection Trade-OpenGexImporter-behavior-materials Material import
 
 -   Alpha mode is always @ref MaterialAlphaMode::Opaque and alpha mask always
@@ -243,6 +261,16 @@ importer-specific data accessors:
         an @ref OpenGex::Node, @ref OpenGex::BoneNode,
         @ref OpenGex::GeometryNode, @ref OpenGex::CameraNode or
         @ref OpenGex::LightNode structure
+
+@section Trade-OpenGexImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration(). See
+below for all options and their default values:
+
+@snippet MagnumPlugins/OpenGexImporter/OpenGexImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_OPENGEXIMPORTER_EXPORT OpenGexImporter: public AbstractImporter {
     public:
@@ -39,6 +39,7 @@
 #include <Magnum/FileCallback.h>
 #include <Magnum/Mesh.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/VertexFormat.h>
 #include <Magnum/Math/Quaternion.h>
 #include <Magnum/Math/Matrix4.h>
 #include <Magnum/Trade/AbstractImporter.h>
@@ -91,7 +92,9 @@ struct OpenGexImporterTest: TestSuite::Tester {
 
     void mesh();
     void meshIndexed();
+    void meshParallelParse();
     void meshMetrics();
+    void meshZeroCopy();
 
     void meshInvalidPrimitive();
     void meshUnsupportedSize();
@@ -146,6 +149,18 @@ const struct {
     {"translation object only", "unsupported object-only transformation in node 1"},
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt id;
+    bool expectZeroCopyVertices;
+} MeshZeroCopyData[] {
+    {"", "mesh.ogex", 0, true},
+    {"indexed", "mesh.ogex", 1, true},
+    {"no positions", "mesh.ogex", 2, true},
+    {"metrics", "mesh-metrics.ogex", 0, false}
+};
+
 OpenGexImporterTest::OpenGexImporterTest() {
     addTests({&OpenGexImporterTest::open,
               &OpenGexImporterTest::openParseError,
@@ -175,9 +190,13 @@ OpenGexImporterTest::OpenGexImporterTest() {
 
               &OpenGexImporterTest::mesh,
               &OpenGexImporterTest::meshIndexed,
-              &OpenGexImporterTest::meshMetrics,
+              &OpenGexImporterTest::meshParallelParse,
+              &OpenGexImporterTest::meshMetrics});
 
-              &OpenGexImporterTest::meshInvalidPrimitive,
+    addInstancedTests({&OpenGexImporterTest::meshZeroCopy},
+        Containers::arraySize(MeshZeroCopyData));
+
+    addTests({&OpenGexImporterTest::meshInvalidPrimitive,
               &OpenGexImporterTest::meshUnsupportedSize,
               &OpenGexImporterTest::meshMismatchedSizes,
               &OpenGexImporterTest::meshInvalidIndexArraySubArraySize,
@@ -793,6 +812,36 @@ void OpenGexImporterTest::meshIndexed() {
         }), TestSuite::Compare::Container);
 }
 
+void OpenGexImporterTest::meshParallelParse() {
+    #ifndef CORRADE_BUILD_MULTITHREADED
+    CORRADE_SKIP("CORRADE_BUILD_MULTITHREADED is not enabled.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenGexImporter");
+    importer->configuration().setValue("threads", 4);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENGEXIMPORTER_TEST_DIR, "mesh.ogex")));
+    CORRADE_COMPARE(importer->meshCount(), 3);
+
+    /* The output should be the same as with the serial parse, spot-check
+       data of the first two geometry objects, which are most likely parsed on
+       different threads */
+    Containers::Optional<MeshData> mesh = importer->mesh(0);
+    CORRADE_VERIFY(mesh);
+    CORRADE_COMPARE(mesh->primitive(), MeshPrimitive::TriangleStrip);
+    CORRADE_COMPARE_AS(mesh->attribute<Vector3>(MeshAttribute::Position),
+        Containers::arrayView<Vector3>({
+            {0.0f, 1.0f, 3.0f}, {-1.0f, 2.0f, 2.0f}, {3.0f, 3.0f, 1.0f}
+        }), TestSuite::Compare::Container);
+
+    Containers::Optional<MeshData> meshIndexed = importer->mesh(1);
+    CORRADE_VERIFY(meshIndexed);
+    CORRADE_COMPARE(meshIndexed->primitive(), MeshPrimitive::Triangles);
+    CORRADE_COMPARE_AS(meshIndexed->indices<UnsignedShort>(),
+        Containers::arrayView<UnsignedShort>({
+            2, 0, 1, 1, 2, 3
+        }), TestSuite::Compare::Container);
+    #endif
+}
+
 void OpenGexImporterTest::meshMetrics() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenGexImporter");
 
@@ -826,6 +875,55 @@ void OpenGexImporterTest::meshMetrics() {
         }), TestSuite::Compare::Container);
 }
 
+void OpenGexImporterTest::meshZeroCopy() {
+    auto&& data = MeshZeroCopyData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Import the mesh with copying first to have something to compare to */
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenGexImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENGEXIMPORTER_TEST_DIR, data.filename)));
+    Containers::Optional<MeshData> expected = importer->mesh(data.id);
+    CORRADE_VERIFY(expected);
+    CORRADE_COMPARE(expected->vertexDataFlags(), DataFlag::Owned|DataFlag::Mutable);
+
+    /* The option has to be set before opening the file */
+    importer->configuration().setValue("zeroCopy", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENGEXIMPORTER_TEST_DIR, data.filename)));
+    Containers::Optional<MeshData> mesh = importer->mesh(data.id);
+    CORRADE_VERIFY(mesh);
+    CORRADE_COMPARE(mesh->primitive(), expected->primitive());
+
+    /* Indices can be always referenced, vertex data only if they don't need
+       to be converted */
+    CORRADE_COMPARE(mesh->indexDataFlags(), DataFlags{});
+    CORRADE_COMPARE(mesh->vertexDataFlags(), data.expectZeroCopyVertices ? DataFlags{} : DataFlag::Owned|DataFlag::Mutable);
+
+    CORRADE_COMPARE(mesh->isIndexed(), expected->isIndexed());
+    if(expected->isIndexed()) {
+        CORRADE_COMPARE(mesh->indexType(), expected->indexType());
+        CORRADE_COMPARE_AS(mesh->indicesAsArray(),
+            expected->indicesAsArray(),
+            TestSuite::Compare::Container);
+    }
+
+    CORRADE_COMPARE(mesh->vertexCount(), expected->vertexCount());
+    CORRADE_COMPARE(mesh->attributeCount(), expected->attributeCount());
+    for(UnsignedInt i = 0; i != expected->attributeCount(); ++i) {
+        CORRADE_ITERATION(i);
+        CORRADE_COMPARE(mesh->attributeName(i), expected->attributeName(i));
+        CORRADE_COMPARE(mesh->attributeFormat(i), expected->attributeFormat(i));
+        if(expected->attributeFormat(i) == VertexFormat::Vector3)
+            CORRADE_COMPARE_AS(mesh->attribute<Vector3>(i),
+                expected->attribute<Vector3>(i),
+                TestSuite::Compare::Container);
+        else if(expected->attributeFormat(i) == VertexFormat::Vector2)
+            CORRADE_COMPARE_AS(mesh->attribute<Vector2>(i),
+                expected->attribute<Vector2>(i),
+                TestSuite::Compare::Container);
+        else CORRADE_FAIL("Unexpected format" << expected->attributeFormat(i));
+    }
+}
+
 void OpenGexImporterTest::meshInvalidPrimitive() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("OpenGexImporter");
     CORRADE_VERIFY(importer->openFile(Utility::Path::join(OPENGEXIMPORTER_TEST_DIR, "mesh-invalid.ogex")));
@@ -37,17 +37,147 @@
     New versions don't have that anymore: https://github.com/glennrp/libpng/commit/6c2e919c7eb736d230581a4c925fa67bd901fcf8
 */
 #include <csetjmp>
+#include <atomic>
+#include <initializer_list>
+#include <thread> /* std::thread::hardware_concurrency(), sigh */
+#include <zlib.h>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Corrade/Utility/Endianness.h>
+#include <Corrade/Utility/Move.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Functions.h>
 
 namespace Magnum { namespace Trade {
 
 using namespace Containers::Literals;
 
+namespace {
+
+/* PNG filter types as stored in the first byte of each row, -1 meaning the
+   best one is picked for each row */
+enum: Int {
+    FilterAdaptive = -1,
+    FilterNone = 0,
+    FilterSub = 1,
+    FilterUp = 2,
+    FilterAverage = 3,
+    FilterPaeth = 4
+};
+
+UnsignedByte paethPredictor(const Int a, const Int b, const Int c) {
+    const Int p = a + b - c;
+    const Int pa = Math::abs(p - a);
+    const Int pb = Math::abs(p - b);
+    const Int pc = Math::abs(p - c);
+    if(pa <= pb && pa <= pc) return a;
+    if(pb <= pc) return b;
+    return c;
+}
+
+/* Filters a single row, writing the filter type and the filtered bytes to
+   out. For the first row of the image the previous row is all zeros. */
+void filterRow(const Int filter, const UnsignedByte* const row, const UnsignedByte* const previous, const std::size_t size, const std::size_t pixelSize, UnsignedByte* const out) {
+    out[0] = filter;
+    UnsignedByte* const filtered = out + 1;
+    switch(filter) {
+        case FilterNone:
+            for(std::size_t i = 0; i != size; ++i)
+                filtered[i] = row[i];
+            break;
+        case FilterSub:
+            for(std::size_t i = 0; i != pixelSize; ++i)
+                filtered[i] = row[i];
+            for(std::size_t i = pixelSize; i != size; ++i)
+                filtered[i] = row[i] - row[i - pixelSize];
+            break;
+        case FilterUp:
+            for(std::size_t i = 0; i != size; ++i)
+                filtered[i] = row[i] - previous[i];
+            break;
+        case FilterAverage:
+            for(std::size_t i = 0; i != pixelSize; ++i)
+                filtered[i] = row[i] - previous[i]/2;
+            for(std::size_t i = pixelSize; i != size; ++i)
+                filtered[i] = row[i] - (row[i - pixelSize] + previous[i])/2;
+            break;
+        case FilterPaeth:
+            for(std::size_t i = 0; i != pixelSize; ++i)
+                filtered[i] = row[i] - previous[i];
+            for(std::size_t i = pixelSize; i != size; ++i)
+                filtered[i] = row[i] - paethPredictor(row[i - pixelSize], previous[i], previous[i - pixelSize]);
+            break;
+        default: CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+    }
+}
+
+/* Same heuristic as libpng uses for picking the best filter -- sum of the
+   filtered bytes interpreted as signed values */
+std::size_t filterCost(const UnsignedByte* const filtered, const std::size_t size) {
+    std::size_t sum = 0;
+    for(std::size_t i = 0; i != size; ++i)
+        sum += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    return sum;
+}
+
+/* Appends a PNG chunk consisting of given pieces of data */
+void writeChunk(Containers::Array<char>& output, const char(&type)[5], std::initializer_list<Containers::ArrayView<const char>> pieces) {
+    std::size_t size = 0;
+    for(const Containers::ArrayView<const char> piece: pieces)
+        size += piece.size();
+
+    UnsignedInt length = Utility::Endianness::bigEndian(UnsignedInt(size));
+    arrayAppend(output, Containers::arrayView(reinterpret_cast<const char*>(&length), 4));
+    arrayAppend(output, Containers::arrayView(type, 4));
+    uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+    for(const Containers::ArrayView<const char> piece: pieces) {
+        /* crc32() resets the checksum if given a null pointer */
+        if(piece.isEmpty()) continue;
+        arrayAppend(output, piece);
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(piece.data()), piece.size());
+    }
+    UnsignedInt crcBigEndian = Utility::Endianness::bigEndian(UnsignedInt(crc));
+    arrayAppend(output, Containers::arrayView(reinterpret_cast<const char*>(&crcBigEndian), 4));
+}
+
+/* Deflates a band of filtered rows as a raw deflate stream that's meant to be
+   concatenated with the other bands. All bands except the last end with a
+   sync flush, which aligns them to a byte boundary. The data preceding the
+   band are used as a dictionary, so matches can reach across band boundaries
+   like if the whole image was compressed at once. Returns nullptr on success
+   or an error string on failure. Called from worker threads, so it can't
+   print anything on its own -- Debug output redirection is thread-local. */
+const char* deflateBand(const Containers::ArrayView<const UnsignedByte> dictionary, const Containers::ArrayView<const UnsignedByte> in, const Int level, const Int strategy, const bool last, Containers::Array<char>& out, std::size_t& outSize) {
+    z_stream stream{};
+    Int result = deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy);
+    if(result != Z_OK)
+        return zError(result);
+    if(!dictionary.isEmpty())
+        deflateSetDictionary(&stream, dictionary.data(), dictionary.size());
+
+    /* The bound doesn't account for the empty stored block emitted by the sync
+       flush, add a bit of extra space for it */
+    out = Containers::Array<char>{NoInit, deflateBound(&stream, in.size()) + 16};
+    stream.next_in = const_cast<Bytef*>(in.data());
+    stream.avail_in = in.size();
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = out.size();
+    result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    outSize = out.size() - stream.avail_out;
+    deflateEnd(&stream);
+    if(result != (last ? Z_STREAM_END : Z_OK) || stream.avail_in)
+        return result < 0 ? zError(result) : "output buffer too small";
+    return nullptr;
+}
+
+}
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 PngImageConverter::PngImageConverter() = default; /* LCOV_EXCL_LINE */
 #endif
@@ -110,6 +240,71 @@ Containers::Optional<Containers::Array<char>> PngImageConverter::doConvertToData
             return {};
     }
 
+    const Int compressionLevel = configuration().value<Int>("compressionLevel");
+    if(compressionLevel < -1 || compressionLevel > 9) {
+        Error{} << "Trade::PngImageConverter::convertToData(): expected compressionLevel to be between -1 and 9, got" << compressionLevel;
+        return {};
+    }
+
+    /* Empty filter means the libpng default, which for all supported formats
+       is picking the best filter for each row */
+    Int filter;
+    Int libpngFilter;
+    const Containers::StringView filterString = configuration().value<Containers::StringView>("filter");
+    if(filterString.isEmpty() || filterString == "all"_s) {
+        filter = FilterAdaptive;
+        libpngFilter = PNG_ALL_FILTERS;
+    } else if(filterString == "none"_s) {
+        filter = FilterNone;
+        libpngFilter = PNG_FILTER_NONE;
+    } else if(filterString == "sub"_s) {
+        filter = FilterSub;
+        libpngFilter = PNG_FILTER_SUB;
+    } else if(filterString == "up"_s) {
+        filter = FilterUp;
+        libpngFilter = PNG_FILTER_UP;
+    } else if(filterString == "average"_s) {
+        filter = FilterAverage;
+        libpngFilter = PNG_FILTER_AVG;
+    } else if(filterString == "paeth"_s) {
+        filter = FilterPaeth;
+        libpngFilter = PNG_FILTER_PAETH;
+    } else {
+        Error{} << "Trade::PngImageConverter::convertToData(): expected filter to be empty, none, sub, up, average, paeth or all, got" << filterString;
+        return {};
+    }
+
+    /* Empty strategy means the libpng default, which is Z_FILTERED if rows
+       are filtered and Z_DEFAULT_STRATEGY otherwise */
+    Int strategy;
+    const Containers::StringView strategyString = configuration().value<Containers::StringView>("strategy");
+    if(strategyString.isEmpty())
+        strategy = filter == FilterNone ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+    else if(strategyString == "default"_s)
+        strategy = Z_DEFAULT_STRATEGY;
+    else if(strategyString == "filtered"_s)
+        strategy = Z_FILTERED;
+    else if(strategyString == "huffmanOnly"_s)
+        strategy = Z_HUFFMAN_ONLY;
+    else if(strategyString == "rle"_s)
+        strategy = Z_RLE;
+    else if(strategyString == "fixed"_s)
+        strategy = Z_FIXED;
+    else {
+        Error{} << "Trade::PngImageConverter::convertToData(): expected strategy to be empty, default, filtered, huffmanOnly, rle or fixed, got" << strategyString;
+        return {};
+    }
+
+    /* Value of 0 means all available cores, there's no point in having more
+       threads than there are rows */
+    UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+    if(!threadCount) {
+        threadCount = std::thread::hardware_concurrency();
+        if(flags() & ImageConverterFlag::Verbose)
+            Debug{} << "Trade::PngImageConverter::convertToData(): autodetected hardware concurrency to" << threadCount << "threads";
+    }
+    threadCount = Math::clamp<UnsignedInt>(threadCount, 1, image.size().y());
+
     png_structp file = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
     /** @todo this will assert if the PNG major/minor version doesn't match,
         with "libpng warning: Application built with libpng-1.7.0 but running
@@ -152,24 +347,171 @@ Containers::Optional<Containers::Array<char>> PngImageConverter::doConvertToData
     png_set_IHDR(file, info, image.size().x(), image.size().y(),
         bitDepth, colorType, PNG_INTERLACE_NONE,
         PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_set_compression_level(file, compressionLevel);
+    if(!strategyString.isEmpty())
+        png_set_compression_strategy(file, strategy);
+    if(!filterString.isEmpty())
+        png_set_filter(file, PNG_FILTER_TYPE_BASE, libpngFilter);
     png_write_info(file, info);
 
-    /* For 16 bit depth we need to swap to big endian */
-    if(bitDepth == 16) {
-        #ifndef CORRADE_TARGET_BIG_ENDIAN
-        png_set_swap(file);
-        #endif
-    } else CORRADE_INTERNAL_ASSERT(bitDepth == 8);
-
     /* Write rows in reverse order. While the rows may have some padding after,
        the actual pixels in the row should be contiguous so it should be safe
        to pass a pointer to the first byte of each. */
     const Containers::StridedArrayView3D<const char> pixelsFlipped = image.pixels().flipped<0>();
     CORRADE_INTERNAL_ASSERT(pixelsFlipped.isContiguous<1>());
-    for(Int y = 0; y != image.size().y(); ++y)
-        png_write_row(file, static_cast<unsigned char*>(const_cast<void*>(pixelsFlipped[y].data())));
+    CORRADE_INTERNAL_ASSERT(bitDepth == 8 || bitDepth == 16);
+
+    /* On a single thread, let libpng do all the work */
+    if(threadCount == 1) {
+        /* For 16 bit depth we need to swap to big endian */
+        #ifndef CORRADE_TARGET_BIG_ENDIAN
+        if(bitDepth == 16)
+            png_set_swap(file);
+        #endif
+
+        for(Int y = 0; y != image.size().y(); ++y)
+            png_write_row(file, static_cast<unsigned char*>(const_cast<void*>(pixelsFlipped[y].data())));
+
+        png_write_end(file, nullptr);
+
+    /* Otherwise split the image into bands of rows, filter and deflate them
+       in parallel and concatenate the results into a single zlib stream, like
+       pigz does. Each band is at most 1 GB so its compressed size fits into
+       the 31-bit chunk size limit. */
+    } else {
+        const std::size_t pixelSize = image.pixelSize();
+        const std::size_t rowSize = image.size().x()*pixelSize;
+        const std::size_t filteredRowSize = rowSize + 1;
+        const std::size_t height = image.size().y();
+        constexpr std::size_t MaxBandSize = 1024*1024*1024;
+        const std::size_t bandCount = Math::min(height, Math::max(std::size_t(threadCount), (height*filteredRowSize + MaxBandSize - 1)/MaxBandSize));
+        /* Rows preceding each band needed to fill the 32 kB deflate window */
+        const std::size_t dictionaryRowCount = (32768 + filteredRowSize - 1)/filteredRowSize;
+        #ifndef CORRADE_TARGET_BIG_ENDIAN
+        const bool swapBytes = bitDepth == 16;
+        #else
+        constexpr bool swapBytes = false;
+        #endif
+
+        Containers::Array<Containers::Array<char>> bands{bandCount};
+        Containers::Array<std::size_t> bandSizes{NoInit, bandCount};
+        Containers::Array<uLong> bandChecksums{NoInit, bandCount};
+        Containers::Array<const char*> errors{ValueInit, bandCount};
+
+        /* Each worker picks the next band that isn't taken yet */
+        std::atomic<std::size_t> nextBand{0};
+        auto worker = [&]() {
+            /* Zero row for filtering the first row of the image, a pair of
+               rows for byte-swapping 16-bit data and space for trying out all
+               filters */
+            Containers::Array<UnsignedByte> scratch{ValueInit, rowSize*3 + filteredRowSize*5};
+            const UnsignedByte* const zeros = scratch.data();
+            UnsignedByte* current = scratch.data() + rowSize;
+            UnsignedByte* previous = scratch.data() + rowSize*2;
+            UnsignedByte* const candidates = scratch.data() + rowSize*3;
+
+            const auto row = [&](const std::size_t y, UnsignedByte* const swapped) -> const UnsignedByte* {
+                const UnsignedByte* const data = static_cast<const UnsignedByte*>(pixelsFlipped[y].data());
+                if(!swapBytes) return data;
+                for(std::size_t i = 0; i != rowSize; i += 2) {
+                    swapped[i] = data[i + 1];
+                    swapped[i + 1] = data[i];
+                }
+                return swapped;
+            };
+
+            Containers::Array<UnsignedByte> filtered;
+            std::size_t band;
+            while((band = nextBand++) < bandCount) {
+                const std::size_t start = height*band/bandCount;
+                const std::size_t end = height*(band + 1)/bandCount;
+                const std::size_t dictionaryStart = start - Math::min(start, dictionaryRowCount);
+                const std::size_t size = (end - dictionaryStart)*filteredRowSize;
+                if(filtered.size() < size)
+                    filtered = Containers::Array<UnsignedByte>{NoInit, size};
+
+                /* Filter the band including the rows used as a dictionary */
+                const UnsignedByte* previousRow = dictionaryStart ? row(dictionaryStart - 1, previous) : zeros;
+                for(std::size_t y = dictionaryStart; y != end; ++y) {
+                    const UnsignedByte* const currentRow = row(y, current);
+                    UnsignedByte* const out = filtered.data() + (y - dictionaryStart)*filteredRowSize;
+                    if(filter == FilterAdaptive) {
+                        std::size_t bestCost = ~std::size_t{};
+                        std::size_t best = 0;
+                        for(Int f = FilterNone; f <= FilterPaeth; ++f) {
+                            filterRow(f, currentRow, previousRow, rowSize, pixelSize, candidates + f*filteredRowSize);
+                            const std::size_t cost = filterCost(candidates + f*filteredRowSize + 1, rowSize);
+                            if(cost < bestCost) {
+                                bestCost = cost;
+                                best = f;
+                            }
+                        }
+                        Utility::copy(Containers::ArrayView<const UnsignedByte>{candidates + best*filteredRowSize, filteredRowSize}, Containers::ArrayView<UnsignedByte>{out, filteredRowSize});
+                    } else filterRow(filter, currentRow, previousRow, rowSize, pixelSize, out);
+
+                    previousRow = currentRow;
+                    Utility::swap(current, previous);
+                }
+
+                const Containers::ArrayView<const UnsignedByte> dictionary = filtered.prefix((start - dictionaryStart)*filteredRowSize);
+                const Containers::ArrayView<const UnsignedByte> data = filtered.slice(dictionary.size(), size);
+                bandChecksums[band] = adler32(1, data.data(), data.size());
+                errors[band] = deflateBand(
+                    dictionary.exceptPrefix(dictionary.size() - Math::min(dictionary.size(), std::size_t(32768))),
+                    data, compressionLevel, strategy, band == bandCount - 1,
+                    bands[band], bandSizes[band]);
+            }
+        };
+
+        Containers::Array<std::thread> threads{threadCount - 1};
+        for(std::thread& thread: threads)
+            thread = std::thread{worker};
+        worker();
+        for(std::thread& thread: threads)
+            thread.join();
+
+        for(std::size_t i = 0; i != bandCount; ++i) {
+            if(errors[i]) {
+                Error{} << "Trade::PngImageConverter::convertToData(): compression of band" << i << "failed:" << errors[i];
+                png_destroy_write_struct(&file, &info);
+                return {};
+            }
+        }
+
+        /* Zlib header, matching what zlib itself would write for given level
+           and strategy */
+        const Int level = compressionLevel == Z_DEFAULT_COMPRESSION ? 6 : compressionLevel;
+        UnsignedInt header = 0x7800;
+        if(strategy >= Z_HUFFMAN_ONLY || level < 2)
+            header |= 0 << 6;
+        else if(level < 6)
+            header |= 1 << 6;
+        else if(level == 6)
+            header |= 2 << 6;
+        else
+            header |= 3 << 6;
+        header += 31 - header % 31;
+        const char zlibHeader[]{char(header >> 8), char(header & 0xff)};
+
+        /* The Adler-32 checksum of the whole data, combined from all bands */
+        uLong checksum = bandChecksums[0];
+        for(std::size_t i = 1; i != bandCount; ++i)
+            checksum = adler32_combine(checksum, bandChecksums[i], (height*(i + 1)/bandCount - height*i/bandCount)*filteredRowSize);
+        const UnsignedInt checksumBigEndian = Utility::Endianness::bigEndian(UnsignedInt(checksum));
+
+        /* Each band goes into a separate IDAT chunk, with the zlib header in
+           the first and the checksum in the last */
+        for(std::size_t i = 0; i != bandCount; ++i) writeChunk(output, "IDAT", {
+            i == 0 ? Containers::arrayView(zlibHeader) : nullptr,
+            bands[i].prefix(bandSizes[i]),
+            i == bandCount - 1 ? Containers::arrayView(reinterpret_cast<const char*>(&checksumBigEndian), 4) : nullptr
+        });
+
+        /* libpng would refuse to write the IEND chunk as it doesn't know about
+           the IDAT chunks written above, so do it directly */
+        writeChunk(output, "IEND", {});
+    }
 
-    png_write_end(file, nullptr);
     png_destroy_write_struct(&file, &info);
 
     /* Convert the growable array back to a non-growable with the default
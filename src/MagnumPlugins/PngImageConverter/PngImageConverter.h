@@ -124,7 +124,35 @@ the file is saved as a regular 2D image.
 
 The plugin recognizes @ref ImageConverterFlag::Quiet, which will cause all
 conversion warnings, coming either from the plugin or libpng itself, to be
-suppressed.
+suppressed. @ref ImageConverterFlag::Verbose prints the autodetected thread
+count if the @cb{.ini} threads @ce option is set to @cpp 0 @ce.
+
+@subsection Trade-PngImageConverter-behavior-compression Compression
+
+The deflate compression level, row filter and deflate strategy can be
+controlled with the @cb{.ini} compressionLevel @ce, @cb{.ini} filter @ce and
+@cb{.ini} strategy @ce @ref Trade-PngImageConverter-configuration "configuration options".
+With the defaults, the output is the same as what libpng produces on its own.
+
+By default the image is written serially through libpng. If the
+@cb{.ini} threads @ce option is set to a value other than @cpp 1 @ce, the
+image is split into bands of rows that are filtered and compressed in
+parallel, and the results are concatenated into a single zlib stream, with
+each band stored in a separate `IDAT` chunk. Each band is compressed with the
+data preceding it as a dictionary, so the output is only slightly larger than
+with the serial path. Because the filters are picked by the plugin itself in
+that case, the output isn't byte-for-byte equivalent to the serial path, but
+decodes to the same pixels.
+
+@section Trade-PngImageConverter-configuration Plugin-specific configuration
+
+It's possible to tune various compression options through
+@ref configuration(). See below for all options and their default values:
+
+@snippet MagnumPlugins/PngImageConverter/PngImageConverter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_PNGIMAGECONVERTER_EXPORT PngImageConverter: public AbstractImageConverter {
     public:
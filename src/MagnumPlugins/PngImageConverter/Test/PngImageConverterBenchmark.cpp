@@ -0,0 +1,112 @@
+/*
+    This file is part of Magnum.
+
+    Copyright © 2010, 2011, 2012, 2013, 2014, 2015, 2016, 2017, 2018, 2019,
+                2020, 2021, 2022, 2023, 2024, 2025
+              Vladimír Vondruš <mosra@centrum.cz>
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation
+    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+    and/or sell copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/Math/Color.h>
+#include <Magnum/Trade/AbstractImageConverter.h>
+
+#include "configure.h"
+
+namespace Magnum { namespace Trade { namespace Test { namespace {
+
+struct PngImageConverterBenchmark: TestSuite::Tester {
+    explicit PngImageConverterBenchmark();
+
+    void convert();
+
+    private:
+        Containers::Array<Color4ub> _pixels;
+
+        /* Explicitly forbid system-wide plugin dependencies */
+        PluginManager::Manager<AbstractImageConverter> _manager{"nonexistent"};
+};
+
+const struct {
+    const char* name;
+    UnsignedInt threads;
+    const char* filter;
+} ConvertData[]{
+    {"serial", 1, ""},
+    {"serial, no filter", 1, "none"},
+    {"2 threads", 2, ""},
+    {"4 threads", 4, ""},
+    {"all threads", 0, ""},
+    {"all threads, no filter", 0, "none"},
+};
+
+/* Roughly a 4K screenshot */
+const Vector2i Size{3840, 2160};
+
+PngImageConverterBenchmark::PngImageConverterBenchmark() {
+    addInstancedBenchmarks({&PngImageConverterBenchmark::convert}, 5,
+        Containers::arraySize(ConvertData));
+
+    /* A smooth gradient with a bit of noise, so the filters have something to
+       do and the output isn't trivially compressible */
+    _pixels = Containers::Array<Color4ub>{NoInit, std::size_t(Size.product())};
+    for(std::size_t i = 0; i != _pixels.size(); ++i) {
+        const std::size_t x = i%Size.x();
+        const std::size_t y = i/Size.x();
+        const UnsignedByte noise = UnsignedInt(i)*2654435761u >> 29;
+        _pixels[i] = Color4ub{UnsignedByte(x*255/Size.x() + noise),
+                              UnsignedByte(y*255/Size.y() + noise),
+                              UnsignedByte((x + y)%256), 0xff};
+    }
+
+    /* Load the plugin directly from the build tree. Otherwise it's static and
+       already loaded. */
+    #ifdef PNGIMAGECONVERTER_PLUGIN_FILENAME
+    CORRADE_INTERNAL_ASSERT_OUTPUT(_manager.load(PNGIMAGECONVERTER_PLUGIN_FILENAME) & PluginManager::LoadState::Loaded);
+    #endif
+}
+
+void PngImageConverterBenchmark::convert() {
+    auto&& data = ConvertData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _manager.instantiate("PngImageConverter");
+    converter->configuration().setValue("threads", data.threads);
+    converter->configuration().setValue("filter", data.filter);
+
+    const ImageView2D image{PixelFormat::RGBA8Unorm, Size, _pixels};
+
+    std::size_t size = 0;
+    CORRADE_BENCHMARK(1) {
+        Containers::Optional<Containers::Array<char>> out = converter->convertToData(image);
+        size += out ? out->size() : 0;
+    }
+
+    CORRADE_VERIFY(size);
+}
+
+}}}}
+
+CORRADE_TEST_MAIN(Magnum::Trade::Test::PngImageConverterBenchmark)
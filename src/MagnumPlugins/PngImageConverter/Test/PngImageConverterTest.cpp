@@ -29,6 +29,7 @@
 #include <Corrade/Containers/StridedArrayView.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/Utility/Format.h>
 #include <Corrade/Utility/Path.h>
@@ -62,6 +63,9 @@ struct PngImageConverterTest: TestSuite::Tester {
 
     void unsupportedMetadata();
 
+    void compressionOptions();
+    void compressionOptionsInvalid();
+
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractImageConverter> _converterManager{"nonexistent"};
     PluginManager::Manager<AbstractImporter> _importerManager{"nonexistent"};
@@ -90,6 +94,47 @@ const struct {
         nullptr},
 };
 
+const struct {
+    const char* name;
+    PixelFormat format;
+    Int compressionLevel;
+    const char* filter;
+    const char* strategy;
+    UnsignedInt threads;
+} CompressionOptionsData[]{
+    {"level 0", PixelFormat::RGB8Unorm, 0, "", "", 1},
+    {"level 9", PixelFormat::RGB8Unorm, 9, "", "", 1},
+    {"no filter", PixelFormat::RGB8Unorm, -1, "none", "", 1},
+    {"paeth filter, RLE", PixelFormat::RGB8Unorm, -1, "paeth", "rle", 1},
+    {"Huffman only", PixelFormat::RGB8Unorm, -1, "", "huffmanOnly", 1},
+    {"2 threads", PixelFormat::RGB8Unorm, -1, "", "", 2},
+    {"4 threads, level 1", PixelFormat::RGB8Unorm, 1, "", "", 4},
+    {"4 threads, level 0", PixelFormat::RGB8Unorm, 0, "", "", 4},
+    {"4 threads, sub filter", PixelFormat::RGB8Unorm, 9, "sub", "", 4},
+    {"4 threads, up filter, fixed", PixelFormat::RGB8Unorm, -1, "up", "fixed", 4},
+    {"4 threads, average filter", PixelFormat::RGB8Unorm, -1, "average", "default", 4},
+    {"4 threads, no filter, 16-bit", PixelFormat::RGB16Unorm, -1, "none", "", 4},
+    {"4 threads, 16-bit", PixelFormat::RGBA16Unorm, -1, "", "", 4},
+    {"all threads", PixelFormat::RGBA8Unorm, -1, "", "", 0},
+    {"more threads than rows", PixelFormat::R8Unorm, -1, "", "", 1000},
+};
+
+const struct {
+    const char* name;
+    const char* option;
+    const char* value;
+    const char* message;
+} CompressionOptionsInvalidData[]{
+    {"level too small", "compressionLevel", "-2",
+        "expected compressionLevel to be between -1 and 9, got -2"},
+    {"level too large", "compressionLevel", "10",
+        "expected compressionLevel to be between -1 and 9, got 10"},
+    {"invalid filter", "filter", "png",
+        "expected filter to be empty, none, sub, up, average, paeth or all, got png"},
+    {"invalid strategy", "strategy", "huffman",
+        "expected strategy to be empty, default, filtered, huffmanOnly, rle or fixed, got huffman"},
+};
+
 PngImageConverterTest::PngImageConverterTest() {
     addTests({&PngImageConverterTest::wrongFormat});
 
@@ -109,6 +154,12 @@ PngImageConverterTest::PngImageConverterTest() {
     addInstancedTests({&PngImageConverterTest::unsupportedMetadata},
         Containers::arraySize(UnsupportedMetadataData));
 
+    addInstancedTests({&PngImageConverterTest::compressionOptions},
+        Containers::arraySize(CompressionOptionsData));
+
+    addInstancedTests({&PngImageConverterTest::compressionOptionsInvalid},
+        Containers::arraySize(CompressionOptionsInvalidData));
+
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
     #ifdef PNGIMAGECONVERTER_PLUGIN_FILENAME
@@ -409,6 +460,58 @@ void PngImageConverterTest::unsupportedMetadata() {
         CORRADE_COMPARE(out, Utility::format("Trade::PngImageConverter::convertToData(): {}\n", data.message));
 }
 
+void PngImageConverterTest::compressionOptions() {
+    auto&& data = CompressionOptionsData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    /* Large enough for the deflate window to span multiple bands and with a
+       bit of noise so different filters get picked for different rows */
+    const Vector2i size{97, 131};
+    const std::size_t pixelSize = pixelFormatSize(data.format);
+    Containers::Array<char> imageData{NoInit, std::size_t(size.product())*pixelSize};
+    for(std::size_t i = 0; i != imageData.size(); ++i)
+        imageData[i] = char((i/pixelSize)%97*3 + (UnsignedInt(i)*2654435761u >> 30) + i%pixelSize*17);
+    ImageView2D image{PixelStorage{}.setAlignment(1), data.format, size, imageData};
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    CORRADE_VERIFY(converter->configuration().setValue("compressionLevel", data.compressionLevel));
+    CORRADE_VERIFY(converter->configuration().setValue("filter", data.filter));
+    CORRADE_VERIFY(converter->configuration().setValue("strategy", data.strategy));
+    CORRADE_VERIFY(converter->configuration().setValue("threads", data.threads));
+    Containers::Optional<Containers::Array<char>> compressed = converter->convertToData(image);
+    CORRADE_VERIFY(compressed);
+
+    /* Unless compression is disabled, the output should be smaller than the
+       input */
+    if(data.compressionLevel != 0)
+        CORRADE_COMPARE_AS(compressed->size(), imageData.size(),
+            TestSuite::Compare::Less);
+
+    if(_importerManager.loadState("PngImporter") == PluginManager::LoadState::NotFound)
+        CORRADE_SKIP("PngImporter plugin not found, cannot test");
+
+    Containers::Pointer<AbstractImporter> importer = _importerManager.instantiate("PngImporter");
+    CORRADE_VERIFY(importer->openData(*compressed));
+    Containers::Optional<Trade::ImageData2D> converted = importer->image2D(0);
+    CORRADE_VERIFY(converted);
+    CORRADE_COMPARE_AS(*converted, image,
+        DebugTools::CompareImage);
+}
+
+void PngImageConverterTest::compressionOptionsInvalid() {
+    auto&& data = CompressionOptionsInvalidData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImageConverter> converter = _converterManager.instantiate("PngImageConverter");
+    CORRADE_VERIFY(converter->configuration().setValue(data.option, data.value));
+
+    const char imageData[4]{};
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!converter->convertToData(ImageView2D{PixelFormat::RGBA8Unorm, {1, 1}, imageData}));
+    CORRADE_COMPARE(out, Utility::format("Trade::PngImageConverter::convertToData(): {}\n", data.message));
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::Trade::Test::PngImageConverterTest)
@@ -26,18 +26,24 @@
 
 #include "SpirvToolsConverter.h"
 
+#include <atomic>
+#include <thread>
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Format.h>
+#include <Magnum/Math/Functions.h>
 
 #include "spirv-tools/libspirv.h"
 /* Unfortunately the C optimizer interface is so minimal that it's useless. No
    way to set any optimization preset, even. */
 #include "spirv-tools/optimizer.hpp"
+#include "spirv-tools/linker.hpp"
 #include "MagnumPlugins/SpirvToolsShaderConverter/configureInternal.h"
 
 namespace Magnum { namespace ShaderTools {
@@ -52,6 +58,23 @@ struct SpirvToolsConverter::State {
     Containers::String inputFilename, outputFilename;
 
     Containers::String optimizationLevel;
+
+    /* Context and optimizer with passes registered, cached across calls and
+       recreated only if the target environment or optimization level
+       changes. Validator and optimizer options are applied on each run, so
+       they don't need to be a part of the key. */
+    spv_context context{};
+    spv_target_env contextEnv{};
+    Containers::Pointer<spvtools::Optimizer> optimizer;
+    spv_target_env optimizerEnv{};
+    Containers::String optimizerLevel;
+
+    ~State() {
+        if(context) spvContextDestroy(context);
+    }
+
+    spv_context contextFor(spv_target_env env);
+    spvtools::Optimizer* optimizerFor(spv_target_env env, Containers::StringView level);
 };
 
 SpirvToolsConverter::SpirvToolsConverter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractConverter{manager, plugin}, _state{InPlaceInit} {
@@ -147,7 +170,7 @@ bool readData(const spv_context context, const Utility::ConfigurationGroup& conf
        unused */
     } else {
         if(data.size() % 4 != 0) {
-            Error{} << "ShaderTools::SpirvToolsConverter::convertDataToData(): SPIR-V binary size not divisible by four:" << data.size() << "bytes";
+            Error{} << prefix << "SPIR-V binary size not divisible by four:" << data.size() << "bytes";
             return false;
         }
 
@@ -209,6 +232,226 @@ void setValidationOptions(spv_validator_options& options, const Utility::Configu
     #endif
 }
 
+/* Optimization level 0 and empty means no optimization */
+bool isOptimizationEnabled(const Containers::StringView level) {
+    return !level.isEmpty() && level != "0"_s;
+}
+
+bool isValidOptimizationLevel(const Containers::StringView level) {
+    return !isOptimizationEnabled(level) ||
+        level == "1"_s ||
+        level == "s"_s ||
+        level == "legalizeHlsl"_s ||
+        level == "strip"_s;
+}
+
+/* Prints linker and optimizer messages via our APIs. The what is either
+   "optimization" or "linking". */
+spvtools::MessageConsumer messageConsumer(const char* const functionPrefix, const char* const what) {
+    return [functionPrefix, what](spv_message_level_t level, const char* file, const spv_position_t& position, const char* message) {
+        std::ostream* output{};
+        const char* prefix{};
+        switch(level) {
+            /* LCOV_EXCL_START */
+            case SPV_MSG_FATAL:
+                output = Error::output();
+                prefix = "fatal {} error:";
+                break;
+            case SPV_MSG_INTERNAL_ERROR:
+                output = Error::output();
+                prefix = "internal {} error:";
+                break;
+            case SPV_MSG_ERROR:
+                output = Error::output();
+                prefix = "{} error:";
+                break;
+            case SPV_MSG_WARNING:
+                output = Warning::output();
+                prefix = "{} warning:";
+                break;
+            case SPV_MSG_INFO:
+                output = Debug::output();
+                prefix = "{} info";
+                break;
+            case SPV_MSG_DEBUG:
+                output = Debug::output();
+                prefix = "{} debug info";
+                break;
+            /* LCOV_EXCL_STOP */
+        }
+        /* output can be nullptr in case Debug/Warning/Error is silenced */
+        CORRADE_INTERNAL_ASSERT(prefix);
+
+        Debug out{output};
+        out << functionPrefix << Utility::format(prefix, what) << Debug::newline;
+        spv_diagnostic_t diag{position, const_cast<char*>(message), false};
+        printDiagnostic(out, file, &diag);
+    };
+}
+
+/* Creates an optimizer with passes for given level registered. Expects the
+   level to be valid and enabled. The optimizer is reused across APIs, so the
+   message consumer is set by convertInternal() with the caller's prefix. */
+Containers::Pointer<spvtools::Optimizer> createOptimizer(const spv_target_env env, const Containers::StringView level) {
+    Containers::Pointer<spvtools::Optimizer> optimizer{InPlaceInit, env};
+    if(level == "1"_s)
+        optimizer->RegisterPerformancePasses();
+    else if(level == "s"_s)
+        optimizer->RegisterSizePasses();
+    else if(level == "legalizeHlsl"_s)
+        optimizer->RegisterLegalizationPasses();
+    /* Not a preset in SPIRV-Tools. Removes debug info such as names and
+       source, reflection info and then everything that's unused, which is
+       mainly useful after linking. No other transformations are done. */
+    else if(level == "strip"_s) optimizer->
+        RegisterPass(spvtools::CreateStripDebugInfoPass())
+       .RegisterPass(spvtools::CreateStripReflectInfoPass())
+       .RegisterPass(spvtools::CreateEliminateDeadFunctionsPass())
+       .RegisterPass(spvtools::CreateDeadVariableEliminationPass())
+       .RegisterPass(spvtools::CreateEliminateDeadConstantPass())
+       .RegisterPass(spvtools::CreateCompactIdsPass());
+    else CORRADE_INTERNAL_ASSERT_UNREACHABLE(); /* LCOV_EXCL_LINE */
+
+    return optimizer;
+}
+
+/* Converts a single module. Shared between doConvertDataToData() and
+   convertDataToDataBatch(), in the latter case called from multiple threads
+   at once, each with its own optimizer instance. The context is only read
+   from, which is safe to do from multiple threads. If optimizer is null, no
+   optimization is done. */
+Containers::Optional<Containers::Array<char>> convertInternal(const spv_context context, spvtools::Optimizer* const optimizer, const Utility::ConfigurationGroup& configuration, const Format inputFormat, const Format outputFormat, const Containers::StringView inputFilename, const Containers::StringView outputFilename, const char* const prefix, const Containers::ArrayView<const char> data) {
+    /** @todo make this work on big-endian */
+
+    spv_binary_t binaryStorage;
+    spv_binary binary{};
+    Containers::ScopeGuard binaryDestroy{NoCreate};
+    if(!readData(context, configuration, inputFormat, inputFilename, prefix, binaryStorage, binary, binaryDestroy, data, 0))
+        return {};
+
+    /* Run the optimizer, if desired. What the hell, is the output a vector
+       again?! Is everyone mad or */
+    std::vector<UnsignedInt> optimizerOutputStorage;
+    if(optimizer) {
+        /* Validator options and limits. Same as in doValidateData(). */
+        spv_validator_options validatorOptions = spvValidatorOptionsCreate();
+        Containers::ScopeGuard validatorOptionsDestroy{validatorOptions, spvValidatorOptionsDestroy};
+        setValidationOptions(validatorOptions, configuration);
+
+        /* Optimizer options */
+        spv_optimizer_options optimizerOptions = spvOptimizerOptionsCreate();
+        Containers::ScopeGuard optimizerOptionsDestroy{optimizerOptions, spvOptimizerOptionsDestroy};
+        spvOptimizerOptionsSetRunValidator(optimizerOptions,
+            configuration.value<bool>("validateBeforeOptimization"));
+        spvOptimizerOptionsSetValidatorOptions(optimizerOptions,
+            validatorOptions);
+        spvOptimizerOptionsSetMaxIdBound(optimizerOptions,
+            configuration.value<UnsignedInt>("maxIdBound"));
+        #if SPIRVTOOLS_VERSION >= 201904
+        spvOptimizerOptionsSetPreserveBindings(optimizerOptions,
+            configuration.value<UnsignedInt>("preserveBindings"));
+        spvOptimizerOptionsSetPreserveSpecConstants(optimizerOptions,
+            configuration.value<UnsignedInt>("preserveSpecializationConstants"));
+        #endif
+        #if SPIRVTOOLS_VERSION >= 201903
+        optimizer->SetValidateAfterAll(configuration.value<bool>("validateAfterEachOptimization"));
+        #endif
+        optimizer->SetTimeReport(configuration.value<bool>("optimizerTimeReport") ? Debug::output() : nullptr);
+        optimizer->SetMessageConsumer(messageConsumer(prefix, "optimization"));
+
+        /* If the optimizer fails, exit. The message is printed by the message
+           consumer we set above. */
+        if(!optimizer->Run(binary->code, binary->wordCount, &optimizerOutputStorage, optimizerOptions))
+            return {};
+
+        /* Reference the vector guts in the binary again for the rest of the
+           code. Replace the old scope guard with an empty one, which will
+           also trigger the original deleter, if it was when disassembing. */
+        binaryDestroy = Containers::ScopeGuard{NoCreate};
+        binary = &binaryStorage;
+        binary->code = optimizerOutputStorage.data();
+        binary->wordCount = optimizerOutputStorage.size();
+    }
+
+    /* Disassemble, if desired, or if the output filename ends with *.spvasm */
+    Containers::Array<char> out;
+    if(outputFormat == Format::SpirvAssembly || (outputFormat == Format::Unspecified && outputFilename.hasSuffix(".spvasm"_s))) {
+        /* There's SPV_BINARY_TO_TEXT_OPTION_NONE which has a non-zero value
+           but isn't used anywhere. Looks like another variant of the same
+           brainfart. */
+        Int options = 0;
+        /* SPV_BINARY_TO_TEXT_OPTION_PRINT not exposed, we always want data */
+        /** @todo put Color into flags? so magnum-shaderconverter can use
+            --color auto and such */
+        if(configuration.value<bool>("color"))
+            options |= SPV_BINARY_TO_TEXT_OPTION_COLOR;
+        if(configuration.value<bool>("indent"))
+            options |= SPV_BINARY_TO_TEXT_OPTION_INDENT;
+        if(configuration.value<bool>("byteOffset"))
+            options |= SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET;
+        /* no-headers=false would be a hard-to-parse double negative, flip
+           that (also it would mean `magnum-shaderconverter -fno-no-headers`,
+           which looks extra stupid) */
+        if(!configuration.value<bool>("header"))
+            options |= SPV_BINARY_TO_TEXT_OPTION_NO_HEADER;
+        if(configuration.value<bool>("friendlyNames"))
+            options |= SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES;
+        /** @todo SPV_BINARY_TO_TEXT_OPTION_COMMENT, since
+            https://github.com/KhronosGroup/SPIRV-Tools/pull/3847, not in the
+            2020.6 release yet -- also, expose through setDebugInfoLevel()? */
+
+        spv_text text{};
+        spv_diagnostic diagnostic;
+        const spv_result_t error = spvBinaryToText(context, binary->code, binary->wordCount, options, &text, &diagnostic);
+        Containers::ScopeGuard textDestroy{text, spvTextDestroy};
+        Containers::ScopeGuard diagnosticDestroy{diagnostic, spvDiagnosticDestroy};
+        if(error) {
+            Error e;
+            e << prefix << "disassembly failed:";
+            printDiagnostic(e, inputFilename, diagnostic);
+            return {};
+        }
+
+        /* Copy the text to the output. We can't take ownership of that array
+           because it *might* have a different deleter (in reality it uses a
+           plain delete[], but I don't want to depend on such an implementation
+           detail, this is not a perf-critical code path). */
+        out = Containers::Array<char>{NoInit, text->length};
+        Utility::copy(Containers::arrayView(text->str, text->length), out);
+
+    /* Otherwise simply copy the binary to the output. We can't take ownership
+       of the array here either because in addition to the case above the
+       binary could also point right at the input `data`. */
+    } else {
+        Containers::ArrayView<const char> in(reinterpret_cast<const char*>(binary->code), 4*binary->wordCount);
+        out = Containers::Array<char>{NoInit, in.size()};
+        Utility::copy(in, out);
+    }
+
+    /* GCC 4.8 needs extra help here */
+    return Containers::optional(Utility::move(out));
+}
+
+}
+
+spv_context SpirvToolsConverter::State::contextFor(const spv_target_env env) {
+    if(!context || contextEnv != env) {
+        if(context) spvContextDestroy(context);
+        context = spvContextCreate(env);
+        contextEnv = env;
+    }
+
+    return context;
+}
+
+spvtools::Optimizer* SpirvToolsConverter::State::optimizerFor(const spv_target_env env, const Containers::StringView level) {
+    if(!optimizer || optimizerEnv != env || optimizerLevel != level) {
+        optimizer = createOptimizer(env, level);
+        optimizerEnv = env;
+        optimizerLevel = level;
+    }
+
+    return optimizer.get();
 }
 
 Containers::Pair<bool, Containers::String> SpirvToolsConverter::doValidateFile(const Stage stage, const Containers::StringView filename) {
@@ -248,8 +491,7 @@ Containers::Pair<bool, Containers::String> SpirvToolsConverter::doValidateData(S
         return {};
     }
 
-    const spv_context context = spvContextCreate(env);
-    Containers::ScopeGuard contextDestroy{context, spvContextDestroy};
+    const spv_context context = _state->contextFor(env);
 
     /** @todo make this work on big-endian */
 
@@ -342,170 +584,176 @@ Containers::Optional<Containers::Array<char>> SpirvToolsConverter::doConvertData
         }
     }
 
-    const spv_context context = spvContextCreate(env);
-    Containers::ScopeGuard contextDestroy{context, spvContextDestroy};
+    if(!isValidOptimizationLevel(_state->optimizationLevel)) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToData(): optimization level should be 0, 1, s, legalizeHlsl, strip or empty but got" << _state->optimizationLevel;
+        return {};
+    }
 
-    /** @todo make this work on big-endian */
+    return convertInternal(_state->contextFor(env), isOptimizationEnabled(_state->optimizationLevel) ? _state->optimizerFor(env, _state->optimizationLevel) : nullptr, configuration(), _state->inputFormat, _state->outputFormat, inputFilename, outputFilename, "ShaderTools::SpirvToolsConverter::convertDataToData():", data);
+}
 
-    spv_binary_t binaryStorage;
-    spv_binary binary{};
-    Containers::ScopeGuard binaryDestroy{NoCreate};
-    if(!readData(context, configuration(), _state->inputFormat, inputFilename, "ShaderTools::SpirvToolsConverter::convertDataToData():", binaryStorage, binary, binaryDestroy, data, 0))
-        return {};
+Containers::Array<Containers::Optional<Containers::Array<char>>> SpirvToolsConverter::convertDataToDataBatch(const Containers::ArrayView<const Containers::ArrayView<const char>> data) {
+    /* Results for items that fail stay NullOpt, which is also the case for
+       all of them if any of the checks below fail */
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out{std::size_t(data.size())};
 
-    /* Run the optimizer, if desired. What the hell, is the output a vector
-       again?! Is everyone mad or */
-    std::vector<UnsignedInt> optimizerOutputStorage;
-    if(!_state->optimizationLevel.isEmpty() && _state->optimizationLevel != "0"_s) {
-        spvtools::Optimizer optimizer{env};
-        if(_state->optimizationLevel == "1"_s)
-            optimizer.RegisterPerformancePasses();
-        else if(_state->optimizationLevel == "s"_s)
-            optimizer.RegisterSizePasses();
-        else if(_state->optimizationLevel == "legalizeHlsl"_s)
-            optimizer.RegisterLegalizationPasses();
-        else {
-            Error{} << "ShaderTools::SpirvToolsConverter::convertDataToData(): optimization level should be 0, 1, s, legalizeHlsl or empty but got" << _state->optimizationLevel;
-            return {};
+    if(_state->inputFormat != Format::Unspecified &&
+       _state->inputFormat != Format::Spirv &&
+       _state->inputFormat != Format::SpirvAssembly) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToDataBatch(): input format should be Spirv, SpirvAssembly or Unspecified but got" << _state->inputFormat;
+        return out;
+    }
+    if(!_state->inputVersion.isEmpty()) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToDataBatch(): input format version should be empty but got" << _state->inputVersion;
+        return out;
+    }
+
+    if(_state->outputFormat != Format::Unspecified &&
+       _state->outputFormat != Format::Spirv &&
+       _state->outputFormat != Format::SpirvAssembly) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToDataBatch(): output format should be Spirv, SpirvAssembly or Unspecified but got" << _state->outputFormat;
+        return out;
+    }
+
+    spv_target_env env = SPV_ENV_VULKAN_1_0;
+    if(!_state->outputVersion.isEmpty() && !spvParseTargetEnv(_state->outputVersion.data(), &env)) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToDataBatch(): unrecognized output format version" << _state->outputVersion;
+        return out;
+    }
+
+    if(!isValidOptimizationLevel(_state->optimizationLevel)) {
+        Error{} << "ShaderTools::SpirvToolsConverter::convertDataToDataBatch(): optimization level should be 0, 1, s, legalizeHlsl, strip or empty but got" << _state->optimizationLevel;
+        return out;
+    }
+
+    /* Messages printed during conversion of each item are captured and
+       printed on the calling thread after, in input order, which relies on
+       the Debug output redirection being thread-local. That's not the case if
+       Corrade isn't built with multithreading support, in which case
+       everything is converted on the calling thread. */
+    #ifdef CORRADE_BUILD_MULTITHREADED
+    UnsignedInt threadCount = configuration().value<UnsignedInt>("threads");
+    if(!threadCount)
+        threadCount = std::thread::hardware_concurrency();
+    threadCount = UnsignedInt(Math::clamp<std::size_t>(threadCount, 1, Math::max(data.size(), std::size_t{1})));
+    #else
+    const UnsignedInt threadCount = 1;
+    #endif
+
+    /* The context is shared by all threads. The optimizer isn't thread-safe,
+       so the first thread uses the cached one and every other thread gets
+       its own. */
+    const spv_context context = _state->contextFor(env);
+    const bool optimize = isOptimizationEnabled(_state->optimizationLevel);
+    Containers::Array<Containers::Pointer<spvtools::Optimizer>> optimizers{threadCount};
+    spvtools::Optimizer* const cachedOptimizer = optimize ? _state->optimizerFor(env, _state->optimizationLevel) : nullptr;
+    if(optimize) for(UnsignedInt i = 1; i != threadCount; ++i)
+        optimizers[i] = createOptimizer(env, _state->optimizationLevel);
+
+    const Utility::ConfigurationGroup& config = configuration();
+    Containers::Array<Containers::String> debugOutput{std::size_t(data.size())};
+    Containers::Array<Containers::String> warningOutput{std::size_t(data.size())};
+    Containers::Array<Containers::String> errorOutput{std::size_t(data.size())};
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](const UnsignedInt thread) {
+        spvtools::Optimizer* const optimizer = thread ? optimizers[thread].get() : cachedOptimizer;
+        for(std::size_t i; (i = next++) < data.size(); ) {
+            Debug redirectDebug{&debugOutput[i]};
+            Warning redirectWarning{&warningOutput[i]};
+            Error redirectError{&errorOutput[i]};
+            out[i] = convertInternal(context, optimizer, config, _state->inputFormat, _state->outputFormat, {}, {}, "ShaderTools::SpirvToolsConverter::convertDataToDataBatch():", data[i]);
         }
+    };
+
+    Containers::Array<std::thread> threads{threadCount - 1};
+    for(UnsignedInt i = 0; i != threads.size(); ++i)
+        threads[i] = std::thread{worker, i + 1};
+    worker(0);
+    for(std::thread& thread: threads)
+        thread.join();
+
+    /* Print the captured messages in input order */
+    for(std::size_t i = 0; i != data.size(); ++i) {
+        if(!debugOutput[i].isEmpty())
+            Debug{Debug::Flag::NoNewlineAtTheEnd} << debugOutput[i];
+        if(!warningOutput[i].isEmpty())
+            Warning{Debug::Flag::NoNewlineAtTheEnd} << warningOutput[i];
+        if(!errorOutput[i].isEmpty())
+            Error{Debug::Flag::NoNewlineAtTheEnd} << errorOutput[i];
+    }
 
-        /* Print using our own APIs */
-        optimizer.SetMessageConsumer([](spv_message_level_t level, const char* file, const spv_position_t& position, const char* message) {
-            std::ostream* output{};
-            const char* prefix{};
-            switch(level) {
-                /* LCOV_EXCL_START */
-                case SPV_MSG_FATAL:
-                    output = Error::output();
-                    prefix = "fatal optimization error:";
-                    break;
-                case SPV_MSG_INTERNAL_ERROR:
-                    output = Error::output();
-                    prefix = "internal optimization error:";
-                    break;
-                case SPV_MSG_ERROR:
-                    output = Error::output();
-                    prefix = "optimization error:";
-                    break;
-                case SPV_MSG_WARNING:
-                    output = Warning::output();
-                    prefix = "optimization warning:";
-                    break;
-                case SPV_MSG_INFO:
-                    output = Debug::output();
-                    prefix = "optimization info";
-                    break;
-                case SPV_MSG_DEBUG:
-                    output = Debug::output();
-                    prefix = "optimization debug info";
-                    break;
-                /* LCOV_EXCL_STOP */
-            }
-            /* output can be nullptr in case Debug/Warning/Error is silenced */
-            CORRADE_INTERNAL_ASSERT(prefix);
-
-            Debug out{output};
-            out << "ShaderTools::SpirvToolsConverter::convertDataToData():" << prefix << Debug::newline;
-            spv_diagnostic_t diag{position, const_cast<char*>(message), false};
-            printDiagnostic(out, file, &diag);
-        });
+    return out;
+}
 
-        /* Validator options and limits. Same as in doValidateData(). */
-        spv_validator_options validatorOptions = spvValidatorOptionsCreate();
-        Containers::ScopeGuard validatorOptionsDestroy{validatorOptions, spvValidatorOptionsDestroy};
-        setValidationOptions(validatorOptions, configuration());
+Containers::Optional<Containers::Array<char>> SpirvToolsConverter::linkDataToData(const Containers::ArrayView<const Containers::ArrayView<const char>> data) {
+    if(_state->inputFormat != Format::Unspecified &&
+       _state->inputFormat != Format::Spirv &&
+       _state->inputFormat != Format::SpirvAssembly) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): input format should be Spirv, SpirvAssembly or Unspecified but got" << _state->inputFormat;
+        return {};
+    }
+    if(!_state->inputVersion.isEmpty()) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): input format version should be empty but got" << _state->inputVersion;
+        return {};
+    }
 
-        /* Optimizer options */
-        spv_optimizer_options optimizerOptions = spvOptimizerOptionsCreate();
-        Containers::ScopeGuard optimizerOptionsDestroy{optimizerOptions, spvOptimizerOptionsDestroy};
-        spvOptimizerOptionsSetRunValidator(optimizerOptions,
-            configuration().value<bool>("validateBeforeOptimization"));
-        spvOptimizerOptionsSetValidatorOptions(optimizerOptions,
-            validatorOptions);
-        spvOptimizerOptionsSetMaxIdBound(optimizerOptions,
-            configuration().value<UnsignedInt>("maxIdBound"));
-        #if SPIRVTOOLS_VERSION >= 201904
-        spvOptimizerOptionsSetPreserveBindings(optimizerOptions,
-            configuration().value<UnsignedInt>("preserveBindings"));
-        spvOptimizerOptionsSetPreserveSpecConstants(optimizerOptions,
-            configuration().value<UnsignedInt>("preserveSpecializationConstants"));
-        #endif
-        #if SPIRVTOOLS_VERSION >= 201903
-        optimizer.SetValidateAfterAll(configuration().value<bool>("validateAfterEachOptimization"));
-        #endif
-        optimizer.SetTimeReport(configuration().value<bool>("optimizerTimeReport") ? Debug::output() : nullptr);
+    if(_state->outputFormat != Format::Unspecified &&
+       _state->outputFormat != Format::Spirv &&
+       _state->outputFormat != Format::SpirvAssembly) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): output format should be Spirv, SpirvAssembly or Unspecified but got" << _state->outputFormat;
+        return {};
+    }
 
-        /* If the optimizer fails, exit. The message is printed by the message
-           consumer we set above. */
-        if(!optimizer.Run(binary->code, binary->wordCount, &optimizerOutputStorage, optimizerOptions))
-            return {};
+    spv_target_env env = SPV_ENV_VULKAN_1_0;
+    if(!_state->outputVersion.isEmpty() && !spvParseTargetEnv(_state->outputVersion.data(), &env)) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): unrecognized output format version" << _state->outputVersion;
+        return {};
+    }
 
-        /* Reference the vector guts in the binary again for the rest of the
-           code. Replace the old scope guard with an empty one, which will
-           also trigger the original deleter, if it was when disassembing. */
-        binaryDestroy = Containers::ScopeGuard{NoCreate};
-        binary = &binaryStorage;
-        binary->code = optimizerOutputStorage.data();
-        binary->wordCount = optimizerOutputStorage.size();
+    if(!isValidOptimizationLevel(_state->optimizationLevel)) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): optimization level should be 0, 1, s, legalizeHlsl, strip or empty but got" << _state->optimizationLevel;
+        return {};
     }
 
-    /* Disassemble, if desired, or if the output filename ends with *.spvasm */
-    Containers::Array<char> out;
-    if(_state->outputFormat == Format::SpirvAssembly || (_state->outputFormat == Format::Unspecified && outputFilename.hasSuffix(".spvasm"_s))) {
-        /* There's SPV_BINARY_TO_TEXT_OPTION_NONE which has a non-zero value
-           but isn't used anywhere. Looks like another variant of the same
-           brainfart. */
-        Int options = 0;
-        /* SPV_BINARY_TO_TEXT_OPTION_PRINT not exposed, we always want data */
-        /** @todo put Color into flags? so magnum-shaderconverter can use
-            --color auto and such */
-        if(configuration().value<bool>("color"))
-            options |= SPV_BINARY_TO_TEXT_OPTION_COLOR;
-        if(configuration().value<bool>("indent"))
-            options |= SPV_BINARY_TO_TEXT_OPTION_INDENT;
-        if(configuration().value<bool>("byteOffset"))
-            options |= SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET;
-        /* no-headers=false would be a hard-to-parse double negative, flip
-           that (also it would mean `magnum-shaderconverter -fno-no-headers`,
-           which looks extra stupid) */
-        if(!configuration().value<bool>("header"))
-            options |= SPV_BINARY_TO_TEXT_OPTION_NO_HEADER;
-        if(configuration().value<bool>("friendlyNames"))
-            options |= SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES;
-        /** @todo SPV_BINARY_TO_TEXT_OPTION_COMMENT, since
-            https://github.com/KhronosGroup/SPIRV-Tools/pull/3847, not in the
-            2020.6 release yet -- also, expose through setDebugInfoLevel()? */
+    if(data.isEmpty()) {
+        Error{} << "ShaderTools::SpirvToolsConverter::linkDataToData(): no modules to link";
+        return {};
+    }
 
-        spv_text text{};
-        spv_diagnostic diagnostic;
-        const spv_result_t error = spvBinaryToText(context, binary->code, binary->wordCount, options, &text, &diagnostic);
-        Containers::ScopeGuard textDestroy{text, spvTextDestroy};
-        Containers::ScopeGuard diagnosticDestroy{diagnostic, spvDiagnosticDestroy};
-        if(error) {
-            Error e;
-            e << "ShaderTools::SpirvToolsConverter::convertDataToData(): disassembly failed:";
-            printDiagnostic(e, inputFilename, diagnostic);
+    /* Assemble or reference all inputs */
+    const spv_context context = _state->contextFor(env);
+    Containers::Array<spv_binary_t> binaryStorage{ValueInit, data.size()};
+    Containers::Array<spv_binary> binaries{ValueInit, data.size()};
+    Containers::Array<Containers::ScopeGuard> binaryDestroy{DirectInit, data.size(), NoCreate};
+    for(std::size_t i = 0; i != data.size(); ++i) {
+        if(!readData(context, configuration(), _state->inputFormat, {}, "ShaderTools::SpirvToolsConverter::linkDataToData():", binaryStorage[i], binaries[i], binaryDestroy[i], data[i], 0))
             return {};
-        }
-
-        /* Copy the text to the output. We can't take ownership of that array
-           because it *might* have a different deleter (in reality it uses a
-           plain delete[], but I don't want to depend on such an implementation
-           detail, this is not a perf-critical code path). */
-        out = Containers::Array<char>{NoInit, text->length};
-        Utility::copy(Containers::arrayView(text->str, text->length), out);
+    }
 
-    /* Otherwise simply copy the binary to the output. We can't take ownership
-       of the array here either because in addition to the case above the
-       binary could also point right at the input `data`. */
-    } else {
-        Containers::ArrayView<const char> in(reinterpret_cast<const char*>(binary->code), 4*binary->wordCount);
-        out = Containers::Array<char>{NoInit, in.size()};
-        Utility::copy(in, out);
+    Containers::Array<const UnsignedInt*> codes{NoInit, data.size()};
+    Containers::Array<std::size_t> wordCounts{NoInit, data.size()};
+    for(std::size_t i = 0; i != data.size(); ++i) {
+        codes[i] = binaries[i]->code;
+        wordCounts[i] = binaries[i]->wordCount;
     }
 
-    /* GCC 4.8 needs extra help here */
-    return Containers::optional(Utility::move(out));
+    /* The linker needs its own context wrapper, it can't take the cached C
+       one. Linking is a one-off operation, so it's not a problem. */
+    spvtools::Context linkerContext{env};
+    linkerContext.SetMessageConsumer(messageConsumer("ShaderTools::SpirvToolsConverter::linkDataToData():", "linking"));
+    spvtools::LinkerOptions options;
+    options.SetCreateLibrary(configuration().value<bool>("linkCreateLibrary"));
+    options.SetVerifyIds(configuration().value<bool>("linkVerifyIds"));
+
+    /* If linking fails, exit. The message is printed by the message consumer
+       we set above. What, a vector again?! */
+    std::vector<UnsignedInt> linked;
+    if(spvtools::Link(linkerContext, codes.data(), wordCounts.data(), data.size(), &linked, options) != SPV_SUCCESS)
+        return {};
+
+    /* Optimize, if desired, and produce the output the same way as
+       doConvertDataToData() does */
+    return convertInternal(context, isOptimizationEnabled(_state->optimizationLevel) ? _state->optimizerFor(env, _state->optimizationLevel) : nullptr, configuration(), Format::Spirv, _state->outputFormat, {}, {}, "ShaderTools::SpirvToolsConverter::linkDataToData():", Containers::arrayCast<const char>(Containers::arrayView(linked)));
 }
 
 }}
@@ -182,12 +182,61 @@ between SPIR-V binary and assembly @ref ShaderTools-SpirvToolsConverter-conversi
 -   `s` optimizes for size
 -   `legalizeHlsl` turns SPIR-V originating from a HLSL source to one that can
     be accepted by Vulkan
+-   `strip` removes debug info such as names and embedded source, reflection
+    info and unused functions, variables and constants, and compacts the IDs.
+    No other optimizations are done. Useful especially after
+    @ref ShaderTools-SpirvToolsConverter-linking "linking" to get a minimal
+    module.
 
 Compared to [spirv-opt](https://github.com/KhronosGroup/SPIRV-Tools#optimizer-tool)
 it can work with assembly on both input and output as well, but there's
 currently no way to directly control particular optimizer stages, only general
 validation options specified through the @ref ShaderTools-SpirvToolsConverter-configuration "plugin-specific config".
 
+@section ShaderTools-SpirvToolsConverter-linking Linking modules
+
+The @ref linkDataToData() function links multiple SPIR-V modules, which can be
+either binaries or assemblies, into one using the SPIRV-Tools linker. Functions
+and variables marked with the `Export` linkage attribute in one module are used
+to resolve those marked with `Import` in other modules. The linked module is
+then optimized according to @ref setOptimizationLevel() and output in the same
+format as with @ref convertDataToData(), so combined with the `strip` level a
+single call produces a minimal module. The
+@cb{.ini} linkCreateLibrary @ce and @cb{.ini} linkVerifyIds @ce
+@ref ShaderTools-SpirvToolsConverter-configuration "configuration options"
+control whether the result can still have unresolved imports and whether the
+IDs get verified after merging the modules. Because the function isn't a part
+of the @ref AbstractConverter interface, you need to link to the plugin
+directly and cast the converter instance to @ref SpirvToolsConverter in order
+to call it.
+
+@section ShaderTools-SpirvToolsConverter-batch Context reuse and batch conversion
+
+The SPIRV-Tools context and the optimizer with passes for the current
+optimization level registered are created on first use and reused by
+subsequent validation and conversion calls, being recreated only if the target
+environment or the optimization level changes. Validation and optimizer
+options from the @ref ShaderTools-SpirvToolsConverter-configuration "plugin-specific config"
+are applied on every call, so changing them doesn't cause the passes to be
+registered again.
+
+The @ref convertDataToDataBatch() function converts many modules in parallel,
+distributing them among the number of threads given by the
+@cb{.ini} threads @ce configuration option, with @cpp 0 @ce meaning all
+available hardware threads. The context is shared among the threads, while
+each thread except the calling one gets its own optimizer instance. The input
+and output format and version as well as the optimization level are the same
+for all items. The items have no filename, so the output is a SPIR-V binary
+unless the output format is @ref Format::SpirvAssembly.
+
+Results are returned in input order. Messages printed during conversion of
+each item are collected and printed after all items are converted, also in
+input order. If Corrade isn't built with @ref CORRADE_BUILD_MULTITHREADED,
+all items are converted on the calling thread. Because the function isn't a
+part of the @ref AbstractConverter interface, you need to link to the plugin
+directly and cast the converter instance to @ref SpirvToolsConverter in order
+to call it.
+
 @section ShaderTools-SpirvToolsConverter-format Input and output format and version
 
 By default, the converter attempts to detect a SPIR-V binary and if that fails,
@@ -272,6 +321,33 @@ class MAGNUM_SPIRVTOOLSSHADERCONVERTER_EXPORT SpirvToolsConverter: public Abstra
         /** @brief Plugin manager constructor */
         explicit SpirvToolsConverter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        /**
+         * @brief Convert a batch of modules
+         * @m_since_latest_{plugins}
+         *
+         * Equivalent to calling @ref convertDataToData() for each item of
+         * @p data, but the items are converted in parallel. Returns a list
+         * with converted data for each item in the same order as the input,
+         * with failed items being @relativeref{Corrade,Containers::NullOpt}.
+         * See @ref ShaderTools-SpirvToolsConverter-batch for more
+         * information.
+         */
+        Containers::Array<Containers::Optional<Containers::Array<char>>> convertDataToDataBatch(Containers::ArrayView<const Containers::ArrayView<const char>> data);
+
+        /**
+         * @brief Link multiple modules together
+         * @m_since_latest_{plugins}
+         *
+         * Links SPIR-V binaries or assemblies in @p data into a single
+         * module, which is then optionally optimized and output the same way
+         * as in @ref convertDataToData(). Prints a message to
+         * @relativeref{Magnum,Error} and returns
+         * @relativeref{Corrade,Containers::NullOpt} if any of the inputs
+         * can't be assembled or if the linking fails. See
+         * @ref ShaderTools-SpirvToolsConverter-linking for more information.
+         */
+        Containers::Optional<Containers::Array<char>> linkDataToData(Containers::ArrayView<const Containers::ArrayView<const char>> data);
+
     private:
         MAGNUM_SPIRVTOOLSSHADERCONVERTER_LOCAL ConverterFeatures doFeatures() const override;
         MAGNUM_SPIRVTOOLSSHADERCONVERTER_LOCAL void doSetInputFormat(Format format, Containers::StringView version) override;
@@ -29,6 +29,7 @@
 #include <Corrade/Containers/Pair.h>
 #include <Corrade/Containers/StringView.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/TestSuite/Compare/String.h>
 #include <Corrade/TestSuite/Compare/StringToFile.h>
 #include <Corrade/TestSuite/Compare/File.h>
 #include <Corrade/TestSuite/Compare/Container.h>
@@ -41,6 +42,10 @@
 #include "configure.h"
 #include "MagnumPlugins/SpirvToolsShaderConverter/configureInternal.h"
 
+#ifdef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+#include "MagnumPlugins/SpirvToolsShaderConverter/SpirvToolsConverter.h"
+#endif
+
 namespace Magnum { namespace ShaderTools { namespace Test { namespace {
 
 struct SpirvToolsConverterTest: TestSuite::Tester {
@@ -80,6 +85,15 @@ struct SpirvToolsConverterTest: TestSuite::Tester {
 
     void convertOptimize();
     void convertOptimizeFail();
+    void convertOptimizeReuse();
+
+    void convertBatch();
+
+    void link();
+    void linkStrip();
+    void linkUnresolved();
+    void linkBinarySizeNotDivisibleByFour();
+    void linkNoModules();
 
     /* Explicitly forbid system-wide plugin dependencies */
     PluginManager::Manager<AbstractConverter> _converterManager{"nonexistent"};
@@ -168,6 +182,17 @@ const struct {
         "triangle-shaders.spv", Format::Spirv}
 };
 
+const struct {
+    const char* name;
+    const char* level;
+    UnsignedInt threads;
+} ConvertBatchData[] {
+    {"no optimization, single thread", "", 1},
+    {"single thread", "1", 1},
+    {"two threads", "1", 2},
+    {"all hardware threads", "1", 0},
+};
+
 SpirvToolsConverterTest::SpirvToolsConverterTest() {
     addInstancedTests({&SpirvToolsConverterTest::validate,
                        &SpirvToolsConverterTest::validateFile},
@@ -214,7 +239,17 @@ SpirvToolsConverterTest::SpirvToolsConverterTest() {
     addInstancedTests({&SpirvToolsConverterTest::convertOptimize},
         Containers::arraySize(OptimizeData));
 
-    addTests({&SpirvToolsConverterTest::convertOptimizeFail});
+    addTests({&SpirvToolsConverterTest::convertOptimizeFail,
+              &SpirvToolsConverterTest::convertOptimizeReuse});
+
+    addInstancedTests({&SpirvToolsConverterTest::convertBatch},
+        Containers::arraySize(ConvertBatchData));
+
+    addTests({&SpirvToolsConverterTest::link,
+              &SpirvToolsConverterTest::linkStrip,
+              &SpirvToolsConverterTest::linkUnresolved,
+              &SpirvToolsConverterTest::linkBinarySizeNotDivisibleByFour,
+              &SpirvToolsConverterTest::linkNoModules});
 
     /* Load the plugin directly from the build tree. Otherwise it's static and
        already loaded. */
@@ -467,7 +502,7 @@ void SpirvToolsConverterTest::validateBinarySizeNotDivisbleByFour() {
     CORRADE_COMPARE(converter->validateData({}, data),
         Containers::pair(false, Containers::String{}));
     CORRADE_COMPARE(out,
-        "ShaderTools::SpirvToolsConverter::convertDataToData(): SPIR-V binary size not divisible by four: 37 bytes\n");
+        "ShaderTools::SpirvToolsConverter::validateData(): SPIR-V binary size not divisible by four: 37 bytes\n");
 }
 
 void SpirvToolsConverterTest::convertNoOp() {
@@ -666,7 +701,7 @@ void SpirvToolsConverterTest::convertWrongOptimizationLevel() {
     Error redirectError{&out};
     CORRADE_VERIFY(!converter->convertDataToData({}, {}));
     CORRADE_COMPARE(out,
-        "ShaderTools::SpirvToolsConverter::convertDataToData(): optimization level should be 0, 1, s, legalizeHlsl or empty but got 2\n");
+        "ShaderTools::SpirvToolsConverter::convertDataToData(): optimization level should be 0, 1, s, legalizeHlsl, strip or empty but got 2\n");
 }
 
 void SpirvToolsConverterTest::convertDisassembleExplicitFormatEmptyData() {
@@ -874,6 +909,217 @@ void SpirvToolsConverterTest::convertOptimizeFail() {
         "<data>:5: {}\n", expected));
 }
 
+void SpirvToolsConverterTest::convertOptimizeReuse() {
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+
+    /* Same setup as in convertOptimize() */
+    converter->configuration().setValue("preserveNumericIds", true);
+    converter->setOutputFormat(Format::Spirv, "spv1.2");
+
+    /* The context and optimizer are cached across calls and recreated only
+       if the level or target environment changes, verify that switching them
+       back and forth and changing options in between gives correct results */
+    for(const char* level: {"1", "1", "s", "0", "1"}) {
+        CORRADE_ITERATION(level);
+        converter->setOptimizationLevel(level);
+        converter->configuration().setValue("validateAfterEachOptimization", level == Containers::StringView{"s"});
+
+        Containers::Optional<Containers::Array<char>> out = converter->convertFileToData({},
+            Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "triangle-shaders.noopt.spv"));
+        CORRADE_VERIFY(out);
+        CORRADE_COMPARE_AS(Containers::ArrayView<const char>{*out},
+            Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, level == Containers::StringView{"0"} ? "triangle-shaders.noopt.spv" : "triangle-shaders.spv"),
+            TestSuite::Compare::StringToFile);
+    }
+
+    /* A different target environment recreates both the context and the
+       optimizer, just verify it doesn't fail */
+    converter->setOutputFormat(Format::Spirv, "spv1.3");
+    Containers::Optional<Containers::Array<char>> out = converter->convertFileToData({},
+        Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "triangle-shaders.noopt.spv"));
+    CORRADE_VERIFY(out);
+    CORRADE_COMPARE_AS(out->size(), 5*4, TestSuite::Compare::Greater);
+}
+
+void SpirvToolsConverterTest::convertBatch() {
+    auto&& data = ConvertBatchData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::convertDataToDataBatch() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+    converter->setOptimizationLevel(data.level);
+    converter->configuration().setValue("threads", data.threads);
+
+    /* Same setup as in convertOptimize() */
+    converter->configuration().setValue("preserveNumericIds", true);
+    converter->setOutputFormat(Format::Spirv, "spv1.2");
+
+    Containers::Optional<Containers::Array<char>> binary = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "triangle-shaders.noopt.spv"));
+    Containers::Optional<Containers::Array<char>> assembly = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "triangle-shaders.noopt.spvasm"));
+    CORRADE_VERIFY(binary);
+    CORRADE_VERIFY(assembly);
+
+    /* The third item fails to assemble, the rest should be unaffected by
+       that */
+    const Containers::ArrayView<const char> items[]{
+        *binary,
+        *assembly,
+        Containers::arrayView("OpNonsense", 10),
+        *binary,
+        *assembly
+    };
+
+    /* The error should be the same as when converted alone, except for the
+       function prefix */
+    Containers::String expectedError;
+    {
+        Error redirectError{&expectedError};
+        CORRADE_VERIFY(!converter->convertDataToData({}, items[2]));
+    }
+    using namespace Containers::Literals;
+    const Containers::StringView convertPrefix = "ShaderTools::SpirvToolsConverter::convertDataToData():"_s;
+    CORRADE_VERIFY(expectedError.hasPrefix(convertPrefix));
+
+    Containers::Array<Containers::Optional<Containers::Array<char>>> out;
+    Containers::String error;
+    {
+        Error redirectError{&error};
+        out = static_cast<SpirvToolsConverter&>(*converter).convertDataToDataBatch(items);
+    }
+    CORRADE_COMPARE(error, "ShaderTools::SpirvToolsConverter::convertDataToDataBatch():"_s + expectedError.exceptPrefix(convertPrefix.size()));
+    CORRADE_COMPARE(out.size(), 5);
+
+    for(std::size_t i: {0, 1, 3, 4}) {
+        CORRADE_ITERATION(i);
+        CORRADE_VERIFY(out[i]);
+
+        /* Same generator ID patching as in convertOptimize() */
+        if(Containers::arrayCast<UnsignedInt>(out[i]->prefix(5*4))[2] == 0x70000)
+            Containers::arrayCast<UnsignedInt>(out[i]->prefix(5*4))[2] = 0xdeadc0de;
+
+        CORRADE_COMPARE_AS(Containers::ArrayView<const char>{*out[i]},
+            Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, Containers::StringView{data.level}.isEmpty() ? "triangle-shaders.noopt.spv" : "triangle-shaders.spv"),
+            TestSuite::Compare::StringToFile);
+    }
+    CORRADE_VERIFY(!out[2]);
+    #endif
+}
+
+void SpirvToolsConverterTest::link() {
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::linkDataToData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+    converter->setOutputFormat(Format::SpirvAssembly, "spv1.0");
+    converter->configuration().setValue("header", false);
+
+    Containers::Optional<Containers::Array<char>> a = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "link-a.spvasm"));
+    Containers::Optional<Containers::Array<char>> b = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "link-b.spvasm"));
+    CORRADE_VERIFY(a);
+    CORRADE_VERIFY(b);
+
+    const Containers::ArrayView<const char> items[]{*a, *b};
+    Containers::Optional<Containers::Array<char>> out = static_cast<SpirvToolsConverter&>(*converter).linkDataToData(items);
+    CORRADE_VERIFY(out);
+
+    /* The import got resolved to the exported definition and the linkage
+       decorations are gone, names are kept */
+    const Containers::StringView assembly{*out};
+    CORRADE_VERIFY(assembly.contains("OpFAdd"));
+    CORRADE_VERIFY(assembly.contains("OpFunctionCall"));
+    CORRADE_VERIFY(assembly.contains("OpName"));
+    CORRADE_VERIFY(!assembly.contains("LinkageAttributes"));
+    #endif
+}
+
+void SpirvToolsConverterTest::linkStrip() {
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::linkDataToData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+    converter->setOutputFormat(Format::SpirvAssembly, "spv1.0");
+    converter->setOptimizationLevel("strip");
+    converter->configuration().setValue("header", false);
+
+    Containers::Optional<Containers::Array<char>> a = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "link-a.spvasm"));
+    Containers::Optional<Containers::Array<char>> b = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "link-b.spvasm"));
+    CORRADE_VERIFY(a);
+    CORRADE_VERIFY(b);
+
+    const Containers::ArrayView<const char> items[]{*a, *b};
+    Containers::Optional<Containers::Array<char>> out = static_cast<SpirvToolsConverter&>(*converter).linkDataToData(items);
+    CORRADE_VERIFY(out);
+
+    /* The function is still called from the entrypoint so it stays, the
+       debug names are stripped */
+    const Containers::StringView assembly{*out};
+    CORRADE_VERIFY(assembly.contains("OpFAdd"));
+    CORRADE_VERIFY(!assembly.contains("OpName"));
+    CORRADE_VERIFY(!assembly.contains("LinkageAttributes"));
+    #endif
+}
+
+void SpirvToolsConverterTest::linkUnresolved() {
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::linkDataToData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+    converter->setOutputFormat(Format::SpirvAssembly, "spv1.0");
+
+    Containers::Optional<Containers::Array<char>> b = Utility::Path::read(Utility::Path::join(SPIRVTOOLSSHADERCONVERTER_TEST_DIR, "link-b.spvasm"));
+    CORRADE_VERIFY(b);
+
+    /* The add() import has no definition, which is an error unless a library
+       is created */
+    const Containers::ArrayView<const char> items[]{*b};
+    {
+        Containers::String out;
+        Error redirectError{&out};
+        CORRADE_VERIFY(!static_cast<SpirvToolsConverter&>(*converter).linkDataToData(items));
+        CORRADE_COMPARE_AS(out,
+            "ShaderTools::SpirvToolsConverter::linkDataToData(): linking error:",
+            TestSuite::Compare::StringHasPrefix);
+    }
+
+    converter->configuration().setValue("linkCreateLibrary", true);
+    CORRADE_VERIFY(static_cast<SpirvToolsConverter&>(*converter).linkDataToData(items));
+    #endif
+}
+
+void SpirvToolsConverterTest::linkBinarySizeNotDivisibleByFour() {
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::linkDataToData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+
+    /* Set the input format explicitly so we don't need to convince the
+       autodetection */
+    converter->setInputFormat(Format::Spirv);
+    const char data[37]{};
+    const Containers::ArrayView<const char> items[]{data};
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!static_cast<SpirvToolsConverter&>(*converter).linkDataToData(items));
+    CORRADE_COMPARE(out, "ShaderTools::SpirvToolsConverter::linkDataToData(): SPIR-V binary size not divisible by four: 37 bytes\n");
+    #endif
+}
+
+void SpirvToolsConverterTest::linkNoModules() {
+    #ifndef MAGNUM_SPIRVTOOLSSHADERCONVERTER_BUILD_STATIC
+    CORRADE_SKIP("SpirvToolsConverter::linkDataToData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractConverter> converter = _converterManager.instantiate("SpirvToolsShaderConverter");
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!static_cast<SpirvToolsConverter&>(*converter).linkDataToData({}));
+    CORRADE_COMPARE(out, "ShaderTools::SpirvToolsConverter::linkDataToData(): no modules to link\n");
+    #endif
+}
+
 }}}}
 
 CORRADE_TEST_MAIN(Magnum::ShaderTools::Test::SpirvToolsConverterTest)
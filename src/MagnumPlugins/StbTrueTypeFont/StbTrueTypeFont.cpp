@@ -31,6 +31,7 @@
 #include <Corrade/Containers/StringView.h>
 #include <Corrade/PluginManager/AbstractManager.h>
 #include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Unicode.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/PixelFormat.h>
@@ -152,6 +153,10 @@ bool StbTrueTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containe
     if(!fontId)
         fontId = cache.addFont(_font->info.numGlyphs, this);
 
+    /* If distance field spread is set, glyphs are rendered as signed distance
+       fields directly */
+    const UnsignedInt distanceFieldSpread = configuration().value<UnsignedInt>("distanceFieldSpread");
+
     /* Get sizes of all glyphs to pack into the cache */
     struct Glyph {
         Vector2i size;
@@ -161,6 +166,10 @@ bool StbTrueTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containe
     for(std::size_t i = 0; i != glyphIndices.size(); ++i) {
         Range2Di box;
         stbtt_GetGlyphBitmapBox(&_font->info, glyphIndices[i], _font->scale, _font->scale, &box.min().x(), &box.min().y(), &box.max().x(), &box.max().y());
+        /* stbtt_GetGlyphSDF() pads the box with the spread on each side,
+           except for empty glyphs, for which it produces nothing */
+        if(distanceFieldSpread && box.sizeX() && box.sizeY())
+            box = box.padded(Vector2i{Int(distanceFieldSpread)});
         glyphs[i].size = box.size();
     }
 
@@ -180,32 +189,53 @@ bool StbTrueTypeFont::doFillGlyphCache(AbstractGlyphCache& cache, const Containe
     }
 
     /* Memory for stb_truetype to render into.  We need to flip Y, so it can't
-       be rendered directly into the glyph cache memory. */
+       be rendered directly into the glyph cache memory. Not needed for
+       distance fields, for which stb_truetype allocates the output itself. */
     Range2Di maxBox;
-    stbtt_GetFontBoundingBox(&_font->info, &maxBox.min().x(), &maxBox.min().y(), &maxBox.max().x(), &maxBox.max().y());
-    Containers::Array<char> srcData{NoInit, std::size_t(maxBox.size().product())};
-    const Containers::StridedArrayView2D<const char> src{srcData, {
-        std::size_t(maxBox.sizeY()),
-        std::size_t(maxBox.sizeX())
-    }};
+    Containers::Array<char> srcData;
+    Containers::StridedArrayView2D<const char> src;
+    if(!distanceFieldSpread) {
+        stbtt_GetFontBoundingBox(&_font->info, &maxBox.min().x(), &maxBox.min().y(), &maxBox.max().x(), &maxBox.max().y());
+        srcData = Containers::Array<char>{NoInit, std::size_t(maxBox.size().product())};
+        src = Containers::StridedArrayView2D<const char>{srcData, {
+            std::size_t(maxBox.sizeY()),
+            std::size_t(maxBox.sizeX())
+        }};
+    }
 
     /* Render all glyphs to the atlas and create a glyph map */
     const Containers::StridedArrayView3D<char> dst = cache.image().pixels<char>();
     for(std::size_t i = 0; i != glyphs.size(); ++i) {
-        /* Render the glyph */
+        const Containers::Size2D glyphSize{std::size_t(glyphs[i].size.y()),
+                                           std::size_t(glyphs[i].size.x())};
+        const Containers::StridedArrayView2D<char> glyphDst = dst[glyphs[i].offset.z()]
+            .sliceSize({std::size_t(glyphs[i].offset.y()),
+                        std::size_t(glyphs[i].offset.x())}, glyphSize);
+
         Range2Di box;
         stbtt_GetGlyphBitmapBox(&_font->info, glyphIndices[i], _font->scale, _font->scale, &box.min().x(), &box.min().y(), &box.max().x(), &box.max().y());
-        stbtt_MakeGlyphBitmap(&_font->info, reinterpret_cast<unsigned char*>(srcData.data()), maxBox.sizeX(), maxBox.sizeY(), maxBox.sizeX(), _font->scale, _font->scale, glyphIndices[i]);
 
-        /* Copy the rendered glyph Y-flipped to the destination image */
-        const Containers::Size2D glyphSize{std::size_t(glyphs[i].size.y()),
-                                           std::size_t(glyphs[i].size.x())};
-        Utility::copy(
-            src
-                .prefix(glyphSize).flipped<0>(),
-            dst[glyphs[i].offset.z()]
-                .sliceSize({std::size_t(glyphs[i].offset.y()),
-                            std::size_t(glyphs[i].offset.x())}, glyphSize));
+        /* Render the glyph as a distance field, mapping the spread to the
+           full 8-bit range with the edge in the middle, and copy it Y-flipped
+           to the destination image. The function allocates the output
+           itself, for empty glyphs it returns nullptr. */
+        if(distanceFieldSpread) {
+            Vector2i sdfSize, sdfOffset;
+            if(unsigned char* const sdf = stbtt_GetGlyphSDF(&_font->info, _font->scale, glyphIndices[i], distanceFieldSpread, 128, 128.0f/distanceFieldSpread, &sdfSize.x(), &sdfSize.y(), &sdfOffset.x(), &sdfOffset.y())) {
+                CORRADE_INTERNAL_ASSERT(sdfSize == glyphs[i].size);
+                box = Range2Di::fromSize(sdfOffset, sdfSize);
+                Utility::copy(
+                    Containers::StridedArrayView2D<const char>{{reinterpret_cast<const char*>(sdf), std::size_t(sdfSize.product())}, glyphSize}.flipped<0>(),
+                    glyphDst);
+                stbtt_FreeSDF(sdf, _font->info.userdata);
+            }
+
+        /* Render the glyph coverage and copy it Y-flipped to the destination
+           image */
+        } else {
+            stbtt_MakeGlyphBitmap(&_font->info, reinterpret_cast<unsigned char*>(srcData.data()), maxBox.sizeX(), maxBox.sizeY(), maxBox.sizeX(), _font->scale, _font->scale, glyphIndices[i]);
+            Utility::copy(src.prefix(glyphSize).flipped<0>(), glyphDst);
+        }
 
         /* Insert glyph parameters into the cache */
         cache.addGlyph(*fontId, glyphIndices[i],
@@ -154,6 +154,28 @@ Hinting is not implemented in stb_truetype. Compared to @ref FreeTypeFont or
 While stb_truetype provides access to font kerning tables, the plugin doesn't
 use them at the moment. The feature list passed to @ref AbstractShaper::shape()
 is ignored.
+
+@subsection Text-StbTrueTypeFont-behavior-distance-field Distance field rendering
+
+If the @cb{.ini} distanceFieldSpread @ce
+@ref Text-StbTrueTypeFont-configuration "configuration option" is set to a
+non-zero value, @ref fillGlyphCache() renders the glyphs directly as signed
+distance fields using @m_class{m-doc-external} [stbtt_GetGlyphSDF()](https://github.com/nothings/stb/blob/master/stb_truetype.h),
+instead of rendering coverage that would need a separate distance field pass
+over a large upscaled glyph cache. Each glyph rectangle is then larger by the
+spread on each side, the glyph edge is at the value of @cpp 0.5 @ce, values
+above are inside the glyph and values at or beyond the spread saturate to
+@cpp 0.0 @ce and @cpp 1.0 @ce.
+
+@section Text-StbTrueTypeFont-configuration Plugin-specific configuration
+
+It's possible to tune various options mainly for glyph cache filling through
+@ref configuration(). See below for all options and their default values:
+
+@snippet MagnumPlugins/StbTrueTypeFont/StbTrueTypeFont.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_STBTRUETYPEFONT_EXPORT StbTrueTypeFont: public AbstractFont {
     public:
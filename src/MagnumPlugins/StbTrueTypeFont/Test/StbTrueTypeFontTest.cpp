@@ -31,9 +31,12 @@
 #include <Corrade/PluginManager/Manager.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/TestSuite/Compare/Container.h>
+#include <Corrade/TestSuite/Compare/Numeric.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/DebugTools/CompareImage.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Range.h>
 #include <Magnum/Text/AbstractFont.h>
 #include <Magnum/Text/AbstractGlyphCache.h>
@@ -62,6 +65,7 @@ struct StbTrueTypeFontTest: TestSuite::Tester {
     void fillGlyphCacheArray();
     void fillGlyphCacheInvalidFormat();
     void fillGlyphCacheCannotFit();
+    void fillGlyphCacheDistanceField();
 
     void openTwice();
 
@@ -131,6 +135,7 @@ StbTrueTypeFontTest::StbTrueTypeFontTest() {
               &StbTrueTypeFontTest::fillGlyphCacheArray,
               &StbTrueTypeFontTest::fillGlyphCacheInvalidFormat,
               &StbTrueTypeFontTest::fillGlyphCacheCannotFit,
+              &StbTrueTypeFontTest::fillGlyphCacheDistanceField,
 
               &StbTrueTypeFontTest::openTwice});
 
@@ -671,6 +676,46 @@ void StbTrueTypeFontTest::fillGlyphCacheCannotFit() {
     CORRADE_COMPARE(out, "Text::StbTrueTypeFont::fillGlyphCache(): cannot fit 5 glyphs with a total area of 680 pixels into a cache of size Vector(16, 32, 1) and Vector(16, 0, 1) filled so far\n");
 }
 
+void StbTrueTypeFontTest::fillGlyphCacheDistanceField() {
+    Containers::Pointer<AbstractFont> font = _manager.instantiate("StbTrueTypeFont");
+    font->configuration().setValue("distanceFieldSpread", 4);
+    CORRADE_VERIFY(font->openFile(Utility::Path::join(FREETYPEFONT_TEST_DIR, "Oxygen.ttf"), 16.0f));
+
+    struct GlyphCache: AbstractGlyphCache {
+        explicit GlyphCache(PixelFormat format, const Vector2i& size, const Vector2i& padding): AbstractGlyphCache{format, size, padding} {}
+
+        GlyphCacheFeatures doFeatures() const override { return {}; }
+        void doSetImage(const Vector3i&, const ImageView3D&) override {}
+    } cache{PixelFormat::R8Unorm, {64, 64}, {}};
+
+    CORRADE_VERIFY(font->fillGlyphCache(cache, "k "));
+
+    /* Compared to fillGlyphCache(), the glyph rectangle is larger by the
+       spread on each side and the offset is shifted by it */
+    Containers::Triple<Vector2i, Int, Range2Di> k = cache.glyph(0, font->glyphId('k'));
+    CORRADE_COMPARE(k.first(), (Vector2i{-3, -4}));
+    CORRADE_COMPARE(k.third().size(), (Vector2i{17, 22}));
+
+    /* Space has no outline, so it stays empty */
+    CORRADE_COMPARE(cache.glyph(0, font->glyphId(' ')).third().size(), Vector2i{});
+
+    /* The rectangle corners are further than the spread from the outline,
+       thus fully outside, while the stems are inside */
+    const Containers::StridedArrayView2D<const UnsignedByte> pixels = cache.image().pixels<UnsignedByte>()[0].sliceSize(
+        {std::size_t(k.third().min().y()),
+         std::size_t(k.third().min().x())},
+        {std::size_t(k.third().sizeY()),
+         std::size_t(k.third().sizeX())});
+    CORRADE_COMPARE(pixels[0][0], 0);
+    CORRADE_COMPARE(pixels[21][16], 0);
+    UnsignedByte max = 0;
+    for(Containers::StridedArrayView1D<const UnsignedByte> row: pixels)
+        for(UnsignedByte value: row)
+            max = Math::max(max, value);
+    CORRADE_COMPARE_AS(max, 128,
+        TestSuite::Compare::Greater);
+}
+
 void StbTrueTypeFontTest::openTwice() {
     Containers::Pointer<AbstractFont> font = _manager.instantiate("StbTrueTypeFont");
 
@@ -28,11 +28,17 @@
 
 #include "StbVorbisImporter.h"
 
-#include <cstdlib> /* std::free() */
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/ScopeGuard.h>
 #include <Corrade/Utility/Algorithms.h>
 #include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Debug.h>
 #include <Corrade/Utility/Endianness.h>
+#include <Magnum/Math/Functions.h>
+
+#include "Magnum/Implementation/audioFileStream.h"
+#include "Magnum/Implementation/remixResampleAudio.h"
 
 /* GCC 12 and 13 in Release warns about some clearly bogus "maybe
    uninitialized" variables inside stb_vorbis. I DON'T CARE, THE FILE IS PULLED
@@ -41,7 +47,7 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #endif
-#define STB_VORBIS_NO_STDIO 1
+/* Stdio is used for decoding directly from a file in the streaming mode */
 #include "stb_vorbis.c"
 #if defined(CORRADE_TARGET_GCC) && !defined(CORRADE_TARGET_CLANG) && __GNUC__ >= 12
 #pragma GCC diagnostic pop
@@ -49,69 +55,303 @@
 
 namespace Magnum { namespace Audio {
 
+namespace {
+
+/** @todo Floating-point formats */
+BufferFormat formatForChannelCount(const Int numChannels) {
+    switch(numChannels) {
+        case 1: return BufferFormat::Mono16;
+        case 2: return BufferFormat::Stereo16;
+        case 4: return BufferFormat::Quad16;
+        case 6: return BufferFormat::Surround51Channel16;
+        case 7: return BufferFormat::Surround61Channel16;
+        case 8: return BufferFormat::Surround71Channel16;
+    }
+
+    return BufferFormat{};
+}
+
+/* Used for remixed and resampled data */
+BufferFormat floatFormatForChannelCount(const Int numChannels) {
+    switch(numChannels) {
+        case 1: return BufferFormat::MonoFloat;
+        case 2: return BufferFormat::StereoFloat;
+        case 4: return BufferFormat::Quad32;
+        case 6: return BufferFormat::Surround51Channel32;
+        case 7: return BufferFormat::Surround61Channel32;
+        case 8: return BufferFormat::Surround71Channel32;
+    }
+
+    return BufferFormat{};
+}
+
+}
+
+struct StbVorbisImporter::Stream {
+    /* Decoding from a copy of the data passed to openData() */
+    explicit Stream(const Containers::ArrayView<const char> input): data{NoInit, input.size()} {
+        Utility::copy(input, data);
+    }
+
+    /* Decoding from a file passed to openFile(), takes ownership of it */
+    explicit Stream(std::FILE* const file): file{file} {}
+
+    ~Stream() {
+        if(handle) stb_vorbis_close(handle);
+        if(file) std::fclose(file);
+    }
+
+    Containers::Array<char> data;
+    std::FILE* file{};
+    stb_vorbis* handle{};
+};
+
 #ifdef MAGNUM_BUILD_DEPRECATED
 StbVorbisImporter::StbVorbisImporter() = default; /* LCOV_EXCL_LINE */
 #endif
 
 StbVorbisImporter::StbVorbisImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin): AbstractImporter{manager, plugin} {}
 
+StbVorbisImporter::~StbVorbisImporter() = default;
+
 ImporterFeatures StbVorbisImporter::doFeatures() const { return ImporterFeature::OpenData; }
 
-bool StbVorbisImporter::doIsOpened() const { return _data; }
+bool StbVorbisImporter::doIsOpened() const { return _data || _stream; }
 
 void StbVorbisImporter::doOpenData(Containers::ArrayView<const char> data) {
-    Int numChannels, frequency;
-    Short* decodedData = nullptr;
+    /* In the streaming mode the decoder stays open after this function
+       exits, so it has to operate on a copy of the data */
+    Containers::Pointer<Stream> stream;
+    if(configuration().value<bool>("streaming")) {
+        stream.emplace(data);
+        data = stream->data;
+    }
+
+    openInternal(Utility::move(stream), data, "Audio::StbVorbisImporter::openData():");
+}
+
+void StbVorbisImporter::doOpenFile(const Containers::StringView filename) {
+    /* Without streaming everything is decoded upfront, so read the whole file
+       to memory */
+    if(!configuration().value<bool>("streaming"))
+        return AbstractImporter::doOpenFile(filename);
+
+    /* Otherwise keep the file open and let the decoder read from it only
+       what it needs, instead of having a copy of the whole file in memory */
+    std::FILE* const file = Implementation::openAudioFile(filename);
+    if(!file) {
+        Error{} << "Audio::StbVorbisImporter::openFile(): cannot open file" << filename;
+        return;
+    }
 
-    Int samples = stb_vorbis_decode_memory(reinterpret_cast<const UnsignedByte*>(data.data()), data.size(), &numChannels, &frequency, &decodedData);
+    openInternal(Containers::Pointer<Stream>{InPlaceInit, file}, nullptr, "Audio::StbVorbisImporter::openFile():");
+}
 
-    if(samples == -1) {
-        Error() << "Audio::StbVorbisImporter::openData(): the file signature is invalid";
+void StbVorbisImporter::openInternal(Containers::Pointer<Stream>&& stream, const Containers::ArrayView<const char> data, const char* const prefix) {
+    /* The file is closed by the Stream, not by stb_vorbis, so it doesn't
+       need to be handled specially if opening fails */
+    int error;
+    stb_vorbis* const handle = stream && stream->file ?
+        stb_vorbis_open_file(stream->file, false, &error, nullptr) :
+        stb_vorbis_open_memory(reinterpret_cast<const UnsignedByte*>(data.data()), data.size(), &error, nullptr);
+    if(!handle) {
+        if(error == VORBIS_outofmem)
+            Error() << prefix << "out of memory";
+        else
+            Error() << prefix << "the file signature is invalid";
         return;
-    } else if (samples == -2) {
-        /* memory allocation failure */
-        Error() << "Audio::StbVorbisImporter::openData(): out of memory";
+    }
+    Containers::ScopeGuard handleClose{handle, stb_vorbis_close};
+
+    const stb_vorbis_info info = stb_vorbis_get_info(handle);
+    const BufferFormat format = formatForChannelCount(info.channels);
+    if(format == BufferFormat{}) {
+        Error() << prefix << "unsupported channel count"
+                << info.channels << "with" << 16 << "bits per sample";
         return;
     }
 
-    Containers::Array<char> tempData{reinterpret_cast<char*>(decodedData), size_t(samples*numChannels*2),
-        [](char* data, size_t) { std::free(data); }};
-    _frequency = frequency;
-
-    /** @todo Floating-point formats */
-    if(numChannels == 1)
-        _format = BufferFormat::Mono16;
-    else if(numChannels == 2)
-        _format = BufferFormat::Stereo16;
-    else if(numChannels == 4)
-        _format = BufferFormat::Quad16;
-    else if(numChannels == 6)
-        _format = BufferFormat::Surround51Channel16;
-    else if(numChannels == 7)
-        _format = BufferFormat::Surround61Channel16;
-    else if(numChannels == 8)
-        _format = BufferFormat::Surround71Channel16;
-    else {
-        Error() << "Audio::StbVorbisImporter::openData(): unsupported channel count"
-                << numChannels << "with" << 16 << "bits per sample";
+    /* Remixing and resampling is done on the whole decoded data, so it's
+       ignored in the streaming mode */
+    UnsignedInt outputFrequency = configuration().value<UnsignedInt>("outputFrequency");
+    UnsignedInt outputChannelCount = configuration().value<UnsignedInt>("outputChannelCount");
+    if(stream && (outputFrequency || outputChannelCount)) {
+        Warning{} << prefix << "outputFrequency and outputChannelCount options are ignored in the streaming mode";
+        outputFrequency = outputChannelCount = 0;
+    }
+    if(!outputFrequency) outputFrequency = info.sample_rate;
+    if(!outputChannelCount) outputChannelCount = info.channels;
+    if(!Implementation::canRemixAudio(info.channels, outputChannelCount)) {
+        Error{} << prefix << "can't remix" << info.channels << "channels to" << outputChannelCount;
         return;
     }
 
-    _data = Utility::move(tempData);
+    _format = format;
+    _frequency = info.sample_rate;
+    _channelCount = info.channels;
+    _sampleSize = sizeof(Short);
+    _frameCount = stb_vorbis_stream_length_in_samples(handle);
+    _frameOffset = 0;
+
+    /* In the streaming mode just keep the decoder open, frames get decoded
+       in readFrames(). If the length isn't known, which is the case when
+       stb_vorbis can't find the last Ogg page, there's no way to implement
+       frameCount() or seeking, so everything gets decoded upfront instead. */
+    if(stream && _frameCount) {
+        handleClose.release();
+        stream->handle = handle;
+        _stream = Utility::move(stream);
+        return;
+    }
+
+    Containers::Array<char> out;
+
+    /* Decode directly into an output of an exact size instead of letting
+       stb_vorbis_decode_memory() grow a malloc'd buffer that then has to be
+       copied in doData(). If decoding fails midway, the rest stays
+       zero-filled. */
+    if(_frameCount) {
+        out = Containers::Array<char>{ValueInit, std::size_t(_frameCount*_channelCount*sizeof(Short))};
+        const Containers::ArrayView<Short> samples = Containers::arrayCast<Short>(out);
+        for(std::size_t offset = 0; offset != _frameCount; ) {
+            const std::size_t read = stb_vorbis_get_samples_short_interleaved(handle, _channelCount, samples.data() + offset*_channelCount, (_frameCount - offset)*_channelCount);
+            if(!read) break;
+            offset += read;
+        }
+
+    /* If the length isn't known, decode in chunks and grow the output until
+       the decoder has nothing more to give */
+    } else {
+        Short samples[4096];
+        const std::size_t maxChunkFrameCount = Containers::arraySize(samples)/_channelCount;
+        while(const std::size_t read = stb_vorbis_get_samples_short_interleaved(handle, _channelCount, samples, maxChunkFrameCount*_channelCount))
+            arrayAppend(out, Containers::arrayCast<const char>(Containers::arrayView(samples).prefix(read*_channelCount)));
+
+        /* Convert the growable array back to a default deleter so it doesn't
+           point to plugin code */
+        arrayShrink(out, DefaultInit);
+        _frameCount = out.size()/(_channelCount*sizeof(Short));
+    }
+
+    /* Remix and resample the decoded data if requested, the output is
+       floats then */
+    if(outputChannelCount != _channelCount || outputFrequency != _frequency) {
+        out = Implementation::remixResampleAudio(out,
+            Implementation::AudioSampleType::Short, _channelCount, _frequency,
+            outputChannelCount, outputFrequency);
+        _format = floatFormatForChannelCount(outputChannelCount);
+        _frequency = outputFrequency;
+        _channelCount = outputChannelCount;
+        _sampleSize = sizeof(Float);
+        _frameCount = out.size()/(outputChannelCount*sizeof(Float));
+    }
+
+    _data = Utility::move(out);
 }
 
-void StbVorbisImporter::doClose() { _data = nullptr; }
+void StbVorbisImporter::doClose() {
+    _data = Containers::NullOpt;
+    _stream = nullptr;
+}
 
 BufferFormat StbVorbisImporter::doFormat() const { return _format; }
 
 UnsignedInt StbVorbisImporter::doFrequency() const { return _frequency; }
 
 Containers::Array<char> StbVorbisImporter::doData() {
-    Containers::Array<char> copy{NoInit, _data.size()};
-    Utility::copy(_data, copy);
+    /* In the streaming mode decode everything from the start and then go
+       back to where the stream was */
+    if(_stream) {
+        const UnsignedLong frameOffset = _frameOffset;
+        Containers::Array<char> out{ValueInit, std::size_t(_frameCount*_channelCount*_sampleSize)};
+        if(!seek(0)) return {};
+        readFrames(out);
+        seek(frameOffset);
+        return out;
+    }
+
+    Containers::Array<char> copy{NoInit, _data->size()};
+    Utility::copy(*_data, copy);
     return copy;
 }
 
+Containers::Array<char> StbVorbisImporter::releaseData() {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::StbVorbisImporter::releaseData(): no file opened", {});
+
+    /* In the streaming mode there's nothing to release, decode everything */
+    Containers::Array<char> out = _stream ? doData() : *Utility::move(_data);
+    close();
+    return out;
+}
+
+UnsignedLong StbVorbisImporter::frameCount() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::StbVorbisImporter::frameCount(): no file opened", {});
+    return _frameCount;
+}
+
+UnsignedLong StbVorbisImporter::frameOffset() const {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::StbVorbisImporter::frameOffset(): no file opened", {});
+    return _frameOffset;
+}
+
+std::size_t StbVorbisImporter::readFrames(const Containers::ArrayView<char> data) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::StbVorbisImporter::readFrames(): no file opened", {});
+    const std::size_t frameSize = _channelCount*_sampleSize;
+    CORRADE_ASSERT(data.size() % frameSize == 0,
+        "Audio::StbVorbisImporter::readFrames(): expected size to be a multiple of" << frameSize << "bytes but got" << data.size(), {});
+
+    const std::size_t frameCount = Math::min(UnsignedLong(data.size()/frameSize), _frameCount - _frameOffset);
+
+    /* Non-streaming mode, copy the already decoded data */
+    if(!_stream) {
+        Utility::copy(_data->sliceSize(_frameOffset*frameSize, frameCount*frameSize),
+            data.prefix(frameCount*frameSize));
+        _frameOffset += frameCount;
+        return frameCount;
+    }
+
+    /* Decode in fixed-size chunks to a temporary buffer on stack in order to
+       not have to deal with unaligned output */
+    Short samples[4096];
+    const std::size_t maxChunkFrameCount = Containers::arraySize(samples)/_channelCount;
+    std::size_t decodedFrameCount = 0;
+    while(decodedFrameCount != frameCount) {
+        const std::size_t chunkFrameCount = Math::min(frameCount - decodedFrameCount, maxChunkFrameCount);
+        const std::size_t read = stb_vorbis_get_samples_short_interleaved(_stream->handle, _channelCount, samples, chunkFrameCount*_channelCount);
+        Utility::copy(
+            Containers::arrayCast<const char>(Containers::arrayView(samples).prefix(read*_channelCount)),
+            data.sliceSize(decodedFrameCount*frameSize, read*frameSize));
+        decodedFrameCount += read;
+        if(read != chunkFrameCount) break;
+    }
+
+    _frameOffset += decodedFrameCount;
+    return decodedFrameCount;
+}
+
+bool StbVorbisImporter::seek(const UnsignedLong frame) {
+    CORRADE_ASSERT(isOpened(),
+        "Audio::StbVorbisImporter::seek(): no file opened", {});
+    if(frame > _frameCount) {
+        Error{} << "Audio::StbVorbisImporter::seek(): frame" << frame << "out of range for" << _frameCount << "frames";
+        return false;
+    }
+
+    /* stb_vorbis fails when seeking to the very end, which is fine as
+       readFrames() doesn't read past _frameCount anyway */
+    if(_stream && frame != _frameCount && !(frame ? stb_vorbis_seek(_stream->handle, frame) : stb_vorbis_seek_start(_stream->handle))) {
+        Error{} << "Audio::StbVorbisImporter::seek(): seek to frame" << frame << "failed";
+        return false;
+    }
+
+    _frameOffset = frame;
+    return true;
+}
+
 }}
 
 CORRADE_PLUGIN_REGISTER(StbVorbisAudioImporter, Magnum::Audio::StbVorbisImporter,
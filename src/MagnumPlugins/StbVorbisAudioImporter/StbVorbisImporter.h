@@ -33,6 +33,8 @@
  */
 
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "MagnumPlugins/StbVorbisAudioImporter/configure.h"
@@ -136,6 +138,67 @@ The files are imported with @ref BufferFormat::Mono16,
 @ref BufferFormat::Stereo16, @ref BufferFormat::Quad16,
 @ref BufferFormat::Surround51Channel16, @ref BufferFormat::Surround61Channel16
 and @ref BufferFormat::Surround71Channel16.
+
+@subsection Audio-StbVorbisImporter-behavior-streaming Streaming decode
+
+By default the whole file is decoded in @ref openData() and @ref data()
+returns a copy of it. Enabling the @cb{.ini} streaming @ce
+@ref Audio-StbVorbisImporter-configuration "configuration option" makes
+@ref openData() and @ref openFile() parse just the header and keep the decoder
+open instead. With @ref openFile() the data are read from the file only as the
+decoder needs them, with @ref openData() the decoder operates on a copy of the
+data passed to it. Frames are then decoded in chunks of arbitrary size
+with @ref readFrames() into a buffer supplied by the caller and @ref seek()
+can be used to jump to an arbitrary frame. The output format is the same as
+with @ref data(). Calling @ref data() in streaming mode decodes the whole file
+without affecting the read position. If the stream length can't be
+determined upfront, for example because the last Ogg page doesn't have a
+granule position, the whole file is decoded on open even in the streaming
+mode.
+
+Seeking is done by locating the Ogg page containing the frame using a
+bisection search over the file and decoding from there.
+
+The @ref readFrames(), @ref seek(), @ref frameOffset() and @ref frameCount()
+APIs work in the non-streaming mode as well, operating on the already decoded
+data. Because they're not a part of the @ref AbstractImporter interface, you
+need to link to the plugin directly and cast the importer instance to
+@ref StbVorbisImporter in order to call them.
+
+@subsection Audio-StbVorbisImporter-behavior-remix Remixing and resampling
+
+Setting the @cb{.ini} outputFrequency @ce and @cb{.ini} outputChannelCount @ce
+@ref Audio-StbVorbisImporter-configuration "configuration options" to a
+non-zero value converts the decoded data to given frequency and channel count
+in @ref openData() using a windowed sinc resampler. Mono files can be remixed
+to stereo and stereo, quad and surround files to stereo or mono, with the LFE
+channel dropped, other combinations fail to import. Converted data are
+imported as @ref BufferFormat::MonoFloat, @ref BufferFormat::StereoFloat,
+@ref BufferFormat::Quad32, @ref BufferFormat::Surround51Channel32,
+@ref BufferFormat::Surround61Channel32 or
+@ref BufferFormat::Surround71Channel32 and @ref frequency() and
+@ref frameCount() report the converted values. The options have no effect in
+the streaming mode, where a warning is printed instead.
+
+@subsection Audio-StbVorbisImporter-behavior-release Taking over the decoded data
+
+As the @ref AbstractImporter interface allows @ref data() to be called
+repeatedly, it always returns a copy of the decoded data. If the data are
+needed just once, for example to be uploaded to an audio buffer,
+@ref releaseData() hands over the internal buffer without copying and closes
+the file, avoiding a temporary that's as large as the whole decoded file.
+Same as with the streaming APIs, you need to link to the plugin directly in
+order to call it.
+
+@section Audio-StbVorbisImporter-configuration Plugin-specific configuration
+
+It's possible to tune various import options through @ref configuration().
+See below for all options and their default values:
+
+@snippet MagnumPlugins/StbVorbisAudioImporter/StbVorbisImporter.conf configuration_
+
+See @ref plugins-configuration for more information and an example showing how
+to edit the configuration values.
 */
 class MAGNUM_STBVORBISAUDIOIMPORTER_EXPORT StbVorbisImporter: public AbstractImporter {
     public:
@@ -152,19 +215,82 @@ class MAGNUM_STBVORBISAUDIOIMPORTER_EXPORT StbVorbisImporter: public AbstractImp
         /** @brief Plugin manager constructor */
         explicit StbVorbisImporter(PluginManager::AbstractManager& manager, const Containers::StringView& plugin);
 
+        ~StbVorbisImporter();
+
+        /**
+         * @brief Frame count
+         *
+         * Count of frames in the file, i.e. count of samples for each
+         * channel. Expects that a file is opened. See
+         * @ref Audio-StbVorbisImporter-behavior-streaming for more
+         * information.
+         */
+        UnsignedLong frameCount() const;
+
+        /**
+         * @brief Read position in frames
+         *
+         * Index of the frame that will be decoded by the next
+         * @ref readFrames() call. Is @cpp 0 @ce right after opening a file,
+         * is equal to @ref frameCount() once everything is read. Expects that
+         * a file is opened.
+         */
+        UnsignedLong frameOffset() const;
+
+        /**
+         * @brief Decode next frames
+         *
+         * Decodes as many frames as fit into @p data, or less if the end of
+         * the file is reached, in the same @ref format() as @ref data()
+         * returns, and advances @ref frameOffset() by the count of decoded
+         * frames. Returns the count of decoded frames, @cpp 0 @ce at the end
+         * of the file. Expects that a file is opened and that size of
+         * @p data is a multiple of the frame size.
+         */
+        std::size_t readFrames(Containers::ArrayView<char> data);
+
+        /**
+         * @brief Seek to a frame
+         *
+         * Sets @ref frameOffset() to @p frame. If @p frame is larger than
+         * @ref frameCount() or seeking fails, prints a message to
+         * @relativeref{Magnum,Error}, returns @cpp false @ce and the read
+         * position is unspecified. Expects that a file is opened.
+         */
+        bool seek(UnsignedLong frame);
+
+        /**
+         * @brief Release the decoded data
+         *
+         * Unlike @ref data(), which returns a copy, gives up ownership of the
+         * decoded data and closes the file. In the streaming mode the whole
+         * file is decoded first, same as with @ref data(). Expects that a file
+         * is opened.
+         */
+        Containers::Array<char> releaseData();
+
     private:
+        struct Stream;
+
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL ImporterFeatures doFeatures() const override;
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL bool doIsOpened() const override;
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL void doOpenData(Containers::ArrayView<const char> data) override;
+        MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL void doOpenFile(Containers::StringView filename) override;
+        MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL void openInternal(Containers::Pointer<Stream>&& stream, Containers::ArrayView<const char> data, const char* prefix);
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL void doClose() override;
 
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL BufferFormat doFormat() const override;
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL UnsignedInt doFrequency() const override;
         MAGNUM_STBVORBISAUDIOIMPORTER_LOCAL Containers::Array<char> doData() override;
 
-        Containers::Array<char> _data;
+        Containers::Optional<Containers::Array<char>> _data;
+        Containers::Pointer<Stream> _stream;
         BufferFormat _format;
         UnsignedInt _frequency;
+        UnsignedInt _channelCount;
+        UnsignedInt _sampleSize;
+        UnsignedLong _frameCount;
+        UnsignedLong _frameOffset;
 };
 
 }}
@@ -27,15 +27,22 @@
 
 #include <string> /** @todo remove once AbstractImporter is <string>-free */
 #include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
 #include <Corrade/Containers/String.h>
 #include <Corrade/Containers/StringStl.h> /** @todo remove when AbstractImporter is <string>-free */
 #include <Corrade/TestSuite/Compare/Container.h>
 #include <Corrade/TestSuite/Tester.h>
+#include <Corrade/Utility/ConfigurationGroup.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Audio/AbstractImporter.h>
 
 #include "configure.h"
 
+#ifdef MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC
+#include "MagnumPlugins/StbVorbisAudioImporter/StbVorbisImporter.h"
+#endif
+
 namespace Magnum { namespace Audio { namespace Test { namespace {
 
 struct StbVorbisImporterTest: TestSuite::Tester {
@@ -49,6 +56,17 @@ struct StbVorbisImporterTest: TestSuite::Tester {
 
     void mono16();
     void stereo8();
+    void unknownLength();
+
+    void streaming();
+    void streamingSeek();
+    void streamingData();
+    void streamingFileNotFound();
+    void releaseData();
+
+    void remixResample();
+    void remixUnsupported();
+    void remixResampleStreaming();
 
     void openTwice();
     void importTwice();
@@ -57,6 +75,55 @@ struct StbVorbisImporterTest: TestSuite::Tester {
     PluginManager::Manager<AbstractImporter> _manager{"nonexistent"};
 };
 
+const struct {
+    const char* name;
+    const char* filename;
+    BufferFormat format;
+    std::size_t frameSize;
+} StreamingData[]{
+    {"mono", "mono16.ogg", BufferFormat::Mono16, 2},
+    {"stereo", "stereo8.ogg", BufferFormat::Stereo16, 4},
+    {"zero samples", "zeroSamples.ogg", BufferFormat::Mono16, 2},
+};
+
+const Float RemixMonoToStereoData[]{
+    0.084381103515625f, 0.084381103515625f,
+    0.079437255859375f, 0.079437255859375f
+};
+
+const Float RemixStereoToMonoData[]{
+    0.1888885498046875f
+};
+
+const struct {
+    const char* name;
+    const char* filename;
+    UnsignedInt outputChannelCount, outputFrequency;
+    BufferFormat format;
+    UnsignedInt frequency;
+    std::size_t size;
+    Containers::ArrayView<const Float> data;
+} RemixResampleData[]{
+    {"mono to stereo", "mono16.ogg", 2, 0,
+        BufferFormat::StereoFloat, 96000, 16, RemixMonoToStereoData},
+    {"stereo to mono", "stereo8.ogg", 1, 0,
+        BufferFormat::MonoFloat, 96000, 4, RemixStereoToMonoData},
+    {"96 kHz to 48 kHz", "mono16.ogg", 0, 48000,
+        BufferFormat::MonoFloat, 48000, 4, {}},
+    {"same channel count and frequency", "stereo8.ogg", 2, 96000,
+        BufferFormat::Stereo16, 96000, 4, {}},
+};
+
+const struct {
+    const char* name;
+    bool streaming;
+} UnknownLengthData[]{
+    {"", false},
+    /* The length is needed for seeking, so the streaming mode falls back to
+       decoding everything upfront */
+    {"streaming", true},
+};
+
 StbVorbisImporterTest::StbVorbisImporterTest() {
     addTests({&StbVorbisImporterTest::empty,
               &StbVorbisImporterTest::wrongSignature,
@@ -65,7 +132,24 @@ StbVorbisImporterTest::StbVorbisImporterTest() {
               &StbVorbisImporterTest::zeroSamples,
 
               &StbVorbisImporterTest::mono16,
-              &StbVorbisImporterTest::stereo8,
+              &StbVorbisImporterTest::stereo8});
+
+    addInstancedTests({&StbVorbisImporterTest::unknownLength},
+        Containers::arraySize(UnknownLengthData));
+
+    addInstancedTests({&StbVorbisImporterTest::streaming},
+        Containers::arraySize(StreamingData));
+
+    addTests({&StbVorbisImporterTest::streamingSeek,
+              &StbVorbisImporterTest::streamingData,
+              &StbVorbisImporterTest::streamingFileNotFound,
+              &StbVorbisImporterTest::releaseData});
+
+    addInstancedTests({&StbVorbisImporterTest::remixResample},
+        Containers::arraySize(RemixResampleData));
+
+    addTests({&StbVorbisImporterTest::remixUnsupported,
+              &StbVorbisImporterTest::remixResampleStreaming,
 
               &StbVorbisImporterTest::openTwice,
               &StbVorbisImporterTest::importTwice});
@@ -142,6 +226,201 @@ void StbVorbisImporterTest::stereo8() {
     }), TestSuite::Compare::Container);
 }
 
+void StbVorbisImporterTest::unknownLength() {
+    auto&& data = UnknownLengthData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("streaming", data.streaming);
+
+    /* Same as mono16.ogg, but with the granule position of the last page set
+       to -1 and the page checksum updated, which makes stb_vorbis unable to
+       determine the stream length. Without the final granule position the
+       last frame isn't trimmed, so the whole 128 samples are decoded. */
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "unknownLength.ogg")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Mono16);
+    CORRADE_COMPARE(importer->frequency(), 96000);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), 128*2);
+    CORRADE_COMPARE_AS(out.prefix(4), Containers::arrayView<char>({
+        '\xcd', '\x0a', '\x2b', '\x0a'
+    }), TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_COMPARE(static_cast<StbVorbisImporter&>(*importer).frameCount(), 128);
+    #endif
+}
+
+void StbVorbisImporterTest::streaming() {
+    auto&& data = StreamingData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, data.filename)));
+    const UnsignedInt frequency = importer->frequency();
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Pointer<AbstractImporter> streamingImporter = _manager.instantiate("StbVorbisAudioImporter");
+    streamingImporter->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(streamingImporter->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, data.filename)));
+    CORRADE_COMPARE(streamingImporter->format(), data.format);
+    CORRADE_COMPARE(streamingImporter->frequency(), frequency);
+
+    /* Decoding everything in the streaming mode should give the same result
+       as in the non-streaming mode */
+    CORRADE_COMPARE_AS(streamingImporter->data(), expected,
+        TestSuite::Compare::Container);
+
+    #ifdef MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC
+    StbVorbisImporter& stbVorbisImporter = static_cast<StbVorbisImporter&>(*streamingImporter);
+    CORRADE_COMPARE(stbVorbisImporter.frameOffset(), 0);
+
+    /* Decode in chunks of 100 frames, the last chunk is shorter */
+    const std::size_t frameSize = data.frameSize;
+    const UnsignedLong frameCount = stbVorbisImporter.frameCount();
+    Containers::Array<char> out{NoInit, 100*frameSize};
+    Containers::Array<char> actual;
+    for(std::size_t read; (read = stbVorbisImporter.readFrames(out)); )
+        arrayAppend(actual, out.prefix(read*frameSize));
+    CORRADE_COMPARE(stbVorbisImporter.frameOffset(), frameCount);
+    CORRADE_COMPARE_AS(actual, expected,
+        TestSuite::Compare::Container);
+    #endif
+}
+
+void StbVorbisImporterTest::streamingSeek() {
+    #ifndef MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("Streaming APIs can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "mono16.ogg")));
+    StbVorbisImporter& stbVorbisImporter = static_cast<StbVorbisImporter&>(*importer);
+    CORRADE_COMPARE(stbVorbisImporter.frameCount(), 2);
+
+    /* The file has just two frames, so this is all we can test */
+    char out[4];
+    CORRADE_VERIFY(stbVorbisImporter.seek(1));
+    CORRADE_COMPARE(stbVorbisImporter.frameOffset(), 1);
+    CORRADE_COMPARE(stbVorbisImporter.readFrames(out), 1);
+    CORRADE_COMPARE(stbVorbisImporter.frameOffset(), 2);
+    CORRADE_COMPARE_AS(Containers::arrayView(out).prefix(2), Containers::arrayView<char>({
+        '\x2b', '\x0a'
+    }), TestSuite::Compare::Container);
+
+    /* Seeking back */
+    CORRADE_VERIFY(stbVorbisImporter.seek(0));
+    CORRADE_COMPARE(stbVorbisImporter.readFrames(out), 2);
+    CORRADE_COMPARE_AS(Containers::arrayView(out), Containers::arrayView<char>({
+        '\xcd', '\x0a', '\x2b', '\x0a'
+    }), TestSuite::Compare::Container);
+
+    /* Seeking to the end is fine, past it not */
+    CORRADE_VERIFY(stbVorbisImporter.seek(2));
+    CORRADE_COMPARE(stbVorbisImporter.readFrames(out), 0);
+
+    Containers::String outError;
+    Error redirectError{&outError};
+    CORRADE_VERIFY(!stbVorbisImporter.seek(3));
+    CORRADE_COMPARE(outError, "Audio::StbVorbisImporter::seek(): frame 3 out of range for 2 frames\n");
+    #endif
+}
+
+void StbVorbisImporterTest::streamingData() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "stereo8.ogg")));
+    Containers::Array<char> expected = importer->data();
+
+    Containers::Optional<Containers::Array<char>> data = Utility::Path::read(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "stereo8.ogg"));
+    CORRADE_VERIFY(data);
+
+    /* Unlike with openFile(), the decoder operates on a copy of the data, so
+       it should work even after the original memory is gone */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openData(*data));
+    *data = Containers::Array<char>{};
+    CORRADE_COMPARE_AS(importer->data(), expected,
+        TestSuite::Compare::Container);
+}
+
+void StbVorbisImporterTest::streamingFileNotFound() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("streaming", true);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile("nonexistent.ogg"));
+    CORRADE_COMPARE(out, "Audio::StbVorbisImporter::openFile(): cannot open file nonexistent.ogg\n");
+}
+
+void StbVorbisImporterTest::releaseData() {
+    #ifndef MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC
+    CORRADE_SKIP("StbVorbisImporter::releaseData() can be used only if the plugin is built as static.");
+    #else
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "mono16.ogg")));
+    Containers::Array<char> expected = importer->data();
+
+    /* The released data should be the same as the copy and the file gets
+       closed */
+    StbVorbisImporter& stbVorbisImporter = static_cast<StbVorbisImporter&>(*importer);
+    CORRADE_COMPARE_AS(stbVorbisImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+
+    /* In the streaming mode it decodes everything */
+    importer->configuration().setValue("streaming", true);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "mono16.ogg")));
+    CORRADE_COMPARE_AS(stbVorbisImporter.releaseData(), expected,
+        TestSuite::Compare::Container);
+    CORRADE_VERIFY(!importer->isOpened());
+    #endif
+}
+
+void StbVorbisImporterTest::remixResample() {
+    auto&& data = RemixResampleData[testCaseInstanceId()];
+    setTestCaseDescription(data.name);
+
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("outputChannelCount", data.outputChannelCount);
+    importer->configuration().setValue("outputFrequency", data.outputFrequency);
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, data.filename)));
+
+    CORRADE_COMPARE(importer->format(), data.format);
+    CORRADE_COMPARE(importer->frequency(), data.frequency);
+
+    Containers::Array<char> out = importer->data();
+    CORRADE_COMPARE(out.size(), data.size);
+    if(!data.data.isEmpty())
+        CORRADE_COMPARE_AS(Containers::arrayCast<const Float>(out), data.data,
+            TestSuite::Compare::Container);
+}
+
+void StbVorbisImporterTest::remixUnsupported() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("outputChannelCount", 6);
+
+    Containers::String out;
+    Error redirectError{&out};
+    CORRADE_VERIFY(!importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "stereo8.ogg")));
+    CORRADE_COMPARE(out, "Audio::StbVorbisImporter::openData(): can't remix 2 channels to 6\n");
+}
+
+void StbVorbisImporterTest::remixResampleStreaming() {
+    Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
+    importer->configuration().setValue("streaming", true);
+    importer->configuration().setValue("outputFrequency", 22050);
+
+    /* The options are ignored, the file is imported as-is */
+    Containers::String out;
+    Warning redirectWarning{&out};
+    CORRADE_VERIFY(importer->openFile(Utility::Path::join(STBVORBISAUDIOIMPORTER_TEST_DIR, "mono16.ogg")));
+    CORRADE_COMPARE(importer->format(), BufferFormat::Mono16);
+    CORRADE_COMPARE(importer->frequency(), 96000);
+    CORRADE_COMPARE(out, "Audio::StbVorbisImporter::openFile(): outputFrequency and outputChannelCount options are ignored in the streaming mode\n");
+}
+
 void StbVorbisImporterTest::openTwice() {
     Containers::Pointer<AbstractImporter> importer = _manager.instantiate("StbVorbisAudioImporter");
 
@@ -27,3 +27,4 @@
 
 #cmakedefine STBVORBISAUDIOIMPORTER_PLUGIN_FILENAME "${STBVORBISAUDIOIMPORTER_PLUGIN_FILENAME}"
 #define STBVORBISAUDIOIMPORTER_TEST_DIR "${STBVORBISAUDIOIMPORTER_TEST_DIR}"
+#cmakedefine MAGNUM_STBVORBISAUDIOIMPORTER_BUILD_STATIC